@@ -0,0 +1,289 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Micro-benchmark harness based on the timestamp counter class Tsc.
+ *
+ * The same benchmark source runs on the target, e.g. with Htsc or
+ * Tsc<Dwt_time_base> as time base, and on the host with the host time
+ * base (see hodea/device/host/host_time_base.hpp).
+ *
+ * Each benchmark is warmed up first. Then the timing of \a batch
+ * invocations is measured for a number of repetitions. Minimum and
+ * median of the repetitions are reported, corrected by the overhead of
+ * the measurement itself. The minimum is the most stable figure for
+ * regression checks, the median shows the influence of interrupts,
+ * caches and flash wait states.
+ *
+ * Results are given in ticks of the time base. If the timestamp counter
+ * is clocked with the core clock, e.g. SysTick with clock source
+ * processor clock or the DWT cycle counter, ticks are CPU cycles.
+ *
+ * The results are reported as machine-readable CSV lines:
+ *
+ * \verbatim
+ * bench,<name>,<reps>,<batch>,<min>,<median>,<counter_clk_hz>
+ * \endverbatim
+ *
+ * <min> and <median> are the ticks per invocation, multiplied by 1000
+ * to preserve sub-tick resolution for batched benchmarks.
+ *
+ * Benchmarks of codecs additionally report the size of their output
+ * for a given input, so changes of the compression ratio are visible
+ * next to the timing:
+ *
+ * \verbatim
+ * size,<name>,<input_bytes>,<output_bytes>
+ * \endverbatim
+ *
+ * An output size of -1 flags that decoding the output did not restore
+ * the input.
+ *
+ * Example:
+ *
+ * \code
+ * Bench<Htsc> bench;
+ *
+ * bench.run("store32_le", [&] {
+ *     do_not_optimize(val);
+ *     store32_le(buf, val);
+ *     clobber_memory();
+ * }, 64);
+ * \endcode
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BENCH_HPP
+#define HODEA_BENCH_HPP
+
+#include <atomic>
+#include <cstdio>
+#include <hodea/core/cstdint.hpp>
+
+namespace hodea {
+
+#if defined __GNUC__
+
+/**
+ * Force the compiler to materialize \a val and treat it as modified.
+ *
+ * Use this for benchmark inputs to prevent the compiler from
+ * calculating the result at compile time, and for results to prevent
+ * the compiler from discarding the calculation.
+ */
+template <typename T>
+inline void do_not_optimize(T& val)
+{
+    __asm volatile("" : "+m,r"(val) : : "memory");
+}
+
+/**
+ * Force the compiler to materialize \a val.
+ */
+template <typename T>
+inline void do_not_optimize(const T& val)
+{
+    __asm volatile("" : : "m,r"(val) : "memory");
+}
+
+/**
+ * Force the compiler to complete all pending stores to memory.
+ */
+inline void clobber_memory()
+{
+    __asm volatile("" : : : "memory");
+}
+
+#else
+
+template <typename T>
+inline void do_not_optimize(const T& val)
+{
+    static volatile const void* sink;
+
+    sink = &val;
+}
+
+inline void clobber_memory()
+{
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+#endif
+
+/**
+ * Class to run micro-benchmarks.
+ *
+ * \tparam T_tsc
+ *      Timestamp counter class, e.g. Htsc.
+ * \tparam max_reps
+ *      Maximum number of repetitions. Determines the memory required to
+ *      calculate the median.
+ */
+template <class T_tsc, int max_reps = 31>
+class Bench {
+public:
+    typedef typename T_tsc::Ticks Ticks;
+
+    /**
+     * Result of a single benchmark.
+     *
+     * Times are given in 1/1000 ticks per invocation.
+     */
+    struct Result {
+        const char* name;
+        int reps;
+        int batch;
+        uint64_t min_milli_ticks;
+        uint64_t median_milli_ticks;
+    };
+
+    typedef void (*Reporter)(const Result& result);
+
+    /**
+     * Constructor.
+     *
+     * \param[in] reps
+     *      Number of measured repetitions, limited to [1, \a max_reps].
+     * \param[in] warmup
+     *      Number of repetitions executed before the measurement.
+     * \param[in] reporter
+     *      Function called with the result of each benchmark.
+     */
+    explicit Bench(
+        int reps = max_reps, int warmup = 2,
+        Reporter reporter = print_csv
+        )
+        : reps{(reps < 1) ? 1 : ((reps < max_reps) ? reps : max_reps)},
+          warmup{warmup}, reporter{reporter}
+    {
+        overhead = measure_min([] {}, 1);
+    }
+
+    /**
+     * Run a benchmark.
+     *
+     * \param[in] name
+     *      Name of the benchmark used in the report.
+     * \param[in] code
+     *      The code to benchmark.
+     * \param[in] batch
+     *      Number of invocations of \a code per repetition.
+     *
+     * \returns
+     *      The result of the benchmark.
+     */
+    template <typename F>
+    Result run(const char* name, F&& code, int batch = 1)
+    {
+        Ticks samples[max_reps];
+
+        for (int i = 0; i < warmup; ++i)
+            measure(code, batch);
+
+        for (int i = 0; i < reps; ++i) {
+            Ticks t = measure(code, batch);
+            samples[i] = (t > overhead) ? t - overhead : 0;
+        }
+
+        sort(samples, reps);
+
+        Result result{
+            name, reps, batch,
+            per_invocation(samples[0], batch),
+            per_invocation(samples[reps / 2], batch)
+        };
+
+        if (reporter)
+            reporter(result);
+        return result;
+    }
+
+    /**
+     * Report a result as CSV line via printf().
+     *
+     * The times are saturated to 32 bit, as the printf() of newlib-nano
+     * does not support 64 bit conversions. This limits the reported
+     * time to about 4.29 million ticks per invocation.
+     */
+    static void print_csv(const Result& r)
+    {
+        printf(
+            "bench,%s,%d,%d,%lu,%lu,%lu\n",
+            r.name, r.reps, r.batch,
+            saturate_u32(r.min_milli_ticks),
+            saturate_u32(r.median_milli_ticks),
+            static_cast<unsigned long>(T_tsc::counter_clk_hz)
+            );
+    }
+
+    /**
+     * Report the output size of a codec as CSV line via printf().
+     *
+     * Nothing is printed if the benchmark was constructed without a
+     * reporter.
+     */
+    void report_size(const char* name, int input_size, int output_size)
+    {
+        if (reporter)
+            printf("size,%s,%d,%d\n", name, input_size, output_size);
+    }
+
+private:
+    template <typename F>
+    static Ticks measure(F& code, int batch)
+    {
+        Ticks ts_start = T_tsc::now();
+        clobber_memory();
+
+        for (int i = 0; i < batch; ++i)
+            code();
+
+        clobber_memory();
+        return T_tsc::elapsed(ts_start, T_tsc::now());
+    }
+
+    template <typename F>
+    Ticks measure_min(F code, int batch)
+    {
+        Ticks t_min = measure(code, batch);
+
+        for (int i = 1; i < reps; ++i) {
+            Ticks t = measure(code, batch);
+            if (t < t_min)
+                t_min = t;
+        }
+        return t_min;
+    }
+
+    static void sort(Ticks* samples, int n)
+    {
+        for (int i = 1; i < n; ++i) {
+            Ticks v = samples[i];
+            int j = i;
+
+            for (; (j > 0) && (samples[j - 1] > v); --j)
+                samples[j] = samples[j - 1];
+            samples[j] = v;
+        }
+    }
+
+    static unsigned long saturate_u32(uint64_t v)
+    {
+        return static_cast<uint32_t>((v > 0xffffffffU) ? 0xffffffffU : v);
+    }
+
+    static uint64_t per_invocation(Ticks t, int batch)
+    {
+        return (static_cast<uint64_t>(t) * 1000) / batch;
+    }
+
+    const int reps;
+    const int warmup;
+    const Reporter reporter;
+    Ticks overhead;
+};
+
+} // namespace hodea
+
+#endif /*!HODEA_BENCH_HPP */
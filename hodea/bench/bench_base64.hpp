@@ -0,0 +1,67 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Benchmarks for base64.hpp.
+ *
+ * A buffer of 1020 bytes is encoded and decoded. The scalar versions
+ * are compared with the default path, which uses SIMD instructions if
+ * enabled for the build. Divide the result by 1020 to get the time per
+ * byte.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BENCH_BASE64_HPP
+#define HODEA_BENCH_BASE64_HPP
+
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/base64.hpp>
+#include <hodea/bench/bench.hpp>
+
+namespace hodea {
+
+/**
+ * Run the benchmarks for the base64 codec.
+ */
+template <class T_bench>
+void bench_base64(T_bench& bench, int batch = 1)
+{
+    constexpr int data_size = 1020;
+    static uint8_t data[data_size];
+    static char text[base64_encoded_size(data_size)];
+    int len = 0;
+
+    for (int i = 0; i < data_size; ++i)
+        data[i] = i * 37 + (i >> 3);
+    base64_encode(text, data, data_size);
+
+    bench.run("base64_encode_scalar_1k", [&] {
+        clobber_memory();
+        len = base64_encode_scalar(text, data, data_size);
+        clobber_memory();
+    }, batch);
+
+    bench.run("base64_encode_1k", [&] {
+        clobber_memory();
+        len = base64_encode(text, data, data_size);
+        clobber_memory();
+    }, batch);
+
+    bench.run("base64_decode_scalar_1k", [&] {
+        clobber_memory();
+        len = base64_decode_scalar(data, text, sizeof(text));
+        clobber_memory();
+    }, batch);
+
+    bench.run("base64_decode_1k", [&] {
+        clobber_memory();
+        len = base64_decode(data, text, sizeof(text));
+        clobber_memory();
+    }, batch);
+
+    do_not_optimize(len);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BENCH_BASE64_HPP */
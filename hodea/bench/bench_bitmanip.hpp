@@ -0,0 +1,60 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Benchmarks for bitmanip.hpp.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BENCH_BITMANIP_HPP
+#define HODEA_BENCH_BITMANIP_HPP
+
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/bitmanip.hpp>
+#include <hodea/bench/bench.hpp>
+
+namespace hodea {
+
+/**
+ * Run the benchmarks for the bit manipulation functions.
+ *
+ * The benchmarks operate on a volatile variable to resemble the access
+ * to peripheral registers.
+ */
+template <class T_bench>
+void bench_bitmanip(T_bench& bench, int batch = 64)
+{
+    volatile uint32_t reg = 0;
+    uint32_t msk = 0x00f0U;
+    bool is_set = false;
+
+    bench.run("set_bit", [&] {
+        do_not_optimize(msk);
+        set_bit(reg, msk);
+    }, batch);
+
+    bench.run("clr_bit", [&] {
+        do_not_optimize(msk);
+        clr_bit(reg, msk);
+    }, batch);
+
+    bench.run("toggle_bit", [&] {
+        do_not_optimize(msk);
+        toggle_bit(reg, msk);
+    }, batch);
+
+    bench.run("modify_bits", [&] {
+        do_not_optimize(msk);
+        modify_bits(reg, msk, msk << 8);
+    }, batch);
+
+    bench.run("is_bit_set", [&] {
+        do_not_optimize(msk);
+        is_set = is_bit_set(reg, msk, true);
+        do_not_optimize(is_set);
+    }, batch);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BENCH_BITMANIP_HPP */
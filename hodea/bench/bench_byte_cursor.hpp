@@ -0,0 +1,108 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Benchmarks for byte_cursor.hpp.
+ *
+ * The bounds-checked cursors are compared with unchecked raw pointer
+ * code and with code checking the remaining space for each field. All
+ * variants encode and decode the message used by bench_msg_codec.hpp.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BENCH_BYTE_CURSOR_HPP
+#define HODEA_BENCH_BYTE_CURSOR_HPP
+
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/byte_cursor.hpp>
+#include <hodea/core/serialization.hpp>
+#include <hodea/core/wire_format.hpp>
+#include <hodea/bench/bench.hpp>
+#include <hodea/bench/bench_msg_codec.hpp>
+
+namespace hodea {
+
+/**
+ * Run the benchmarks for the byte cursors.
+ */
+template <class T_bench>
+void bench_byte_cursor(T_bench& bench, int batch = 64)
+{
+    uint8_t buf[32];
+    int len = Bench_msg_codec::size;
+    Bench_msg msg{0x11, 0x2233, -4, 0x55667788U, 0x0123456789abcdefULL};
+    int num_failed = 0;
+
+    bench.run("cursor_raw_encode", [&] {
+        do_not_optimize(msg);
+        uint8_t* p = buf;
+        p += store8(p, msg.id);
+        p += store16_le(p, msg.flags);
+        p += store32_le(p, msg.current);
+        p += store32_be(p, msg.voltage);
+        p += store64_be(p, msg.timestamp);
+        clobber_memory();
+    }, batch);
+
+    bench.run("cursor_per_field_encode", [&] {
+        do_not_optimize(msg);
+        uint8_t* p = buf;
+        uint8_t* end = buf + sizeof(buf);
+        if (end - p < 1)
+            goto fail;
+        p += store8(p, msg.id);
+        if (end - p < 2)
+            goto fail;
+        p += store16_le(p, msg.flags);
+        if (end - p < 4)
+            goto fail;
+        p += store32_le(p, msg.current);
+        if (end - p < 4)
+            goto fail;
+        p += store32_be(p, msg.voltage);
+        if (end - p < 8)
+            goto fail;
+        p += store64_be(p, msg.timestamp);
+        clobber_memory();
+        return;
+    fail:
+        ++num_failed;
+    }, batch);
+
+    bench.run("cursor_writer_encode", [&] {
+        do_not_optimize(msg);
+        Byte_writer w{buf};
+        w.put<Wire_u8, Wire_le16, Wire_le32, Wire_be32, Wire_be64>(
+            msg.id, msg.flags, msg.current, msg.voltage, msg.timestamp
+            );
+        num_failed += !w.ok();
+        clobber_memory();
+    }, batch);
+
+    bench.run("cursor_raw_decode", [&] {
+        clobber_memory();
+        const uint8_t* p = buf;
+        p += fetch8(msg.id, p);
+        p += fetch16_le(msg.flags, p);
+        p += fetch32_le(msg.current, p);
+        p += fetch32_be(msg.voltage, p);
+        p += fetch64_be(msg.timestamp, p);
+        do_not_optimize(msg);
+    }, batch);
+
+    bench.run("cursor_reader_decode", [&] {
+        clobber_memory();
+        Byte_reader r{buf, len};
+        r.get<Wire_u8, Wire_le16, Wire_le32, Wire_be32, Wire_be64>(
+            msg.id, msg.flags, msg.current, msg.voltage, msg.timestamp
+            );
+        num_failed += !r.ok();
+        do_not_optimize(msg);
+    }, batch);
+
+    do_not_optimize(num_failed);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BENCH_BYTE_CURSOR_HPP */
@@ -0,0 +1,67 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Benchmarks for cpu_endian.hpp and uswap.hpp.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BENCH_CPU_ENDIAN_HPP
+#define HODEA_BENCH_CPU_ENDIAN_HPP
+
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/cpu_endian.hpp>
+#include <hodea/bench/bench.hpp>
+
+namespace hodea {
+
+/**
+ * Run the benchmarks for the byte order conversion functions.
+ */
+template <class T_bench>
+void bench_cpu_endian(T_bench& bench, int batch = 64)
+{
+    uint16_t v16 = 0x1234;
+    uint32_t v32 = 0x12345678;
+    uint64_t v64 = 0x0123456789abcdefULL;
+
+    bench.run("uswap16", [&] {
+        do_not_optimize(v16);
+        v16 = uswap16(v16);
+        do_not_optimize(v16);
+    }, batch);
+
+    bench.run("uswap32", [&] {
+        do_not_optimize(v32);
+        v32 = uswap32(v32);
+        do_not_optimize(v32);
+    }, batch);
+
+    bench.run("uswap64", [&] {
+        do_not_optimize(v64);
+        v64 = uswap64(v64);
+        do_not_optimize(v64);
+    }, batch);
+
+    bench.run("cpu_to_be32", [&] {
+        do_not_optimize(v32);
+        v32 = cpu_to_be32(v32);
+        do_not_optimize(v32);
+    }, batch);
+
+    bench.run("le32_to_cpu", [&] {
+        do_not_optimize(v32);
+        v32 = le32_to_cpu(v32);
+        do_not_optimize(v32);
+    }, batch);
+
+    bench.run("be64_to_cpu", [&] {
+        do_not_optimize(v64);
+        v64 = be64_to_cpu(v64);
+        do_not_optimize(v64);
+    }, batch);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BENCH_CPU_ENDIAN_HPP */
@@ -0,0 +1,63 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Benchmarks for crc.hpp.
+ *
+ * The CRC-32 over a buffer of 1024 bytes is calculated with each table
+ * size. With PCLMULQDQ enabled for the build, the slice-by-8 variant
+ * uses carry-less multiplication. Divide the result by 1024 to get the
+ * time per byte.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BENCH_CRC_HPP
+#define HODEA_BENCH_CRC_HPP
+
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/crc.hpp>
+#include <hodea/bench/bench.hpp>
+
+namespace hodea {
+
+/**
+ * Run the benchmarks for the CRC calculation.
+ */
+template <class T_bench>
+void bench_crc(T_bench& bench, int batch = 1)
+{
+    constexpr int data_size = 1024;
+    static uint8_t data[data_size];
+    uint32_t crc = 0;
+
+    for (int i = 0; i < data_size; ++i)
+        data[i] = i * 37 + (i >> 3);
+
+    bench.run("crc32_nibble_1k", [&] {
+        clobber_memory();
+        crc = Crc32<Crc_table::nibble>::compute(data, data_size);
+        do_not_optimize(crc);
+    }, batch);
+
+    bench.run("crc32_byte_1k", [&] {
+        clobber_memory();
+        crc = Crc32<Crc_table::byte>::compute(data, data_size);
+        do_not_optimize(crc);
+    }, batch);
+
+    bench.run("crc32_slice8_1k", [&] {
+        clobber_memory();
+        crc = Crc32<Crc_table::slice8>::compute(data, data_size);
+        do_not_optimize(crc);
+    }, batch);
+
+    bench.run("crc32_stm32_slice8_1k", [&] {
+        clobber_memory();
+        crc = Crc32_stm32<Crc_table::slice8>{}(data, data_size);
+        do_not_optimize(crc);
+    }, batch);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BENCH_CRC_HPP */
@@ -0,0 +1,84 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Benchmarks for delta_codec.hpp.
+ *
+ * 256 samples of a 12 bit ADC waveform are encoded and decoded. The
+ * waveform is a slow triangle with superimposed noise of +/-3 LSB,
+ * generated without floating point arithmetic so the benchmark also
+ * runs on targets without FPU. The encoded size is reported against the
+ * 512 bytes of the samples stored as 16 bit words.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BENCH_DELTA_CODEC_HPP
+#define HODEA_BENCH_DELTA_CODEC_HPP
+
+#include <cstring>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/bitstream.hpp>
+#include <hodea/core/delta_codec.hpp>
+#include <hodea/core/serialization.hpp>
+#include <hodea/bench/bench.hpp>
+
+namespace hodea {
+
+/**
+ * Run the benchmarks for the delta codec.
+ */
+template <class T_bench>
+void bench_delta_codec(T_bench& bench, int batch = 4)
+{
+    constexpr int num_samples = 256;
+    static uint16_t samples[num_samples];
+    static uint16_t decoded[num_samples];
+    static uint8_t buf[2 * num_samples];
+    uint32_t rnd = 1;
+    int len = 0;
+
+    for (int i = 0; i < num_samples; ++i) {
+        int tri = (i < num_samples / 2) ? i : num_samples - i;
+        rnd = rnd * 1103515245U + 12345U;
+        samples[i] = static_cast<uint16_t>(
+            1024 + 16 * tri + static_cast<int>((rnd >> 16) % 7) - 3
+            );
+    }
+
+    bench.run("delta_store16_256", [&] {
+        clobber_memory();
+        uint8_t* p = buf;
+        for (int i = 0; i < num_samples; ++i)
+            p += store16_le(p, samples[i]);
+        clobber_memory();
+    }, batch);
+
+    bench.run("delta_encode_256", [&] {
+        clobber_memory();
+        Bit_writer w{buf};
+        Delta_encoder<> enc{w};
+        enc.put(samples, num_samples);
+        enc.flush();
+        len = w.size();
+        clobber_memory();
+    }, batch);
+
+    bench.run("delta_decode_256", [&] {
+        clobber_memory();
+        Bit_reader r{buf, len};
+        Delta_decoder<> dec{r};
+        dec.get(decoded, num_samples);
+        clobber_memory();
+    }, batch);
+
+    bench.report_size(
+        "delta_encode_256", sizeof(samples),
+        (std::memcmp(decoded, samples, sizeof(samples)) == 0) ? len : -1
+        );
+
+    do_not_optimize(len);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BENCH_DELTA_CODEC_HPP */
@@ -0,0 +1,113 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Benchmarks for endian_types.hpp.
+ *
+ * The message used by bench_msg_codec.hpp is accessed in place via a
+ * struct composed of endian types, and compared with the fetch and
+ * store functions of serialization.hpp.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BENCH_ENDIAN_TYPES_HPP
+#define HODEA_BENCH_ENDIAN_TYPES_HPP
+
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/endian_types.hpp>
+#include <hodea/core/serialization.hpp>
+#include <hodea/bench/bench.hpp>
+#include <hodea/bench/bench_msg_codec.hpp>
+
+namespace hodea {
+
+/**
+ * Wire layout of Bench_msg.
+ */
+struct Bench_msg_overlay {
+    uint8_t id;
+    le_uint16_t flags;
+    le_uint32_t current;
+    be_uint32_t voltage;
+    be_uint64_t timestamp;
+};
+
+static_assert(
+    sizeof(Bench_msg_overlay) == Bench_msg_codec::size,
+    "Bench_msg_overlay does not match the message layout"
+    );
+
+/**
+ * Run the benchmarks for the endian types.
+ */
+template <class T_bench>
+void bench_endian_types(T_bench& bench, int batch = 64)
+{
+    uint8_t buf[Bench_msg_codec::size];
+    Bench_msg msg{0x11, 0x2233, -4, 0x55667788U, 0x0123456789abcdefULL};
+    auto frame = reinterpret_cast<Bench_msg_overlay*>(buf);
+
+    bench.run("overlay_encode", [&] {
+        do_not_optimize(msg);
+        frame->id = msg.id;
+        frame->flags = msg.flags;
+        frame->current = msg.current;
+        frame->voltage = msg.voltage;
+        frame->timestamp = msg.timestamp;
+        clobber_memory();
+    }, batch);
+
+    bench.run("overlay_store_encode", [&] {
+        do_not_optimize(msg);
+        uint8_t* p = buf;
+        p += store8(p, msg.id);
+        p += store16_le(p, msg.flags);
+        p += store32_le(p, msg.current);
+        p += store32_be(p, msg.voltage);
+        p += store64_be(p, msg.timestamp);
+        clobber_memory();
+    }, batch);
+
+    bench.run("overlay_decode", [&] {
+        clobber_memory();
+        msg.id = frame->id;
+        msg.flags = frame->flags;
+        msg.current = frame->current;
+        msg.voltage = frame->voltage;
+        msg.timestamp = frame->timestamp;
+        do_not_optimize(msg);
+    }, batch);
+
+    bench.run("overlay_fetch_decode", [&] {
+        clobber_memory();
+        const uint8_t* p = buf;
+        p += fetch8(msg.id, p);
+        p += fetch16_le(msg.flags, p);
+        p += fetch32_le(msg.current, p);
+        p += fetch32_be(msg.voltage, p);
+        p += fetch64_be(msg.timestamp, p);
+        do_not_optimize(msg);
+    }, batch);
+
+    /*
+     * Typical use case: check a single field in place, e.g. the
+     * timestamp, without decoding the whole message.
+     */
+    uint64_t ts;
+
+    bench.run("overlay_field_access", [&] {
+        clobber_memory();
+        ts = frame->timestamp;
+        do_not_optimize(ts);
+    }, batch);
+
+    bench.run("overlay_fetch_field", [&] {
+        clobber_memory();
+        fetch64_be(ts, buf + 11);
+        do_not_optimize(ts);
+    }, batch);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BENCH_ENDIAN_TYPES_HPP */
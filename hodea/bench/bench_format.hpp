@@ -0,0 +1,87 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Benchmarks for format.hpp.
+ *
+ * The format functions are compared with snprintf() for the same
+ * conversions.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BENCH_FORMAT_HPP
+#define HODEA_BENCH_FORMAT_HPP
+
+#include <cstdio>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/format.hpp>
+#include <hodea/bench/bench.hpp>
+
+namespace hodea {
+
+/**
+ * Run the benchmarks for the number formatting.
+ */
+template <class T_bench>
+void bench_format(T_bench& bench, int batch = 16)
+{
+    char buf[32];
+    uint32_t u32 = 3141592653U;
+    int64_t i64 = -1234567890123456789LL;
+    int32_t q15 = 0x2b3c;
+    int len = 0;
+
+    bench.run("format_u32", [&] {
+        do_not_optimize(u32);
+        len = format_u32(buf, u32);
+        clobber_memory();
+    }, batch);
+
+    bench.run("snprintf_u32", [&] {
+        do_not_optimize(u32);
+        len = snprintf(
+            buf, sizeof(buf), "%lu", static_cast<unsigned long>(u32)
+            );
+        clobber_memory();
+    }, batch);
+
+    bench.run("format_i64", [&] {
+        do_not_optimize(i64);
+        len = format_i64(buf, i64);
+        clobber_memory();
+    }, batch);
+
+    bench.run("snprintf_i64", [&] {
+        do_not_optimize(i64);
+        len = snprintf(
+            buf, sizeof(buf), "%lld", static_cast<long long>(i64)
+            );
+        clobber_memory();
+    }, batch);
+
+    bench.run("format_hex32", [&] {
+        do_not_optimize(u32);
+        len = format_hex(buf, u32, 8);
+        clobber_memory();
+    }, batch);
+
+    bench.run("snprintf_hex32", [&] {
+        do_not_optimize(u32);
+        len = snprintf(
+            buf, sizeof(buf), "%08lx", static_cast<unsigned long>(u32)
+            );
+        clobber_memory();
+    }, batch);
+
+    bench.run("format_fixed_q15", [&] {
+        do_not_optimize(q15);
+        len = format_fixed<15, 4>(buf, q15);
+        clobber_memory();
+    }, batch);
+
+    do_not_optimize(len);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BENCH_FORMAT_HPP */
@@ -0,0 +1,87 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Benchmarks for cobs.hpp and slip.hpp.
+ *
+ * A frame of 256 bytes is encoded and decoded. The payload contains
+ * all byte values, so both zero bytes for COBS and special characters
+ * for SLIP occur.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BENCH_FRAMING_HPP
+#define HODEA_BENCH_FRAMING_HPP
+
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/cobs.hpp>
+#include <hodea/core/slip.hpp>
+#include <hodea/bench/bench.hpp>
+
+namespace hodea {
+
+/**
+ * Run the benchmarks for the framing protocols.
+ */
+template <class T_bench>
+void bench_framing(T_bench& bench, int batch = 4)
+{
+    constexpr int payload_size = 256;
+    static uint8_t payload[payload_size];
+    static uint8_t encoded[Slip_encoder::max_encoded_size(payload_size)];
+    static uint8_t decoded[payload_size];
+    int len = 0;
+
+    for (int i = 0; i < payload_size; ++i)
+        payload[i] = static_cast<uint8_t>(i * 7);
+
+    bench.run("cobs_encode_256", [&] {
+        clobber_memory();
+        Cobs_encoder enc{encoded};
+        enc.put(payload, payload_size);
+        enc.finish();
+        len = enc.size();
+        clobber_memory();
+    }, batch);
+
+    bench.run("cobs_decode_stream_256", [&] {
+        clobber_memory();
+        Cobs_decoder dec{decoded};
+        Cobs_decoder::Status status;
+        dec.put(encoded, len, status);
+        clobber_memory();
+    }, batch);
+
+    bench.run("cobs_decode_frame_256", [&] {
+        clobber_memory();
+        cobs_decode(decoded, encoded, len);
+        clobber_memory();
+    }, batch);
+
+    bench.run("slip_encode_256", [&] {
+        clobber_memory();
+        Slip_encoder enc{encoded};
+        enc.put(payload, payload_size);
+        enc.finish();
+        len = enc.size();
+        clobber_memory();
+    }, batch);
+
+    bench.run("slip_decode_stream_256", [&] {
+        clobber_memory();
+        Slip_decoder dec{decoded};
+        Slip_decoder::Status status;
+        dec.put(encoded, len, status);
+        clobber_memory();
+    }, batch);
+
+    bench.run("slip_decode_frame_256", [&] {
+        clobber_memory();
+        slip_decode(decoded, encoded, len);
+        clobber_memory();
+    }, batch);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BENCH_FRAMING_HPP */
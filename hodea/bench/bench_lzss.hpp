@@ -0,0 +1,91 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Benchmarks for lzss.hpp.
+ *
+ * A log buffer of 1024 bytes, composed of lines as typically printed
+ * by firmware, is compressed and decompressed with the default
+ * parameters. Divide the result by 1024 to get the time per byte. The
+ * compressed size is reported as well.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BENCH_LZSS_HPP
+#define HODEA_BENCH_LZSS_HPP
+
+#include <cstring>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/lzss.hpp>
+#include <hodea/bench/bench.hpp>
+
+namespace hodea {
+
+/**
+ * Run the benchmarks for the LZSS codec.
+ */
+template <class T_bench>
+void bench_lzss(T_bench& bench, int batch = 1)
+{
+    constexpr int log_size = 1024;
+    static const char* const lines[] = {
+        "[INFO] adc: ch0=1203 mV ch1=3298 mV\n",
+        "[INFO] ctrl: state=RUN duty=0.412\n",
+        "[WARN] uart1: rx overrun\n",
+        "[INFO] adc: ch0=1207 mV ch1=3301 mV\n",
+    };
+    static uint8_t log[log_size];
+    static uint8_t packed[log_size + log_size / 8 + 1];
+    static uint8_t unpacked[log_size];
+    static Lzss_encoder<> enc;
+    static Lzss_decoder<> dec;
+    int packed_len = 0;
+
+    for (int pos = 0, i = 0; pos < log_size; ++i) {
+        const char* line = lines[i % 4];
+        int len = std::strlen(line);
+
+        if (len > log_size - pos)
+            len = log_size - pos;
+        std::memcpy(log + pos, line, len);
+        pos += len;
+    }
+
+    bench.run("lzss_compress_1k", [&] {
+        clobber_memory();
+        int done = 0;
+        int n = 0;
+        enc.reset();
+        while (!enc.is_done()) {
+            done += enc.sink(log + done, log_size - done);
+            if (done == log_size)
+                enc.finish();
+            n += enc.poll(packed + n, sizeof(packed) - n);
+        }
+        packed_len = n;
+        clobber_memory();
+    }, batch);
+
+    bench.run("lzss_decompress_1k", [&] {
+        clobber_memory();
+        int done = 0;
+        int n = 0;
+        dec.reset();
+        while (done < packed_len) {
+            done += dec.sink(packed + done, packed_len - done);
+            n += dec.poll(unpacked + n, log_size - n);
+        }
+        clobber_memory();
+    }, batch);
+
+    bench.report_size(
+        "lzss_compress_1k", log_size,
+        (std::memcmp(unpacked, log, log_size) == 0) ? packed_len : -1
+        );
+
+    do_not_optimize(packed_len);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BENCH_LZSS_HPP */
@@ -0,0 +1,123 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Benchmarks for msg_codec.hpp.
+ *
+ * The generated codec is compared with hand-written code using memcpy()
+ * and byte swaps, and with the field-by-field store and fetch functions
+ * of serialization.hpp.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BENCH_MSG_CODEC_HPP
+#define HODEA_BENCH_MSG_CODEC_HPP
+
+#include <cstring>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/cpu_endian.hpp>
+#include <hodea/core/msg_codec.hpp>
+#include <hodea/core/serialization.hpp>
+#include <hodea/bench/bench.hpp>
+
+namespace hodea {
+
+/**
+ * Message used by the codec benchmarks.
+ */
+struct Bench_msg {
+    uint8_t id;
+    uint16_t flags;
+    int32_t current;
+    uint32_t voltage;
+    uint64_t timestamp;
+};
+
+using Bench_msg_codec = Msg_codec<
+    Bench_msg,
+    HODEA_MSG_FIELD(Bench_msg, id, 1, le),
+    HODEA_MSG_FIELD(Bench_msg, flags, 2, le),
+    HODEA_MSG_FIELD(Bench_msg, current, 4, le),
+    HODEA_MSG_FIELD(Bench_msg, voltage, 4, be),
+    HODEA_MSG_FIELD(Bench_msg, timestamp, 8, be)
+    >;
+
+/**
+ * Run the benchmarks for the message codec.
+ */
+template <class T_bench>
+void bench_msg_codec(T_bench& bench, int batch = 64)
+{
+    uint8_t buf[Bench_msg_codec::size];
+    Bench_msg msg{0x11, 0x2233, -4, 0x55667788U, 0x0123456789abcdefULL};
+
+    bench.run("msg_codec_encode", [&] {
+        do_not_optimize(msg);
+        Bench_msg_codec::encode(buf, msg);
+        clobber_memory();
+    }, batch);
+
+    bench.run("msg_memcpy_encode", [&] {
+        do_not_optimize(msg);
+        uint16_t flags = cpu_to_le16(msg.flags);
+        uint32_t current = cpu_to_le32(msg.current);
+        uint32_t voltage = cpu_to_be32(msg.voltage);
+        uint64_t timestamp = cpu_to_be64(msg.timestamp);
+        buf[0] = msg.id;
+        std::memcpy(buf + 1, &flags, 2);
+        std::memcpy(buf + 3, &current, 4);
+        std::memcpy(buf + 7, &voltage, 4);
+        std::memcpy(buf + 11, &timestamp, 8);
+        clobber_memory();
+    }, batch);
+
+    bench.run("msg_store_encode", [&] {
+        do_not_optimize(msg);
+        uint8_t* p = buf;
+        p += store8(p, msg.id);
+        p += store16_le(p, msg.flags);
+        p += store32_le(p, msg.current);
+        p += store32_be(p, msg.voltage);
+        p += store64_be(p, msg.timestamp);
+        clobber_memory();
+    }, batch);
+
+    bench.run("msg_codec_decode", [&] {
+        clobber_memory();
+        Bench_msg_codec::decode(msg, buf);
+        do_not_optimize(msg);
+    }, batch);
+
+    bench.run("msg_memcpy_decode", [&] {
+        clobber_memory();
+        uint16_t flags;
+        uint32_t current;
+        uint32_t voltage;
+        uint64_t timestamp;
+        msg.id = buf[0];
+        std::memcpy(&flags, buf + 1, 2);
+        std::memcpy(&current, buf + 3, 4);
+        std::memcpy(&voltage, buf + 7, 4);
+        std::memcpy(&timestamp, buf + 11, 8);
+        msg.flags = le16_to_cpu(flags);
+        msg.current = le32_to_cpu(current);
+        msg.voltage = be32_to_cpu(voltage);
+        msg.timestamp = be64_to_cpu(timestamp);
+        do_not_optimize(msg);
+    }, batch);
+
+    bench.run("msg_fetch_decode", [&] {
+        clobber_memory();
+        const uint8_t* p = buf;
+        p += fetch8(msg.id, p);
+        p += fetch16_le(msg.flags, p);
+        p += fetch32_le(msg.current, p);
+        p += fetch32_be(msg.voltage, p);
+        p += fetch64_be(msg.timestamp, p);
+        do_not_optimize(msg);
+    }, batch);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BENCH_MSG_CODEC_HPP */
@@ -0,0 +1,101 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Benchmarks for parse.hpp.
+ *
+ * The parse functions are compared with strtoul() and strtol() for the
+ * same conversions.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BENCH_PARSE_HPP
+#define HODEA_BENCH_PARSE_HPP
+
+#include <cstdlib>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/parse.hpp>
+#include <hodea/bench/bench.hpp>
+
+namespace hodea {
+
+/**
+ * Run the benchmarks for the number parsing.
+ */
+template <class T_bench>
+void bench_parse(T_bench& bench, int batch = 16)
+{
+    static const char u32_text[] = "3141592653 ";
+    static const char i32_text[] = "-27182818 ";
+    static const char hex_text[] = "0xdeadbeef ";
+    static const char fixed_text[] = "-12.3456 ";
+    const char* text;
+    Const_byte_span src;
+    uint32_t u32 = 0;
+    int32_t i32 = 0;
+    int len = 0;
+
+    bench.run("parse_u32", [&] {
+        src = Const_byte_span(
+            reinterpret_cast<const uint8_t*>(u32_text), sizeof(u32_text) - 1
+            );
+        do_not_optimize(src);
+        len = parse_u32(u32, src);
+        do_not_optimize(u32);
+    }, batch);
+
+    bench.run("strtoul_u32", [&] {
+        text = u32_text;
+        do_not_optimize(text);
+        u32 = std::strtoul(text, nullptr, 10);
+        do_not_optimize(u32);
+    }, batch);
+
+    bench.run("parse_i32", [&] {
+        src = Const_byte_span(
+            reinterpret_cast<const uint8_t*>(i32_text), sizeof(i32_text) - 1
+            );
+        do_not_optimize(src);
+        len = parse_i32(i32, src);
+        do_not_optimize(i32);
+    }, batch);
+
+    bench.run("strtol_i32", [&] {
+        text = i32_text;
+        do_not_optimize(text);
+        i32 = std::strtol(text, nullptr, 10);
+        do_not_optimize(i32);
+    }, batch);
+
+    bench.run("parse_hex32", [&] {
+        src = Const_byte_span(
+            reinterpret_cast<const uint8_t*>(hex_text), sizeof(hex_text) - 1
+            );
+        do_not_optimize(src);
+        len = parse_hex(u32, src);
+        do_not_optimize(u32);
+    }, batch);
+
+    bench.run("strtoul_hex32", [&] {
+        text = hex_text;
+        do_not_optimize(text);
+        u32 = std::strtoul(text, nullptr, 16);
+        do_not_optimize(u32);
+    }, batch);
+
+    bench.run("parse_fixed_q15", [&] {
+        src = Const_byte_span(
+            reinterpret_cast<const uint8_t*>(fixed_text),
+            sizeof(fixed_text) - 1
+            );
+        do_not_optimize(src);
+        len = parse_fixed<15>(i32, src);
+        do_not_optimize(i32);
+    }, batch);
+
+    do_not_optimize(len);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BENCH_PARSE_HPP */
@@ -0,0 +1,105 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Benchmarks for protobuf.hpp.
+ *
+ * The message used by bench_msg_codec.hpp is encoded and decoded in
+ * protocol buffers wire format, for comparison with the fixed layout of
+ * Bench_msg_codec.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BENCH_PROTOBUF_HPP
+#define HODEA_BENCH_PROTOBUF_HPP
+
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/protobuf.hpp>
+#include <hodea/bench/bench.hpp>
+#include <hodea/bench/bench_msg_codec.hpp>
+
+namespace hodea {
+
+using Bench_pb_id = Pb_field<1, Pb_type::uint32>;
+using Bench_pb_flags = Pb_field<2, Pb_type::uint32>;
+using Bench_pb_current = Pb_field<3, Pb_type::sint32>;
+using Bench_pb_voltage = Pb_field<4, Pb_type::uint32>;
+using Bench_pb_timestamp = Pb_field<5, Pb_type::uint64>;
+
+/**
+ * Run the benchmarks for the protocol buffers codec.
+ */
+template <class T_bench>
+void bench_protobuf(T_bench& bench, int batch = 64)
+{
+    uint8_t buf[64];
+    int len = 0;
+    Bench_msg msg{0x11, 0x2233, -4, 0x55667788U, 0x0123456789abcdefULL};
+
+    bench.run("protobuf_encode", [&] {
+        do_not_optimize(msg);
+        Pb_writer w{buf};
+        w.write<Bench_pb_id>(msg.id);
+        w.write<Bench_pb_flags>(msg.flags);
+        w.write<Bench_pb_current>(msg.current);
+        w.write<Bench_pb_voltage>(msg.voltage);
+        w.write<Bench_pb_timestamp>(msg.timestamp);
+        len = w.size();
+        clobber_memory();
+    }, batch);
+
+    bench.run("protobuf_decode", [&] {
+        clobber_memory();
+        Pb_reader r{buf, len};
+        while (r.next()) {
+            switch (r.field_number()) {
+            case Bench_pb_id::number:
+                r.read<Bench_pb_id>(msg.id);
+                break;
+            case Bench_pb_flags::number:
+                r.read<Bench_pb_flags>(msg.flags);
+                break;
+            case Bench_pb_current::number:
+                r.read<Bench_pb_current>(msg.current);
+                break;
+            case Bench_pb_voltage::number:
+                r.read<Bench_pb_voltage>(msg.voltage);
+                break;
+            case Bench_pb_timestamp::number:
+                r.read<Bench_pb_timestamp>(msg.timestamp);
+                break;
+            default:
+                r.skip();
+                break;
+            }
+        }
+        do_not_optimize(msg);
+    }, batch);
+
+    uint32_t samples[64];
+
+    for (int i = 0; i < 64; ++i)
+        samples[i] = 2048 + 16 * i;
+
+    uint8_t packed[256];
+
+    bench.run("protobuf_packed_encode_64", [&] {
+        clobber_memory();
+        Pb_writer w{packed};
+        w.write_packed<Bench_pb_voltage>(samples, 64);
+        len = w.size();
+        clobber_memory();
+    }, batch);
+
+    bench.run("protobuf_packed_decode_64", [&] {
+        clobber_memory();
+        Pb_reader r{packed, len};
+        r.next();
+        r.read_packed<Bench_pb_voltage>(samples, 64);
+        clobber_memory();
+    }, batch);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BENCH_PROTOBUF_HPP */
@@ -0,0 +1,77 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Benchmarks for segment_list.hpp.
+ *
+ * A frame consisting of an 8 byte constant header, a 256 byte payload
+ * and a 6 byte tail (sequence number and CRC) is assembled once by
+ * copying everything into a contiguous buffer, and once with
+ * Segment_list. The latter copies only the 6 tail bytes instead of
+ * 270 bytes.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BENCH_SEGMENT_LIST_HPP
+#define HODEA_BENCH_SEGMENT_LIST_HPP
+
+#include <cstring>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/segment_list.hpp>
+#include <hodea/core/serialization.hpp>
+#include <hodea/core/wire_format.hpp>
+#include <hodea/bench/bench.hpp>
+
+namespace hodea {
+
+/**
+ * Run the benchmarks for the scatter-gather frame assembly.
+ */
+template <class T_bench>
+void bench_segment_list(T_bench& bench, int batch = 4)
+{
+    constexpr int payload_size = 256;
+    static const uint8_t header[8] = {
+        0x7e, 0x03, 0x21, 0x01, 0x00, 0x01, 0x00, 0x00
+        };
+    static uint8_t payload[payload_size];
+    static uint8_t frame[sizeof(header) + payload_size + 6];
+    uint16_t seq = 0x1234;
+    uint32_t crc = 0xcafebabeU;
+    int len = 0;
+
+    for (int i = 0; i < payload_size; ++i)
+        payload[i] = static_cast<uint8_t>(i);
+
+    bench.run("frame_copy_256", [&] {
+        do_not_optimize(seq);
+        do_not_optimize(crc);
+        uint8_t* p = frame;
+        std::memcpy(p, header, sizeof(header));
+        p += sizeof(header);
+        std::memcpy(p, payload, payload_size);
+        p += payload_size;
+        p += store16_le(p, seq);
+        p += store32_le(p, crc);
+        len = p - frame;
+        clobber_memory();
+    }, batch);
+
+    bench.run("frame_segments_256", [&] {
+        do_not_optimize(seq);
+        do_not_optimize(crc);
+        Segment_list<4, 8> sl;
+        sl.add(header, sizeof(header));
+        sl.add(payload, payload_size);
+        sl.put<Wire_le16, Wire_le32>(seq, crc);
+        len = sl.size();
+        do_not_optimize(sl);
+        clobber_memory();
+    }, batch);
+
+    do_not_optimize(len);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BENCH_SEGMENT_LIST_HPP */
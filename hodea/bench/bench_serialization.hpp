@@ -0,0 +1,104 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Benchmarks for serialization.hpp.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BENCH_SERIALIZATION_HPP
+#define HODEA_BENCH_SERIALIZATION_HPP
+
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/serialization.hpp>
+#include <hodea/bench/bench.hpp>
+
+namespace hodea {
+
+/**
+ * Run the benchmarks for the store and fetch functions.
+ */
+template <class T_bench>
+void bench_serialization(T_bench& bench, int batch = 64)
+{
+    uint8_t buf[8] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef};
+    uint16_t v16 = 0x1234;
+    uint32_t v32 = 0x12345678;
+    uint64_t v64 = 0x0123456789abcdefULL;
+
+    bench.run("store16_le", [&] {
+        do_not_optimize(v16);
+        store16_le(buf, v16);
+        clobber_memory();
+    }, batch);
+
+    bench.run("store32_le", [&] {
+        do_not_optimize(v32);
+        store32_le(buf, v32);
+        clobber_memory();
+    }, batch);
+
+    bench.run("store64_le", [&] {
+        do_not_optimize(v64);
+        store64_le(buf, v64);
+        clobber_memory();
+    }, batch);
+
+    bench.run("store16_be", [&] {
+        do_not_optimize(v16);
+        store16_be(buf, v16);
+        clobber_memory();
+    }, batch);
+
+    bench.run("store32_be", [&] {
+        do_not_optimize(v32);
+        store32_be(buf, v32);
+        clobber_memory();
+    }, batch);
+
+    bench.run("store64_be", [&] {
+        do_not_optimize(v64);
+        store64_be(buf, v64);
+        clobber_memory();
+    }, batch);
+
+    bench.run("fetch16_le", [&] {
+        clobber_memory();
+        fetch16_le(v16, buf);
+        do_not_optimize(v16);
+    }, batch);
+
+    bench.run("fetch32_le", [&] {
+        clobber_memory();
+        fetch32_le(v32, buf);
+        do_not_optimize(v32);
+    }, batch);
+
+    bench.run("fetch64_le", [&] {
+        clobber_memory();
+        fetch64_le(v64, buf);
+        do_not_optimize(v64);
+    }, batch);
+
+    bench.run("fetch16_be", [&] {
+        clobber_memory();
+        fetch16_be(v16, buf);
+        do_not_optimize(v16);
+    }, batch);
+
+    bench.run("fetch32_be", [&] {
+        clobber_memory();
+        fetch32_be(v32, buf);
+        do_not_optimize(v32);
+    }, batch);
+
+    bench.run("fetch64_be", [&] {
+        clobber_memory();
+        fetch64_be(v64, buf);
+        do_not_optimize(v64);
+    }, batch);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BENCH_SERIALIZATION_HPP */
@@ -0,0 +1,125 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Benchmarks for serialization_array.hpp.
+ *
+ * A block of 1 KB is serialized in big and little endian format and
+ * compared with the element-by-element store and fetch functions of
+ * serialization.hpp and with the scalar byte swap reference.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BENCH_SERIALIZATION_ARRAY_HPP
+#define HODEA_BENCH_SERIALIZATION_ARRAY_HPP
+
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/bulk_uswap.hpp>
+#include <hodea/core/serialization.hpp>
+#include <hodea/core/serialization_array.hpp>
+#include <hodea/bench/bench.hpp>
+
+namespace hodea {
+
+/**
+ * Run the benchmarks for the array serialization.
+ */
+template <class T_bench>
+void bench_serialization_array(T_bench& bench, int batch = 8)
+{
+    constexpr int block_size = 1024;
+    constexpr int n16 = block_size / 2;
+    constexpr int n32 = block_size / 4;
+    static uint16_t samples16[n16];
+    static uint32_t samples32[n32];
+    static uint8_t buf[block_size];
+
+    for (int i = 0; i < n16; ++i)
+        samples16[i] = static_cast<uint16_t>(i * 0x0101U);
+    for (int i = 0; i < n32; ++i)
+        samples32[i] = i * 0x01010101U;
+
+    bench.run("array16_store16_be_loop", [&] {
+        clobber_memory();
+        uint8_t* p = buf;
+        for (int i = 0; i < n16; ++i)
+            p += store16_be(p, samples16[i]);
+        clobber_memory();
+    }, batch);
+
+    bench.run("array16_uswap_scalar", [&] {
+        clobber_memory();
+        uswap16_copy_scalar(buf, samples16, n16);
+        clobber_memory();
+    }, batch);
+
+    bench.run("array16_store_array_be", [&] {
+        clobber_memory();
+        store_array_be(buf, samples16, n16);
+        clobber_memory();
+    }, batch);
+
+    bench.run("array16_store_array_le", [&] {
+        clobber_memory();
+        store_array_le(buf, samples16, n16);
+        clobber_memory();
+    }, batch);
+
+    bench.run("array16_fetch16_be_loop", [&] {
+        clobber_memory();
+        const uint8_t* p = buf;
+        for (int i = 0; i < n16; ++i)
+            p += fetch16_be(samples16[i], p);
+        clobber_memory();
+    }, batch);
+
+    bench.run("array16_fetch_array_be", [&] {
+        clobber_memory();
+        fetch_array_be(samples16, buf, n16);
+        clobber_memory();
+    }, batch);
+
+    bench.run("array32_store32_be_loop", [&] {
+        clobber_memory();
+        uint8_t* p = buf;
+        for (int i = 0; i < n32; ++i)
+            p += store32_be(p, samples32[i]);
+        clobber_memory();
+    }, batch);
+
+    bench.run("array32_uswap_scalar", [&] {
+        clobber_memory();
+        uswap32_copy_scalar(buf, samples32, n32);
+        clobber_memory();
+    }, batch);
+
+    bench.run("array32_store_array_be", [&] {
+        clobber_memory();
+        store_array_be(buf, samples32, n32);
+        clobber_memory();
+    }, batch);
+
+    bench.run("array32_uswap_buffer", [&] {
+        clobber_memory();
+        uswap32_buffer(buf, n32);
+        clobber_memory();
+    }, batch);
+
+    bench.run("array32_fetch32_be_loop", [&] {
+        clobber_memory();
+        const uint8_t* p = buf;
+        for (int i = 0; i < n32; ++i)
+            p += fetch32_be(samples32[i], p);
+        clobber_memory();
+    }, batch);
+
+    bench.run("array32_fetch_array_be", [&] {
+        clobber_memory();
+        fetch_array_be(samples32, buf, n32);
+        clobber_memory();
+    }, batch);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BENCH_SERIALIZATION_ARRAY_HPP */
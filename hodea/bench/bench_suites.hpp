@@ -0,0 +1,66 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Run all benchmark suites.
+ *
+ * The same function is used on the host (see tools/bench) and on the
+ * target, where the application calls it e.g. on request via a debug
+ * command.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BENCH_SUITES_HPP
+#define HODEA_BENCH_SUITES_HPP
+
+#include <hodea/bench/bench.hpp>
+#include <hodea/bench/bench_base64.hpp>
+#include <hodea/bench/bench_bitmanip.hpp>
+#include <hodea/bench/bench_byte_cursor.hpp>
+#include <hodea/bench/bench_cpu_endian.hpp>
+#include <hodea/bench/bench_crc.hpp>
+#include <hodea/bench/bench_delta_codec.hpp>
+#include <hodea/bench/bench_endian_types.hpp>
+#include <hodea/bench/bench_format.hpp>
+#include <hodea/bench/bench_framing.hpp>
+#include <hodea/bench/bench_hex_codec.hpp>
+#include <hodea/bench/bench_lzss.hpp>
+#include <hodea/bench/bench_msg_codec.hpp>
+#include <hodea/bench/bench_parse.hpp>
+#include <hodea/bench/bench_protobuf.hpp>
+#include <hodea/bench/bench_serialization.hpp>
+#include <hodea/bench/bench_segment_list.hpp>
+#include <hodea/bench/bench_serialization_array.hpp>
+#include <hodea/bench/bench_tsc.hpp>
+
+namespace hodea {
+
+/**
+ * Run all benchmark suites with timestamp counter \a T_tsc.
+ */
+template <class T_tsc, class T_bench>
+void bench_all(T_bench& bench)
+{
+    bench_serialization(bench);
+    bench_serialization_array(bench);
+    bench_cpu_endian(bench);
+    bench_bitmanip(bench);
+    bench_tsc<T_tsc>(bench);
+    bench_msg_codec(bench);
+    bench_byte_cursor(bench);
+    bench_endian_types(bench);
+    bench_protobuf(bench);
+    bench_framing(bench);
+    bench_segment_list(bench);
+    bench_delta_codec(bench);
+    bench_lzss(bench);
+    bench_format(bench);
+    bench_parse(bench);
+    bench_base64(bench);
+    bench_hex_codec(bench);
+    bench_crc(bench);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BENCH_SUITES_HPP */
@@ -0,0 +1,55 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Benchmarks for the runtime methods of Tsc.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BENCH_TSC_HPP
+#define HODEA_BENCH_TSC_HPP
+
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/tsc.hpp>
+#include <hodea/bench/bench.hpp>
+
+namespace hodea {
+
+/**
+ * Run the benchmarks for the timestamp counter class \a T_tsc.
+ */
+template <class T_tsc, class T_bench>
+void bench_tsc(T_bench& bench, int batch = 64)
+{
+    typename T_tsc::Ticks ts = 0;
+    typename T_tsc::Ticks period = 1000;
+    unsigned us = 1234;
+    bool elapsed = false;
+
+    bench.run("tsc_now", [&] {
+        ts = T_tsc::now();
+        do_not_optimize(ts);
+    }, batch);
+
+    bench.run("tsc_i_us_to_ticks", [&] {
+        do_not_optimize(us);
+        period = T_tsc::i_us_to_ticks(us);
+        do_not_optimize(period);
+    }, batch);
+
+    bench.run("tsc_elapsed", [&] {
+        do_not_optimize(ts);
+        period = T_tsc::elapsed(ts, period);
+        do_not_optimize(period);
+    }, batch);
+
+    bench.run("tsc_is_elapsed", [&] {
+        do_not_optimize(ts);
+        elapsed = T_tsc::is_elapsed(ts, period);
+        do_not_optimize(elapsed);
+    }, batch);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BENCH_TSC_HPP */
@@ -0,0 +1,801 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Base64 encoding and decoding according to RFC 4648.
+ *
+ * Base64 transports binary data, e.g. firmware chunks or memory dumps,
+ * over channels which accept printable text only. Every 3 bytes are
+ * encoded as 4 characters of the alphabet A-Z, a-z, 0-9, + and /. The
+ * last group is padded with '='.
+ *
+ * This file provides:
+ *
+ * - Base64_encoder and Base64_decoder, which process a stream passed in
+ *   chunks of arbitrary size, e.g. as received line by line.
+ * - base64_encode() and base64_decode(), which process a complete
+ *   buffer.
+ *
+ * The functions follow the convention of serialization.hpp: The
+ * destination is given first, and the number of bytes respectively
+ * characters written is returned. The output is not terminated with a
+ * null character. The decoder accepts input without padding, but no
+ * whitespace or line breaks.
+ *
+ * The implementation selects the fastest path available:
+ *
+ * - Host builds with SSSE3 or AVX2 enabled (e.g. -mssse3, -mavx2,
+ *   -march=native) encode 12 respectively 24 bytes and decode 16
+ *   respectively 32 characters per iteration. The 6 bit groups are
+ *   mapped to characters and back with byte shuffles (pshufb) instead
+ *   of table lookups.
+ * - Otherwise a group of 3 bytes is processed per iteration. Characters
+ *   are decoded with comparisons, so no 256 byte table is required on
+ *   small targets like the Cortex-M0.
+ *
+ * The scalar versions are also provided for benchmarking.
+ *
+ * Example:
+ *
+ * \code
+ * char line[Base64_encoder::max_put_size(48) + Base64_encoder::finish_size];
+ * Base64_encoder enc;
+ *
+ * while ((len = flash_read(chunk, 48)) > 0) {
+ *     int n = enc.put(line, chunk, len);
+ *     if (len < 48)
+ *         n += enc.finish(line + n);
+ *     uart_write(line, n);
+ * }
+ * \endcode
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BASE64_HPP
+#define HODEA_BASE64_HPP
+
+#include <cstring>
+#include <hodea/core/cstdint.hpp>
+
+#if defined __AVX2__
+#include <immintrin.h>
+#elif defined __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+namespace hodea {
+
+/**
+ * Get the number of characters required to encode \a len bytes.
+ */
+static inline constexpr int base64_encoded_size(int len)
+{
+    return 4 * ((len + 2) / 3);
+}
+
+/**
+ * Get the maximum number of bytes decoded from \a len characters.
+ */
+static inline constexpr int base64_decoded_size(int len)
+{
+    return 3 * ((len + 3) / 4);
+}
+
+/**
+ * The base64 alphabet.
+ */
+static constexpr char base64_alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/**
+ * Get the value of a base64 character.
+ *
+ * \returns
+ *      The value 0 to 63, or -1 if \a c is not in the alphabet.
+ */
+static inline int base64_decode_char(uint8_t c)
+{
+    if (static_cast<uint8_t>(c - 'A') < 26)
+        return c - 'A';
+    if (static_cast<uint8_t>(c - 'a') < 26)
+        return c - 'a' + 26;
+    if (static_cast<uint8_t>(c - '0') < 10)
+        return c - '0' + 52;
+    if (c == '+')
+        return 62;
+    if (c == '/')
+        return 63;
+    return -1;
+}
+
+/**
+ * Encode 3 bytes into 4 characters.
+ */
+static inline void base64_encode_group(char* dst, const uint8_t* src)
+{
+    uint32_t v = (static_cast<uint32_t>(src[0]) << 16) |
+                 (static_cast<uint32_t>(src[1]) << 8) | src[2];
+
+    dst[0] = base64_alphabet[v >> 18];
+    dst[1] = base64_alphabet[(v >> 12) & 0x3f];
+    dst[2] = base64_alphabet[(v >> 6) & 0x3f];
+    dst[3] = base64_alphabet[v & 0x3f];
+}
+
+/**
+ * Decode 4 characters into 3 bytes.
+ *
+ * \returns
+ *      False if a character is not in the alphabet, including the
+ *      padding character.
+ */
+static inline bool base64_decode_group(uint8_t* dst, const char* src)
+{
+    int a = base64_decode_char(src[0]);
+    int b = base64_decode_char(src[1]);
+    int c = base64_decode_char(src[2]);
+    int d = base64_decode_char(src[3]);
+
+    if ((a | b | c | d) < 0)
+        return false;
+
+    uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+
+    dst[0] = v >> 16;
+    dst[1] = v >> 8;
+    dst[2] = v;
+    return true;
+}
+
+/**
+ * Encode complete groups of 3 bytes, one group per iteration.
+ *
+ * \returns
+ *      The number of bytes encoded, a multiple of 3.
+ */
+static inline int base64_encode_scalar(char* dst, const uint8_t* src, int len)
+{
+    int done = 0;
+
+    for (; len - done >= 3; done += 3, dst += 4)
+        base64_encode_group(dst, src + done);
+    return done;
+}
+
+/**
+ * Decode complete groups of 4 characters, one group per iteration.
+ *
+ * Decoding stops at the first group containing a character outside the
+ * alphabet, including the padding character.
+ *
+ * \returns
+ *      The number of characters decoded, a multiple of 4.
+ */
+static inline int base64_decode_scalar(uint8_t* dst, const char* src, int len)
+{
+    int done = 0;
+
+    for (; len - done >= 4; done += 4, dst += 3) {
+        if (!base64_decode_group(dst, src + done))
+            break;
+    }
+    return done;
+}
+
+#if defined __SSSE3__
+
+/**
+ * Map 6 bit values in each byte to base64 characters.
+ *
+ * Each range of the alphabet gets an offset added. The offset is
+ * selected with a byte shuffle from the range index.
+ */
+static inline __m128i base64_lookup_sse(__m128i idx)
+{
+    const __m128i offsets = _mm_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+        '/' - 63, 'A', 0, 0
+        );
+    // 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12
+    __m128i range = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+    __m128i is_upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), idx);
+
+    range = _mm_or_si128(range, _mm_and_si128(is_upper, _mm_set1_epi8(13)));
+    return _mm_add_epi8(idx, _mm_shuffle_epi8(offsets, range));
+}
+
+/**
+ * Encode the lower 12 bytes of \a in into 16 characters.
+ */
+static inline __m128i base64_encode_sse(__m128i in)
+{
+    // spread each group of 3 bytes into a 32 bit word, byte order
+    // b1 b0 b2 b1, then move the 6 bit values into separate bytes
+    in = _mm_shuffle_epi8(
+        in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10)
+        );
+
+    __m128i t0 = _mm_mulhi_epu16(
+        _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)),
+        _mm_set1_epi32(0x04000040)
+        );
+    __m128i t1 = _mm_mullo_epi16(
+        _mm_and_si128(in, _mm_set1_epi32(0x003f03f0)),
+        _mm_set1_epi32(0x01000010)
+        );
+
+    return base64_lookup_sse(_mm_or_si128(t0, t1));
+}
+
+/**
+ * Decode 16 characters into the lower 12 bytes of \a out.
+ *
+ * The upper nibble of a character selects the valid range and the
+ * offset to subtract with a byte shuffle. '/' is the only character
+ * sharing the upper nibble with another one and is handled separately.
+ *
+ * \returns
+ *      False if a character is not in the alphabet.
+ */
+static inline bool base64_decode_sse(__m128i& out, __m128i in)
+{
+    const __m128i lower_bound = _mm_setr_epi8(
+        1, 1, 0x2b, 0x30, 0x41, 0x50, 0x61, 0x70, 1, 1, 1, 1, 1, 1, 1, 1
+        );
+    const __m128i upper_bound = _mm_setr_epi8(
+        0, 0, 0x2b, 0x39, 0x4f, 0x5a, 0x6f, 0x7a, 0, 0, 0, 0, 0, 0, 0, 0
+        );
+    const __m128i offsets = _mm_setr_epi8(
+        0, 0, 62 - 0x2b, 52 - 0x30, 0 - 0x41, 15 - 0x50, 26 - 0x61,
+        41 - 0x70, 0, 0, 0, 0, 0, 0, 0, 0
+        );
+    __m128i nibble = _mm_and_si128(
+        _mm_srli_epi32(in, 4), _mm_set1_epi8(0x0f)
+        );
+    __m128i is_slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+    __m128i outside = _mm_andnot_si128(
+        is_slash,
+        _mm_or_si128(
+            _mm_cmplt_epi8(in, _mm_shuffle_epi8(lower_bound, nibble)),
+            _mm_cmpgt_epi8(in, _mm_shuffle_epi8(upper_bound, nibble))
+            )
+        );
+
+    if (_mm_movemask_epi8(outside))
+        return false;
+
+    // '/' gets the offset of '+', which is 3 too high
+    __m128i v = _mm_add_epi8(
+        _mm_add_epi8(in, _mm_shuffle_epi8(offsets, nibble)),
+        _mm_and_si128(is_slash, _mm_set1_epi8(-3))
+        );
+
+    // merge 4 values of 6 bits into 24 bits per 32 bit word
+    v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+    v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+    out = _mm_shuffle_epi8(
+        v, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)
+        );
+    return true;
+}
+
+/**
+ * Store the lower 12 bytes of \a v.
+ */
+static inline void base64_store12_sse(uint8_t* dst, __m128i v)
+{
+    uint32_t tail = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), v);
+    std::memcpy(dst + 8, &tail, sizeof(tail));
+}
+
+#endif
+
+#if defined __AVX2__
+
+/**
+ * AVX2 version of base64_lookup_sse().
+ */
+static inline __m256i base64_lookup_avx2(__m256i idx)
+{
+    const __m256i offsets = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+        '/' - 63, 'A', 0, 0,
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+        '/' - 63, 'A', 0, 0
+        );
+    __m256i range = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+    __m256i is_upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx);
+
+    range = _mm256_or_si256(
+        range, _mm256_and_si256(is_upper, _mm256_set1_epi8(13))
+        );
+    return _mm256_add_epi8(idx, _mm256_shuffle_epi8(offsets, range));
+}
+
+/**
+ * Encode the lower 12 bytes of each 128 bit lane into 32 characters.
+ */
+static inline __m256i base64_encode_avx2(__m256i in)
+{
+    in = _mm256_shuffle_epi8(
+        in,
+        _mm256_setr_epi8(
+            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10
+            )
+        );
+
+    __m256i t0 = _mm256_mulhi_epu16(
+        _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)),
+        _mm256_set1_epi32(0x04000040)
+        );
+    __m256i t1 = _mm256_mullo_epi16(
+        _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)),
+        _mm256_set1_epi32(0x01000010)
+        );
+
+    return base64_lookup_avx2(_mm256_or_si256(t0, t1));
+}
+
+/**
+ * AVX2 version of base64_decode_sse(), decoding 32 characters into the
+ * lower 24 bytes of \a out.
+ */
+static inline bool base64_decode_avx2(__m256i& out, __m256i in)
+{
+    const __m256i lower_bound = _mm256_setr_epi8(
+        1, 1, 0x2b, 0x30, 0x41, 0x50, 0x61, 0x70, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 0x2b, 0x30, 0x41, 0x50, 0x61, 0x70, 1, 1, 1, 1, 1, 1, 1, 1
+        );
+    const __m256i upper_bound = _mm256_setr_epi8(
+        0, 0, 0x2b, 0x39, 0x4f, 0x5a, 0x6f, 0x7a, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0x2b, 0x39, 0x4f, 0x5a, 0x6f, 0x7a, 0, 0, 0, 0, 0, 0, 0, 0
+        );
+    const __m256i offsets = _mm256_setr_epi8(
+        0, 0, 62 - 0x2b, 52 - 0x30, 0 - 0x41, 15 - 0x50, 26 - 0x61,
+        41 - 0x70, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 62 - 0x2b, 52 - 0x30, 0 - 0x41, 15 - 0x50, 26 - 0x61,
+        41 - 0x70, 0, 0, 0, 0, 0, 0, 0, 0
+        );
+    __m256i nibble = _mm256_and_si256(
+        _mm256_srli_epi32(in, 4), _mm256_set1_epi8(0x0f)
+        );
+    __m256i is_slash = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/'));
+    __m256i outside = _mm256_andnot_si256(
+        is_slash,
+        _mm256_or_si256(
+            _mm256_cmpgt_epi8(_mm256_shuffle_epi8(lower_bound, nibble), in),
+            _mm256_cmpgt_epi8(in, _mm256_shuffle_epi8(upper_bound, nibble))
+            )
+        );
+
+    if (_mm256_movemask_epi8(outside))
+        return false;
+
+    __m256i v = _mm256_add_epi8(
+        _mm256_add_epi8(in, _mm256_shuffle_epi8(offsets, nibble)),
+        _mm256_and_si256(is_slash, _mm256_set1_epi8(-3))
+        );
+
+    v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+    v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+    v = _mm256_shuffle_epi8(
+        v,
+        _mm256_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+            )
+        );
+    // join the 12 bytes of both lanes
+    out = _mm256_permutevar8x32_epi32(
+        v, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7)
+        );
+    return true;
+}
+
+#endif
+
+/**
+ * Encode as many bytes as possible using SIMD instructions.
+ *
+ * \returns
+ *      The number of bytes encoded, a multiple of 12. Zero if no SIMD
+ *      instructions are available.
+ */
+static inline int base64_encode_simd(char* dst, const uint8_t* src, int len)
+{
+    int done = 0;
+
+#if defined __SSSE3__
+#if defined __AVX2__
+    // each lane loads 16 bytes and encodes the lower 12 of them
+    for (; len - done >= 28; done += 24, dst += 32) {
+        __m256i in = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + done))
+                ),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + done + 12)),
+            1
+            );
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(dst), base64_encode_avx2(in)
+            );
+    }
+#endif
+
+    for (; len - done >= 16; done += 12, dst += 16) {
+        __m128i in = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(src + done)
+            );
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(dst), base64_encode_sse(in)
+            );
+    }
+#else
+    (void) dst;
+    (void) src;
+    (void) len;
+#endif
+
+    return done;
+}
+
+/**
+ * Decode as many characters as possible using SIMD instructions.
+ *
+ * Decoding stops at the first block containing a character outside the
+ * alphabet, including the padding character.
+ *
+ * \returns
+ *      The number of characters decoded, a multiple of 16. Zero if no
+ *      SIMD instructions are available.
+ */
+static inline int base64_decode_simd(uint8_t* dst, const char* src, int len)
+{
+    int done = 0;
+
+#if defined __SSSE3__
+#if defined __AVX2__
+    for (; len - done >= 32; done += 32, dst += 24) {
+        __m256i out;
+        __m256i in = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(src + done)
+            );
+        if (!base64_decode_avx2(out, in))
+            return done;
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(dst), _mm256_castsi256_si128(out)
+            );
+        _mm_storel_epi64(
+            reinterpret_cast<__m128i*>(dst + 16),
+            _mm256_extracti128_si256(out, 1)
+            );
+    }
+#endif
+
+    for (; len - done >= 16; done += 16, dst += 12) {
+        __m128i out;
+        __m128i in = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(src + done)
+            );
+        if (!base64_decode_sse(out, in))
+            return done;
+        base64_store12_sse(dst, out);
+    }
+#else
+    (void) dst;
+    (void) src;
+    (void) len;
+#endif
+
+    return done;
+}
+
+/**
+ * Class to encode a stream in base64.
+ *
+ * The stream is passed in chunks of arbitrary size via put(). Up to 2
+ * bytes not forming a complete group are kept until the next call.
+ * finish() encodes them with padding.
+ */
+class Base64_encoder {
+public:
+    /**
+     * Get the maximum number of characters written by put().
+     */
+    static constexpr int max_put_size(int len)
+    {
+        return 4 * ((len + 2) / 3);
+    }
+
+    /**
+     * Maximum number of characters written by finish().
+     */
+    static constexpr int finish_size = 4;
+
+    Base64_encoder() { reset(); }
+
+    /**
+     * Start a new stream, discarding pending bytes.
+     */
+    void reset() { num_pending = 0; }
+
+    /**
+     * Encode a chunk of the stream.
+     *
+     * \param[out] dst
+     *      Target buffer with space for max_put_size(len) characters.
+     * \param[in] src
+     *      The chunk to encode.
+     * \param[in] len
+     *      The size of the chunk.
+     *
+     * \returns
+     *      The number of characters written into \a dst.
+     */
+    int put(char* dst, const uint8_t* src, int len)
+    {
+        char* d = dst;
+
+        if (num_pending > 0) {
+            while ((num_pending < 3) && (len > 0)) {
+                pending[num_pending++] = *src++;
+                --len;
+            }
+            if (num_pending < 3)
+                return 0;
+            base64_encode_group(d, pending);
+            d += 4;
+            num_pending = 0;
+        }
+
+        int done = base64_encode_simd(d, src, len);
+
+        done += base64_encode_scalar(
+            d + done / 3 * 4, src + done, len - done
+            );
+        d += done / 3 * 4;
+
+        // src may be a null pointer if len is 0
+        num_pending = len - done;
+        if (num_pending > 0)
+            std::memcpy(pending, src + done, num_pending);
+        return d - dst;
+    }
+
+    /**
+     * Complete the stream.
+     *
+     * \param[out] dst
+     *      Target buffer with space for finish_size characters.
+     *
+     * \returns
+     *      The number of characters written into \a dst.
+     */
+    int finish(char* dst)
+    {
+        if (num_pending == 0)
+            return 0;
+
+        uint8_t group[3] = {pending[0], 0, 0};
+
+        if (num_pending > 1)
+            group[1] = pending[1];
+        base64_encode_group(dst, group);
+        dst[3] = '=';
+        if (num_pending < 2)
+            dst[2] = '=';
+        reset();
+        return 4;
+    }
+
+private:
+    uint8_t pending[3];
+    int num_pending;
+};
+
+/**
+ * Class to decode a base64 stream.
+ *
+ * The stream is passed in chunks of arbitrary size via put(). Up to 3
+ * characters not forming a complete group are kept until the next call.
+ * After a group with padding no more characters are accepted. A stream
+ * containing an invalid character is rejected up to reset().
+ */
+class Base64_decoder {
+public:
+    /**
+     * Get the maximum number of bytes written by put().
+     */
+    static constexpr int max_put_size(int len)
+    {
+        return 3 * ((len + 3) / 4);
+    }
+
+    /**
+     * Maximum number of bytes written by finish().
+     */
+    static constexpr int finish_size = 2;
+
+    Base64_decoder() { reset(); }
+
+    /**
+     * Start a new stream, discarding pending characters.
+     */
+    void reset()
+    {
+        acc = 0;
+        num_chars = 0;
+        num_pad = 0;
+        failed = false;
+    }
+
+    /**
+     * Decode a chunk of the stream.
+     *
+     * \param[out] dst
+     *      Target buffer with space for max_put_size(len) bytes.
+     * \param[in] src
+     *      The chunk to decode.
+     * \param[in] len
+     *      The size of the chunk.
+     *
+     * \returns
+     *      The number of bytes written into \a dst, or -1 if the stream
+     *      is malformed.
+     */
+    int put(uint8_t* dst, const char* src, int len)
+    {
+        uint8_t* d = dst;
+        const char* end = src + len;
+
+        if (failed)
+            return -1;
+
+        while (src < end) {
+            if ((num_chars == 0) && (num_pad == 0)) {
+                int done = base64_decode_simd(d, src, end - src);
+
+                done += base64_decode_scalar(
+                    d + done / 4 * 3, src + done, end - src - done
+                    );
+                d += done / 4 * 3;
+                src += done;
+                if (src == end)
+                    break;
+            }
+            if (!put_char(d, *src++)) {
+                failed = true;
+                return -1;
+            }
+        }
+        return d - dst;
+    }
+
+    /**
+     * Complete the stream.
+     *
+     * A last group without padding is decoded. The decoder is reset
+     * for the next stream.
+     *
+     * \param[out] dst
+     *      Target buffer with space for finish_size bytes.
+     *
+     * \returns
+     *      The number of bytes written into \a dst, or -1 if the stream
+     *      is malformed or incomplete.
+     */
+    int finish(uint8_t* dst)
+    {
+        int n = 0;
+
+        if (failed || (num_chars == 1) || ((num_chars > 0) && num_pad)) {
+            n = -1;
+        }
+        else if (num_chars > 0) {
+            acc <<= 6 * (4 - num_chars);
+            for (n = 0; n < num_chars - 1; ++n)
+                dst[n] = acc >> (16 - 8 * n);
+        }
+        reset();
+        return n;
+    }
+
+    /**
+     * Test if the stream decoded so far is well-formed.
+     */
+    bool ok() const { return !failed; }
+
+private:
+    bool put_char(uint8_t*& d, uint8_t c)
+    {
+        // padding completed the stream
+        if (num_pad && (num_chars == 0))
+            return false;
+
+        if (c == '=') {
+            if (num_chars < 2)
+                return false;
+            ++num_pad;
+            acc <<= 6;
+        }
+        else {
+            int v = base64_decode_char(c);
+
+            if ((v < 0) || num_pad)
+                return false;
+            acc = (acc << 6) | v;
+        }
+
+        if (++num_chars == 4) {
+            for (int i = 0; i < 3 - num_pad; ++i)
+                *d++ = acc >> (16 - 8 * i);
+            acc = 0;
+            num_chars = 0;
+        }
+        return true;
+    }
+
+    uint32_t acc;               // values of the current group
+    int num_chars;              // characters in the current group
+    int num_pad;                // padding characters received
+    bool failed;
+};
+
+/**
+ * Encode a buffer in base64, with padding.
+ *
+ * \param[out] dst
+ *      Target buffer with space for base64_encoded_size(len)
+ *      characters.
+ * \param[in] src
+ *      The data to encode.
+ * \param[in] len
+ *      The size of the data.
+ *
+ * \returns
+ *      The number of characters written into \a dst.
+ */
+static inline int base64_encode(char* dst, const uint8_t* src, int len)
+{
+    Base64_encoder enc;
+    int n = enc.put(dst, src, len);
+
+    return n + enc.finish(dst + n);
+}
+
+/**
+ * Decode a base64 encoded buffer.
+ *
+ * \param[out] dst
+ *      Target buffer with space for base64_decoded_size(len) bytes.
+ * \param[in] src
+ *      The characters to decode.
+ * \param[in] len
+ *      The number of characters.
+ *
+ * \returns
+ *      The number of bytes written into \a dst, or -1 if the input is
+ *      malformed.
+ */
+static inline int base64_decode(uint8_t* dst, const char* src, int len)
+{
+    Base64_decoder dec;
+    int n = dec.put(dst, src, len);
+
+    if (n < 0)
+        return -1;
+
+    int m = dec.finish(dst + n);
+
+    return (m < 0) ? -1 : n + m;
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BASE64_HPP */
@@ -47,6 +47,7 @@
 #define HODEA_BITMANIP_HPP
 
 #include <type_traits>
+#include <hodea/core/cstdint.hpp>
 #include <hodea/core/type_constraints.hpp>
 
 namespace hodea {
@@ -263,6 +264,47 @@ bool is_bit_set(T_v val, T_m msk, bool need_all_bits_set = false)
     return (need_all_bits_set) ? ((uval & umsk) == umsk) : (uval & umsk);
 }
 
+/**
+ * Get the number of bits required to represent an unsigned value.
+ *
+ * \param[in] x
+ *      The value.
+ * \returns
+ *      The position of the highest bit set plus one, or 0 if \a x is 0.
+ */
+static inline constexpr int bit_width(uint32_t x)
+{
+#if (defined __GNUC__ || defined __clang__) && !defined __ARM_ARCH_6M__
+    return (x == 0) ? 0 : 32 - __builtin_clz(x);
+#else
+    // ARMv6-M has no CLZ instruction, so __builtin_clz() would be a
+    // library call; a binary search takes a few cycles per step
+    int n = 0;
+
+    if (x >= (1UL << 16)) {
+        n += 16;
+        x >>= 16;
+    }
+    if (x >= (1U << 8)) {
+        n += 8;
+        x >>= 8;
+    }
+    if (x >= (1U << 4)) {
+        n += 4;
+        x >>= 4;
+    }
+    if (x >= (1U << 2)) {
+        n += 2;
+        x >>= 2;
+    }
+    if (x >= (1U << 1)) {
+        n += 1;
+        x >>= 1;
+    }
+    return n + static_cast<int>(x);
+#endif
+}
+
 } // namespace hodea
 
 #endif /*!HODEA_BITMANIP_HPP */
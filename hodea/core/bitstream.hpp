@@ -0,0 +1,286 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Write and read sequential fields of arbitrary bit width.
+ *
+ * Bit_writer packs fields of 0 to 32 bits back to back into a byte
+ * buffer, Bit_reader reads them back. The bits are packed LSB first,
+ * i.e. the first field starts at bit 0 of byte 0, as with Intel signals
+ * in CAN frames (see signal_codec.hpp).
+ *
+ * Both classes hold up to 64 bits in an accumulator and access the
+ * buffer byte-wise, so the buffer does not need to be aligned. As with
+ * Byte_writer and Byte_reader, the error state is sticky.
+ *
+ * On Cortex-M0 (ARMv6-M) shifts of 64 bit integers by a variable amount
+ * are library calls. Bit_writer therefore uses a 32 bit accumulator
+ * there, which is written to the buffer when full.
+ *
+ * Example:
+ *
+ * \code
+ * uint8_t buf[16];
+ * Bit_writer w{buf};
+ *
+ * w.put(mode, 3);
+ * w.put(channel, 5);
+ * w.put(value, 12);
+ * w.flush();
+ * if (w.ok())
+ *     send_msg(buf, w.size());
+ * \endcode
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BITSTREAM_HPP
+#define HODEA_BITSTREAM_HPP
+
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/serialization.hpp>
+#include <hodea/core/span.hpp>
+
+namespace hodea {
+
+/**
+ * Class to write fields of arbitrary bit width into a buffer.
+ */
+class Bit_writer {
+public:
+    Bit_writer(uint8_t* buf, int capacity)
+        : buf{buf}, capacity{capacity}
+    {}
+
+    Bit_writer(Byte_span buf) : Bit_writer(buf.data(), buf.size()) {}
+
+    template <std::size_t N>
+    Bit_writer(uint8_t (&buf)[N]) : Bit_writer(buf, N) {}
+
+    /**
+     * Append a field.
+     *
+     * \param[in] val
+     *      The value. Bits above \a num_bits are ignored.
+     * \param[in] num_bits
+     *      The width of the field, 0 to 32.
+     *
+     * \returns
+     *      True on success, false if the buffer is too small or the
+     *      writer is in error state.
+     */
+    bool put(uint32_t val, int num_bits)
+    {
+#if defined __ARM_ARCH_6M__
+        return put(&val, 1, num_bits);
+#else
+        if (failed || ((acc_bits + num_bits) / 8 > capacity - pos)) {
+            failed = true;
+            return false;
+        }
+
+        uint64_t msk = (1ULL << num_bits) - 1;
+
+        acc |= (val & msk) << acc_bits;
+        acc_bits += num_bits;
+        while (acc_bits >= 8) {
+            buf[pos++] = static_cast<uint8_t>(acc);
+            acc >>= 8;
+            acc_bits -= 8;
+        }
+        return true;
+#endif
+    }
+
+    /**
+     * Append a sequence of fields of the same width.
+     *
+     * The capacity is checked once for all fields, and the bits are
+     * written in units of 32 bits. This is considerably faster than
+     * calling put() for each field.
+     *
+     * \param[in] vals
+     *      The values. Bits above \a num_bits are ignored.
+     * \param[in] n
+     *      The number of values.
+     * \param[in] num_bits
+     *      The width of each field, 0 to 32.
+     */
+    bool put(const uint32_t* vals, int n, int num_bits)
+    {
+        if (failed ||
+            ((acc_bits + n * num_bits) / 8 > capacity - pos)) {
+            failed = true;
+            return false;
+        }
+
+#if defined __ARM_ARCH_6M__
+        uint32_t msk = (num_bits == 32) ? ~0UL : (1UL << num_bits) - 1;
+        uint32_t a = static_cast<uint32_t>(acc);
+        int a_bits = acc_bits;
+        uint8_t* p = buf + pos;
+
+        // a holds less than 32 bits; when full, it is written and takes
+        // the bits of the value which did not fit
+        for (int i = 0; i < n; ++i) {
+            uint32_t v = vals[i] & msk;
+
+            a |= v << a_bits;
+            a_bits += num_bits;
+            if (a_bits >= 32) {
+                p += store32_le(p, a);
+                a_bits -= 32;
+                a = (a_bits == 0) ? 0 : v >> (num_bits - a_bits);
+            }
+        }
+#else
+        uint64_t msk = (1ULL << num_bits) - 1;
+        uint64_t a = acc;
+        int a_bits = acc_bits;
+        uint8_t* p = buf + pos;
+
+        for (int i = 0; i < n; ++i) {
+            a |= (vals[i] & msk) << a_bits;
+            a_bits += num_bits;
+            if (a_bits >= 32) {
+                p += store32_le(p, static_cast<uint32_t>(a));
+                a >>= 32;
+                a_bits -= 32;
+            }
+        }
+#endif
+        while (a_bits >= 8) {
+            *p++ = static_cast<uint8_t>(a);
+            a >>= 8;
+            a_bits -= 8;
+        }
+
+        acc = a;
+        acc_bits = a_bits;
+        pos = p - buf;
+        return true;
+    }
+
+    /**
+     * Write pending bits, padding the last byte with zeros.
+     */
+    bool flush()
+    {
+        if (acc_bits == 0)
+            return ok();
+        return put(0, 8 - acc_bits);
+    }
+
+    /**
+     * Test if all writes succeeded.
+     */
+    bool ok() const { return !failed; }
+
+    /**
+     * Get the number of complete bytes written so far.
+     */
+    int size() const { return pos; }
+
+    /**
+     * Get the number of bits written so far.
+     */
+    int bit_size() const { return 8 * pos + acc_bits; }
+
+private:
+    uint8_t* const buf;
+    const int capacity;
+    int pos = 0;
+    uint64_t acc = 0;
+    int acc_bits = 0;
+    bool failed = false;
+};
+
+/**
+ * Class to read fields of arbitrary bit width from a buffer.
+ */
+class Bit_reader {
+public:
+    Bit_reader(const uint8_t* buf, int len)
+        : buf{buf}, len{len}
+    {}
+
+    Bit_reader(Const_byte_span buf) : Bit_reader(buf.data(), buf.size()) {}
+
+    /**
+     * Read a field.
+     *
+     * \param[out] val
+     *      The value read. Not modified on error.
+     * \param[in] num_bits
+     *      The width of the field, 0 to 32.
+     *
+     * \returns
+     *      True on success, false if not enough bits are available or
+     *      the reader is in error state.
+     */
+    bool get(uint32_t& val, int num_bits)
+    {
+        if (failed || (num_bits - acc_bits > 8 * (len - pos))) {
+            failed = true;
+            return false;
+        }
+
+        while (acc_bits < num_bits) {
+            acc |= static_cast<uint64_t>(buf[pos++]) << acc_bits;
+            acc_bits += 8;
+        }
+        val = static_cast<uint32_t>(acc & ((1ULL << num_bits) - 1));
+        acc >>= num_bits;
+        acc_bits -= num_bits;
+        return true;
+    }
+
+    /**
+     * Read a field holding a number in two's complement.
+     */
+    bool get_signed(int32_t& val, int num_bits)
+    {
+        uint32_t v;
+
+        if (!get(v, num_bits))
+            return false;
+        if ((num_bits > 0) && (num_bits < 32)) {
+            uint32_t sign = 1U << (num_bits - 1);
+            v = (v ^ sign) - sign;
+        }
+        val = static_cast<int32_t>(v);
+        return true;
+    }
+
+    /**
+     * Skip the remaining bits of the current byte.
+     */
+    void align()
+    {
+        int num_pad = acc_bits % 8;
+
+        acc >>= num_pad;
+        acc_bits -= num_pad;
+    }
+
+    /**
+     * Test if all reads succeeded.
+     */
+    bool ok() const { return !failed; }
+
+    /**
+     * Get the number of bits not read yet.
+     */
+    int remaining_bits() const { return 8 * (len - pos) + acc_bits; }
+
+private:
+    const uint8_t* const buf;
+    const int len;
+    int pos = 0;
+    uint64_t acc = 0;
+    int acc_bits = 0;
+    bool failed = false;
+};
+
+} // namespace hodea
+
+#endif /*!HODEA_BITSTREAM_HPP */
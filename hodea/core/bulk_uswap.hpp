@@ -0,0 +1,393 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Reverse the byte order of arrays of unsigned 16, 32 and 64 bit values.
+ *
+ * The functions copy \a n elements from \a src to \a dst and reverse the
+ * byte order of each element on the fly. Neither buffer needs to be
+ * aligned. \a dst may be equal to \a src to swap in place, but the
+ * buffers must not overlap otherwise. The uswapN_buffer() functions
+ * are shortcuts for swapping in place.
+ *
+ * The implementation selects the fastest path available:
+ *
+ * - Host builds with SSSE3, AVX2 or AVX-512BW enabled (e.g. -mssse3,
+ *   -mavx2, -march=native) swap two vectors of 16, 32 respectively 64
+ *   bytes per iteration with a byte shuffle (pshufb).
+ * - Host builds with SSE2 only, e.g. the x86-64 baseline, swap two
+ *   vectors of 16 bytes per iteration with 16 bit shifts and word
+ *   shuffles. The word-wise loop below lost to the element-wise loop of
+ *   serialization.hpp there, which the compiler vectorizes itself.
+ * - Otherwise a word is swapped per iteration. For 16 bit values two
+ *   elements are swapped within a 32 bit word at once. GCC and clang
+ *   translate the expressions into REV and REV16 instructions on ARM
+ *   cores providing them, e.g. the Cortex-M4.
+ *
+ * The plain element-by-element versions are provided as reference and
+ * for benchmarking.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BULK_USWAP_HPP
+#define HODEA_BULK_USWAP_HPP
+
+#include <cstring>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/uswap.hpp>
+
+#if defined __AVX2__
+#include <immintrin.h>
+#elif defined __SSSE3__
+#include <tmmintrin.h>
+#elif defined __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace hodea {
+
+/**
+ * Reverse byte order within both halves of a 32 bit value.
+ */
+static inline constexpr uint32_t uswap16x2(uint32_t x)
+{
+    return ((x & 0xff00ff00U) >> 8) | ((x & 0x00ff00ffU) << 8);
+}
+
+/**
+ * Copy an array of 16 bit values element by element, swapping bytes.
+ */
+static inline void uswap16_copy_scalar(void* dst, const void* src, int n)
+{
+    uint8_t* d = static_cast<uint8_t*>(dst);
+    const uint8_t* s = static_cast<const uint8_t*>(src);
+
+    for (int i = 0; i < n; ++i, d += 2, s += 2) {
+        uint16_t v;
+        std::memcpy(&v, s, sizeof(v));
+        v = uswap16(v);
+        std::memcpy(d, &v, sizeof(v));
+    }
+}
+
+/**
+ * Copy an array of 32 bit values element by element, swapping bytes.
+ */
+static inline void uswap32_copy_scalar(void* dst, const void* src, int n)
+{
+    uint8_t* d = static_cast<uint8_t*>(dst);
+    const uint8_t* s = static_cast<const uint8_t*>(src);
+
+    for (int i = 0; i < n; ++i, d += 4, s += 4) {
+        uint32_t v;
+        std::memcpy(&v, s, sizeof(v));
+        v = uswap32(v);
+        std::memcpy(d, &v, sizeof(v));
+    }
+}
+
+/**
+ * Copy an array of 64 bit values element by element, swapping bytes.
+ */
+static inline void uswap64_copy_scalar(void* dst, const void* src, int n)
+{
+    uint8_t* d = static_cast<uint8_t*>(dst);
+    const uint8_t* s = static_cast<const uint8_t*>(src);
+
+    for (int i = 0; i < n; ++i, d += 8, s += 8) {
+        uint64_t v;
+        std::memcpy(&v, s, sizeof(v));
+        v = uswap64(v);
+        std::memcpy(d, &v, sizeof(v));
+    }
+}
+
+#if defined __SSSE3__
+
+/**
+ * Get the pshufb mask reversing elements of the given size.
+ */
+template <int size>
+static inline __m128i uswap_shuffle_mask()
+{
+    return _mm_setr_epi8(
+        (0 / size) * size + size - 1 - 0 % size,
+        (1 / size) * size + size - 1 - 1 % size,
+        (2 / size) * size + size - 1 - 2 % size,
+        (3 / size) * size + size - 1 - 3 % size,
+        (4 / size) * size + size - 1 - 4 % size,
+        (5 / size) * size + size - 1 - 5 % size,
+        (6 / size) * size + size - 1 - 6 % size,
+        (7 / size) * size + size - 1 - 7 % size,
+        (8 / size) * size + size - 1 - 8 % size,
+        (9 / size) * size + size - 1 - 9 % size,
+        (10 / size) * size + size - 1 - 10 % size,
+        (11 / size) * size + size - 1 - 11 % size,
+        (12 / size) * size + size - 1 - 12 % size,
+        (13 / size) * size + size - 1 - 13 % size,
+        (14 / size) * size + size - 1 - 14 % size,
+        (15 / size) * size + size - 1 - 15 % size
+        );
+}
+
+/**
+ * Reverse the byte order of each element of a vector.
+ */
+template <int size>
+static inline __m128i uswap_vector(__m128i v)
+{
+    return _mm_shuffle_epi8(v, uswap_shuffle_mask<size>());
+}
+
+#elif defined __SSE2__
+
+/**
+ * Reverse the byte order of each element of a vector.
+ *
+ * Without pshufb the 32 bit halves and 16 bit words are exchanged with
+ * shuffles first, then the bytes of each word with shifts.
+ */
+template <int size>
+static inline __m128i uswap_vector(__m128i v)
+{
+    if (size == 8)
+        v = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    if (size >= 4) {
+        v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    }
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+#endif
+
+/**
+ * Swap as many bytes as possible using SIMD instructions.
+ *
+ * Two vectors are processed per iteration, so loads and stores of
+ * successive iterations overlap.
+ *
+ * \returns
+ *      The number of bytes processed, a multiple of 16. Zero if no SIMD
+ *      instructions are available.
+ */
+template <int size>
+static inline int uswap_copy_simd(uint8_t* dst, const uint8_t* src, int len)
+{
+    int done = 0;
+
+#if defined __SSSE3__ || defined __SSE2__
+#if defined __AVX512BW__
+    // the maskz form avoids a bogus -Wuninitialized warning of GCC
+    const __m512i mask4 = _mm512_maskz_broadcast_i32x4(
+        0xffff, uswap_shuffle_mask<size>()
+        );
+
+    for (; len - done >= 128; done += 128) {
+        __m512i v0 = _mm512_loadu_si512(src + done);
+        __m512i v1 = _mm512_loadu_si512(src + done + 64);
+
+        _mm512_storeu_si512(dst + done, _mm512_shuffle_epi8(v0, mask4));
+        _mm512_storeu_si512(dst + done + 64, _mm512_shuffle_epi8(v1, mask4));
+    }
+#endif
+
+#if defined __AVX2__
+    const __m256i mask2 = _mm256_broadcastsi128_si256(
+        uswap_shuffle_mask<size>()
+        );
+
+    for (; len - done >= 64; done += 64) {
+        __m256i v0 = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(src + done)
+            );
+        __m256i v1 = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(src + done + 32)
+            );
+
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(dst + done),
+            _mm256_shuffle_epi8(v0, mask2)
+            );
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(dst + done + 32),
+            _mm256_shuffle_epi8(v1, mask2)
+            );
+    }
+#endif
+
+    for (; len - done >= 32; done += 32) {
+        __m128i v0 = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(src + done)
+            );
+        __m128i v1 = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(src + done + 16)
+            );
+
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(dst + done), uswap_vector<size>(v0)
+            );
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(dst + done + 16),
+            uswap_vector<size>(v1)
+            );
+    }
+
+    if (len - done >= 16) {
+        __m128i v = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(src + done)
+            );
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(dst + done), uswap_vector<size>(v)
+            );
+        done += 16;
+    }
+#else
+    (void) dst;
+    (void) src;
+    (void) len;
+#endif
+
+    return done;
+}
+
+/**
+ * Copy an array of 16 bit values, swapping bytes.
+ *
+ * \param[out] dst
+ *      Destination buffer.
+ * \param[in] src
+ *      Source buffer, either equal to \a dst or not overlapping.
+ * \param[in] n
+ *      The number of elements.
+ */
+static inline void uswap16_copy(void* dst, const void* src, int n)
+{
+    uint8_t* d = static_cast<uint8_t*>(dst);
+    const uint8_t* s = static_cast<const uint8_t*>(src);
+    int len = 2 * n;
+    int done = uswap_copy_simd<2>(d, s, len);
+
+    for (; len - done >= 4; done += 4) {
+        uint32_t v;
+        std::memcpy(&v, s + done, sizeof(v));
+        v = uswap16x2(v);
+        std::memcpy(d + done, &v, sizeof(v));
+    }
+    uswap16_copy_scalar(d + done, s + done, (len - done) / 2);
+}
+
+/**
+ * Copy an array of 32 bit values, swapping bytes.
+ *
+ * \param[out] dst
+ *      Destination buffer.
+ * \param[in] src
+ *      Source buffer, either equal to \a dst or not overlapping.
+ * \param[in] n
+ *      The number of elements.
+ */
+static inline void uswap32_copy(void* dst, const void* src, int n)
+{
+    uint8_t* d = static_cast<uint8_t*>(dst);
+    const uint8_t* s = static_cast<const uint8_t*>(src);
+    int len = 4 * n;
+    int done = uswap_copy_simd<4>(d, s, len);
+
+    uswap32_copy_scalar(d + done, s + done, (len - done) / 4);
+}
+
+/**
+ * Copy an array of 64 bit values, swapping bytes.
+ *
+ * \param[out] dst
+ *      Destination buffer.
+ * \param[in] src
+ *      Source buffer, either equal to \a dst or not overlapping.
+ * \param[in] n
+ *      The number of elements.
+ */
+static inline void uswap64_copy(void* dst, const void* src, int n)
+{
+    uint8_t* d = static_cast<uint8_t*>(dst);
+    const uint8_t* s = static_cast<const uint8_t*>(src);
+    int len = 8 * n;
+    int done = uswap_copy_simd<8>(d, s, len);
+
+    uswap64_copy_scalar(d + done, s + done, (len - done) / 8);
+}
+
+/**
+ * Reverse the byte order of an array of 16 bit values in place.
+ *
+ * \param[in,out] buf
+ *      The array, not necessarily aligned.
+ * \param[in] n
+ *      The number of elements.
+ */
+static inline void uswap16_buffer(void* buf, int n)
+{
+    uswap16_copy(buf, buf, n);
+}
+
+/**
+ * Reverse the byte order of an array of 32 bit values in place.
+ *
+ * \param[in,out] buf
+ *      The array, not necessarily aligned.
+ * \param[in] n
+ *      The number of elements.
+ */
+static inline void uswap32_buffer(void* buf, int n)
+{
+    uswap32_copy(buf, buf, n);
+}
+
+/**
+ * Reverse the byte order of an array of 64 bit values in place.
+ *
+ * \param[in,out] buf
+ *      The array, not necessarily aligned.
+ * \param[in] n
+ *      The number of elements.
+ */
+static inline void uswap64_buffer(void* buf, int n)
+{
+    uswap64_copy(buf, buf, n);
+}
+
+/**
+ * Copy an array of elements with the given size, swapping bytes.
+ *
+ * \tparam size
+ *      Size of an element in bytes, 1, 2, 4 or 8. Elements of size 1
+ *      are just copied.
+ */
+template <int size>
+static inline void uswap_copy(void* dst, const void* src, int n)
+{
+    static_assert(
+        (size == 1) || (size == 2) || (size == 4) || (size == 8),
+        "unsupported element size"
+        );
+
+    switch (size) {
+    case 1:
+        if (dst != src)
+            std::memcpy(dst, src, n);
+        break;
+    case 2:
+        uswap16_copy(dst, src, n);
+        break;
+    case 4:
+        uswap32_copy(dst, src, n);
+        break;
+    default:
+        uswap64_copy(dst, src, n);
+        break;
+    }
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_BULK_USWAP_HPP */
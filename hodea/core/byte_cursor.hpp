@@ -0,0 +1,366 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Bounds-checked cursors to serialize and deserialize messages.
+ *
+ * The pattern
+ *
+ * \code
+ * p += store16_le(p, v1);
+ * p += store32_be(p, v2);
+ * \endcode
+ *
+ * does not check if the buffer is large enough. Checking each field
+ * separately clutters the code and costs run time.
+ *
+ * Byte_writer and Byte_reader track the position within a buffer. A
+ * sequence of fixed-size fields is written or read with a single call,
+ * given the wire formats as template arguments (see Wire_format). The
+ * total size of the fields is calculated at compile time, so there is
+ * exactly one capacity check per call and none per field.
+ *
+ * The error state is sticky: Once an access failed, all further
+ * accesses fail as well, and the caller checks ok() once at the end.
+ *
+ * Example:
+ *
+ * \code
+ * uint8_t buf[64];
+ * Byte_writer w{buf};
+ *
+ * w.put<Wire_u8, Wire_le16, Wire_be32>(type, flags, value);
+ * int len_mark = w.begin_length<Wire_u8>();
+ * w.put_bytes(payload, payload_len);
+ * w.end_length<Wire_u8>(len_mark);
+ *
+ * if (w.ok())
+ *     send_msg(w.data(), w.size());
+ * \endcode
+ *
+ * \code
+ * Byte_reader r{rx_buf, rx_len};
+ * int len;
+ *
+ * r.get<Wire_u8, Wire_le16, Wire_be32>(type, flags, value);
+ * r.get<Wire_u8>(len);
+ * Const_byte_span payload = r.take(len);
+ *
+ * if (!r.ok())
+ *     return error;
+ * \endcode
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_BYTE_CURSOR_HPP
+#define HODEA_BYTE_CURSOR_HPP
+
+#include <cstring>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/span.hpp>
+#include <hodea/core/wire_format.hpp>
+
+namespace hodea {
+
+/**
+ * Class to write a message into a buffer.
+ */
+class Byte_writer {
+public:
+    Byte_writer(uint8_t* buf, int capacity)
+        : buf{buf}, capacity{capacity}
+    {}
+
+    Byte_writer(Byte_span buf) : Byte_writer(buf.data(), buf.size()) {}
+
+    template <std::size_t N>
+    Byte_writer(uint8_t (&buf)[N]) : Byte_writer(buf, N) {}
+
+    /**
+     * Write a sequence of fixed-size fields.
+     *
+     * \tparam T_formats
+     *      Wire formats of the fields, e.g. Wire_le16.
+     * \param[in] vals
+     *      The values to write, one for each wire format.
+     *
+     * \returns
+     *      True on success, false if the buffer is too small or the
+     *      writer is in error state. Nothing is written in this case.
+     */
+    template <typename... T_formats, typename... T_vals>
+    bool put(const T_vals&... vals)
+    {
+        static_assert(
+            sizeof...(T_formats) == sizeof...(T_vals),
+            "number of formats and values differ"
+            );
+
+        uint8_t* p = reserve(Wire_size<T_formats...>::value);
+
+        if (!p)
+            return false;
+        put_at<0, T_formats...>(p, vals...);
+        return true;
+    }
+
+    /**
+     * Copy a sequence of bytes.
+     */
+    bool put_bytes(const uint8_t* src, int len)
+    {
+        if (len == 0)   // src and buf may be nullptr, memcpy() forbids it
+            return ok();
+
+        uint8_t* p = reserve(len);
+
+        if (!p)
+            return false;
+        std::memcpy(p, src, len);
+        return true;
+    }
+
+    /**
+     * Copy a sequence of bytes.
+     */
+    bool put_bytes(Const_byte_span src)
+    {
+        return put_bytes(src.data(), src.size());
+    }
+
+    /**
+     * Reserve space to be filled by the caller.
+     *
+     * \returns
+     *      Pointer to the reserved space, or nullptr if the buffer is
+     *      too small or the writer is in error state.
+     */
+    uint8_t* reserve(int len)
+    {
+        if (failed || (len > capacity - pos) || (len < 0)) {
+            failed = true;
+            return nullptr;
+        }
+
+        uint8_t* p = buf + pos;
+        pos += len;
+        return p;
+    }
+
+    /**
+     * Reserve a length field to be patched via end_length().
+     *
+     * \tparam T_format
+     *      Wire format of the length field.
+     *
+     * \returns
+     *      Mark to be passed to end_length().
+     */
+    template <typename T_format>
+    int begin_length()
+    {
+        int mark = pos;
+
+        reserve(T_format::size);
+        return mark;
+    }
+
+    /**
+     * Patch a length field reserved with begin_length().
+     *
+     * The length is the number of bytes written after the length field.
+     * The writer enters the error state if the length does not fit into
+     * the length field.
+     *
+     * \tparam T_format
+     *      Wire format of the length field, as for begin_length().
+     * \param[in] mark
+     *      Mark returned by begin_length().
+     */
+    template <typename T_format>
+    void end_length(int mark)
+    {
+        typedef typename T_format::Uint Uint;
+
+        if (failed)
+            return;
+
+        uint64_t len = pos - mark - T_format::size;
+
+        if (len > static_cast<Uint>(~static_cast<Uint>(0))) {
+            failed = true;
+            return;
+        }
+        T_format::store(buf + mark, len);
+    }
+
+    /**
+     * Test if all accesses succeeded.
+     */
+    bool ok() const { return !failed; }
+
+    /**
+     * Get the number of bytes written so far.
+     */
+    int size() const { return pos; }
+
+    /**
+     * Get the number of bytes still available.
+     */
+    int remaining() const { return capacity - pos; }
+
+    /**
+     * Get the start of the buffer.
+     */
+    uint8_t* data() const { return buf; }
+
+    /**
+     * Get a span onto the bytes written so far.
+     */
+    Byte_span written() const { return Byte_span{buf, pos}; }
+
+private:
+    template <int offs>
+    static void put_at(uint8_t*) {}
+
+    template <int offs, typename T_format, typename... T_rest,
+              typename T_val, typename... T_vals>
+    static void put_at(uint8_t* p, const T_val& val, const T_vals&... vals)
+    {
+        T_format::store(p + offs, val);
+        put_at<offs + T_format::size, T_rest...>(p, vals...);
+    }
+
+    uint8_t* const buf;
+    const int capacity;
+    int pos = 0;
+    bool failed = false;
+};
+
+/**
+ * Class to read a message from a buffer.
+ */
+class Byte_reader {
+public:
+    Byte_reader(const uint8_t* buf, int len)
+        : buf{buf}, len{len}
+    {}
+
+    Byte_reader(Const_byte_span buf) : Byte_reader(buf.data(), buf.size())
+    {}
+
+    /**
+     * Read a sequence of fixed-size fields.
+     *
+     * \tparam T_formats
+     *      Wire formats of the fields, e.g. Wire_le16.
+     * \param[out] vals
+     *      The variables receiving the values, one for each wire format.
+     *
+     * \returns
+     *      True on success, false if not enough data is available or the
+     *      reader is in error state. The variables are not modified in
+     *      this case.
+     */
+    template <typename... T_formats, typename... T_vals>
+    bool get(T_vals&... vals)
+    {
+        static_assert(
+            sizeof...(T_formats) == sizeof...(T_vals),
+            "number of formats and values differ"
+            );
+
+        const uint8_t* p = consume(Wire_size<T_formats...>::value);
+
+        if (!p)
+            return false;
+        get_at<0, T_formats...>(p, vals...);
+        return true;
+    }
+
+    /**
+     * Copy a sequence of bytes.
+     */
+    bool get_bytes(uint8_t* dst, int n)
+    {
+        if (n == 0)     // dst and buf may be nullptr, memcpy() forbids it
+            return ok();
+
+        const uint8_t* p = consume(n);
+
+        if (!p)
+            return false;
+        std::memcpy(dst, p, n);
+        return true;
+    }
+
+    /**
+     * Get a sequence of bytes without copying them.
+     *
+     * \returns
+     *      Span onto the next \a n bytes within the buffer, or an empty
+     *      span if not enough data is available.
+     */
+    Const_byte_span take(int n)
+    {
+        const uint8_t* p = consume(n);
+
+        return p ? Const_byte_span{p, n} : Const_byte_span{};
+    }
+
+    /**
+     * Skip a number of bytes.
+     */
+    bool skip(int n)
+    {
+        return consume(n) != nullptr;
+    }
+
+    /**
+     * Test if all accesses succeeded.
+     */
+    bool ok() const { return !failed; }
+
+    /**
+     * Get the number of bytes consumed so far.
+     */
+    int position() const { return pos; }
+
+    /**
+     * Get the number of bytes not consumed yet.
+     */
+    int remaining() const { return len - pos; }
+
+private:
+    const uint8_t* consume(int n)
+    {
+        if (failed || (n > len - pos) || (n < 0)) {
+            failed = true;
+            return nullptr;
+        }
+
+        const uint8_t* p = buf + pos;
+        pos += n;
+        return p;
+    }
+
+    template <int offs>
+    static void get_at(const uint8_t*) {}
+
+    template <int offs, typename T_format, typename... T_rest,
+              typename T_val, typename... T_vals>
+    static void get_at(const uint8_t* p, T_val& val, T_vals&... vals)
+    {
+        T_format::fetch(val, p + offs);
+        get_at<offs + T_format::size, T_rest...>(p, vals...);
+    }
+
+    const uint8_t* const buf;
+    const int len;
+    int pos = 0;
+    bool failed = false;
+};
+
+} // namespace hodea
+
+#endif /*!HODEA_BYTE_CURSOR_HPP */
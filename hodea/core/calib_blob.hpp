@@ -0,0 +1,344 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Versioned calibration blobs accessed in place from flash.
+ *
+ * Calibration and configuration data is often copied from flash into a
+ * RAM struct at boot, field by field. This costs boot time and RAM.
+ *
+ * A calibration blob consists of a Calib_header, followed by the
+ * payload. The payload is a struct composed of endian types (see
+ * endian_types.hpp) and uint8_t, so it has no padding and is accessed
+ * in place. Validation is a single CRC pass over the payload.
+ *
+ * Versioning rules:
+ *
+ * - Fields are never removed or reordered, new fields are appended.
+ * - The version is incremented whenever fields are appended.
+ * - A reader accepts a blob with the same or a newer version, provided
+ *   the blob holds at least the fields known to the reader.
+ *
+ * The layout of the payload struct is checked at compile time against
+ * a schema, which gives the wire format of each member in order (see
+ * Calib_schema and HODEA_CALIB_FIELD()). Each member must be at the
+ * offset following from the formats of the members before it, and its
+ * type must have the width and byte order of its format.
+ *
+ * The CRC algorithm is passed as functor with the signature
+ * uint32_t(const uint8_t* data, int len), so the same code works with
+ * a table driven software CRC and with the CRC unit of the MCU.
+ *
+ * Example:
+ *
+ * \code
+ * struct Motor_calib {
+ *     le_uint16_t gain;
+ *     le_uint32_t offset;
+ *     uint8_t pole_pairs;
+ *     be_uint16_t max_current;
+ * };
+ *
+ * typedef Calib_schema<
+ *     HODEA_CALIB_FIELD(Motor_calib, gain, Wire_le16),
+ *     HODEA_CALIB_FIELD(Motor_calib, offset, Wire_le32),
+ *     HODEA_CALIB_FIELD(Motor_calib, pole_pairs, Wire_u8),
+ *     HODEA_CALIB_FIELD(Motor_calib, max_current, Wire_be16)
+ *     > Motor_calib_schema;
+ *
+ * static_assert(
+ *     calib_layout_matches<Motor_calib, Motor_calib_schema>(),
+ *     "Motor_calib does not match its schema"
+ *     );
+ *
+ * constexpr uint32_t motor_calib_magic = 0x4d43414c;
+ * constexpr uint16_t motor_calib_version = 2;
+ *
+ * extern const uint8_t calib_flash[];  // placed by the linker script
+ *
+ * const Motor_calib* calib = open_calib_blob<Motor_calib>(
+ *     calib_flash, calib_flash_size,
+ *     motor_calib_magic, motor_calib_version, crc32
+ *     );
+ * if (!calib)
+ *     use_defaults();
+ * :
+ * uint16_t gain = calib->gain;
+ * \endcode
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_CALIB_BLOB_HPP
+#define HODEA_CALIB_BLOB_HPP
+
+#include <cstddef>
+#include <type_traits>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/endian_types.hpp>
+#include <hodea/core/wire_format.hpp>
+
+namespace hodea {
+
+/**
+ * Header of a calibration blob.
+ */
+struct Calib_header {
+    le_uint32_t magic;          // identifies the payload type
+    le_uint16_t version;        // layout version of the payload
+    le_uint16_t reserved;       // zero, a blob with other values is rejected
+    le_uint32_t length;         // number of payload bytes
+    le_uint32_t crc;            // CRC over the payload bytes
+};
+
+static_assert(sizeof(Calib_header) == 16, "Calib_header has padding");
+
+/**
+ * Wire format corresponding to the type of a payload member.
+ *
+ * Endian types map onto the wire format with their width and byte
+ * order, bytes onto Wire_u8. Other types are not allowed in a payload
+ * and map onto void.
+ */
+template <typename T_member>
+struct Calib_member_format {
+    typedef void Format;
+};
+
+template <typename T, Byte_order order>
+struct Calib_member_format<Endian_uint<T, order>> {
+    typedef Wire_format<sizeof(T), order> Format;
+};
+
+template <>
+struct Calib_member_format<uint8_t> {
+    typedef Wire_u8 Format;
+};
+
+template <>
+struct Calib_member_format<int8_t> {
+    typedef Wire_u8 Format;
+};
+
+/**
+ * Class describing a member of a payload struct.
+ *
+ * \tparam T_payload
+ *      The payload struct.
+ * \tparam T_member
+ *      The type of the data member.
+ * \tparam member_offset
+ *      The offset of the data member within \a T_payload.
+ * \tparam T_format
+ *      The wire format of the member, e.g. Wire_le16.
+ *
+ * The macro HODEA_CALIB_FIELD() is provided for convenience.
+ */
+template <
+    typename T_payload, typename T_member, std::size_t member_offset,
+    typename T_format
+    >
+struct Calib_field {
+    static_assert(
+        std::is_same<
+            typename Calib_member_format<T_member>::Format, T_format
+            >::value,
+        "type of payload member does not match its wire format"
+        );
+
+    typedef T_payload Payload;
+
+    static constexpr int size = T_format::size;
+    static constexpr int offset = member_offset;
+};
+
+/**
+ * Declare a member of a payload struct.
+ *
+ * \param[in] payload The payload struct.
+ * \param[in] member  The name of the data member.
+ * \param[in] format  The wire format of the member, e.g. Wire_le16.
+ */
+#define HODEA_CALIB_FIELD(payload, member, format)                      \
+    ::hodea::Calib_field<                                               \
+        payload, decltype(payload::member), offsetof(payload, member),  \
+        ::hodea::format                                                 \
+        >
+
+/**
+ * Layout of a payload given as list of its members.
+ *
+ * \tparam T_fields
+ *      The members in order, see Calib_field.
+ */
+template <typename... T_fields>
+struct Calib_schema {
+    /**
+     * Number of fields.
+     */
+    static constexpr int count = sizeof...(T_fields);
+
+    /**
+     * Size of the payload in bytes.
+     */
+    static constexpr int size = Wire_size<T_fields...>::value;
+
+    /**
+     * Get the offset of the field with index \a idx.
+     */
+    static constexpr int offset(int idx)
+    {
+        const int sizes[] = {T_fields::size..., 0};
+        int offs = 0;
+
+        for (int i = 0; i < idx; ++i)
+            offs += sizes[i];
+        return offs;
+    }
+
+    /**
+     * Test if all fields are members of \a T_payload, placed one after
+     * another without gap.
+     */
+    template <typename T_payload>
+    static constexpr bool fields_match()
+    {
+        const bool is_member[] = {
+            std::is_same<typename T_fields::Payload, T_payload>::value...,
+            true
+            };
+        const int offsets[] = {T_fields::offset..., 0};
+
+        for (int i = 0; i < count; ++i) {
+            if (!is_member[i] || (offsets[i] != offset(i)))
+                return false;
+        }
+        return true;
+    }
+};
+
+/**
+ * Test at compile time if a payload struct is usable in place and
+ * matches its schema member by member.
+ *
+ * The type of each member is checked against its wire format when the
+ * schema is instantiated.
+ */
+template <typename T_payload, typename T_schema>
+constexpr bool calib_layout_matches()
+{
+    return std::is_standard_layout<T_payload>::value &&
+        std::is_trivially_copyable<T_payload>::value &&
+        (alignof(T_payload) == 1) &&
+        (sizeof(T_payload) == T_schema::size) &&
+        T_schema::template fields_match<T_payload>();
+}
+
+/**
+ * Result of the validation of a calibration blob.
+ */
+enum struct Calib_status {
+    ok,
+    bad_magic,
+    bad_reserved,       // reserved header field not zero
+    bad_version,        // blob older than the reader
+    bad_length,         // blob too short or length field inconsistent
+    bad_crc
+};
+
+/**
+ * Validate a calibration blob.
+ *
+ * \tparam T_payload
+ *      The payload struct known to the reader.
+ *
+ * \param[in] blob
+ *      The blob, e.g. in flash.
+ * \param[in] size
+ *      The size of the memory area holding the blob.
+ * \param[in] magic
+ *      The expected magic number.
+ * \param[in] version
+ *      The version of the layout of \a T_payload.
+ * \param[in] crc
+ *      Functor calculating the CRC over a sequence of bytes.
+ */
+template <typename T_payload, typename T_crc>
+Calib_status validate_calib_blob(
+    const uint8_t* blob, int size, uint32_t magic, uint16_t version,
+    T_crc&& crc
+    )
+{
+    if (size < static_cast<int>(sizeof(Calib_header)))
+        return Calib_status::bad_length;
+
+    auto hdr = reinterpret_cast<const Calib_header*>(blob);
+    uint32_t length = hdr->length;
+
+    if (hdr->magic != magic)
+        return Calib_status::bad_magic;
+    if (hdr->reserved != 0)
+        return Calib_status::bad_reserved;
+    if (hdr->version < version)
+        return Calib_status::bad_version;
+    if ((length < sizeof(T_payload)) ||
+        (length > size - sizeof(Calib_header)))
+        return Calib_status::bad_length;
+    if (crc(blob + sizeof(Calib_header), static_cast<int>(length)) !=
+        hdr->crc)
+        return Calib_status::bad_crc;
+    return Calib_status::ok;
+}
+
+/**
+ * Validate a calibration blob and get a view onto its payload.
+ *
+ * \returns
+ *      Pointer to the payload, or nullptr if the blob is invalid.
+ */
+template <typename T_payload, typename T_crc>
+const T_payload* open_calib_blob(
+    const uint8_t* blob, int size, uint32_t magic, uint16_t version,
+    T_crc&& crc
+    )
+{
+    static_assert(
+        std::is_standard_layout<T_payload>::value &&
+        std::is_trivially_copyable<T_payload>::value &&
+        (alignof(T_payload) == 1),
+        "payload must be composed of endian types and bytes"
+        );
+
+    if (validate_calib_blob<T_payload>(blob, size, magic, version, crc) !=
+        Calib_status::ok)
+        return nullptr;
+    return reinterpret_cast<const T_payload*>(blob + sizeof(Calib_header));
+}
+
+/**
+ * Fill in the header of a calibration blob.
+ *
+ * The payload must already be placed behind the header. Used by the
+ * production tools and by firmware updating the calibration data.
+ *
+ * \returns
+ *      The total size of the blob.
+ */
+template <typename T_crc>
+int seal_calib_blob(
+    uint8_t* blob, uint32_t magic, uint16_t version, int length,
+    T_crc&& crc
+    )
+{
+    auto hdr = reinterpret_cast<Calib_header*>(blob);
+
+    hdr->magic = magic;
+    hdr->version = version;
+    hdr->reserved = 0;
+    hdr->length = length;
+    hdr->crc = crc(blob + sizeof(Calib_header), length);
+    return sizeof(Calib_header) + length;
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_CALIB_BLOB_HPP */
@@ -0,0 +1,354 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Consistent Overhead Byte Stuffing (COBS).
+ *
+ * COBS removes all zero bytes from a frame, so a zero byte can be used
+ * as unambiguous frame delimiter, e.g. on a UART link. The encoded frame
+ * is a sequence of blocks, each starting with a code byte \a n followed
+ * by \a n - 1 data bytes. A code byte less than 0xff implies a zero
+ * after the data bytes, except for the last block of the frame. The
+ * overhead is at most one byte per 254 bytes of data, plus the
+ * delimiter.
+ *
+ * This file provides:
+ *
+ * - Cobs_encoder, which encodes a frame passed in one or several chunks
+ *   into an output buffer.
+ * - Cobs_decoder, which decodes the received bytes incrementally, one
+ *   at a time or in chunks as provided by an interrupt service routine
+ *   or a DMA buffer.
+ * - cobs_decode(), which decodes a complete frame. It supports decoding
+ *   in place, so a frame received e.g. via DMA needs no second buffer.
+ *
+ * Example:
+ *
+ * \code
+ * uint8_t tx_buf[Cobs_encoder::max_encoded_size(payload_size)];
+ * Cobs_encoder enc{tx_buf};
+ *
+ * enc.put(header, sizeof(header));
+ * enc.put(payload, payload_len);
+ * if (enc.finish())
+ *     uart_send(tx_buf, enc.size());
+ *
+ * uint8_t rx_frame[64];
+ * Cobs_decoder dec{rx_frame};
+ *
+ * void USART1_IRQHandler()
+ * {
+ *     if (dec.put(USART1->RDR) == Cobs_decoder::Status::complete)
+ *         process_frame(dec.frame());
+ * }
+ * \endcode
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_COBS_HPP
+#define HODEA_COBS_HPP
+
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/span.hpp>
+
+namespace hodea {
+
+/**
+ * Class to encode a frame with COBS.
+ */
+class Cobs_encoder {
+public:
+    /**
+     * Get the maximum size of an encoded frame including delimiter.
+     */
+    static constexpr int max_encoded_size(int len)
+    {
+        return len + len / 254 + 2;
+    }
+
+    Cobs_encoder(uint8_t* buf, int capacity)
+        : buf{buf}, capacity{capacity}
+    {
+        reset();
+    }
+
+    Cobs_encoder(Byte_span buf) : Cobs_encoder(buf.data(), buf.size()) {}
+
+    template <std::size_t N>
+    Cobs_encoder(uint8_t (&buf)[N]) : Cobs_encoder(buf, N) {}
+
+    /**
+     * Start a new frame, discarding the current one.
+     */
+    void reset()
+    {
+        failed = capacity < 1;
+        code_pos = 0;
+        pos = 1;
+        code = 1;
+    }
+
+    /**
+     * Append a byte to the frame.
+     */
+    bool put(uint8_t byte)
+    {
+        if (failed)
+            return false;
+
+        // a full block is closed lazily, as no code byte must follow
+        // if it is the last one of the frame
+        if (code == 0xff) {
+            if (pos >= capacity)
+                return fail();
+            close_block();
+        }
+
+        if (pos >= capacity)
+            return fail();
+        if (byte == 0) {
+            close_block();
+        }
+        else {
+            buf[pos++] = byte;
+            ++code;
+        }
+        return true;
+    }
+
+    /**
+     * Append a sequence of bytes to the frame.
+     */
+    bool put(const uint8_t* data, int len)
+    {
+        for (int i = 0; i < len; ++i) {
+            if (!put(data[i]))
+                return false;
+        }
+        return ok();
+    }
+
+    /**
+     * Complete the frame and append the delimiter.
+     */
+    bool finish()
+    {
+        if (failed || (pos >= capacity))
+            return fail();
+
+        buf[code_pos] = code;
+        buf[pos++] = 0;
+        return true;
+    }
+
+    /**
+     * Test if all bytes fitted into the buffer.
+     */
+    bool ok() const { return !failed; }
+
+    /**
+     * Get the size of the encoded frame.
+     *
+     * After finish() this is the size including delimiter.
+     */
+    int size() const { return pos; }
+
+private:
+    bool fail()
+    {
+        failed = true;
+        return false;
+    }
+
+    void close_block()
+    {
+        buf[code_pos] = code;
+        code_pos = pos++;
+        code = 1;
+    }
+
+    uint8_t* const buf;
+    const int capacity;
+    int code_pos;               // position of the current code byte
+    int pos;                    // next position to write
+    uint8_t code;               // code of the current block
+    bool failed;
+};
+
+/**
+ * Class to decode COBS frames incrementally.
+ *
+ * Received bytes are passed via put(). The decoded frame is written
+ * into the buffer given to the constructor. When the delimiter is
+ * received, put() reports a complete frame, which is accessible via
+ * frame() until the next byte is passed.
+ *
+ * Frames exceeding the buffer and frames violating the encoding are
+ * reported as error. The decoder resynchronizes at the next delimiter.
+ * Empty frames, i.e. consecutive delimiters, are ignored.
+ */
+class Cobs_decoder {
+public:
+    enum struct Status {
+        pending,        // frame not yet complete
+        complete,       // frame received
+        error           // frame dropped
+    };
+
+    Cobs_decoder(uint8_t* buf, int capacity)
+        : buf{buf}, capacity{capacity}
+    {}
+
+    Cobs_decoder(Byte_span buf) : Cobs_decoder(buf.data(), buf.size()) {}
+
+    template <std::size_t N>
+    Cobs_decoder(uint8_t (&buf)[N]) : Cobs_decoder(buf, N) {}
+
+    /**
+     * Process a received byte.
+     */
+    Status put(uint8_t byte)
+    {
+        if (is_complete)
+            restart();
+
+        if (byte == 0)
+            return end_of_frame();
+        if (failed)
+            return Status::pending;
+
+        if (remaining == 0) {
+            // code byte
+            if (has_block && (block_code != 0xff) && !append(0))
+                return Status::pending;
+            has_block = true;
+            block_code = byte;
+            remaining = byte - 1;
+        }
+        else {
+            append(byte);
+            --remaining;
+        }
+        return Status::pending;
+    }
+
+    /**
+     * Process a chunk of received bytes.
+     *
+     * Processing stops after a complete frame or an error, so the frame
+     * can be handled before the remaining bytes are passed.
+     *
+     * \param[in] data
+     *      The received bytes.
+     * \param[in] len
+     *      The number of bytes in \a data.
+     * \param[out] status
+     *      The status after the last byte processed.
+     *
+     * \returns
+     *      The number of bytes processed.
+     */
+    int put(const uint8_t* data, int len, Status& status)
+    {
+        status = Status::pending;
+        for (int i = 0; i < len; ++i) {
+            status = put(data[i]);
+            if (status != Status::pending)
+                return i + 1;
+        }
+        return len;
+    }
+
+    /**
+     * Get the frame after put() reported Status::complete.
+     */
+    Byte_span frame() const { return Byte_span{buf, pos}; }
+
+    /**
+     * Discard the frame received so far.
+     */
+    void restart()
+    {
+        pos = 0;
+        remaining = 0;
+        has_block = false;
+        is_complete = false;
+        failed = false;
+    }
+
+private:
+    bool append(uint8_t byte)
+    {
+        if (pos >= capacity) {
+            failed = true;
+            return false;
+        }
+        buf[pos++] = byte;
+        return true;
+    }
+
+    Status end_of_frame()
+    {
+        if (!has_block && !failed)
+            return Status::pending;
+
+        if (failed || (remaining != 0)) {
+            restart();
+            return Status::error;
+        }
+        is_complete = true;
+        return Status::complete;
+    }
+
+    uint8_t* const buf;
+    const int capacity;
+    int pos = 0;
+    int remaining = 0;          // data bytes left in the current block
+    uint8_t block_code = 0;
+    bool has_block = false;
+    bool is_complete = false;
+    bool failed = false;
+};
+
+/**
+ * Decode a complete COBS frame.
+ *
+ * \param[out] dst
+ *      Target buffer with space for \a len bytes. May be equal to
+ *      \a src to decode in place.
+ * \param[in] src
+ *      The encoded frame, with or without trailing delimiter.
+ * \param[in] len
+ *      The number of bytes in \a src.
+ *
+ * \returns
+ *      The size of the decoded frame, or -1 if the frame is malformed.
+ */
+static inline int cobs_decode(uint8_t* dst, const uint8_t* src, int len)
+{
+    const uint8_t* end = src + len;
+    uint8_t* p = dst;
+
+    if ((len > 0) && (end[-1] == 0))
+        --end;
+
+    while (src < end) {
+        int code = *src++;
+
+        if ((code == 0) || (code - 1 > end - src))
+            return -1;
+        for (int i = 1; i < code; ++i) {
+            uint8_t byte = *src++;
+            if (byte == 0)
+                return -1;
+            *p++ = byte;
+        }
+        if ((code != 0xff) && (src < end))
+            *p++ = 0;
+    }
+    return p - dst;
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_COBS_HPP */
@@ -89,6 +89,22 @@ constexpr bool is_cpu_be()
     return HODEA_IS_CPU_BE;
 }
 
+/**
+ * Enumeration listing the supported byte orders.
+ */
+enum struct Byte_order {
+    le,         // little endian, LSB first
+    be          // big endian, MSB first
+};
+
+/**
+ * Get the byte order of the CPU.
+ */
+constexpr Byte_order cpu_byte_order()
+{
+    return is_cpu_le() ? Byte_order::le : Byte_order::be;
+}
+
 /**
  * Convert unsigned 16 bit value in CPU byte order to little endian.
  */
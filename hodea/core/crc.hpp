@@ -0,0 +1,571 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Table driven cyclic redundancy checks (CRC).
+ *
+ * The class template Crc implements CRCs with a width of 8, 16 and 32
+ * bits. It is parameterized as in the catalogue of parameterised CRC
+ * algorithms (Rocksoft model): polynomial, initial value, reflection
+ * of input and output, and final XOR value. Common CRCs are available
+ * as aliases, e.g. Crc32 and Crc16_modbus.
+ *
+ * The lookup tables are generated at compile time and placed in
+ * read-only memory. The table size trades flash for speed:
+ *
+ * - Crc_table::nibble uses 16 entries and processes 4 bits per step.
+ * - Crc_table::byte uses 256 entries and processes a byte per step.
+ * - Crc_table::slice8 uses 8 tables of 256 entries and processes 8
+ *   bytes per step. Host builds with PCLMULQDQ and SSSE3 enabled (e.g.
+ *   -mpclmul -mssse3, -march=native) fold 64 bytes per step with
+ *   carry-less multiplication instead, and use the tables only for the
+ *   remainder.
+ *
+ * For a 32 bit CRC the tables take 64 bytes, 1 KB and 8 KB of flash.
+ *
+ * The CRC unit of the STM32 processes 32 bit words, most significant
+ * byte first. Crc::update_words() does the same in software, so
+ * Crc32_stm32 is bit-exact with bls_progmem_crc() and the CRC unit in
+ * its default configuration.
+ *
+ * Example:
+ *
+ * \code
+ * Crc32<> crc;
+ *
+ * while ((len = read_chunk(buf, sizeof(buf))) > 0)
+ *     crc.update(buf, len);
+ * if (crc.value() != expected)
+ *     return error;
+ *
+ * uint8_t pec = Crc8_smbus<Crc_table::nibble>::compute(frame, frame_len);
+ * \endcode
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_CRC_HPP
+#define HODEA_CRC_HPP
+
+#include <type_traits>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/serialization.hpp>
+#include <hodea/core/span.hpp>
+
+#if defined __PCLMUL__ && defined __SSSE3__
+#define HODEA_CRC_CLMUL 1
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+#endif
+
+namespace hodea {
+
+/**
+ * Size of the lookup tables used by Crc.
+ */
+enum struct Crc_table {
+    nibble,             // 16 entries
+    byte,               // 256 entries
+    slice8              // 8 x 256 entries
+};
+
+/**
+ * Reverse the order of the lower \a width bits of \a v.
+ */
+static inline constexpr uint64_t crc_reflect(uint64_t v, int width)
+{
+    uint64_t r = 0;
+
+    for (int i = 0; i < width; ++i)
+        r |= ((v >> i) & 1) << (width - 1 - i);
+    return r;
+}
+
+/**
+ * Lookup tables for a CRC, generated at compile time.
+ *
+ * For a reflected CRC the tables hold the reflected remainders.
+ */
+template <typename T, T poly, bool reflected, Crc_table table>
+struct Crc_lut {
+    static constexpr int width = 8 * sizeof(T);
+    static constexpr int num_tables = (table == Crc_table::slice8) ? 8 : 1;
+    static constexpr int index_bits = (table == Crc_table::nibble) ? 4 : 8;
+    static constexpr int num_entries = 1 << index_bits;
+
+    constexpr Crc_lut() : t{}
+    {
+        const T rpoly = static_cast<T>(crc_reflect(poly, width));
+        const T top = static_cast<T>(1ULL << (width - 1));
+
+        for (int i = 0; i < num_entries; ++i) {
+            T c = reflected ? i : static_cast<T>(i << (width - index_bits));
+
+            for (int bit = 0; bit < index_bits; ++bit) {
+                if (reflected)
+                    c = (c & 1) ? (c >> 1) ^ rpoly : c >> 1;
+                else
+                    c = (c & top) ? static_cast<T>(c << 1) ^ poly :
+                        static_cast<T>(c << 1);
+            }
+            t[0][i] = c;
+        }
+
+        // t[k][i] is the remainder of byte i followed by k zero bytes
+        for (int k = 1; k < num_tables; ++k) {
+            for (int i = 0; i < num_entries; ++i) {
+                T c = t[k - 1][i];
+
+                if (reflected)
+                    t[k][i] = static_cast<T>(c >> 8) ^ t[0][c & 0xff];
+                else
+                    t[k][i] = static_cast<T>(c << 8) ^
+                              t[0][c >> (width - 8)];
+            }
+        }
+    }
+
+    T t[num_tables][num_entries];
+};
+
+#if defined HODEA_CRC_CLMUL
+
+/**
+ * Get x^n mod P, with P given by the lower \a width bits of \a poly.
+ */
+static inline constexpr uint64_t crc_xn_mod_p(
+    uint64_t poly, int width, int n
+    )
+{
+    uint64_t r = 1;
+
+    for (int i = 0; i < n; ++i) {
+        r <<= 1;
+        if (r & (1ULL << width))
+            r ^= (1ULL << width) | poly;
+    }
+    return r;
+}
+
+/**
+ * Get the constants to fold a 128 bit block over \a distance bits.
+ *
+ * The lower 64 bit are multiplied with the lower half of the block and
+ * the upper 64 bit with the upper half. In the reflected domain bit i
+ * of a 64 bit half stands for x^(63 - i), so the product is one bit
+ * short of the position required, which is compensated by the
+ * exponent.
+ */
+template <typename T, T poly, bool reflected, int distance>
+static inline __m128i crc_fold_constants()
+{
+    constexpr int width = 8 * sizeof(T);
+    constexpr uint64_t k_lo = reflected ?
+        crc_reflect(crc_xn_mod_p(poly, width, distance + 63), 64) :
+        crc_xn_mod_p(poly, width, distance);
+    constexpr uint64_t k_hi = reflected ?
+        crc_reflect(crc_xn_mod_p(poly, width, distance - 1), 64) :
+        crc_xn_mod_p(poly, width, distance + 64);
+
+    return _mm_set_epi64x(k_hi, k_lo);
+}
+
+/**
+ * Fold block \a a into the following block \a b.
+ */
+static inline __m128i crc_fold(__m128i a, __m128i b, __m128i k)
+{
+    return _mm_xor_si128(
+        _mm_xor_si128(
+            _mm_clmulepi64_si128(a, k, 0x00),
+            _mm_clmulepi64_si128(a, k, 0x11)
+            ),
+        b
+        );
+}
+
+/**
+ * Fold complete 16 byte blocks with carry-less multiplication.
+ *
+ * The 16 byte remainder written to \a rest has the same CRC with an
+ * initial register value of zero as the blocks processed with the
+ * register value \a reg.
+ *
+ * \tparam word_swap
+ *      Process the bytes of each 32 bit word in reverse order.
+ *
+ * \returns
+ *      The number of bytes processed, a multiple of 16, at least 16.
+ */
+template <typename T, T poly, bool reflected, bool word_swap>
+int crc_fold_clmul(uint8_t* rest, T reg, const uint8_t* p, int len)
+{
+    constexpr int width = 8 * sizeof(T);
+    // bring the bytes into polynomial order: In the reflected domain
+    // the first byte is the least significant one, otherwise the most
+    // significant one
+    const __m128i order = reflected ?
+        _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12) :
+        _mm_setr_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    const __m128i reverse = _mm_setr_epi8(
+        15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+        );
+    const __m128i k1 = crc_fold_constants<T, poly, reflected, 128>();
+    const __m128i k4 = crc_fold_constants<T, poly, reflected, 512>();
+    int done;
+
+    auto load = [&](const uint8_t* q) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q));
+
+        if (word_swap)
+            return _mm_shuffle_epi8(v, order);
+        return reflected ? v : _mm_shuffle_epi8(v, reverse);
+    };
+
+    __m128i x = reflected ?
+        _mm_cvtsi32_si128(reg) :
+        _mm_set_epi32(static_cast<uint32_t>(reg) << (32 - width), 0, 0, 0);
+
+    if (len >= 128) {
+        __m128i x0 = _mm_xor_si128(load(p), x);
+        __m128i x1 = load(p + 16);
+        __m128i x2 = load(p + 32);
+        __m128i x3 = load(p + 48);
+
+        for (done = 64; len - done >= 64; done += 64) {
+            x0 = crc_fold(x0, load(p + done), k4);
+            x1 = crc_fold(x1, load(p + done + 16), k4);
+            x2 = crc_fold(x2, load(p + done + 32), k4);
+            x3 = crc_fold(x3, load(p + done + 48), k4);
+        }
+        x = crc_fold(crc_fold(crc_fold(x0, x1, k1), x2, k1), x3, k1);
+    }
+    else {
+        x = _mm_xor_si128(load(p), x);
+        done = 16;
+    }
+
+    for (; len - done >= 16; done += 16)
+        x = crc_fold(x, load(p + done), k1);
+
+    if (!reflected)
+        x = _mm_shuffle_epi8(x, reverse);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(rest), x);
+    return done;
+}
+
+#endif
+
+/**
+ * Cyclic redundancy check.
+ *
+ * \tparam T
+ *      uint8_t, uint16_t or uint32_t, determining the width of the CRC.
+ * \tparam poly
+ *      The polynomial in normal representation, without the x^width
+ *      term, e.g. 0x04c11db7 for CRC-32.
+ * \tparam init
+ *      The initial register value in normal representation.
+ * \tparam reflected
+ *      Process the bits of each byte least significant bit first, and
+ *      reflect the result.
+ * \tparam xor_out
+ *      Value XORed to the result.
+ * \tparam table
+ *      Size of the lookup tables.
+ */
+template <
+    typename T, T poly, T init, bool reflected, T xor_out,
+    Crc_table table = Crc_table::byte
+    >
+class Crc {
+public:
+    static_assert(
+        std::is_same<T, uint8_t>::value || std::is_same<T, uint16_t>::value ||
+        std::is_same<T, uint32_t>::value,
+        "CRC width must be 8, 16 or 32 bits"
+        );
+
+    using Value = T;
+    static constexpr int width = 8 * sizeof(T);
+
+    constexpr Crc() : reg{reg_init} {}
+
+    /**
+     * Start a new calculation.
+     */
+    void reset() { reg = reg_init; }
+
+    /**
+     * Add a sequence of bytes to the calculation.
+     */
+    void update(const uint8_t* data, int len)
+    {
+        update_bytes<false>(data, len);
+    }
+
+    void update(Const_byte_span data) { update(data.data(), data.size()); }
+
+    /**
+     * Add a sequence of 32 bit little endian words to the calculation.
+     *
+     * The bytes of each word are processed most significant byte first,
+     * as done by the CRC unit of the STM32 when words are written to
+     * its data register.
+     *
+     * \param[in] data
+     *      The words, not necessarily aligned.
+     * \param[in] len
+     *      The size in bytes, a multiple of 4.
+     */
+    void update_words(const uint8_t* data, int len)
+    {
+        update_bytes<true>(data, len);
+    }
+
+    /**
+     * Get the CRC of the bytes added since the last reset().
+     */
+    T value() const { return reg ^ xor_out; }
+
+    /**
+     * Calculate the CRC of a sequence of bytes.
+     */
+    static T compute(const uint8_t* data, int len)
+    {
+        Crc crc;
+
+        crc.update(data, len);
+        return crc.value();
+    }
+
+    /**
+     * Calculate the CRC of a sequence of bytes.
+     *
+     * Allows passing a Crc object where a functor is expected, e.g. to
+     * open_calib_blob().
+     */
+    T operator()(const uint8_t* data, int len) const
+    {
+        return compute(data, len);
+    }
+
+private:
+    using Lut = Crc_lut<T, poly, reflected, table>;
+
+    static constexpr T reg_init =
+        reflected ? static_cast<T>(crc_reflect(init, width)) : init;
+    static constexpr Lut lut{};
+
+    /**
+     * Get byte \a i of the input, taking the word order into account.
+     */
+    template <bool word_swap>
+    static uint8_t byte_at(const uint8_t* p, int i)
+    {
+        return p[word_swap ? (i ^ 3) : i];
+    }
+
+    /**
+     * Process a byte with the 256 entry table.
+     */
+    void update_byte(uint8_t b)
+    {
+        const auto& t = lut.t[0];
+
+        if (reflected)
+            reg = static_cast<T>(reg >> 8) ^ t[(reg ^ b) & 0xff];
+        else
+            reg = static_cast<T>(reg << 8) ^ t[(reg >> (width - 8)) ^ b];
+    }
+
+    /**
+     * Process a byte with the 16 entry table, one nibble at a time.
+     */
+    void update_nibbles(uint8_t b)
+    {
+        const auto& t = lut.t[0];
+
+        if (reflected) {
+            reg = static_cast<T>(reg >> 4) ^ t[(reg ^ b) & 0xf];
+            reg = static_cast<T>(reg >> 4) ^ t[(reg ^ (b >> 4)) & 0xf];
+        }
+        else {
+            reg = static_cast<T>(reg << 4) ^
+                  t[((reg >> (width - 4)) ^ (b >> 4)) & 0xf];
+            reg = static_cast<T>(reg << 4) ^
+                  t[((reg >> (width - 4)) ^ b) & 0xf];
+        }
+    }
+
+    /**
+     * Process 8 bytes with the slice-by-8 tables.
+     *
+     * The register is XORed into the leading bytes, then each byte
+     * selects its remainder from the table matching its distance to
+     * the end of the group. The bytes are fetched as two 32 bit words,
+     * with the first byte in the position the register is aligned to.
+     */
+    template <bool word_swap>
+    void update_slice8(const uint8_t* p)
+    {
+        const auto& t = lut.t;
+        uint32_t a;
+        uint32_t b;
+
+        if (reflected == word_swap) {
+            fetch32_be(a, p);
+            fetch32_be(b, p + 4);
+        }
+        else {
+            fetch32_le(a, p);
+            fetch32_le(b, p + 4);
+        }
+
+        if (reflected) {
+            a ^= reg;
+            reg = t[7][a & 0xff] ^ t[6][(a >> 8) & 0xff] ^
+                  t[5][(a >> 16) & 0xff] ^ t[4][a >> 24] ^
+                  t[3][b & 0xff] ^ t[2][(b >> 8) & 0xff] ^
+                  t[1][(b >> 16) & 0xff] ^ t[0][b >> 24];
+        }
+        else {
+            a ^= static_cast<uint32_t>(reg) << (32 - width);
+            reg = t[7][a >> 24] ^ t[6][(a >> 16) & 0xff] ^
+                  t[5][(a >> 8) & 0xff] ^ t[4][a & 0xff] ^
+                  t[3][b >> 24] ^ t[2][(b >> 16) & 0xff] ^
+                  t[1][(b >> 8) & 0xff] ^ t[0][b & 0xff];
+        }
+    }
+
+    template <bool word_swap>
+    void update_bytes(const uint8_t* p, int len)
+    {
+        int done = 0;
+
+        if (table == Crc_table::slice8) {
+#if defined HODEA_CRC_CLMUL
+            if (len >= 64) {
+                uint8_t rest[16];
+
+                done = crc_fold_clmul<T, poly, reflected, word_swap>(
+                    rest, reg, p, len
+                    );
+                reg = 0;
+                update_bytes<false>(rest, sizeof(rest));
+            }
+#endif
+            for (; len - done >= 8; done += 8)
+                update_slice8<word_swap>(p + done);
+        }
+
+        // done is a multiple of 8, so byte_at() stays within the words
+        for (; done < len; ++done) {
+            if (table == Crc_table::nibble)
+                update_nibbles(byte_at<word_swap>(p + (done & ~3), done & 3));
+            else
+                update_byte(byte_at<word_swap>(p + (done & ~3), done & 3));
+        }
+    }
+
+    T reg;
+};
+
+template <
+    typename T, T poly, T init, bool reflected, T xor_out, Crc_table table
+    >
+constexpr typename Crc<T, poly, init, reflected, xor_out, table>::Lut
+    Crc<T, poly, init, reflected, xor_out, table>::lut;
+
+template <
+    typename T, T poly, T init, bool reflected, T xor_out, Crc_table table
+    >
+constexpr T Crc<T, poly, init, reflected, xor_out, table>::reg_init;
+
+/**
+ * CRC-8 as used for the packet error code (PEC) of SMBus.
+ */
+template <Crc_table table = Crc_table::byte>
+using Crc8_smbus = Crc<uint8_t, 0x07, 0x00, false, 0x00, table>;
+
+/**
+ * CRC-16/CCITT-FALSE, e.g. used by Bluetooth and many bootloaders.
+ */
+template <Crc_table table = Crc_table::byte>
+using Crc16_ccitt_false = Crc<uint16_t, 0x1021, 0xffff, false, 0x0000, table>;
+
+/**
+ * CRC-16/XMODEM.
+ */
+template <Crc_table table = Crc_table::byte>
+using Crc16_xmodem = Crc<uint16_t, 0x1021, 0x0000, false, 0x0000, table>;
+
+/**
+ * CRC-16/KERMIT, the reflected CCITT CRC.
+ */
+template <Crc_table table = Crc_table::byte>
+using Crc16_kermit = Crc<uint16_t, 0x1021, 0x0000, true, 0x0000, table>;
+
+/**
+ * CRC-16/MODBUS.
+ */
+template <Crc_table table = Crc_table::byte>
+using Crc16_modbus = Crc<uint16_t, 0x8005, 0xffff, true, 0x0000, table>;
+
+/**
+ * CRC-32 as used by Ethernet, zlib and PNG.
+ */
+template <Crc_table table = Crc_table::byte>
+using Crc32 =
+    Crc<uint32_t, 0x04c11db7, 0xffffffff, true, 0xffffffff, table>;
+
+/**
+ * CRC-32C (Castagnoli), e.g. used by iSCSI and ext4.
+ */
+template <Crc_table table = Crc_table::byte>
+using Crc32c =
+    Crc<uint32_t, 0x1edc6f41, 0xffffffff, true, 0xffffffff, table>;
+
+/**
+ * CRC-32/MPEG-2, the CRC-32 polynomial processed unreflected.
+ */
+template <Crc_table table = Crc_table::byte>
+using Crc32_mpeg2 = Crc<uint32_t, 0x04c11db7, 0xffffffff, false, 0, table>;
+
+/**
+ * CRC of the STM32 CRC unit in its default configuration.
+ *
+ * The data is processed as sequence of 32 bit little endian words,
+ * most significant byte first. The length must be a multiple of 4.
+ */
+template <Crc_table table = Crc_table::byte>
+struct Crc32_stm32 {
+    uint32_t operator()(const uint8_t* data, int len) const
+    {
+        Crc32_mpeg2<table> crc;
+
+        crc.update_words(data, len);
+        return crc.value();
+    }
+};
+
+/**
+ * Calculate the CRC-32 of a sequence of bytes.
+ */
+static inline uint32_t crc32(const uint8_t* data, int len)
+{
+    return Crc32<>::compute(data, len);
+}
+
+/**
+ * Calculate the CRC-32C of a sequence of bytes.
+ */
+static inline uint32_t crc32c(const uint8_t* data, int len)
+{
+    return Crc32c<>::compute(data, len);
+}
+
+} // namespace hodea
+
+#undef HODEA_CRC_CLMUL
+
+#endif /*!HODEA_CRC_HPP */
@@ -0,0 +1,226 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Delta compression for sampled signal streams.
+ *
+ * Smooth signals, e.g. ADC samples of a slowly changing voltage, differ
+ * only little from sample to sample. Delta_encoder therefore transmits
+ * the difference to the previous sample instead of the sample itself.
+ * The differences are zigzag encoded (see protobuf.hpp), so small
+ * negative and positive differences both result in small numbers.
+ *
+ * The samples are grouped into blocks of \a block_size samples. Each
+ * block starts with a 6 bit field giving the bit width of the largest
+ * zigzag value within the block, followed by the zigzag values packed
+ * at this width with Bit_writer (see bitstream.hpp). A block of 16
+ * samples of a 12 bit ADC changing by at most +/-7 LSB per sample
+ * takes 6 + 16 * 4 = 70 bits instead of 256 bits as 16 bit words.
+ *
+ * The bit width is determined once per block by OR-ing the zigzag
+ * values, so the per sample work is a subtraction, the zigzag encoding
+ * and the bit packing, without data dependent branches.
+ *
+ * The stream does not contain the number of samples. The last block
+ * may be incomplete, and the receiver must know the number of samples,
+ * e.g. from the frame header.
+ *
+ * Example:
+ *
+ * \code
+ * uint8_t buf[64];
+ * Bit_writer w{buf};
+ * Delta_encoder<> enc{w};
+ *
+ * for (int i = 0; i < num_samples; ++i)
+ *     enc.put(adc_samples[i]);
+ * enc.flush();
+ * if (w.ok())
+ *     send_msg(buf, w.size());
+ *
+ * Bit_reader r{rx_buf, rx_len};
+ * Delta_decoder<> dec{r};
+ *
+ * dec.get(samples, num_samples);
+ * \endcode
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_DELTA_CODEC_HPP
+#define HODEA_DELTA_CODEC_HPP
+
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/bitmanip.hpp>
+#include <hodea/core/bitstream.hpp>
+#include <hodea/core/protobuf.hpp>
+
+namespace hodea {
+
+/**
+ * Number of bits used to transmit the bit width of a block.
+ */
+constexpr int delta_width_bits = 6;
+
+/**
+ * Class to encode a stream of samples.
+ *
+ * \tparam block_size
+ *      Number of samples per block.
+ */
+template <int block_size = 16>
+class Delta_encoder {
+public:
+    static_assert(block_size > 0, "block_size must be positive");
+
+    /**
+     * Constructor.
+     *
+     * \param[in] writer
+     *      Bit writer receiving the encoded stream.
+     * \param[in] initial
+     *      Reference value for the first difference. Must be the same
+     *      for encoder and decoder.
+     */
+    Delta_encoder(Bit_writer& writer, int32_t initial = 0)
+        : writer(writer), prev{initial}
+    {}
+
+    /**
+     * Append a sample.
+     *
+     * \returns
+     *      False if the writer is in error state.
+     */
+    bool put(int32_t sample)
+    {
+        uint32_t delta = static_cast<uint32_t>(sample) -
+            static_cast<uint32_t>(prev);
+
+        prev = sample;
+        zz[count++] = zigzag_encode32(static_cast<int32_t>(delta));
+        if (count == block_size)
+            return write_block();
+        return writer.ok();
+    }
+
+    /**
+     * Append a sequence of samples.
+     */
+    template <typename T>
+    bool put(const T* samples, int n)
+    {
+        for (int i = 0; i < n; ++i)
+            put(samples[i]);
+        return writer.ok();
+    }
+
+    /**
+     * Write the incomplete block and the pending bits of the writer.
+     */
+    bool flush()
+    {
+        if (count > 0)
+            write_block();
+        return writer.flush();
+    }
+
+private:
+    bool write_block()
+    {
+        uint32_t all = 0;
+
+        for (int i = 0; i < count; ++i)
+            all |= zz[i];
+
+        int width = bit_width(all);
+
+        writer.put(width, delta_width_bits);
+        writer.put(zz, count, width);
+        count = 0;
+        return writer.ok();
+    }
+
+    Bit_writer& writer;
+    int32_t prev;
+    int count = 0;
+    uint32_t zz[block_size];
+};
+
+/**
+ * Class to decode a stream written by Delta_encoder.
+ *
+ * \tparam block_size
+ *      Number of samples per block, as used by the encoder.
+ */
+template <int block_size = 16>
+class Delta_decoder {
+public:
+    static_assert(block_size > 0, "block_size must be positive");
+
+    Delta_decoder(Bit_reader& reader, int32_t initial = 0)
+        : reader(reader), prev{initial}
+    {}
+
+    /**
+     * Read a sample.
+     *
+     * \returns
+     *      False if the stream is exhausted or malformed, or the decoder
+     *      is in error state.
+     */
+    template <typename T>
+    bool get(T& sample)
+    {
+        uint32_t zz;
+
+        if (index == 0) {
+            uint32_t w;
+
+            if (!reader.get(w, delta_width_bits))
+                return false;
+            width = w;
+            if (width > 32)
+                failed = true;
+        }
+        if (failed || !reader.get(zz, width))
+            return false;
+        if (++index == block_size)
+            index = 0;
+
+        prev = static_cast<int32_t>(
+            static_cast<uint32_t>(prev) +
+            static_cast<uint32_t>(zigzag_decode32(zz))
+            );
+        sample = static_cast<T>(prev);
+        return true;
+    }
+
+    /**
+     * Read a sequence of samples.
+     */
+    template <typename T>
+    bool get(T* samples, int n)
+    {
+        for (int i = 0; i < n; ++i) {
+            if (!get(samples[i]))
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Test if all reads succeeded.
+     */
+    bool ok() const { return !failed && reader.ok(); }
+
+private:
+    Bit_reader& reader;
+    int32_t prev;
+    int index = 0;
+    int width = 0;
+    bool failed = false;
+};
+
+} // namespace hodea
+
+#endif /*!HODEA_DELTA_CODEC_HPP */
@@ -0,0 +1,171 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Unsigned integer types stored in a fixed byte order.
+ *
+ * The types le_uint16_t, be_uint32_t, etc. hold their value as array of
+ * bytes in the given byte order. They convert implicitly from and to
+ * the corresponding native type, using the functions of cpu_endian.hpp.
+ *
+ * The types are trivially copyable and have an alignment of 1. So a
+ * struct composed of them has no padding and describes the layout of a
+ * message byte by byte. A received frame can be overlaid directly with
+ * such a struct and the fields are accessed in place, without a
+ * separate decode pass.
+ *
+ * Example:
+ *
+ * \code
+ * struct Frame_header {
+ *     uint8_t type;
+ *     le_uint16_t len;
+ *     be_uint32_t seq;
+ * };
+ *
+ * static_assert(sizeof(Frame_header) == 7, "unexpected padding");
+ * :
+ * auto hdr = reinterpret_cast<const Frame_header*>(rx_buf);
+ * if (hdr->len > max_len)
+ *     return error;
+ * uint32_t seq = hdr->seq;
+ * \endcode
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_ENDIAN_TYPES_HPP
+#define HODEA_ENDIAN_TYPES_HPP
+
+#include <cstring>
+#include <type_traits>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/cpu_endian.hpp>
+
+namespace hodea {
+
+/**
+ * Conversion between CPU byte order and the given byte order.
+ */
+template <typename T, Byte_order order>
+struct Endian_conv;
+
+template <>
+struct Endian_conv<uint16_t, Byte_order::le> {
+    static uint16_t to_cpu(uint16_t x) { return le16_to_cpu(x); }
+    static uint16_t from_cpu(uint16_t x) { return cpu_to_le16(x); }
+};
+
+template <>
+struct Endian_conv<uint32_t, Byte_order::le> {
+    static uint32_t to_cpu(uint32_t x) { return le32_to_cpu(x); }
+    static uint32_t from_cpu(uint32_t x) { return cpu_to_le32(x); }
+};
+
+template <>
+struct Endian_conv<uint64_t, Byte_order::le> {
+    static uint64_t to_cpu(uint64_t x) { return le64_to_cpu(x); }
+    static uint64_t from_cpu(uint64_t x) { return cpu_to_le64(x); }
+};
+
+template <>
+struct Endian_conv<uint16_t, Byte_order::be> {
+    static uint16_t to_cpu(uint16_t x) { return be16_to_cpu(x); }
+    static uint16_t from_cpu(uint16_t x) { return cpu_to_be16(x); }
+};
+
+template <>
+struct Endian_conv<uint32_t, Byte_order::be> {
+    static uint32_t to_cpu(uint32_t x) { return be32_to_cpu(x); }
+    static uint32_t from_cpu(uint32_t x) { return cpu_to_be32(x); }
+};
+
+template <>
+struct Endian_conv<uint64_t, Byte_order::be> {
+    static uint64_t to_cpu(uint64_t x) { return be64_to_cpu(x); }
+    static uint64_t from_cpu(uint64_t x) { return cpu_to_be64(x); }
+};
+
+/**
+ * Class representing an unsigned integer stored in a fixed byte order.
+ *
+ * \tparam T
+ *      Native unsigned type: uint16_t, uint32_t or uint64_t.
+ * \tparam order
+ *      Byte order used to store the value.
+ */
+template <typename T, Byte_order order>
+class Endian_uint {
+public:
+    typedef T Value;
+
+    Endian_uint() = default;
+
+    Endian_uint(T val) { set(val); }
+
+    Endian_uint& operator=(T val)
+    {
+        set(val);
+        return *this;
+    }
+
+    operator T() const { return get(); }
+
+    /**
+     * Get the value in CPU byte order.
+     */
+    T get() const
+    {
+        T v;
+
+        std::memcpy(&v, bytes, sizeof(v));
+        return Endian_conv<T, order>::to_cpu(v);
+    }
+
+    /**
+     * Set the value given in CPU byte order.
+     */
+    void set(T val)
+    {
+        val = Endian_conv<T, order>::from_cpu(val);
+        std::memcpy(bytes, &val, sizeof(val));
+    }
+
+private:
+    uint8_t bytes[sizeof(T)];
+};
+
+typedef Endian_uint<uint16_t, Byte_order::le> le_uint16_t;
+typedef Endian_uint<uint32_t, Byte_order::le> le_uint32_t;
+typedef Endian_uint<uint64_t, Byte_order::le> le_uint64_t;
+typedef Endian_uint<uint16_t, Byte_order::be> be_uint16_t;
+typedef Endian_uint<uint32_t, Byte_order::be> be_uint32_t;
+typedef Endian_uint<uint64_t, Byte_order::be> be_uint64_t;
+
+/*
+ * The types are intended to be overlaid onto byte buffers, which
+ * requires the following layout properties.
+ */
+#define HODEA_ASSERT_ENDIAN_TYPE_LAYOUT(type, size)                     \
+    static_assert(sizeof(type) == size, #type " has unexpected size");  \
+    static_assert(alignof(type) == 1, #type " must be byte aligned");   \
+    static_assert(                                                      \
+        std::is_trivially_copyable<type>::value,                        \
+        #type " must be trivially copyable"                             \
+        );                                                              \
+    static_assert(                                                      \
+        std::is_standard_layout<type>::value,                           \
+        #type " must have standard layout"                              \
+        )
+
+HODEA_ASSERT_ENDIAN_TYPE_LAYOUT(le_uint16_t, 2);
+HODEA_ASSERT_ENDIAN_TYPE_LAYOUT(le_uint32_t, 4);
+HODEA_ASSERT_ENDIAN_TYPE_LAYOUT(le_uint64_t, 8);
+HODEA_ASSERT_ENDIAN_TYPE_LAYOUT(be_uint16_t, 2);
+HODEA_ASSERT_ENDIAN_TYPE_LAYOUT(be_uint32_t, 4);
+HODEA_ASSERT_ENDIAN_TYPE_LAYOUT(be_uint64_t, 8);
+
+#undef HODEA_ASSERT_ENDIAN_TYPE_LAYOUT
+
+} // namespace hodea
+
+#endif /*!HODEA_ENDIAN_TYPES_HPP */
@@ -0,0 +1,181 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Conversion between Q-format fixed-point and scaled integer numbers.
+ *
+ * Controllers on MCUs without FPU, e.g. Cortex-M0, use fixed-point
+ * numbers in Q-format. A Qn number \a q represents the value
+ * q / 2^n, e.g. Q15 covers [-1, 1) with a resolution of 2^-15.
+ *
+ * Messages on the other hand often carry scaled integers, e.g. a
+ * current in mA or a gain in 1/1000. The functions in this file convert
+ * directly between both representations with integer arithmetic only,
+ * so no soft-float library is pulled in.
+ *
+ * The Q-format values are passed as plain int16_t and int32_t. We don't
+ * define dedicated types to avoid clashes with q15_t and q31_t of the
+ * CMSIS DSP library.
+ *
+ * Example:
+ *
+ * \code
+ * // controller gain in Q15, transmitted in 1/1000
+ * int16_t kp_q15;
+ * :
+ * p += store16_le(p, q15_to_scaled(kp_q15, 1000));
+ * :
+ * int16_t kp_milli;
+ * p += fetch16_le(kp_milli, p);
+ * kp_q15 = scaled_to_q15(kp_milli, 1000);
+ * \endcode
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_FIXED_POINT_HPP
+#define HODEA_FIXED_POINT_HPP
+
+#include <hodea/core/cstdint.hpp>
+
+namespace hodea {
+
+/**
+ * Convert a Qn number into a scaled integer.
+ *
+ * \tparam frac_bits
+ *      The number of fractional bits \a n.
+ * \param[in] q
+ *      The Qn number.
+ * \param[in] scale
+ *      The integer representing the value 1.0, e.g. 1000 for a
+ *      resolution of 1/1000.
+ *
+ * \returns
+ *      q * scale / 2^n, rounded to nearest.
+ */
+template <int frac_bits>
+constexpr int64_t q_to_scaled(int64_t q, int32_t scale)
+{
+    return (q * scale + (1LL << (frac_bits - 1))) >> frac_bits;
+}
+
+/**
+ * Convert a scaled integer into a Qn number.
+ *
+ * \tparam frac_bits
+ *      The number of fractional bits \a n.
+ * \param[in] val
+ *      The scaled integer.
+ * \param[in] scale
+ *      The integer representing the value 1.0.
+ *
+ * \returns
+ *      val * 2^n / scale, rounded to nearest, not saturated.
+ *
+ * \note
+ * This requires a 64 bit division, which is a library call (e.g.
+ * __aeabi_ldivmod) on 32 bit MCUs, even if \a scale is a compile-time
+ * constant. scaled_to_q15() and scaled_to_q31() avoid it.
+ */
+template <int frac_bits>
+constexpr int64_t scaled_to_q(int64_t val, int32_t scale)
+{
+    return
+        ((val * (1LL << frac_bits)) +
+         (((val < 0) == (scale < 0)) ? scale / 2 : -(scale / 2))) /
+        scale;
+}
+
+/**
+ * Saturate a 64 bit number to the range of a signed type with \a bits.
+ */
+template <int bits>
+constexpr int64_t q_saturate(int64_t x)
+{
+    return
+        (x > ((1LL << (bits - 1)) - 1)) ? ((1LL << (bits - 1)) - 1) :
+        (x < -(1LL << (bits - 1))) ? -(1LL << (bits - 1)) :
+        x;
+}
+
+/**
+ * Convert a scaled integer into a Qn number, saturated to [-1, 1).
+ *
+ * If |val| >= |scale| the result saturates. Otherwise the quotient is
+ * less than 2^n and calculated by long division with 32 bit arithmetic
+ * only, one bit per iteration.
+ *
+ * \tparam frac_bits
+ *      The number of fractional bits \a n, 1 to 31.
+ */
+template <int frac_bits>
+constexpr int32_t scaled_to_q_saturated(int32_t val, int32_t scale)
+{
+    static_assert(
+        (frac_bits >= 1) && (frac_bits <= 31), "frac_bits out of range"
+        );
+
+    bool is_negative = (val < 0) != (scale < 0);
+    uint32_t v = (val < 0) ? 0U - static_cast<uint32_t>(val) : val;
+    uint32_t s = (scale < 0) ? 0U - static_cast<uint32_t>(scale) : scale;
+    uint32_t q = 0;
+    constexpr uint32_t q_max = (1UL << frac_bits) - 1;
+
+    if (v >= s)
+        return is_negative ? -static_cast<int32_t>(q_max) - 1 : q_max;
+
+    // v < s <= 2^31, so v does not overflow when shifted; the extra
+    // quotient bit is used for rounding
+    for (int i = 0; i <= frac_bits; ++i) {
+        v <<= 1;
+        q <<= 1;
+        if (v >= s) {
+            v -= s;
+            q |= 1;
+        }
+    }
+    q = (q >> 1) + (q & 1);
+
+    if (is_negative)
+        return (q > q_max) ? -static_cast<int32_t>(q_max) - 1 :
+            -static_cast<int32_t>(q);
+    return (q > q_max) ? q_max : q;
+}
+
+/**
+ * Convert a Q15 number into a scaled integer.
+ */
+constexpr int32_t q15_to_scaled(int16_t q, int32_t scale)
+{
+    return static_cast<int32_t>(q_to_scaled<15>(q, scale));
+}
+
+/**
+ * Convert a Q31 number into a scaled integer.
+ *
+ * The result is saturated to the int32_t range.
+ */
+constexpr int32_t q31_to_scaled(int32_t q, int32_t scale)
+{
+    return static_cast<int32_t>(q_saturate<32>(q_to_scaled<31>(q, scale)));
+}
+
+/**
+ * Convert a scaled integer into a Q15 number, saturated to [-1, 1).
+ */
+constexpr int16_t scaled_to_q15(int32_t val, int32_t scale)
+{
+    return static_cast<int16_t>(scaled_to_q_saturated<15>(val, scale));
+}
+
+/**
+ * Convert a scaled integer into a Q31 number, saturated to [-1, 1).
+ */
+constexpr int32_t scaled_to_q31(int32_t val, int32_t scale)
+{
+    return scaled_to_q_saturated<31>(val, scale);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_FIXED_POINT_HPP */
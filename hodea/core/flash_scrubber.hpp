@@ -0,0 +1,261 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Check the integrity of the program memory in the background.
+ *
+ * The scrubber calculates the CRC over a memory region incrementally
+ * and compares it with the expected value at the end of each pass.
+ * Each call of tick() submits at most \a bytes_per_tick bytes in chunks
+ * of \a chunk_size bytes and returns when the time budget is used up.
+ * The DMA transfer of the last chunk submitted continues after tick()
+ * returned, so with a budget of 0 the scrubber only submits a single
+ * chunk and never waits.
+ *
+ * The CRC is calculated by a job class with the interface of
+ * Crc_unit_job, i.e. the CRC unit in word mode. The expected value can
+ * therefore be calculated with Crc32_stm32 from crc.hpp when the image
+ * is built, or with bls_progmem_crc() at startup.
+ *
+ * Example:
+ *
+ * \code
+ * extern "C" const uint32_t __app_start[];
+ * extern "C" const uint32_t __app_size[];
+ * extern "C" const uint32_t __app_crc[];
+ *
+ * Crc_unit_job scrub_job;
+ * Flash_scrubber<Htsc, Crc_unit_job> scrubber{
+ *      scrub_job, __app_start, reinterpret_cast<int>(__app_size),
+ *      *__app_crc, 1024, 256, Htsc::us_to_ticks(20.0)
+ *      };
+ *
+ * void scheduler_tick()
+ * {
+ *     scrubber.tick();
+ *     if (scrubber.is_corrupted())
+ *         enter_safe_state();
+ * }
+ * \endcode
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_FLASH_SCRUBBER_HPP
+#define HODEA_FLASH_SCRUBBER_HPP
+
+#include <hodea/core/cstdint.hpp>
+
+namespace hodea {
+
+/**
+ * Class to check a memory region with a hardware CRC job.
+ *
+ * \tparam T_tsc
+ *      Timestamp counter class, e.g. Htsc.
+ * \tparam T_crc_job
+ *      CRC job class, e.g. Crc_unit_job.
+ */
+template <class T_tsc, class T_crc_job>
+class Flash_scrubber {
+public:
+    typedef typename T_tsc::Ticks Ticks;
+    typedef typename T_crc_job::State State;
+
+    /**
+     * Results of the passes over the region.
+     */
+    struct Statistics {
+        uint32_t num_passes;    // passes completed
+        uint32_t num_errors;    // passes with a CRC mismatch
+        uint32_t num_aborted;   // passes aborted, job failed or rejected
+        uint32_t last_crc;      // CRC of the last pass completed
+    };
+
+    /**
+     * Constructor.
+     *
+     * The parameters are checked here, as the CRC job would reject
+     * misaligned chunks. With an invalid configuration no pass is
+     * ever completed, and is_corrupted() returns true so the region
+     * is not silently left unchecked.
+     *
+     * \param[in] job
+     *      CRC job used exclusively by the scrubber.
+     * \param[in] start
+     *      Start of the region, must be word-aligned.
+     * \param[in] len
+     *      Size of the region in bytes, must be a multiple of 4.
+     * \param[in] expected_crc
+     *      The CRC expected over the region.
+     * \param[in] bytes_per_tick
+     *      The maximum number of bytes submitted by tick(), a multiple
+     *      of 4.
+     * \param[in] chunk_size
+     *      The size of a single chunk in bytes, a multiple of 4.
+     * \param[in] budget
+     *      Time budget for tick() in ticks of \a T_tsc.
+     */
+    Flash_scrubber(
+        T_crc_job& job, const uint32_t* start, int len,
+        uint32_t expected_crc, int bytes_per_tick, int chunk_size,
+        Ticks budget
+        )
+        : job(job), start{reinterpret_cast<const uint8_t*>(start)},
+          len{len}, expected_crc{expected_crc},
+          bytes_per_tick{bytes_per_tick}, chunk_size{chunk_size},
+          budget{budget},
+          is_config_valid{
+              is_valid_config(start, len, bytes_per_tick, chunk_size)
+              }
+    {}
+
+    Flash_scrubber(const Flash_scrubber&) = delete;
+    Flash_scrubber& operator=(const Flash_scrubber&) = delete;
+
+    /**
+     * Continue checking the region.
+     *
+     * Call this method periodically, e.g. from the scheduler.
+     *
+     * \returns
+     *      True if a pass over the region has been completed by this
+     *      call, false otherwise.
+     */
+    bool tick()
+    {
+        Ticks ts_start = T_tsc::now();
+        int quota = bytes_per_tick;
+        bool is_pass_complete = false;
+
+        if (!is_config_valid)
+            return false;
+
+        for (;;) {
+            if (in_flight) {
+                State st = job.poll();
+
+                if ((st == State::queued) || (st == State::busy)) {
+                    if ((quota == 0) || T_tsc::is_elapsed(ts_start, budget))
+                        return is_pass_complete;
+                    continue;
+                }
+
+                if (st == State::done) {
+                    offset += in_flight;
+                    if (offset >= len) {
+                        end_pass(job.value());
+                        is_pass_complete = true;
+                    }
+                }
+                else {
+                    // transfer error or job cancelled, restart the pass
+                    ++stats.num_aborted;
+                    offset = 0;
+                }
+                in_flight = 0;
+            }
+
+            // the first chunk is submitted regardless of the budget
+            if ((quota == 0) ||
+                ((quota < bytes_per_tick) &&
+                 T_tsc::is_elapsed(ts_start, budget)))
+                return is_pass_complete;
+
+            int n = len - offset;
+
+            if (n > chunk_size)
+                n = chunk_size;
+            if (n > quota)
+                n = quota;
+
+            bool is_accepted = offset ?
+                job.append(start + offset, n) :
+                job.start(start, n);
+
+            if (!is_accepted) {
+                // chunk rejected, e.g. job in use elsewhere; restart the pass
+                ++stats.num_aborted;
+                offset = 0;
+                return is_pass_complete;
+            }
+            in_flight = n;
+            quota -= n;
+        }
+    }
+
+    /**
+     * Test if a pass detected a CRC mismatch.
+     *
+     * The flag is sticky and reset by clear_errors() only. It is also
+     * set if the configuration is invalid.
+     */
+    bool is_corrupted() const
+    {
+        return (stats.num_errors != 0) || !is_config_valid;
+    }
+
+    /**
+     * Test if the parameters passed to the constructor are valid.
+     */
+    bool ok() const
+    {
+        return is_config_valid;
+    }
+
+    void clear_errors()
+    {
+        stats.num_errors = 0;
+    }
+
+    /**
+     * Get the results of the passes completed so far.
+     */
+    const Statistics& statistics() const
+    {
+        return stats;
+    }
+
+    /**
+     * Number of bytes of the current pass checked so far.
+     */
+    int progress() const
+    {
+        return offset;
+    }
+
+private:
+    static bool is_valid_config(
+        const uint32_t* start, int len, int bytes_per_tick, int chunk_size
+        )
+    {
+        return ((reinterpret_cast<uintptr_t>(start) & 3) == 0) &&
+            (len > 0) && ((len & 3) == 0) &&
+            (bytes_per_tick > 0) && ((bytes_per_tick & 3) == 0) &&
+            (chunk_size > 0) && ((chunk_size & 3) == 0);
+    }
+
+    void end_pass(uint32_t crc)
+    {
+        ++stats.num_passes;
+        if (crc != expected_crc)
+            ++stats.num_errors;
+        stats.last_crc = crc;
+        offset = 0;
+    }
+
+    T_crc_job& job;
+    const uint8_t* const start;
+    const int len;
+    const uint32_t expected_crc;
+    const int bytes_per_tick;
+    const int chunk_size;
+    const Ticks budget;
+    const bool is_config_valid;
+    int offset = 0;             // bytes checked in the current pass
+    int in_flight = 0;          // size of the chunk submitted
+    Statistics stats = Statistics{};
+};
+
+} // namespace hodea
+
+#endif /*!HODEA_FLASH_SCRUBBER_HPP */
@@ -0,0 +1,410 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Format integers as decimal or hexadecimal text without printf().
+ *
+ * printf() and its relatives pull several KB of code into the image and
+ * take thousands of cycles per call. The functions in this file convert
+ * a single number into text in a caller provided buffer.
+ *
+ * - The decimal conversion emits two digits at a time from a table of
+ *   digit pairs.
+ * - Divisions by constants are replaced by multiplications with the
+ *   reciprocal. The Cortex-M0 has no hardware divider and no 32x32->64
+ *   bit multiply instruction, and the compiler would call the run time
+ *   division routine for divisions by constants. The reciprocal
+ *   multiplication is used on all targets; it is what the compiler does
+ *   on targets with a long multiply instruction anyway.
+ * - The buffer sizes required are available at compile time as
+ *   constants, e.g. format_u32_size.
+ *
+ * The output is not terminated with a null character. The functions
+ * follow the convention of serialization.hpp: The destination is given
+ * first, and the number of characters written is returned.
+ *
+ * Example:
+ *
+ * \code
+ * char buf[format_i32_size + 1 + format_hex32_size];
+ * char* p = buf;
+ *
+ * p += format_i32(p, temperature);
+ * *p++ = ' ';
+ * p += format_hex(p, status, 8);
+ * uart_write(buf, p - buf);
+ * \endcode
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_FORMAT_HPP
+#define HODEA_FORMAT_HPP
+
+#include <cstring>
+#include <type_traits>
+#include <hodea/core/cstdint.hpp>
+
+namespace hodea {
+
+/**
+ * Maximum number of characters written by the format functions.
+ */
+constexpr int format_u32_size = 10;
+constexpr int format_i32_size = 11;
+constexpr int format_u64_size = 20;
+constexpr int format_i64_size = 20;
+constexpr int format_hex32_size = 8;
+constexpr int format_hex64_size = 16;
+
+/**
+ * Maximum number of characters written by format_fixed().
+ */
+constexpr int format_fixed_size(int decimals)
+{
+    return format_i32_size + 1 + decimals;
+}
+
+/**
+ * Table of the decimal digit pairs "00" to "99".
+ */
+static constexpr char format_digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/**
+ * Divide by 100 for \a x < 43699.
+ */
+static inline constexpr uint32_t format_div100(uint32_t x)
+{
+    return (x * 5243U) >> 19;
+}
+
+/**
+ * Get the upper 32 bits of the 64 bit product \a a * \a b.
+ *
+ * On Cortex-M0 the 32x32->64 bit multiply would call the run time
+ * library. The upper half of the product is therefore assembled from
+ * four 16x16->32 bit products. The lower half is simply \a a * \a b.
+ */
+static inline constexpr uint32_t format_mul_hi(uint32_t a, uint32_t b)
+{
+#if defined __ARM_ARCH_6M__
+    uint32_t a_hi = a >> 16;
+    uint32_t a_lo = a & 0xffff;
+    uint32_t b_hi = b >> 16;
+    uint32_t b_lo = b & 0xffff;
+    uint32_t mid1 = a_hi * b_lo;
+    uint32_t mid2 = a_lo * b_hi;
+    uint32_t carry =
+        (((a_lo * b_lo) >> 16) + (mid1 & 0xffff) + (mid2 & 0xffff)) >> 16;
+
+    return a_hi * b_hi + (mid1 >> 16) + (mid2 >> 16) + carry;
+#else
+    return static_cast<uint32_t>((static_cast<uint64_t>(a) * b) >> 32);
+#endif
+}
+
+/**
+ * Divide by 10000.
+ */
+static inline constexpr uint32_t format_div10000(uint32_t x)
+{
+    return format_mul_hi(x, 0xd1b71759U) >> 13;
+}
+
+/**
+ * Get 10 to the power of \a n, for \a n < 10.
+ */
+static inline constexpr uint32_t format_pow10(int n)
+{
+    return (n == 0) ? 1 : 10 * format_pow10(n - 1);
+}
+
+/**
+ * Write \a x < 10000 as exactly 4 digits.
+ */
+static inline void format_4digits(char* buf, uint32_t x)
+{
+    uint32_t hi = format_div100(x);
+    uint32_t lo = x - 100 * hi;
+
+    std::memcpy(buf, &format_digit_pairs[2 * hi], 2);
+    std::memcpy(buf + 2, &format_digit_pairs[2 * lo], 2);
+}
+
+/**
+ * Write \a x < 10000 without leading zeros.
+ *
+ * \returns
+ *      The number of digits written.
+ */
+static inline int format_upto4digits(char* buf, uint32_t x)
+{
+    uint32_t hi = format_div100(x);
+    uint32_t lo = x - 100 * hi;
+
+    if (x < 10) {
+        buf[0] = '0' + x;
+        return 1;
+    }
+    if (x < 100) {
+        std::memcpy(buf, &format_digit_pairs[2 * x], 2);
+        return 2;
+    }
+    if (x < 1000) {
+        buf[0] = '0' + hi;
+        std::memcpy(buf + 1, &format_digit_pairs[2 * lo], 2);
+        return 3;
+    }
+    std::memcpy(buf, &format_digit_pairs[2 * hi], 2);
+    std::memcpy(buf + 2, &format_digit_pairs[2 * lo], 2);
+    return 4;
+}
+
+/**
+ * Format an unsigned 32 bit integer as decimal number.
+ *
+ * \param[out] buf
+ *      Target buffer with space for format_u32_size characters.
+ * \param[in] val
+ *      The value to format.
+ *
+ * \returns
+ *      The number of characters written into \a buf.
+ */
+static inline int format_u32(char* buf, uint32_t val)
+{
+    if (val < 10000)
+        return format_upto4digits(buf, val);
+
+    uint32_t hi = format_div10000(val);
+    uint32_t lo = val - 10000 * hi;
+    int n;
+
+    if (hi < 10000) {
+        n = format_upto4digits(buf, hi);
+    }
+    else {
+        uint32_t top = format_div10000(hi);
+
+        hi -= 10000 * top;
+        n = format_upto4digits(buf, top);
+        format_4digits(buf + n, hi);
+        n += 4;
+    }
+    format_4digits(buf + n, lo);
+    return n + 4;
+}
+
+/**
+ * Format a signed 32 bit integer as decimal number.
+ *
+ * \param[out] buf
+ *      Target buffer with space for format_i32_size characters.
+ */
+static inline int format_i32(char* buf, int32_t val)
+{
+    if (val >= 0)
+        return format_u32(buf, val);
+    buf[0] = '-';
+    return 1 + format_u32(buf + 1, 0U - static_cast<uint32_t>(val));
+}
+
+/**
+ * Divide \a v by 10000 and get the remainder.
+ *
+ * On Cortex-M0 a 64 bit division would call the run time library. The
+ * division is therefore done in steps of 16 bits, each being a 32 bit
+ * division by a constant, i.e. a reciprocal multiplication.
+ */
+static inline uint32_t format_divmod10000(uint64_t& v)
+{
+#if defined __ARM_ARCH_6M__
+    // shifts by a variable amount would call the run time library too
+    uint32_t hi = static_cast<uint32_t>(v >> 32);
+    uint32_t lo = static_cast<uint32_t>(v);
+    uint32_t x = hi >> 16;
+    uint32_t d3 = format_div10000(x);
+    uint32_t r = x - 10000 * d3;
+
+    x = (r << 16) | (hi & 0xffff);
+    uint32_t d2 = format_div10000(x);
+    r = x - 10000 * d2;
+
+    x = (r << 16) | (lo >> 16);
+    uint32_t d1 = format_div10000(x);
+    r = x - 10000 * d1;
+
+    x = (r << 16) | (lo & 0xffff);
+    uint32_t d0 = format_div10000(x);
+    r = x - 10000 * d0;
+
+    // each partial quotient is below 2^16
+    v = (static_cast<uint64_t>((d3 << 16) | d2) << 32) | ((d1 << 16) | d0);
+    return r;
+#else
+    uint64_t q = v / 10000;
+    uint32_t r = static_cast<uint32_t>(v - 10000 * q);
+
+    v = q;
+    return r;
+#endif
+}
+
+/**
+ * Format an unsigned 64 bit integer as decimal number.
+ *
+ * \param[out] buf
+ *      Target buffer with space for format_u64_size characters.
+ */
+static inline int format_u64(char* buf, uint64_t val)
+{
+    char tmp[format_u64_size];
+    char* p = tmp + sizeof(tmp);
+
+    while (val > 0xffffffffU) {
+        p -= 4;
+        format_4digits(p, format_divmod10000(val));
+    }
+
+    int n = format_u32(buf, static_cast<uint32_t>(val));
+    int num_low = tmp + sizeof(tmp) - p;
+
+    std::memcpy(buf + n, p, num_low);
+    return n + num_low;
+}
+
+/**
+ * Format a signed 64 bit integer as decimal number.
+ *
+ * \param[out] buf
+ *      Target buffer with space for format_i64_size characters.
+ */
+static inline int format_i64(char* buf, int64_t val)
+{
+    if (val >= 0)
+        return format_u64(buf, val);
+    buf[0] = '-';
+    return 1 + format_u64(buf + 1, 0U - static_cast<uint64_t>(val));
+}
+
+/**
+ * Format an unsigned integer as hexadecimal number.
+ *
+ * Lower case digits are used, without prefix.
+ *
+ * \param[out] buf
+ *      Target buffer with space for format_hex32_size respectively
+ *      format_hex64_size characters.
+ * \param[in] val
+ *      The value to format.
+ * \param[in] min_digits
+ *      Minimum number of digits, padded with leading zeros.
+ *
+ * \returns
+ *      The number of characters written into \a buf.
+ */
+template <
+    typename T,
+    typename = typename std::enable_if<std::is_unsigned<T>::value>::type
+    >
+int format_hex(char* buf, T val, int min_digits = 1)
+{
+    static const char digits[] = "0123456789abcdef";
+    int n = 1;
+
+    while ((n < 2 * static_cast<int>(sizeof(T))) && (val >> (4 * n)))
+        ++n;
+    if (n < min_digits)
+        n = min_digits;
+
+    for (int i = n - 1; i >= 0; --i) {
+        buf[i] = digits[val & 0xf];
+        val >>= 4;
+    }
+    return n;
+}
+
+/**
+ * Format a fixed-point number as decimal fraction.
+ *
+ * The result is rounded to nearest, e.g. the Q15 value 0x4000 is
+ * formatted as "0.500" by format_fixed<15, 3>().
+ *
+ * \tparam frac_bits
+ *      Number of fractional bits, e.g. 15 for Q15.
+ * \tparam decimals
+ *      Number of decimal places, 1 to 9.
+ *
+ * \param[out] buf
+ *      Target buffer with space for format_fixed_size(decimals)
+ *      characters.
+ * \param[in] val
+ *      The fixed-point value.
+ *
+ * \returns
+ *      The number of characters written into \a buf.
+ */
+template <int frac_bits, int decimals>
+int format_fixed(char* buf, int32_t val)
+{
+    static_assert(
+        (frac_bits > 0) && (frac_bits < 32), "frac_bits out of range"
+        );
+    static_assert((decimals > 0) && (decimals < 10), "decimals out of range");
+
+    constexpr uint32_t scale = format_pow10(decimals);
+    constexpr uint32_t frac_msk = (1ULL << frac_bits) - 1;
+    constexpr uint32_t half = 1U << (frac_bits - 1);
+
+    // e.g. Q15 with up to 5 decimals
+    constexpr bool is_product_32bit =
+        static_cast<uint64_t>(frac_msk) * scale + half <= 0xffffffffU;
+
+    uint32_t mag = (val < 0) ? 0U - static_cast<uint32_t>(val) : val;
+    uint32_t int_part = mag >> frac_bits;
+    uint32_t frac = mag & frac_msk;
+    uint32_t dec;
+    int n = 0;
+
+    if (is_product_32bit) {
+        dec = (frac * scale + half) >> frac_bits;
+    }
+    else {
+        uint32_t lo = frac * scale;
+        uint32_t hi = format_mul_hi(frac, scale);
+
+        lo += half;
+        hi += (lo < half);
+        dec = (hi << (32 - frac_bits)) | (lo >> frac_bits);
+    }
+
+    if (dec >= scale) {
+        dec -= scale;
+        ++int_part;
+    }
+
+    if (val < 0)
+        buf[n++] = '-';
+    n += format_u32(buf + n, int_part);
+    buf[n++] = '.';
+
+    char tmp[format_u32_size];
+    int len = format_u32(tmp, dec);
+
+    std::memset(buf + n, '0', decimals - len);
+    std::memcpy(buf + n + decimals - len, tmp, len);
+    return n + decimals;
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_FORMAT_HPP */
@@ -0,0 +1,133 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Frames built at compile time and placed in flash.
+ *
+ * Many outgoing frames are mostly constant, e.g. headers, IDs or fixed
+ * configuration responses. As the store functions in serialization.hpp
+ * are constexpr, such a frame can be built by a constexpr function into
+ * a Byte_array. If the result is assigned to a constexpr object, the
+ * frame is computed by the compiler and placed in .rodata, i.e. in
+ * flash. No RAM and no CPU time is spent for it at run time.
+ *
+ * Frames with a few variable fields are sent either by copying the
+ * template into RAM and filling in the variable fields with patch(), or
+ * by sending the constant part directly from flash, followed by a small
+ * RAM buffer holding the variable fields.
+ *
+ * Example:
+ *
+ * \code
+ * constexpr Byte_array<8> make_status_req()
+ * {
+ *     Byte_array<8> frame{};
+ *     uint8_t* p = frame.data();
+ *
+ *     p += store8(p, 0x7e);            // start of frame
+ *     p += store16_be(p, 0x0321);      // node ID
+ *     p += store8(p, 0x01);            // command
+ *     p += store16_le(p, 0);           // sequence number, patched
+ *     p += store16_le(p, 0);           // argument, patched
+ *     return frame;
+ * }
+ *
+ * constexpr Byte_array<8> status_req = make_status_req();
+ *
+ * void send_status_req(uint16_t seq, uint16_t arg)
+ * {
+ *     Byte_array<8> tx = status_req;
+ *
+ *     patch<4, Wire_le16>(tx, seq);
+ *     patch<6, Wire_le16>(tx, arg);
+ *     uart_send(tx.data(), tx.size());
+ * }
+ * \endcode
+ *
+ * \note
+ * std::array is not usable here, as its non-const operator[] and
+ * data() are not constexpr before C++17.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_FRAME_TEMPLATE_HPP
+#define HODEA_FRAME_TEMPLATE_HPP
+
+#include <cstddef>
+#include <type_traits>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/span.hpp>
+#include <hodea/core/wire_format.hpp>
+
+namespace hodea {
+
+/**
+ * Fixed size byte array which can be modified in constexpr functions.
+ *
+ * \tparam N The number of bytes.
+ */
+template <std::size_t N>
+struct Byte_array {
+    uint8_t bytes[N];
+
+    constexpr uint8_t* data() { return bytes; }
+
+    constexpr const uint8_t* data() const { return bytes; }
+
+    static constexpr int size() { return N; }
+
+    constexpr uint8_t& operator[](int idx) { return bytes[idx]; }
+
+    constexpr const uint8_t& operator[](int idx) const
+    {
+        return bytes[idx];
+    }
+
+    constexpr Byte_span span() { return Byte_span{bytes}; }
+
+    constexpr Const_byte_span span() const
+    {
+        return Const_byte_span{bytes};
+    }
+};
+
+/**
+ * Store a variable field into a frame at a given offset.
+ *
+ * Offset and wire format are template parameters, so it is checked at
+ * compile time that the field fits into the frame.
+ *
+ * \tparam offs
+ *      The offset of the field within the frame.
+ * \tparam T_format
+ *      The wire format of the field, e.g. Wire_le16.
+ *
+ * \param[in,out] frame
+ *      The frame to patch.
+ * \param[in] val
+ *      The value to store.
+ *
+ * \returns
+ *      The offset following the field.
+ */
+template <
+    int offs,
+    typename T_format,
+    std::size_t N,
+    typename T,
+    typename = typename std::enable_if<
+        std::is_integral<T>::value || std::is_enum<T>::value>::type
+    >
+int patch(Byte_array<N>& frame, const T val)
+{
+    static_assert(
+        (offs >= 0) && (offs + T_format::size <= static_cast<int>(N)),
+        "field exceeds frame"
+        );
+
+    return offs + T_format::store(frame.data() + offs, val);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_FRAME_TEMPLATE_HPP */
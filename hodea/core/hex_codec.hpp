@@ -0,0 +1,477 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Hexadecimal encoding and decoding of byte buffers.
+ *
+ * Each byte is encoded as two hexadecimal digits, the upper nibble
+ * first. The encoder emits lower case digits, the decoder accepts both
+ * upper and lower case.
+ *
+ * This file provides:
+ *
+ * - hex_encode(), which encodes a buffer. As every byte is encoded on
+ *   its own, a stream is encoded chunk by chunk with the same function.
+ * - Hex_decoder, which decodes a stream passed in chunks of arbitrary
+ *   size, including chunks ending in the middle of a byte.
+ * - hex_decode(), which decodes a complete buffer.
+ *
+ * The functions follow the convention of serialization.hpp: The
+ * destination is given first, and the number of bytes respectively
+ * characters written is returned. The output is not terminated with a
+ * null character.
+ *
+ * The implementation selects the fastest path available:
+ *
+ * - Host builds with SSSE3 or AVX2 enabled (e.g. -mssse3, -mavx2,
+ *   -march=native) encode 16 respectively 32 bytes per iteration,
+ *   looking up the digits with a byte shuffle (pshufb). The decoder
+ *   validates and converts 32 respectively 64 digits per iteration.
+ * - Otherwise a byte is processed per iteration. Digits are decoded with
+ *   comparisons, so no 256 byte table is required on small targets
+ *   like the Cortex-M0.
+ *
+ * The scalar versions are also provided for benchmarking.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_HEX_CODEC_HPP
+#define HODEA_HEX_CODEC_HPP
+
+#include <hodea/core/cstdint.hpp>
+
+#if defined __AVX2__
+#include <immintrin.h>
+#elif defined __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+namespace hodea {
+
+/**
+ * Get the value of a hexadecimal digit.
+ *
+ * \returns
+ *      The value 0 to 15, or -1 if \a c is not a hexadecimal digit.
+ */
+static inline int hex_decode_char(uint8_t c)
+{
+    uint8_t v = c - '0';
+
+    if (v < 10)
+        return v;
+    v = (c | 0x20) - 'a';
+    if (v < 6)
+        return v + 10;
+    return -1;
+}
+
+/**
+ * Encode a buffer byte by byte.
+ *
+ * \returns
+ *      The number of characters written into \a dst.
+ */
+static inline int hex_encode_scalar(char* dst, const uint8_t* src, int len)
+{
+    static const char digits[] = "0123456789abcdef";
+
+    for (int i = 0; i < len; ++i) {
+        dst[2 * i] = digits[src[i] >> 4];
+        dst[2 * i + 1] = digits[src[i] & 0xf];
+    }
+    return 2 * len;
+}
+
+/**
+ * Decode pairs of digits byte by byte.
+ *
+ * Decoding stops at the first pair containing an invalid digit.
+ *
+ * \returns
+ *      The number of characters decoded, a multiple of 2.
+ */
+static inline int hex_decode_scalar(uint8_t* dst, const char* src, int len)
+{
+    int done = 0;
+
+    for (; len - done >= 2; done += 2) {
+        int hi = hex_decode_char(src[done]);
+        int lo = hex_decode_char(src[done + 1]);
+
+        if ((hi | lo) < 0)
+            break;
+        *dst++ = (hi << 4) | lo;
+    }
+    return done;
+}
+
+#if defined __SSSE3__
+
+/**
+ * Convert 16 hexadecimal digits into their values.
+ *
+ * \returns
+ *      False if a character is not a hexadecimal digit.
+ */
+static inline bool hex_decode_nibbles_sse(__m128i& out, __m128i in)
+{
+    __m128i d = _mm_sub_epi8(in, _mm_set1_epi8('0'));
+    __m128i l = _mm_sub_epi8(
+        _mm_or_si128(in, _mm_set1_epi8(0x20)), _mm_set1_epi8('a')
+        );
+    // unsigned compare x <= max as min(x, max) == x
+    __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+    __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(l, _mm_set1_epi8(5)), l);
+
+    if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) != 0xffff)
+        return false;
+
+    out = _mm_or_si128(
+        _mm_and_si128(is_digit, d),
+        _mm_and_si128(is_letter, _mm_add_epi8(l, _mm_set1_epi8(10)))
+        );
+    return true;
+}
+
+#endif
+
+#if defined __AVX2__
+
+/**
+ * AVX2 version of hex_decode_nibbles_sse(), converting 32 digits.
+ */
+static inline bool hex_decode_nibbles_avx2(__m256i& out, __m256i in)
+{
+    __m256i d = _mm256_sub_epi8(in, _mm256_set1_epi8('0'));
+    __m256i l = _mm256_sub_epi8(
+        _mm256_or_si256(in, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a')
+        );
+    __m256i is_digit = _mm256_cmpeq_epi8(
+        _mm256_min_epu8(d, _mm256_set1_epi8(9)), d
+        );
+    __m256i is_letter = _mm256_cmpeq_epi8(
+        _mm256_min_epu8(l, _mm256_set1_epi8(5)), l
+        );
+
+    if (~_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_letter)))
+        return false;
+
+    out = _mm256_or_si256(
+        _mm256_and_si256(is_digit, d),
+        _mm256_and_si256(is_letter, _mm256_add_epi8(l, _mm256_set1_epi8(10)))
+        );
+    return true;
+}
+
+#endif
+
+/**
+ * Encode as many bytes as possible using SIMD instructions.
+ *
+ * \returns
+ *      The number of bytes encoded, a multiple of 16. Zero if no SIMD
+ *      instructions are available.
+ */
+static inline int hex_encode_simd(char* dst, const uint8_t* src, int len)
+{
+    int done = 0;
+
+#if defined __SSSE3__
+    const __m128i digits = _mm_setr_epi8(
+        '0', '1', '2', '3', '4', '5', '6', '7',
+        '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'
+        );
+    const __m128i nibble_msk = _mm_set1_epi8(0x0f);
+
+#if defined __AVX2__
+    const __m256i digits2 = _mm256_broadcastsi128_si256(digits);
+    const __m256i nibble_msk2 = _mm256_set1_epi8(0x0f);
+
+    for (; len - done >= 32; done += 32) {
+        __m256i v = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(src + done)
+            );
+        __m256i hi = _mm256_shuffle_epi8(
+            digits2, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble_msk2)
+            );
+        __m256i lo = _mm256_shuffle_epi8(
+            digits2, _mm256_and_si256(v, nibble_msk2)
+            );
+        // interleaving works within 128 bit lanes, reorder the lanes
+        __m256i a = _mm256_unpacklo_epi8(hi, lo);
+        __m256i b = _mm256_unpackhi_epi8(hi, lo);
+
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(dst + 2 * done),
+            _mm256_permute2x128_si256(a, b, 0x20)
+            );
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(dst + 2 * done + 32),
+            _mm256_permute2x128_si256(a, b, 0x31)
+            );
+    }
+#endif
+
+    for (; len - done >= 16; done += 16) {
+        __m128i v = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(src + done)
+            );
+        __m128i hi = _mm_shuffle_epi8(
+            digits, _mm_and_si128(_mm_srli_epi16(v, 4), nibble_msk)
+            );
+        __m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(v, nibble_msk));
+
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(dst + 2 * done),
+            _mm_unpacklo_epi8(hi, lo)
+            );
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(dst + 2 * done + 16),
+            _mm_unpackhi_epi8(hi, lo)
+            );
+    }
+#else
+    (void) dst;
+    (void) src;
+    (void) len;
+#endif
+
+    return done;
+}
+
+/**
+ * Decode as many digits as possible using SIMD instructions.
+ *
+ * Decoding stops at the first block containing an invalid digit.
+ *
+ * \returns
+ *      The number of characters decoded, a multiple of 32. Zero if no
+ *      SIMD instructions are available.
+ */
+static inline int hex_decode_simd(uint8_t* dst, const char* src, int len)
+{
+    int done = 0;
+
+#if defined __SSSE3__
+    // multiply the upper nibble by 16 and add the lower one
+    const __m128i weights = _mm_set1_epi16(0x0110);
+
+#if defined __AVX2__
+    const __m256i weights2 = _mm256_set1_epi16(0x0110);
+
+    for (; len - done >= 64; done += 64) {
+        __m256i v0;
+        __m256i v1;
+
+        if (!hex_decode_nibbles_avx2(
+                v0,
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + done))
+                ) ||
+            !hex_decode_nibbles_avx2(
+                v1,
+                _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(src + done + 32)
+                    )
+                ))
+            return done;
+
+        // packing works within 128 bit lanes, reorder the 64 bit words
+        __m256i bytes = _mm256_packus_epi16(
+            _mm256_maddubs_epi16(v0, weights2),
+            _mm256_maddubs_epi16(v1, weights2)
+            );
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(dst + done / 2),
+            _mm256_permute4x64_epi64(bytes, 0xd8)
+            );
+    }
+#endif
+
+    for (; len - done >= 32; done += 32) {
+        __m128i v0;
+        __m128i v1;
+
+        if (!hex_decode_nibbles_sse(
+                v0,
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + done))
+                ) ||
+            !hex_decode_nibbles_sse(
+                v1,
+                _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(src + done + 16)
+                    )
+                ))
+            return done;
+
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(dst + done / 2),
+            _mm_packus_epi16(
+                _mm_maddubs_epi16(v0, weights),
+                _mm_maddubs_epi16(v1, weights)
+                )
+            );
+    }
+#else
+    (void) dst;
+    (void) src;
+    (void) len;
+#endif
+
+    return done;
+}
+
+/**
+ * Encode a buffer as hexadecimal digits.
+ *
+ * \param[out] dst
+ *      Target buffer with space for 2 * \a len characters.
+ * \param[in] src
+ *      The data to encode.
+ * \param[in] len
+ *      The size of the data.
+ *
+ * \returns
+ *      The number of characters written into \a dst.
+ */
+static inline int hex_encode(char* dst, const uint8_t* src, int len)
+{
+    int done = hex_encode_simd(dst, src, len);
+
+    hex_encode_scalar(dst + 2 * done, src + done, len - done);
+    return 2 * len;
+}
+
+/**
+ * Class to decode a stream of hexadecimal digits.
+ *
+ * The stream is passed in chunks of arbitrary size via put(). A digit
+ * not forming a complete byte is kept until the next call. A stream
+ * containing an invalid character is rejected up to reset().
+ */
+class Hex_decoder {
+public:
+    /**
+     * Get the maximum number of bytes written by put().
+     */
+    static constexpr int max_put_size(int len)
+    {
+        return (len + 1) / 2;
+    }
+
+    Hex_decoder() { reset(); }
+
+    /**
+     * Start a new stream, discarding a pending digit.
+     */
+    void reset()
+    {
+        pending = -1;
+        failed = false;
+    }
+
+    /**
+     * Decode a chunk of the stream.
+     *
+     * \param[out] dst
+     *      Target buffer with space for max_put_size(len) bytes.
+     * \param[in] src
+     *      The chunk to decode.
+     * \param[in] len
+     *      The size of the chunk.
+     *
+     * \returns
+     *      The number of bytes written into \a dst, or -1 if the stream
+     *      contains an invalid character.
+     */
+    int put(uint8_t* dst, const char* src, int len)
+    {
+        uint8_t* d = dst;
+        int done = 0;
+
+        if (failed)
+            return -1;
+
+        if ((pending >= 0) && (len > 0)) {
+            int lo = hex_decode_char(src[done++]);
+
+            if (lo < 0)
+                return fail();
+            *d++ = (pending << 4) | lo;
+            pending = -1;
+        }
+
+        int n = hex_decode_simd(d, src + done, len - done);
+
+        n += hex_decode_scalar(d + n / 2, src + done + n, len - done - n);
+        d += n / 2;
+        done += n;
+
+        if (done < len) {
+            // either an odd digit at the end or an invalid pair
+            int hi = hex_decode_char(src[done]);
+
+            if ((hi < 0) || (len - done > 1))
+                return fail();
+            pending = hi;
+        }
+        return d - dst;
+    }
+
+    /**
+     * Complete the stream.
+     *
+     * The decoder is reset for the next stream.
+     *
+     * \returns
+     *      False if the stream is malformed or ends with a single digit.
+     */
+    bool finish()
+    {
+        bool is_ok = !failed && (pending < 0);
+
+        reset();
+        return is_ok;
+    }
+
+    /**
+     * Test if the stream decoded so far is well-formed.
+     */
+    bool ok() const { return !failed; }
+
+private:
+    int fail()
+    {
+        failed = true;
+        return -1;
+    }
+
+    int pending;                // pending upper nibble, or -1
+    bool failed;
+};
+
+/**
+ * Decode a buffer of hexadecimal digits.
+ *
+ * \param[out] dst
+ *      Target buffer with space for \a len / 2 bytes.
+ * \param[in] src
+ *      The digits to decode.
+ * \param[in] len
+ *      The number of digits.
+ *
+ * \returns
+ *      The number of bytes written into \a dst, or -1 if the input
+ *      contains an invalid character or an odd number of digits.
+ */
+static inline int hex_decode(uint8_t* dst, const char* src, int len)
+{
+    Hex_decoder dec;
+    int n = dec.put(dst, src, len);
+
+    return dec.finish() ? n : -1;
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_HEX_CODEC_HPP */
@@ -0,0 +1,111 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Histogram with a fixed number of equally sized bins.
+ *
+ * The histogram is intended for measurements taken within interrupt
+ * service routines, e.g. jitter, latencies or program counter samples.
+ * Therefore, adding a value is cheap: The bin width is a power of two,
+ * so the bin index is calculated with a shift rather than a division.
+ * No memory is allocated, the bins are part of the object.
+ *
+ * Values beyond the last bin are accounted in the last bin. The counters
+ * saturate instead of wrapping around.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_HISTOGRAM_HPP
+#define HODEA_HISTOGRAM_HPP
+
+#include <limits>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/type_constraints.hpp>
+
+namespace hodea {
+
+/**
+ * Class representing a histogram.
+ *
+ * \tparam num_bins
+ *      The number of bins.
+ * \tparam bin_shift
+ *      Binary logarithm of the bin width. A value \a v goes into bin
+ *      \a v >> \a bin_shift.
+ * \tparam T_count
+ *      Unsigned type used for the counters.
+ */
+template <
+    int num_bins,
+    int bin_shift = 0,
+    typename T_count = uint32_t,
+    typename = typename enable_if_unsigned_type<T_count>::type
+    >
+class Histogram {
+public:
+    static_assert(num_bins > 0, "num_bins must be positive");
+
+    typedef T_count Count;
+
+    static constexpr int size = num_bins;
+    static constexpr int shift = bin_shift;
+
+    /**
+     * Account a value in the corresponding bin.
+     */
+    template <
+        typename T,
+        typename = typename enable_if_unsigned_type<T>::type
+        >
+    void add(T value)
+    {
+        // compared in the widest type, num_bins need not fit into T
+        uintmax_t v = value >> bin_shift;
+        int idx = (v >= static_cast<uintmax_t>(num_bins)) ?
+            num_bins - 1 : static_cast<int>(v);
+
+        if (bins[idx] != std::numeric_limits<T_count>::max())
+            ++bins[idx];
+    }
+
+    /**
+     * Reset all counters to zero.
+     */
+    void clear()
+    {
+        for (auto& b : bins)
+            b = 0;
+    }
+
+    /**
+     * Get the counter of the given bin.
+     */
+    T_count operator[](int idx) const { return bins[idx]; }
+
+    /**
+     * Get the sum of all counters.
+     */
+    uint64_t total() const
+    {
+        uint64_t sum = 0;
+
+        for (auto b : bins)
+            sum += b;
+        return sum;
+    }
+
+    /**
+     * Get the smallest value accounted in the given bin.
+     */
+    static constexpr uint32_t lower_bound(int idx)
+    {
+        return static_cast<uint32_t>(idx) << bin_shift;
+    }
+
+private:
+    T_count bins[num_bins] = {};
+};
+
+} // namespace hodea
+
+#endif /*!HODEA_HISTOGRAM_HPP */
@@ -0,0 +1,196 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Measure the interrupt latency imposed by foreground code.
+ *
+ * The meter pends a software triggered interrupt and captures the
+ * timestamp of the trigger. The interrupt service routine records its
+ * entry time. The difference is the interrupt latency, which is
+ * accounted in a histogram.
+ *
+ * The latency consists of the hardware exception entry time plus the
+ * time the interrupt is blocked by the code running in the foreground,
+ * e.g. a critical section or a long multi-cycle instruction sequence.
+ * By placing the trigger at the begin of the code under test, we
+ * measure the latency this code imposes. Comparing the distribution
+ * with the one of a plain trigger (baseline) allows to rank library
+ * primitives by the latency they add.
+ *
+ * The class is parametrized with a timestamp counter class (see Tsc)
+ * and an interrupt class. The interrupt class must provide a static
+ * method pend() which sets the interrupt pending. For Cortex-M devices
+ * see Nvic_sw_irq, for host builds Host_sw_irq.
+ *
+ * Example:
+ *
+ * \code
+ * using Latency_tsc = Tsc<Dwt_time_base>;
+ * using Probe_irq = Nvic_sw_irq<TIM17_IRQn>;
+ * Irq_latency_meter<Latency_tsc, Probe_irq> meter;
+ *
+ * void TIM17_IRQHandler()
+ * {
+ *     meter.isr_entry();
+ * }
+ *
+ * void measure()
+ * {
+ *     // baseline
+ *     meter.run([] { meter.trigger(); }, 1000);
+ *     auto baseline = meter.statistics();
+ *
+ *     // latency caused by a critical section
+ *     meter.reset();
+ *     meter.run([] {
+ *             Critical_section cs;
+ *             std::lock_guard<Critical_section> lock(cs);
+ *             meter.trigger();
+ *             code_under_test();
+ *         }, 1000);
+ *     auto cs_latency = meter.statistics();
+ * }
+ * \endcode
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_IRQ_LATENCY_METER_HPP
+#define HODEA_IRQ_LATENCY_METER_HPP
+
+#include <atomic>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/histogram.hpp>
+#include <hodea/core/seqlock.hpp>
+
+namespace hodea {
+
+/**
+ * Class to build an interrupt latency distribution.
+ *
+ * \tparam T_tsc
+ *      Timestamp counter class. Preferably a cycle counter.
+ * \tparam T_irq
+ *      Class providing a static method pend() to trigger the interrupt.
+ * \tparam num_bins
+ *      Number of histogram bins.
+ * \tparam bin_shift
+ *      Binary logarithm of the bin width in ticks.
+ */
+template <class T_tsc, class T_irq, int num_bins = 32, int bin_shift = 0>
+class Irq_latency_meter {
+public:
+    typedef typename T_tsc::Ticks Ticks;
+    typedef Histogram<num_bins, bin_shift> Latency_histogram;
+
+    /**
+     * Results published by the meter.
+     */
+    struct Statistics {
+        uint32_t num_samples;           // number of measured latencies
+        Ticks min_latency;              // shortest latency measured
+        Ticks max_latency;              // longest latency measured
+        uint64_t sum_latency;           // sum of all latencies
+        Latency_histogram histogram;    // latency distribution
+    };
+
+    /**
+     * Capture the trigger timestamp and pend the interrupt.
+     *
+     * A trigger issued while the previous measurement is still pending
+     * is ignored.
+     */
+    void trigger()
+    {
+        if (pending.load(std::memory_order_relaxed))
+            return;
+
+        pending.store(true, std::memory_order_relaxed);
+        ts_trigger = T_tsc::now();
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        T_irq::pend();
+    }
+
+    /**
+     * Record the entry of the interrupt service routine.
+     *
+     * Call this method as first statement in the interrupt service
+     * routine of the interrupt triggered via \a T_irq.
+     */
+    void isr_entry()
+    {
+        Ticks ts_now = T_tsc::now();
+
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        if (!pending.load(std::memory_order_relaxed))
+            return;
+
+        Ticks latency = T_tsc::elapsed(ts_trigger, ts_now);
+
+        stats.modify([=](Statistics& s) {
+            if ((s.num_samples == 0) || (latency < s.min_latency))
+                s.min_latency = latency;
+            if (latency > s.max_latency)
+                s.max_latency = latency;
+            s.sum_latency += latency;
+            ++s.num_samples;
+            s.histogram.add(latency);
+        });
+
+        pending.store(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * Test if a measurement is in progress.
+     */
+    bool is_pending() const
+    {
+        return pending.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Run foreground code repeatedly and wait for each measurement.
+     *
+     * \a code is expected to call trigger() at the point where the
+     * latency it imposes should be measured. After each invocation we
+     * wait until the interrupt service routine has recorded the
+     * latency.
+     *
+     * \param[in] code
+     *      The code under test.
+     * \param[in] repetitions
+     *      The number of times \a code is executed.
+     */
+    template <typename F>
+    void run(F&& code, int repetitions)
+    {
+        for (int i = 0; i < repetitions; ++i) {
+            code();
+            while (is_pending()) ;
+        }
+    }
+
+    /**
+     * Discard the statistics collected so far.
+     *
+     * \note
+     * Must not be called while a measurement is in progress.
+     */
+    void reset()
+    {
+        stats.store(Statistics{});
+    }
+
+    /**
+     * Get a consistent copy of the statistics.
+     */
+    Statistics statistics() const { return stats.load(); }
+
+private:
+    Ticks ts_trigger = 0;
+    std::atomic<bool> pending{false};
+    Seqlock<Statistics> stats;
+};
+
+} // namespace hodea
+
+#endif /*!HODEA_IRQ_LATENCY_METER_HPP */
@@ -0,0 +1,284 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Instrumentation for control loop jitter and CPU load.
+ *
+ * This file provides two lightweight monitors based on the timestamp
+ * counter class Tsc:
+ *
+ * - Jitter_monitor measures the period between successive invocations
+ *   of a periodic interrupt service routine and keeps a histogram of
+ *   its deviation from the ideal period.
+ * - Cpu_load_monitor measures the time spent in the idle loop and
+ *   derives the CPU load for a given measurement window.
+ *
+ * Both monitors neither allocate memory nor disable the global
+ * interrupt. The results are published via a sequence lock and can be
+ * read at any time as plain struct.
+ *
+ * Example:
+ *
+ * \code
+ * constexpr Htsc::Ticks ctrl_period = Htsc::us_to_ticks(50.0);
+ * Jitter_monitor<Htsc> ctrl_jitter{ctrl_period};
+ * Cpu_load_monitor<Htsc> cpu_load{
+ *      Htsc::ms_to_ticks(100), Htsc::us_to_ticks(2.0)
+ *      };
+ *
+ * void TIM1_UP_TIM16_IRQHandler()
+ * {
+ *     ctrl_jitter.isr_entry();
+ *     :
+ * }
+ *
+ * int main()
+ * {
+ *     :
+ *     for (;;) {
+ *         if (!has_work())
+ *             cpu_load.idle();
+ *         :
+ *         auto jitter = ctrl_jitter.statistics();
+ *         auto load = cpu_load.statistics();
+ *     }
+ * }
+ * \endcode
+ *
+ * \note
+ * All time measurements use Tsc::elapsed(). Therefore, the measured
+ * periods and windows must be shorter than the time span covered by
+ * the underlying timestamp counter.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_LOOP_MONITOR_HPP
+#define HODEA_LOOP_MONITOR_HPP
+
+#include <atomic>
+#include <type_traits>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/histogram.hpp>
+#include <hodea/core/seqlock.hpp>
+
+namespace hodea {
+
+/**
+ * Class to monitor the period jitter of a periodic interrupt.
+ *
+ * The histogram holds the deviation of the measured period from the
+ * ideal period. Bin \a num_bins / 2 accounts deviations in the range
+ * [0, 2^bin_shift) ticks, lower bins negative and higher bins positive
+ * deviations. Deviations outside the covered range are accounted in the
+ * first respectively last bin.
+ *
+ * \tparam T_tsc
+ *      Timestamp counter class, e.g. Htsc.
+ * \tparam num_bins
+ *      Number of histogram bins.
+ * \tparam bin_shift
+ *      Binary logarithm of the bin width in ticks.
+ */
+template <class T_tsc, int num_bins = 16, int bin_shift = 0>
+class Jitter_monitor {
+public:
+    typedef typename T_tsc::Ticks Ticks;
+    typedef typename std::make_signed<Ticks>::type Deviation;
+    typedef Histogram<num_bins, bin_shift> Jitter_histogram;
+
+    /**
+     * Index of the bin accounting a deviation of zero.
+     */
+    static constexpr int zero_bin = num_bins / 2;
+
+    /**
+     * Results published by the monitor.
+     */
+    struct Statistics {
+        uint32_t num_periods;       // number of measured periods
+        Ticks min_period;           // shortest period measured
+        Ticks max_period;           // longest period measured
+        Ticks max_jitter;           // largest absolute deviation
+        Jitter_histogram histogram; // deviation from the ideal period
+    };
+
+    constexpr explicit Jitter_monitor(Ticks ideal_period)
+        : ideal_period{ideal_period}
+    {}
+
+    /**
+     * Record the entry of the monitored interrupt service routine.
+     *
+     * Call this method as early as possible within the interrupt
+     * service routine.
+     */
+    void isr_entry()
+    {
+        Ticks ts_now = T_tsc::now();
+
+        if (reset_requested.load(std::memory_order_relaxed)) {
+            stats.store(Statistics{});
+            reset_requested.store(false, std::memory_order_relaxed);
+        }
+        else if (has_ts_last) {
+            account(T_tsc::elapsed(ts_last, ts_now));
+        }
+
+        ts_last = ts_now;
+        has_ts_last = true;
+    }
+
+    /**
+     * Discard the statistics collected so far.
+     *
+     * The statistics are cleared with the next invocation of
+     * isr_entry(), so this method can be called from any context.
+     */
+    void reset()
+    {
+        reset_requested.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * Get a consistent copy of the statistics.
+     */
+    Statistics statistics() const { return stats.load(); }
+
+private:
+    void account(Ticks period)
+    {
+        Deviation dev =
+            static_cast<Deviation>(period) -
+            static_cast<Deviation>(ideal_period);
+        Ticks abs_dev = (dev < 0) ? -dev : dev;
+        Deviation offs =
+            dev + (static_cast<Deviation>(zero_bin) << bin_shift);
+
+        if (offs < 0)
+            offs = 0;
+
+        stats.modify([=](Statistics& s) {
+            if ((s.num_periods == 0) || (period < s.min_period))
+                s.min_period = period;
+            if (period > s.max_period)
+                s.max_period = period;
+            if (abs_dev > s.max_jitter)
+                s.max_jitter = abs_dev;
+            ++s.num_periods;
+            s.histogram.add(static_cast<Ticks>(offs));
+        });
+    }
+
+    const Ticks ideal_period;
+    Ticks ts_last = 0;
+    bool has_ts_last = false;
+    std::atomic<bool> reset_requested{false};
+    Seqlock<Statistics> stats;
+};
+
+/**
+ * Class to measure the CPU load via the time spent in the idle loop.
+ *
+ * The idle loop calls idle() in each iteration. The method measures the
+ * time since its last invocation. A step not longer than
+ * \a max_idle_step is considered as idle time. Longer steps mean that
+ * the CPU was busy, either with work done by the main loop or with
+ * interrupt service routines.
+ *
+ * \a max_idle_step should be slightly larger than the execution time of
+ * one idle loop iteration.
+ *
+ * At the end of each measurement window the load is calculated and
+ * published.
+ */
+template <class T_tsc>
+class Cpu_load_monitor {
+public:
+    typedef typename T_tsc::Ticks Ticks;
+
+    /**
+     * Results published by the monitor.
+     */
+    struct Statistics {
+        uint32_t num_windows;       // number of evaluated windows
+        int load_permille;          // load of the last window
+        int peak_permille;          // highest load measured
+    };
+
+    /**
+     * Constructor.
+     *
+     * \param[in] window
+     *      Length of the measurement window.
+     * \param[in] max_idle_step
+     *      Longest time between two idle() calls considered as idle.
+     */
+    constexpr Cpu_load_monitor(Ticks window, Ticks max_idle_step)
+        : window{window}, max_idle_step{max_idle_step}
+    {}
+
+    /**
+     * Account the time elapsed since the last invocation.
+     *
+     * Call this method in each iteration of the idle loop.
+     */
+    void idle()
+    {
+        Ticks ts_now = T_tsc::now();
+
+        if (!is_running) {
+            ts_last = ts_window = ts_now;
+            is_running = true;
+            return;
+        }
+
+        Ticks step = T_tsc::elapsed(ts_last, ts_now);
+        if (step <= max_idle_step)
+            idle_ticks += step;
+        ts_last = ts_now;
+
+        Ticks win = T_tsc::elapsed(ts_window, ts_now);
+        if (win >= window) {
+            publish(win);
+            ts_window = ts_now;
+            idle_ticks = 0;
+        }
+    }
+
+    /**
+     * Get a consistent copy of the statistics.
+     *
+     * \note
+     * The statistics are written by idle(). Call this method only from
+     * contexts which cannot preempt the idle loop, usually the main
+     * loop itself.
+     */
+    Statistics statistics() const { return stats.load(); }
+
+private:
+    void publish(Ticks win)
+    {
+        int load = static_cast<int>(
+            (static_cast<uint64_t>(win - idle_ticks) * 1000) / win
+            );
+
+        stats.modify([=](Statistics& s) {
+            ++s.num_windows;
+            s.load_permille = load;
+            if (load > s.peak_permille)
+                s.peak_permille = load;
+        });
+    }
+
+    const Ticks window;
+    const Ticks max_idle_step;
+    Ticks ts_last = 0;
+    Ticks ts_window = 0;
+    Ticks idle_ticks = 0;
+    bool is_running = false;
+    Seqlock<Statistics> stats;
+};
+
+} // namespace hodea
+
+#endif /*!HODEA_LOOP_MONITOR_HPP */
@@ -0,0 +1,422 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * LZSS compression with static buffers for small targets.
+ *
+ * The encoder replaces a sequence of bytes which occurred already within
+ * the last 2^window_bits bytes by a back-reference, i.e. its offset and
+ * its length. All other bytes are sent as literals. The compressed
+ * stream is a sequence of fields, packed LSB first as by Bit_writer
+ * (see bitstream.hpp):
+ *
+ * - literal: tag bit 1, followed by the byte (8 bits)
+ * - back-reference: tag bit 0, followed by the offset - 1
+ *   (window_bits bits) and the length - min_match (lookahead_bits bits)
+ *
+ * The last byte is padded with ones. They form an incomplete literal,
+ * which the decoder ignores.
+ *
+ * The design follows the heatshrink library: All buffers are members
+ * sized at compile time, no heap is used, and both encoder and decoder
+ * work incrementally. Input is passed with sink(), output is fetched
+ * with poll(). Each call processes as much as the buffers allow, so a
+ * log buffer can be compressed while the UART transmits the output.
+ *
+ * The encoder requires 2 * 2^window_bits bytes of RAM, the decoder
+ * 2^window_bits bytes plus its input buffer. With the default of 8
+ * window bits this is 512 respectively 288 bytes. The encoder searches
+ * the window linearly, so its run time grows with the window size.
+ *
+ * Example:
+ *
+ * \code
+ * static Lzss_encoder<> enc;
+ * uint8_t out[32];
+ * int done = 0;
+ *
+ * enc.reset();
+ * while (!enc.is_done()) {
+ *     done += enc.sink(log_buf + done, log_len - done);
+ *     if (done == log_len)
+ *         enc.finish();
+ *     int n = enc.poll(out, sizeof(out));
+ *     uart_send(out, n);
+ * }
+ * \endcode
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_LZSS_HPP
+#define HODEA_LZSS_HPP
+
+#include <cstring>
+#include <type_traits>
+#include <hodea/core/cstdint.hpp>
+
+namespace hodea {
+
+/**
+ * Parameters of the compressed format.
+ *
+ * \tparam window_bits
+ *      Number of bits of the offset, 4 to 15.
+ * \tparam lookahead_bits
+ *      Number of bits of the length, 2 to \a window_bits - 1.
+ */
+template <int window_bits, int lookahead_bits>
+struct Lzss_params {
+    static_assert(
+        (window_bits >= 4) && (window_bits <= 15),
+        "window_bits out of range"
+        );
+    static_assert(
+        (lookahead_bits >= 2) && (lookahead_bits < window_bits),
+        "lookahead_bits out of range"
+        );
+
+    static constexpr int window_size = 1 << window_bits;
+    static constexpr int literal_bits = 9;
+    static constexpr int backref_bits = 1 + window_bits + lookahead_bits;
+
+    /**
+     * Shortest back-reference which is shorter than the literals.
+     */
+    static constexpr int min_match = backref_bits / literal_bits + 1;
+    static constexpr int max_match = min_match + (1 << lookahead_bits) - 1;
+
+    /**
+     * Bit accumulator of encoder and decoder.
+     *
+     * Both hold fewer than 8 bits when a field is added or read, so 32
+     * bits suffice unless a back-reference takes more than 25 bits.
+     * This keeps the variable shifts within a register on 32 bit
+     * targets.
+     */
+    typedef typename std::conditional<
+        (backref_bits <= 25), uint32_t, uint64_t
+        >::type Acc;
+};
+
+/**
+ * Class to compress a stream incrementally.
+ */
+template <int window_bits = 8, int lookahead_bits = 4>
+class Lzss_encoder : private Lzss_params<window_bits, lookahead_bits> {
+    typedef Lzss_params<window_bits, lookahead_bits> Params;
+    typedef typename Params::Acc Acc;
+    using Params::window_size;
+    using Params::literal_bits;
+    using Params::backref_bits;
+    using Params::min_match;
+    using Params::max_match;
+
+public:
+    Lzss_encoder() { reset(); }
+
+    /**
+     * Start a new stream.
+     */
+    void reset()
+    {
+        pos = window_size;
+        end = window_size;
+        hist_start = window_size;
+        acc = 0;
+        acc_bits = 0;
+        finishing = false;
+    }
+
+    /**
+     * Pass input bytes.
+     *
+     * \returns
+     *      The number of bytes accepted. If less than \a len, poll()
+     *      must be called before the rest is accepted.
+     */
+    int sink(const uint8_t* data, int len)
+    {
+        if (finishing)
+            return 0;
+        if ((end == 2 * window_size) && (pos > window_size))
+            shift();
+
+        int n = 2 * window_size - end;
+
+        if (n > len)
+            n = len;
+        std::memcpy(buf + end, data, n);
+        end += n;
+        return n;
+    }
+
+    /**
+     * Signal the end of the input.
+     *
+     * Afterwards poll() compresses the remaining input and flushes the
+     * last byte.
+     */
+    void finish() { finishing = true; }
+
+    /**
+     * Fetch compressed bytes.
+     *
+     * \returns
+     *      The number of bytes written into \a out.
+     */
+    int poll(uint8_t* out, int capacity)
+    {
+        int n = 0;
+
+        for (;;) {
+            while ((acc_bits >= 8) && (n < capacity)) {
+                out[n++] = static_cast<uint8_t>(acc);
+                acc >>= 8;
+                acc_bits -= 8;
+            }
+            // step() requires fewer than 8 bits in the accumulator
+            if (acc_bits >= 8)
+                return n;
+
+            int avail = end - pos;
+
+            if ((avail == 0) || (!finishing && (avail < max_match)))
+                break;
+            step((avail < max_match) ? avail : max_match);
+        }
+
+        if (finishing && (pos == end) && (acc_bits > 0) && (n < capacity)) {
+            out[n++] = static_cast<uint8_t>(acc | (0xffU << acc_bits));
+            acc = 0;
+            acc_bits = 0;
+        }
+        return n;
+    }
+
+    /**
+     * Test if the stream is complete, i.e. finish() was called and all
+     * output was fetched.
+     */
+    bool is_done() const
+    {
+        return finishing && (pos == end) && (acc_bits == 0);
+    }
+
+private:
+    /*
+     * Compress the bytes at pos, looking ahead at most max_len bytes.
+     */
+    void step(int max_len)
+    {
+        const uint8_t* cur = buf + pos;
+        int lowest = pos - window_size;
+        int best_len = 0;
+        int best_offs = 0;
+
+        if (lowest < hist_start)
+            lowest = hist_start;
+
+        for (int c = pos - 1; c >= lowest; --c) {
+            // test the byte which would make this match the longest one
+            if ((buf[c] != cur[0]) || (buf[c + best_len] != cur[best_len]))
+                continue;
+
+            int len = 1;
+
+            while ((len < max_len) && (buf[c + len] == cur[len]))
+                ++len;
+            if (len > best_len) {
+                best_len = len;
+                best_offs = pos - c;
+                if (len == max_len)
+                    break;
+            }
+        }
+
+        if (best_len >= min_match) {
+            put(
+                (static_cast<uint32_t>(best_offs - 1) << 1) |
+                (static_cast<uint32_t>(best_len - min_match) <<
+                 (1 + window_bits)),
+                backref_bits
+                );
+            pos += best_len;
+        }
+        else {
+            put(1U | (static_cast<uint32_t>(cur[0]) << 1), literal_bits);
+            pos += 1;
+        }
+    }
+
+    void put(uint32_t val, int num_bits)
+    {
+        acc |= static_cast<Acc>(val) << acc_bits;
+        acc_bits += num_bits;
+    }
+
+    /*
+     * Discard history older than the window to make room for input.
+     */
+    void shift()
+    {
+        int delta = pos - window_size;
+
+        std::memmove(buf, buf + delta, end - delta);
+        pos -= delta;
+        end -= delta;
+        hist_start = (hist_start > delta) ? hist_start - delta : 0;
+    }
+
+    // buf[hist_start, pos): history, buf[pos, end): pending input
+    uint8_t buf[2 * window_size];
+    int pos;
+    int end;
+    int hist_start;
+    Acc acc;
+    int acc_bits;
+    bool finishing;
+};
+
+/**
+ * Class to decompress a stream incrementally.
+ *
+ * \tparam input_size
+ *      Size of the buffer holding input bytes passed via sink().
+ */
+template <int window_bits = 8, int lookahead_bits = 4, int input_size = 32>
+class Lzss_decoder : private Lzss_params<window_bits, lookahead_bits> {
+    typedef Lzss_params<window_bits, lookahead_bits> Params;
+    typedef typename Params::Acc Acc;
+    using Params::window_size;
+    using Params::literal_bits;
+    using Params::backref_bits;
+    using Params::min_match;
+
+public:
+    Lzss_decoder() { reset(); }
+
+    /**
+     * Start a new stream.
+     */
+    void reset()
+    {
+        in_pos = 0;
+        in_len = 0;
+        acc = 0;
+        acc_bits = 0;
+        head = 0;
+        hist_len = 0;
+        count = 0;
+        offs = 0;
+        failed = false;
+    }
+
+    /**
+     * Pass compressed bytes.
+     *
+     * \returns
+     *      The number of bytes accepted. If less than \a len, poll()
+     *      must be called before the rest is accepted.
+     */
+    int sink(const uint8_t* data, int len)
+    {
+        if (in_pos > 0) {
+            std::memmove(in, in + in_pos, in_len - in_pos);
+            in_len -= in_pos;
+            in_pos = 0;
+        }
+
+        int n = input_size - in_len;
+
+        if (n > len)
+            n = len;
+        std::memcpy(in + in_len, data, n);
+        in_len += n;
+        return n;
+    }
+
+    /**
+     * Fetch decompressed bytes.
+     *
+     * \returns
+     *      The number of bytes written into \a out.
+     */
+    int poll(uint8_t* out, int capacity)
+    {
+        int n = 0;
+
+        while (!failed && (n < capacity)) {
+            if (count > 0) {
+                out[n++] = emit(hist[(head - offs) & (window_size - 1)]);
+                --count;
+                continue;
+            }
+
+            if (!fill(1))
+                break;
+            if (acc & 1) {
+                if (!fill(literal_bits))
+                    break;
+                out[n++] = emit(static_cast<uint8_t>(acc >> 1));
+                drop(literal_bits);
+            }
+            else {
+                if (!fill(backref_bits))
+                    break;
+                offs = ((acc >> 1) & (window_size - 1)) + 1;
+                count = ((acc >> (1 + window_bits)) &
+                         ((1 << lookahead_bits) - 1)) + min_match;
+                drop(backref_bits);
+                if (offs > hist_len)
+                    failed = true;
+            }
+        }
+        return n;
+    }
+
+    /**
+     * Test if the stream is valid so far.
+     */
+    bool ok() const { return !failed; }
+
+private:
+    bool fill(int num_bits)
+    {
+        while ((acc_bits < num_bits) && (in_pos < in_len)) {
+            acc |= static_cast<Acc>(in[in_pos++]) << acc_bits;
+            acc_bits += 8;
+        }
+        return acc_bits >= num_bits;
+    }
+
+    void drop(int num_bits)
+    {
+        acc >>= num_bits;
+        acc_bits -= num_bits;
+    }
+
+    uint8_t emit(uint8_t byte)
+    {
+        hist[head] = byte;
+        head = (head + 1) & (window_size - 1);
+        if (hist_len < window_size)
+            ++hist_len;
+        return byte;
+    }
+
+    uint8_t hist[window_size];
+    uint8_t in[input_size];
+    int in_pos;
+    int in_len;
+    Acc acc;
+    int acc_bits;
+    int head;
+    int hist_len;
+    int count;                  // bytes left of the current back-reference
+    int offs;
+    bool failed;
+};
+
+} // namespace hodea
+
+#endif /*!HODEA_LZSS_HPP */
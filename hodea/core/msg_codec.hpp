@@ -0,0 +1,176 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Message codec generated from a compile-time schema.
+ *
+ * Serializing a message field by field with the store and fetch
+ * functions is error-prone: Offsets, widths and byte orders are spread
+ * over encoding and decoding code and must be kept consistent by hand.
+ *
+ * With this module the layout of a message is declared once as list of
+ * fields, each given by a data member, its width on the wire and its
+ * byte order. The codec class generates the encode and decode functions
+ * and provides the message size as compile-time constant. The field
+ * offsets are calculated at compile time as well.
+ *
+ * The fields are converted with Wire_format, so each field compiles to
+ * a single load or store, plus a byte swap where the wire byte order
+ * differs from the CPU byte order (on targets supporting unaligned
+ * accesses).
+ *
+ * Example:
+ *
+ * \code
+ * struct Status {
+ *     uint8_t id;
+ *     uint16_t flags;
+ *     int32_t current;
+ * };
+ *
+ * using Status_codec = Msg_codec<
+ *     Status,
+ *     HODEA_MSG_FIELD(Status, id, 1, le),
+ *     HODEA_MSG_FIELD(Status, flags, 2, le),
+ *     HODEA_MSG_FIELD(Status, current, 4, be)
+ *     >;
+ *
+ * uint8_t buf[Status_codec::size];
+ * Status status;
+ * :
+ * send_msg(buf, Status_codec::encode(buf, status));
+ * \endcode
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_MSG_CODEC_HPP
+#define HODEA_MSG_CODEC_HPP
+
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/cpu_endian.hpp>
+#include <hodea/core/wire_format.hpp>
+
+namespace hodea {
+
+/**
+ * Class describing a message field.
+ *
+ * \tparam T_msg
+ *      The message type.
+ * \tparam T_member
+ *      The type of the data member.
+ * \tparam member
+ *      Pointer to the data member.
+ * \tparam width
+ *      Width of the field on the wire in bytes: 1, 2, 4 or 8.
+ * \tparam order
+ *      Byte order of the field on the wire.
+ *
+ * The macro HODEA_MSG_FIELD() is provided for convenience.
+ */
+template <
+    typename T_msg, typename T_member, T_member T_msg::* member,
+    int width, Byte_order order
+    >
+class Msg_field {
+public:
+    typedef Wire_format<width, order> Format;
+
+    static constexpr int size = width;
+
+    static void encode(uint8_t* buf, const T_msg& msg)
+    {
+        Format::store(buf, msg.*member);
+    }
+
+    static void decode(T_msg& msg, const uint8_t* buf)
+    {
+        Format::fetch(msg.*member, buf);
+    }
+};
+
+/**
+ * Declare a message field.
+ *
+ * \param[in] msg    The message type.
+ * \param[in] member The name of the data member.
+ * \param[in] width  The width of the field on the wire in bytes.
+ * \param[in] order  The byte order on the wire: le or be.
+ */
+#define HODEA_MSG_FIELD(msg, member, width, order)                      \
+    ::hodea::Msg_field<                                                 \
+        msg, decltype(msg::member), &msg::member,                       \
+        width, ::hodea::Byte_order::order                               \
+        >
+
+/**
+ * Class providing encode and decode functions for a message.
+ *
+ * \tparam T_msg
+ *      The message type.
+ * \tparam T_fields
+ *      The fields in the order they appear on the wire, see Msg_field.
+ */
+template <typename T_msg, typename... T_fields>
+class Msg_codec {
+public:
+    /**
+     * Size of the encoded message in bytes.
+     */
+    static constexpr int size = Wire_size<T_fields...>::value;
+
+    /**
+     * Encode a message.
+     *
+     * \param[out] buf Target buffer with at least \a size bytes.
+     * \param[in] msg The message to encode.
+     *
+     * \returns
+     *      The number of bytes written into \a buf.
+     */
+    static int encode(uint8_t* buf, const T_msg& msg)
+    {
+        encode_at<0, T_fields...>(buf, msg);
+        return size;
+    }
+
+    /**
+     * Decode a message.
+     *
+     * \param[out] msg The decoded message.
+     * \param[in] buf Source buffer holding the encoded message.
+     *
+     * \returns
+     *      The number of bytes read from \a buf.
+     */
+    static int decode(T_msg& msg, const uint8_t* buf)
+    {
+        decode_at<0, T_fields...>(msg, buf);
+        return size;
+    }
+
+private:
+    template <int offs>
+    static void encode_at(uint8_t*, const T_msg&) {}
+
+    template <int offs, typename T, typename... T_rest>
+    static void encode_at(uint8_t* buf, const T_msg& msg)
+    {
+        T::encode(buf + offs, msg);
+        encode_at<offs + T::size, T_rest...>(buf, msg);
+    }
+
+    template <int offs>
+    static void decode_at(T_msg&, const uint8_t*) {}
+
+    template <int offs, typename T, typename... T_rest>
+    static void decode_at(T_msg& msg, const uint8_t* buf)
+    {
+        T::decode(msg, buf + offs);
+        decode_at<offs + T::size, T_rest...>(msg, buf);
+    }
+};
+
+} // namespace hodea
+
+#endif /*!HODEA_MSG_CODEC_HPP */
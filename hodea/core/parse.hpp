@@ -0,0 +1,349 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Parse decimal and hexadecimal numbers from text.
+ *
+ * strtol() and its relatives depend on the locale and errno, require a
+ * null-terminated string and are slow. The functions in this file parse
+ * a number at the start of a byte span instead:
+ *
+ * - The number of bytes consumed is returned, so the functions compose
+ *   with Byte_reader::skip() and similar streaming readers. 0 is
+ *   returned if the span does not start with a valid number or if the
+ *   number overflows. The target variable is not modified in this case.
+ * - Parsing stops at the first character which does not belong to the
+ *   number. Checking the delimiter is up to the caller.
+ * - Overflow is detected by comparing with constants, no division is
+ *   required. No tables are used.
+ * - On little endian hosts runs of 8 decimal digits are validated and
+ *   converted at once (SWAR, SIMD within a register), with 64 bit words
+ *   on 64 bit hosts and two 32 bit words otherwise. The Cortex-M0
+ *   cannot load unaligned words and uses the plain digit loop.
+ *
+ * The functions follow the convention of serialization.hpp: The
+ * destination is given first.
+ *
+ * Example:
+ *
+ * \code
+ * // "SET 12 -0.25\r\n"
+ * Const_byte_span args = cmd.subspan(4);
+ * uint32_t channel;
+ * int32_t gain;
+ * int n;
+ *
+ * n = parse_u32(channel, args);
+ * if (!n || (n == args.size()) || (args[n] != ' '))
+ *     return error;
+ * args = args.subspan(n + 1);
+ * if (!parse_fixed<15>(gain, args))
+ *     return error;
+ * \endcode
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_PARSE_HPP
+#define HODEA_PARSE_HPP
+
+#include <cstring>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/span.hpp>
+
+#if defined __BYTE_ORDER__ && !defined __ARM_ARCH_6M__
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define HODEA_PARSE_SWAR 1
+#endif
+#endif
+
+namespace hodea {
+
+/**
+ * Test if a character is a decimal digit.
+ */
+static inline constexpr bool parse_is_digit(uint8_t c)
+{
+    return static_cast<uint8_t>(c - '0') < 10;
+}
+
+#if defined HODEA_PARSE_SWAR
+
+#if UINTPTR_MAX > 0xffffffffU
+
+/**
+ * Convert 8 decimal digits at once.
+ *
+ * \returns
+ *      True if all 8 bytes at \a p are decimal digits.
+ */
+static inline bool parse_8digits_swar(uint32_t& dst, const uint8_t* p)
+{
+    uint64_t x;
+
+    std::memcpy(&x, p, sizeof(x));
+    // each byte must be within '0' to '9', i.e. 0x30 to 0x39
+    if ((((x & 0xf0f0f0f0f0f0f0f0ULL) |
+          (((x + 0x0606060606060606ULL) & 0xf0f0f0f0f0f0f0f0ULL) >> 4)) !=
+         0x3333333333333333ULL))
+        return false;
+
+    x -= 0x3030303030303030ULL;
+    x = (x * 10) + (x >> 8);
+    x = (((x & 0x000000ff000000ffULL) * (100 + (1000000ULL << 32))) +
+         (((x >> 16) & 0x000000ff000000ffULL) * (1 + (10000ULL << 32))))
+        >> 32;
+    dst = static_cast<uint32_t>(x);
+    return true;
+}
+
+#else
+
+/**
+ * Convert 4 decimal digits at once.
+ *
+ * \returns
+ *      True if all 4 bytes at \a p are decimal digits.
+ */
+static inline bool parse_4digits_swar(uint32_t& dst, const uint8_t* p)
+{
+    uint32_t x;
+
+    std::memcpy(&x, p, sizeof(x));
+    // each byte must be within '0' to '9', i.e. 0x30 to 0x39
+    if ((((x & 0xf0f0f0f0U) |
+          (((x + 0x06060606U) & 0xf0f0f0f0U) >> 4)) != 0x33333333U))
+        return false;
+
+    x -= 0x30303030U;
+    x = (x * 10) + (x >> 8);
+    dst = ((x & 0x00ff00ffU) * (1 + (100U << 16))) >> 16;
+    return true;
+}
+
+/**
+ * Convert 8 decimal digits at once.
+ *
+ * \returns
+ *      True if all 8 bytes at \a p are decimal digits.
+ */
+static inline bool parse_8digits_swar(uint32_t& dst, const uint8_t* p)
+{
+    uint32_t hi;
+    uint32_t lo;
+
+    if (!parse_4digits_swar(hi, p) || !parse_4digits_swar(lo, p + 4))
+        return false;
+    dst = 10000 * hi + lo;
+    return true;
+}
+
+#endif
+
+#endif
+
+/**
+ * Parse a sequence of decimal digits.
+ *
+ * \returns
+ *      Pointer to the first character following the digits, \a p if
+ *      there are no digits, or nullptr on overflow.
+ */
+static inline const uint8_t* parse_digits_u32(
+    uint32_t& dst, const uint8_t* p, const uint8_t* end
+    )
+{
+    uint32_t v = 0;
+
+#if defined HODEA_PARSE_SWAR
+    // v < 10^8 after this, so at least 2 more digits fit
+    if ((end - p >= 8) && parse_8digits_swar(v, p))
+        p += 8;
+#endif
+
+    for (; (p < end) && parse_is_digit(*p); ++p) {
+        uint32_t d = *p - '0';
+
+        if ((v >= 429496729U) && ((v > 429496729U) || (d > 5)))
+            return nullptr;
+        v = 10 * v + d;
+    }
+    dst = v;
+    return p;
+}
+
+/**
+ * Parse an unsigned decimal number.
+ *
+ * \param[out] dst
+ *      Target variable.
+ * \param[in] src
+ *      The text starting with the number.
+ *
+ * \returns
+ *      The number of bytes consumed, or 0 on error.
+ */
+static inline int parse_u32(uint32_t& dst, Const_byte_span src)
+{
+    const uint8_t* p = src.begin();
+    uint32_t v;
+    const uint8_t* q = parse_digits_u32(v, p, src.end());
+
+    if (!q || (q == p))
+        return 0;
+    dst = v;
+    return q - p;
+}
+
+/**
+ * Parse a signed decimal number with optional sign.
+ *
+ * \returns
+ *      The number of bytes consumed, or 0 on error.
+ */
+static inline int parse_i32(int32_t& dst, Const_byte_span src)
+{
+    const uint8_t* p = src.begin();
+    const uint8_t* end = src.end();
+    bool is_negative = false;
+
+    if ((p < end) && ((*p == '-') || (*p == '+')))
+        is_negative = *p++ == '-';
+
+    uint32_t v;
+    const uint8_t* q = parse_digits_u32(v, p, end);
+
+    if (!q || (q == p) || (v > 0x7fffffffU + is_negative))
+        return 0;
+    dst = is_negative ? static_cast<int32_t>(0U - v) : v;
+    return q - src.begin();
+}
+
+/**
+ * Parse an unsigned hexadecimal number.
+ *
+ * An optional prefix "0x" or "0X" is accepted. Both upper and lower
+ * case digits are accepted.
+ *
+ * \returns
+ *      The number of bytes consumed, or 0 on error.
+ */
+static inline int parse_hex(uint32_t& dst, Const_byte_span src)
+{
+    const uint8_t* p = src.begin();
+    const uint8_t* end = src.end();
+    const uint8_t* first;
+    uint32_t v = 0;
+
+    if ((end - p >= 3) && (p[0] == '0') && ((p[1] | 0x20) == 'x'))
+        p += 2;
+
+    for (first = p; p < end; ++p) {
+        uint32_t d = static_cast<uint8_t>(*p - '0');
+
+        if (d >= 10) {
+            d = static_cast<uint8_t>((*p | 0x20) - 'a');
+            if (d >= 6)
+                break;
+            d += 10;
+        }
+        if (v > 0x0fffffffU)
+            return 0;
+        v = (v << 4) | d;
+    }
+
+    if (p == first) {
+        // "0x" not followed by a hex digit is the number 0
+        if (first == src.begin() + 2) {
+            dst = 0;
+            return 1;
+        }
+        return 0;
+    }
+    dst = v;
+    return p - src.begin();
+}
+
+/**
+ * Parse a decimal fraction into a fixed-point number.
+ *
+ * The text consists of an optional sign, an integer part and an
+ * optional fraction, e.g. "-1.25" or ".5". The result is rounded to
+ * nearest. Fraction digits beyond the ninth are consumed but ignored.
+ *
+ * The fraction is converted bit by bit with shifts and subtractions, so
+ * neither a division nor a multiplication is required.
+ *
+ * \tparam frac_bits
+ *      Number of fractional bits, e.g. 15 for Q15.
+ *
+ * \returns
+ *      The number of bytes consumed, or 0 on error.
+ */
+template <int frac_bits>
+int parse_fixed(int32_t& dst, Const_byte_span src)
+{
+    static_assert(
+        (frac_bits >= 0) && (frac_bits < 32), "frac_bits out of range"
+        );
+
+    const uint8_t* p = src.begin();
+    const uint8_t* end = src.end();
+    bool is_negative = false;
+
+    if ((p < end) && ((*p == '-') || (*p == '+')))
+        is_negative = *p++ == '-';
+
+    uint32_t int_part;
+    const uint8_t* q = parse_digits_u32(int_part, p, end);
+
+    if (!q)
+        return 0;
+
+    bool has_digits = q != p;
+    uint32_t num = 0;           // fraction digits as integer
+    uint32_t den = 1;           // 10^(number of fraction digits)
+
+    p = q;
+    if ((p < end) && (*p == '.')) {
+        for (++p; (p < end) && parse_is_digit(*p); ++p) {
+            if (den < 1000000000U) {
+                num = 10 * num + (*p - '0');
+                den *= 10;
+            }
+            has_digits = true;
+        }
+    }
+    if (!has_digits)
+        return 0;
+
+    // binary long division num / den, one bit per iteration
+    uint32_t frac = 0;
+
+    for (int i = 0; i < frac_bits; ++i) {
+        num <<= 1;
+        frac <<= 1;
+        if (num >= den) {
+            num -= den;
+            frac |= 1;
+        }
+    }
+
+    uint64_t mag = (static_cast<uint64_t>(int_part) << frac_bits) + frac;
+
+    if (2 * static_cast<uint64_t>(num) >= den)
+        ++mag;
+    if (mag > 0x7fffffffU + static_cast<uint64_t>(is_negative))
+        return 0;
+
+    dst = static_cast<int32_t>(
+        is_negative ? 0U - static_cast<uint32_t>(mag) :
+        static_cast<uint32_t>(mag)
+        );
+    return p - src.begin();
+}
+
+} // namespace hodea
+
+#undef HODEA_PARSE_SWAR
+
+#endif /*!HODEA_PARSE_HPP */
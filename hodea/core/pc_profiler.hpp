@@ -0,0 +1,181 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Statistical profiler based on program counter sampling.
+ *
+ * A periodic interrupt samples the program counter of the interrupted
+ * code and accounts it in a histogram of address ranges. After a while
+ * the histogram shows where the CPU spends its time. No debugger is
+ * required, so this works in the field.
+ *
+ * The histogram covers the address range
+ * [base, base + num_bins * 2^bin_shift). Samples outside this range,
+ * e.g. code executed from RAM, are counted separately.
+ *
+ * The overhead is controlled by the rate of the sampling interrupt and
+ * additionally by a divider, which allows to take only every n-th
+ * interrupt as sample. This allows to piggyback the profiler onto an
+ * existing periodic interrupt.
+ *
+ * The histogram is exported as binary record via dump(). The host tool
+ * tools/pcprof reads such records, merges them and maps the bins to the
+ * symbols of the ELF file.
+ *
+ * Record format, all numbers in little endian format:
+ *
+ * | Offset | Size | Content                              |
+ * |--------|------|--------------------------------------|
+ * |      0 |    4 | magic "HPCP"                         |
+ * |      4 |    1 | format version (1)                   |
+ * |      5 |    1 | bin_shift                            |
+ * |      6 |    2 | num_bins                             |
+ * |      8 |    4 | base address                         |
+ * |     12 |    4 | total number of samples              |
+ * |     16 |    4 | number of samples outside the range  |
+ * |     20 |  4*n | sample count for each bin            |
+ *
+ * For Cortex-M devices see pc_sampling_isr.hpp how to obtain the
+ * program counter of the interrupted code.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_PC_PROFILER_HPP
+#define HODEA_PC_PROFILER_HPP
+
+#include <atomic>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/histogram.hpp>
+#include <hodea/core/serialization.hpp>
+
+namespace hodea {
+
+/**
+ * Class accounting program counter samples.
+ *
+ * \tparam num_bins
+ *      Number of histogram bins.
+ * \tparam bin_shift
+ *      Binary logarithm of the address range covered by a bin.
+ */
+template <int num_bins, int bin_shift>
+class Pc_profiler {
+public:
+    static_assert(num_bins <= 0xffff, "too many bins for record format");
+
+    static constexpr uint8_t record_version = 1;
+    static constexpr int record_header_size = 20;
+    static constexpr int record_size = record_header_size + 4 * num_bins;
+
+    /**
+     * Constructor.
+     *
+     * \param[in] base
+     *      Lowest address covered by the histogram, e.g. flash start.
+     * \param[in] divider
+     *      Only every \a divider-th call of sample() is accounted.
+     */
+    constexpr explicit Pc_profiler(uint32_t base, int divider = 1)
+        : base{base}, divider{divider}
+    {}
+
+    /**
+     * Account a program counter sample.
+     *
+     * Called from the sampling interrupt service routine.
+     */
+    void sample(uint32_t pc)
+    {
+        if (!enabled.load(std::memory_order_relaxed))
+            return;
+        if (++divider_cnt < divider)
+            return;
+        divider_cnt = 0;
+
+        uint32_t offs = pc - base;
+
+        ++num_samples;
+        // addresses below base wrap around and end up outside as well
+        if ((offs >> bin_shift) >= static_cast<uint32_t>(num_bins))
+            ++num_outside;
+        else
+            histogram.add(offs);
+    }
+
+    /**
+     * Enable sampling.
+     */
+    void start() { enabled.store(true, std::memory_order_relaxed); }
+
+    /**
+     * Disable sampling, e.g. to get a consistent dump.
+     */
+    void stop() { enabled.store(false, std::memory_order_relaxed); }
+
+    /**
+     * Discard all samples.
+     *
+     * \note
+     * Sampling should be stopped while clearing.
+     */
+    void clear()
+    {
+        histogram.clear();
+        num_samples = num_outside = 0;
+        divider_cnt = 0;
+    }
+
+    /**
+     * Export the histogram as binary record.
+     *
+     * The record is passed in small chunks to \a write, so no large
+     * buffer is required.
+     *
+     * \param[in] write
+     *      Callable invoked as write(const uint8_t* buf, int len), e.g.
+     *      to send the data via UART.
+     */
+    template <typename F>
+    void dump(F&& write) const
+    {
+        uint8_t buf[record_header_size];
+        uint8_t* p = buf;
+
+        p += store8(p, 'H');
+        p += store8(p, 'P');
+        p += store8(p, 'C');
+        p += store8(p, 'P');
+        p += store8(p, record_version);
+        p += store8(p, bin_shift);
+        p += store16_le(p, num_bins);
+        p += store32_le(p, base);
+        p += store32_le(p, num_samples);
+        p += store32_le(p, num_outside);
+        write(buf, p - buf);
+
+        for (int i = 0; i < num_bins; i += 4) {
+            p = buf;
+            for (int j = i; (j < i + 4) && (j < num_bins); ++j)
+                p += store32_le(p, histogram[j]);
+            write(buf, p - buf);
+        }
+    }
+
+    /**
+     * Get the total number of samples accounted.
+     */
+    uint32_t samples() const { return num_samples; }
+
+private:
+    const uint32_t base;
+    const int divider;
+    int divider_cnt = 0;
+    uint32_t num_samples = 0;
+    uint32_t num_outside = 0;
+    std::atomic<bool> enabled{false};
+    Histogram<num_bins, bin_shift> histogram;
+};
+
+} // namespace hodea
+
+#endif /*!HODEA_PC_PROFILER_HPP */
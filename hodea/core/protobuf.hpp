@@ -0,0 +1,833 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Encoder and decoder for the protocol buffers wire format.
+ *
+ * Protocol buffers encode a message as sequence of fields, each prefixed
+ * with a tag holding the field number and the wire type. Integers are
+ * encoded as variable length integers (varints), so small values need
+ * less bytes. Fields with default values can be omitted. This makes the
+ * format compact and self-describing, and a host tool can decode it
+ * with the standard protobuf libraries given the .proto file.
+ *
+ * In the style of nanopb, this file provides a header-only codec which
+ * neither allocates memory nor needs generated code:
+ *
+ * - Fields are described at compile time via Pb_field, giving the field
+ *   number and the protobuf type. The tag is calculated at compile time.
+ * - Pb_writer encodes fields in a streaming fashion into a caller
+ *   provided buffer, with a sticky error state like Byte_writer.
+ * - Pb_reader iterates over the fields of an encoded message.
+ *
+ * Example:
+ *
+ * \code
+ * // message Telemetry {
+ * //     uint32 seq = 1;
+ * //     sint32 current = 2;
+ * //     fixed64 timestamp = 3;
+ * //     repeated uint32 samples = 4 [packed = true];
+ * // }
+ * using Tm_seq = Pb_field<1, Pb_type::uint32>;
+ * using Tm_current = Pb_field<2, Pb_type::sint32>;
+ * using Tm_timestamp = Pb_field<3, Pb_type::fixed64>;
+ * using Tm_samples = Pb_field<4, Pb_type::uint32>;
+ *
+ * uint8_t buf[128];
+ * Pb_writer w{buf};
+ *
+ * w.write<Tm_seq>(seq);
+ * w.write<Tm_current>(current);
+ * w.write<Tm_timestamp>(Htsc::now());
+ * w.write_packed<Tm_samples>(samples, num_samples);
+ * if (w.ok())
+ *     send_msg(w.data(), w.size());
+ *
+ * Pb_reader r{rx_buf, rx_len};
+ *
+ * while (r.next()) {
+ *     switch (r.field_number()) {
+ *     case Tm_seq::number:
+ *         r.read<Tm_seq>(seq);
+ *         break;
+ *     case Tm_samples::number:
+ *         num_samples = r.read_packed<Tm_samples>(samples, max_samples);
+ *         break;
+ *     default:
+ *         r.skip();
+ *         break;
+ *     }
+ * }
+ * if (!r.ok())
+ *     return error;
+ * \endcode
+ *
+ * \note
+ * The message lengths are limited to INT_MAX bytes as we use int for
+ * sizes according our coding style.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_PROTOBUF_HPP
+#define HODEA_PROTOBUF_HPP
+
+#include <cstring>
+#include <type_traits>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/byte_cursor.hpp>
+#include <hodea/core/serialization.hpp>
+#include <hodea/core/span.hpp>
+
+namespace hodea {
+
+/**
+ * Maximum size of a varint in bytes.
+ */
+constexpr int pb_max_varint_size = 10;
+
+/**
+ * Map a signed 32 bit integer onto an unsigned one (zigzag encoding).
+ *
+ * Small absolute values result in small numbers: 0 -> 0, -1 -> 1,
+ * 1 -> 2, -2 -> 3, and so on.
+ */
+static inline constexpr uint32_t zigzag_encode32(int32_t x)
+{
+    return (static_cast<uint32_t>(x) << 1) ^ static_cast<uint32_t>(x >> 31);
+}
+
+/**
+ * Map a signed 64 bit integer onto an unsigned one (zigzag encoding).
+ */
+static inline constexpr uint64_t zigzag_encode64(int64_t x)
+{
+    return (static_cast<uint64_t>(x) << 1) ^ static_cast<uint64_t>(x >> 63);
+}
+
+/**
+ * Reverse zigzag_encode32().
+ */
+static inline constexpr int32_t zigzag_decode32(uint32_t x)
+{
+    return static_cast<int32_t>((x >> 1) ^ (0U - (x & 1U)));
+}
+
+/**
+ * Reverse zigzag_encode64().
+ */
+static inline constexpr int64_t zigzag_decode64(uint64_t x)
+{
+    return static_cast<int64_t>((x >> 1) ^ (0ULL - (x & 1ULL)));
+}
+
+/**
+ * Get the number of bytes required to encode a value as varint.
+ */
+static inline constexpr int varint_size(uint64_t x)
+{
+    int n = 1;
+
+    while (x >= 0x80U) {
+        x >>= 7;
+        ++n;
+    }
+    return n;
+}
+
+/**
+ * Store a value as varint.
+ *
+ * \param[out] buf
+ *      Target buffer, providing at least varint_size(\a val) bytes.
+ * \param[in] val
+ *      The value to store.
+ *
+ * \returns
+ *      The number of bytes written to \a buf.
+ */
+static inline int store_varint(uint8_t* buf, uint64_t val)
+{
+    uint8_t* p = buf;
+
+    while (val >= 0x80U) {
+        *p++ = static_cast<uint8_t>(val) | 0x80U;
+        val >>= 7;
+    }
+    *p++ = static_cast<uint8_t>(val);
+    return p - buf;
+}
+
+/**
+ * Extract a varint.
+ *
+ * \param[out] dst
+ *      Target variable.
+ * \param[in] buf
+ *      Source buffer holding the varint.
+ * \param[in] len
+ *      The number of bytes available in \a buf.
+ *
+ * \returns
+ *      The number of bytes read from \a buf, or 0 if the varint is
+ *      truncated or longer than pb_max_varint_size bytes.
+ */
+static inline int fetch_varint(uint64_t& dst, const uint8_t* buf, int len)
+{
+    uint64_t v = 0;
+
+    // fast path without bounds check for each byte
+    int n = (len < pb_max_varint_size) ? len : pb_max_varint_size;
+
+    for (int i = 0; i < n; ++i) {
+        uint8_t b = buf[i];
+
+        v |= static_cast<uint64_t>(b & 0x7fU) << (7 * i);
+        if (b < 0x80U) {
+            dst = v;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Wire types defined by the protocol buffers encoding.
+ */
+enum struct Pb_wire_type : uint8_t {
+    varint = 0,
+    fixed64 = 1,
+    length_delimited = 2,
+    fixed32 = 5
+};
+
+/**
+ * Protocol buffers scalar value types.
+ */
+enum struct Pb_type {
+    int32,
+    int64,
+    uint32,
+    uint64,
+    sint32,
+    sint64,
+    boolean,
+    enumeration,
+    fixed32,
+    fixed64,
+    sfixed32,
+    sfixed64,
+    float32,            // float
+    float64,            // double
+    bytes,              // also used for strings and nested messages
+};
+
+/**
+ * Get the wire type used for a protobuf type.
+ */
+static inline constexpr Pb_wire_type pb_wire_type(Pb_type type)
+{
+    return
+        ((type == Pb_type::fixed32) || (type == Pb_type::sfixed32) ||
+         (type == Pb_type::float32)) ? Pb_wire_type::fixed32 :
+        ((type == Pb_type::fixed64) || (type == Pb_type::sfixed64) ||
+         (type == Pb_type::float64)) ? Pb_wire_type::fixed64 :
+        (type == Pb_type::bytes) ? Pb_wire_type::length_delimited :
+        Pb_wire_type::varint;
+}
+
+/**
+ * Conversion between a C++ value and its wire representation.
+ *
+ * Varint types convert to and from the varint value, fixed types to and
+ * from the unsigned integer holding the bits in CPU byte order.
+ */
+template <Pb_type type>
+struct Pb_value;
+
+template <>
+struct Pb_value<Pb_type::int32> {
+    template <typename T>
+    static uint64_t encode(T v)
+    {
+        // negative values are sign-extended to 64 bit (10 bytes)
+        return static_cast<uint64_t>(static_cast<int64_t>(
+            static_cast<int32_t>(v)));
+    }
+    template <typename T>
+    static void decode(T& v, uint64_t x)
+    {
+        v = static_cast<T>(static_cast<int32_t>(x));
+    }
+};
+
+template <>
+struct Pb_value<Pb_type::int64> {
+    template <typename T>
+    static uint64_t encode(T v)
+    {
+        return static_cast<uint64_t>(static_cast<int64_t>(v));
+    }
+    template <typename T>
+    static void decode(T& v, uint64_t x)
+    {
+        v = static_cast<T>(static_cast<int64_t>(x));
+    }
+};
+
+template <>
+struct Pb_value<Pb_type::uint32> {
+    template <typename T>
+    static uint64_t encode(T v) { return static_cast<uint32_t>(v); }
+    template <typename T>
+    static void decode(T& v, uint64_t x)
+    {
+        v = static_cast<T>(static_cast<uint32_t>(x));
+    }
+};
+
+template <>
+struct Pb_value<Pb_type::uint64> {
+    template <typename T>
+    static uint64_t encode(T v) { return static_cast<uint64_t>(v); }
+    template <typename T>
+    static void decode(T& v, uint64_t x) { v = static_cast<T>(x); }
+};
+
+template <>
+struct Pb_value<Pb_type::sint32> {
+    template <typename T>
+    static uint64_t encode(T v)
+    {
+        return zigzag_encode32(static_cast<int32_t>(v));
+    }
+    template <typename T>
+    static void decode(T& v, uint64_t x)
+    {
+        v = static_cast<T>(zigzag_decode32(static_cast<uint32_t>(x)));
+    }
+};
+
+template <>
+struct Pb_value<Pb_type::sint64> {
+    template <typename T>
+    static uint64_t encode(T v)
+    {
+        return zigzag_encode64(static_cast<int64_t>(v));
+    }
+    template <typename T>
+    static void decode(T& v, uint64_t x)
+    {
+        v = static_cast<T>(zigzag_decode64(x));
+    }
+};
+
+template <>
+struct Pb_value<Pb_type::boolean> {
+    template <typename T>
+    static uint64_t encode(T v) { return v ? 1 : 0; }
+    template <typename T>
+    static void decode(T& v, uint64_t x) { v = (x != 0); }
+};
+
+template <>
+struct Pb_value<Pb_type::enumeration> : Pb_value<Pb_type::int32> {};
+
+template <>
+struct Pb_value<Pb_type::fixed32> : Pb_value<Pb_type::uint32> {};
+
+template <>
+struct Pb_value<Pb_type::sfixed32> {
+    template <typename T>
+    static uint64_t encode(T v)
+    {
+        return static_cast<uint32_t>(static_cast<int32_t>(v));
+    }
+    template <typename T>
+    static void decode(T& v, uint64_t x)
+    {
+        v = static_cast<T>(static_cast<int32_t>(x));
+    }
+};
+
+template <>
+struct Pb_value<Pb_type::fixed64> : Pb_value<Pb_type::uint64> {};
+
+template <>
+struct Pb_value<Pb_type::sfixed64> : Pb_value<Pb_type::int64> {};
+
+template <>
+struct Pb_value<Pb_type::float32> {
+    static uint64_t encode(float v)
+    {
+        uint32_t x;
+
+        std::memcpy(&x, &v, sizeof(x));
+        return x;
+    }
+    static void decode(float& v, uint64_t x)
+    {
+        uint32_t u = static_cast<uint32_t>(x);
+
+        std::memcpy(&v, &u, sizeof(v));
+    }
+};
+
+template <>
+struct Pb_value<Pb_type::float64> {
+    static uint64_t encode(double v)
+    {
+        uint64_t x;
+
+        std::memcpy(&x, &v, sizeof(x));
+        return x;
+    }
+    static void decode(double& v, uint64_t x)
+    {
+        std::memcpy(&v, &x, sizeof(v));
+    }
+};
+
+/**
+ * Compile-time description of a message field.
+ *
+ * \tparam field_number
+ *      The field number as given in the .proto file.
+ * \tparam field_type
+ *      The protobuf type of the field.
+ */
+template <uint32_t field_number, Pb_type field_type>
+struct Pb_field {
+    static_assert(
+        (field_number >= 1) && (field_number <= 0x1fffffffU),
+        "invalid field number"
+        );
+
+    static constexpr uint32_t number = field_number;
+    static constexpr Pb_type type = field_type;
+    static constexpr Pb_wire_type wire_type = pb_wire_type(field_type);
+
+    /**
+     * The tag preceding the field value.
+     */
+    static constexpr uint32_t tag =
+        (field_number << 3) | static_cast<uint32_t>(wire_type);
+    static constexpr int tag_size = varint_size(tag);
+};
+
+/**
+ * Class to encode a message into a caller provided buffer.
+ *
+ * All write methods return false if the buffer is too small. As with
+ * Byte_writer, the error is sticky and ok() can be checked once after
+ * the message is complete.
+ */
+class Pb_writer {
+public:
+    Pb_writer(uint8_t* buf, int capacity) : writer{buf, capacity} {}
+
+    Pb_writer(Byte_span buf) : writer{buf} {}
+
+    template <std::size_t N>
+    Pb_writer(uint8_t (&buf)[N]) : writer{buf} {}
+
+    /**
+     * Write a scalar field.
+     */
+    template <typename T_field, typename T>
+    bool write(T val)
+    {
+        static_assert(
+            T_field::wire_type != Pb_wire_type::length_delimited,
+            "use write_bytes() for length delimited fields"
+            );
+
+        uint64_t x = Pb_value<T_field::type>::encode(val);
+        uint8_t* p = writer.reserve(
+            T_field::tag_size + value_size<T_field::wire_type>(x)
+            );
+
+        if (!p)
+            return false;
+        p += store_varint(p, T_field::tag);
+        store_value<T_field::wire_type>(p, x);
+        return true;
+    }
+
+    /**
+     * Write a length delimited field, e.g. a string.
+     */
+    template <typename T_field>
+    bool write_bytes(const void* data, int len)
+    {
+        static_assert(
+            T_field::wire_type == Pb_wire_type::length_delimited,
+            "field is not length delimited"
+            );
+
+        uint8_t* p = writer.reserve(
+            T_field::tag_size + varint_size(len) + len
+            );
+
+        if (!p)
+            return false;
+        p += store_varint(p, T_field::tag);
+        p += store_varint(p, len);
+        std::memcpy(p, data, len);
+        return true;
+    }
+
+    /**
+     * Write a repeated scalar field in packed encoding.
+     *
+     * Nothing is written if \a n is zero.
+     */
+    template <typename T_field, typename T>
+    bool write_packed(const T* vals, int n)
+    {
+        static_assert(
+            T_field::wire_type != Pb_wire_type::length_delimited,
+            "only scalar fields can be packed"
+            );
+
+        if (n <= 0)
+            return ok();
+
+        int len = 0;
+
+        if (T_field::wire_type == Pb_wire_type::varint) {
+            for (int i = 0; i < n; ++i)
+                len += varint_size(Pb_value<T_field::type>::encode(vals[i]));
+        }
+        else {
+            len = n * value_size<T_field::wire_type>(0);
+        }
+
+        uint8_t* p = writer.reserve(
+            T_field::tag_size + varint_size(len) + len
+            );
+
+        if (!p)
+            return false;
+        p += store_varint(
+            p,
+            (T_field::number << 3) |
+            static_cast<uint32_t>(Pb_wire_type::length_delimited)
+            );
+        p += store_varint(p, len);
+        for (int i = 0; i < n; ++i) {
+            p += store_value<T_field::wire_type>(
+                p, Pb_value<T_field::type>::encode(vals[i])
+                );
+        }
+        return true;
+    }
+
+    /**
+     * Start a nested message.
+     *
+     * The fields of the nested message are written with the usual
+     * methods, followed by a call to end_message().
+     *
+     * \returns
+     *      Mark to be passed to end_message().
+     */
+    template <typename T_field>
+    int begin_message()
+    {
+        static_assert(
+            T_field::wire_type == Pb_wire_type::length_delimited,
+            "nested messages must be of type bytes"
+            );
+
+        uint8_t* p = writer.reserve(T_field::tag_size + 1);
+
+        if (!p)
+            return -1;
+        store_varint(p, T_field::tag);
+        return writer.size() - 1;
+    }
+
+    /**
+     * Finish a nested message started with begin_message().
+     *
+     * One byte is reserved for the length. If the nested message is
+     * longer than 127 bytes, its content is moved to make room for the
+     * longer length.
+     */
+    bool end_message(int mark)
+    {
+        if (!ok() || (mark < 0))
+            return false;
+
+        int len = writer.size() - mark - 1;
+        int extra = varint_size(len) - 1;
+
+        if (extra > 0) {
+            if (!writer.reserve(extra))
+                return false;
+            uint8_t* payload = writer.data() + mark + 1;
+            std::memmove(payload + extra, payload, len);
+        }
+        store_varint(writer.data() + mark, len);
+        return true;
+    }
+
+    /**
+     * Test if all writes succeeded.
+     */
+    bool ok() const { return writer.ok(); }
+
+    /**
+     * Get the number of bytes written so far.
+     */
+    int size() const { return writer.size(); }
+
+    /**
+     * Get the start of the buffer.
+     */
+    uint8_t* data() const { return writer.data(); }
+
+private:
+    template <Pb_wire_type wire_type>
+    static int value_size(uint64_t x)
+    {
+        return
+            (wire_type == Pb_wire_type::fixed32) ? 4 :
+            (wire_type == Pb_wire_type::fixed64) ? 8 :
+            varint_size(x);
+    }
+
+    template <Pb_wire_type wire_type>
+    static int store_value(uint8_t* buf, uint64_t x)
+    {
+        return
+            (wire_type == Pb_wire_type::fixed32) ? store32_le(buf, x) :
+            (wire_type == Pb_wire_type::fixed64) ? store64_le(buf, x) :
+            store_varint(buf, x);
+    }
+
+    Byte_writer writer;
+};
+
+/**
+ * Class to decode a message.
+ *
+ * next() advances to the next field. The value of the current field is
+ * either read with one of the read methods or skipped via skip(). A
+ * nested message is decoded by a separate reader constructed from the
+ * span returned by read_bytes().
+ *
+ * Decoding errors (truncated data, wire type mismatch) are sticky. Once
+ * an error occurred, next() returns false and ok() reports the error.
+ */
+class Pb_reader {
+public:
+    Pb_reader(const uint8_t* buf, int len) : p{buf}, end{buf + len} {}
+
+    Pb_reader(Const_byte_span buf) : Pb_reader(buf.data(), buf.size()) {}
+
+    /**
+     * Advance to the next field.
+     *
+     * \returns
+     *      True if a field is available, false at the end of the message
+     *      or on error.
+     */
+    bool next()
+    {
+        if (failed || (p == end))
+            return false;
+
+        uint64_t tag;
+
+        if (!get_varint(tag) || ((tag >> 3) == 0) || (tag > 0xffffffffU))
+            return fail();
+        number = static_cast<uint32_t>(tag >> 3);
+        type = static_cast<Pb_wire_type>(tag & 0x07U);
+        return true;
+    }
+
+    /**
+     * Get the field number of the current field.
+     */
+    uint32_t field_number() const { return number; }
+
+    /**
+     * Get the wire type of the current field.
+     */
+    Pb_wire_type wire_type() const { return type; }
+
+    /**
+     * Read the value of a scalar field.
+     *
+     * \returns
+     *      True on success, false if the data is truncated or the wire
+     *      type does not match \a T_field.
+     */
+    template <typename T_field, typename T>
+    bool read(T& val)
+    {
+        uint64_t x;
+
+        if ((type != T_field::wire_type) || !get_value(type, x))
+            return fail();
+        Pb_value<T_field::type>::decode(val, x);
+        return true;
+    }
+
+    /**
+     * Read a length delimited field without copying it.
+     *
+     * \returns
+     *      Span onto the field content within the message buffer, or an
+     *      empty span on error.
+     */
+    Const_byte_span read_bytes()
+    {
+        uint64_t len;
+
+        if ((type != Pb_wire_type::length_delimited) ||
+            !get_varint(len) || (len > static_cast<uint64_t>(end - p))) {
+            fail();
+            return Const_byte_span{};
+        }
+
+        Const_byte_span bytes{p, static_cast<int>(len)};
+        p += len;
+        return bytes;
+    }
+
+    /**
+     * Read a repeated scalar field.
+     *
+     * Both the packed encoding and a single unpacked element are
+     * accepted, as required by the protobuf specification.
+     *
+     * \param[out] dst
+     *      Array receiving the values.
+     * \param[in] max_n
+     *      The number of elements available in \a dst.
+     *
+     * \returns
+     *      The number of values read. On error, e.g. if there are more
+     *      than \a max_n values, the reader enters the error state.
+     */
+    template <typename T_field, typename T>
+    int read_packed(T* dst, int max_n)
+    {
+        if (type == T_field::wire_type) {
+            if (max_n < 1) {
+                fail();
+                return 0;
+            }
+            return read<T_field>(dst[0]) ? 1 : 0;
+        }
+
+        Const_byte_span bytes = read_bytes();
+        const uint8_t* q = bytes.begin();
+        int n = 0;
+
+        if (!ok())
+            return 0;
+
+        while (q < bytes.end()) {
+            uint64_t x;
+
+            int len = 0;
+
+            if (n < max_n)
+                len = fetch_packed_value<T_field::wire_type>(
+                    x, q, bytes.end() - q
+                    );
+            if (len == 0) {
+                fail();
+                return n;
+            }
+            q += len;
+            Pb_value<T_field::type>::decode(dst[n++], x);
+        }
+        return n;
+    }
+
+    /**
+     * Skip the value of the current field.
+     */
+    bool skip()
+    {
+        uint64_t x;
+
+        if (type == Pb_wire_type::length_delimited) {
+            read_bytes();
+            return ok();
+        }
+        if (!get_value(type, x))
+            return fail();
+        return true;
+    }
+
+    /**
+     * Test if no decoding error occurred.
+     */
+    bool ok() const { return !failed; }
+
+    /**
+     * Test if the whole message has been consumed.
+     */
+    bool at_end() const { return p == end; }
+
+private:
+    bool fail()
+    {
+        failed = true;
+        return false;
+    }
+
+    template <Pb_wire_type wire_type>
+    static int fetch_packed_value(uint64_t& x, const uint8_t* buf, int len)
+    {
+        if (wire_type == Pb_wire_type::fixed32)
+            return (len < 4) ? 0 : fetch32_le(x, buf);
+        if (wire_type == Pb_wire_type::fixed64)
+            return (len < 8) ? 0 : fetch64_le(x, buf);
+        return fetch_varint(x, buf, len);
+    }
+
+    bool get_varint(uint64_t& x)
+    {
+        int len = fetch_varint(x, p, end - p);
+
+        p += len;
+        return len != 0;
+    }
+
+    bool get_value(Pb_wire_type wire_type, uint64_t& x)
+    {
+        switch (wire_type) {
+        case Pb_wire_type::varint:
+            return get_varint(x);
+        case Pb_wire_type::fixed32:
+            if (end - p < 4)
+                return false;
+            p += fetch32_le(x, p);
+            return true;
+        case Pb_wire_type::fixed64:
+            if (end - p < 8)
+                return false;
+            p += fetch64_le(x, p);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    const uint8_t* p;
+    const uint8_t* const end;
+    uint32_t number = 0;
+    Pb_wire_type type = Pb_wire_type::varint;
+    bool failed = false;
+};
+
+} // namespace hodea
+
+#endif /*!HODEA_PROTOBUF_HPP */
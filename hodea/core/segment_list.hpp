@@ -0,0 +1,243 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Assemble a frame from references to existing buffers.
+ *
+ * A frame usually consists of a constant header, a payload and a few
+ * variable fields like a sequence number or a CRC. Copying all of them
+ * into one contiguous buffer before sending costs RAM and CPU time,
+ * especially for large payloads.
+ *
+ * Segment_list describes the frame as a list of segments instead, each
+ * referring to an existing buffer, e.g. a header in flash (see
+ * frame_template.hpp) and the payload in place. Variable fields are
+ * encoded with the wire formats into a small RAM tail owned by the
+ * list. Consecutive fields in the tail are merged into one segment.
+ *
+ * A DMA based transmitter walks the segments and reloads the DMA
+ * channel with the next segment on each transfer complete interrupt.
+ * Transmitters without DMA support use copy_to().
+ *
+ * Example:
+ *
+ * \code
+ * Segment_list<4, 8> frame;
+ *
+ * frame.add(status_hdr.span());
+ * frame.put<Wire_le16>(payload_len);
+ * frame.add(payload, payload_len);
+ * frame.put<Wire_le32>(crc);
+ *
+ * if (frame.ok())
+ *     uart_send_dma(frame.segments());
+ * \endcode
+ *
+ * \note
+ * The referenced buffers and the list itself must remain valid until
+ * the transmission is complete.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_SEGMENT_LIST_HPP
+#define HODEA_SEGMENT_LIST_HPP
+
+#include <cstring>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/span.hpp>
+#include <hodea/core/wire_format.hpp>
+
+namespace hodea {
+
+/**
+ * A contiguous part of a frame.
+ */
+struct Segment {
+    const uint8_t* data;
+    int len;
+};
+
+/**
+ * Class describing a frame as list of segments.
+ *
+ * \tparam max_segments
+ *      Maximum number of segments.
+ * \tparam tail_capacity
+ *      Size of the RAM tail holding fields written with put().
+ */
+template <int max_segments, int tail_capacity>
+class Segment_list {
+public:
+    static_assert(max_segments > 0, "max_segments must be positive");
+    static_assert(tail_capacity > 0, "tail_capacity must be positive");
+
+    Segment_list() = default;
+
+    // segments refer to the tail of this object
+    Segment_list(const Segment_list&) = delete;
+    Segment_list& operator=(const Segment_list&) = delete;
+
+    /**
+     * Start a new frame, discarding the current one.
+     */
+    void reset()
+    {
+        num_segments = 0;
+        tail_pos = 0;
+        total_size = 0;
+        failed = false;
+    }
+
+    /**
+     * Append a reference to an existing buffer.
+     *
+     * \returns
+     *      True on success, false if the list is full or in error state.
+     */
+    bool add(const uint8_t* data, int len)
+    {
+        if (failed || (len < 0))
+            return fail();
+        if (len == 0)
+            return true;
+        if (num_segments >= max_segments)
+            return fail();
+
+        segs[num_segments++] = Segment{data, len};
+        total_size += len;
+        return true;
+    }
+
+    /**
+     * Append a reference to an existing buffer.
+     */
+    bool add(Const_byte_span data)
+    {
+        return add(data.data(), data.size());
+    }
+
+    /**
+     * Append a sequence of fixed-size fields, encoded into the tail.
+     *
+     * \tparam T_formats
+     *      Wire formats of the fields, e.g. Wire_le16.
+     * \param[in] vals
+     *      The values to write, one for each wire format.
+     *
+     * \returns
+     *      True on success, false if the tail or the list is full or the
+     *      list is in error state.
+     */
+    template <typename... T_formats, typename... T_vals>
+    bool put(const T_vals&... vals)
+    {
+        static_assert(
+            sizeof...(T_formats) == sizeof...(T_vals),
+            "number of formats and values differ"
+            );
+
+        uint8_t* p = reserve(Wire_size<T_formats...>::value);
+
+        if (!p)
+            return false;
+        put_at<0, T_formats...>(p, vals...);
+        return true;
+    }
+
+    /**
+     * Reserve space in the tail to be filled by the caller.
+     *
+     * \returns
+     *      Pointer to the reserved space, or nullptr on error.
+     */
+    uint8_t* reserve(int len)
+    {
+        if (failed || (len < 0) || (len > tail_capacity - tail_pos)) {
+            fail();
+            return nullptr;
+        }
+
+        uint8_t* p = tail + tail_pos;
+
+        if ((num_segments > 0) &&
+            (segs[num_segments - 1].data + segs[num_segments - 1].len == p)) {
+            segs[num_segments - 1].len += len;
+        }
+        else if (len > 0) {
+            if (num_segments >= max_segments) {
+                fail();
+                return nullptr;
+            }
+            segs[num_segments++] = Segment{p, len};
+        }
+        tail_pos += len;
+        total_size += len;
+        return p;
+    }
+
+    /**
+     * Copy the frame into a contiguous buffer.
+     *
+     * \returns
+     *      The size of the frame, or -1 if \a capacity is too small or
+     *      the list is in error state.
+     */
+    int copy_to(uint8_t* dst, int capacity) const
+    {
+        if (failed || (total_size > capacity))
+            return -1;
+
+        for (int i = 0; i < num_segments; ++i) {
+            std::memcpy(dst, segs[i].data, segs[i].len);
+            dst += segs[i].len;
+        }
+        return total_size;
+    }
+
+    /**
+     * Test if all accesses succeeded.
+     */
+    bool ok() const { return !failed; }
+
+    /**
+     * Get the total size of the frame.
+     */
+    int size() const { return total_size; }
+
+    /**
+     * Get the segments of the frame.
+     */
+    Span<const Segment> segments() const
+    {
+        return Span<const Segment>{segs, num_segments};
+    }
+
+private:
+    bool fail()
+    {
+        failed = true;
+        return false;
+    }
+
+    template <int offs>
+    static void put_at(uint8_t*) {}
+
+    template <int offs, typename T_format, typename... T_rest,
+              typename T_val, typename... T_vals>
+    static void put_at(uint8_t* p, const T_val& val, const T_vals&... vals)
+    {
+        T_format::store(p + offs, val);
+        put_at<offs + T_format::size, T_rest...>(p, vals...);
+    }
+
+    Segment segs[max_segments];
+    uint8_t tail[tail_capacity];
+    int num_segments = 0;
+    int tail_pos = 0;
+    int total_size = 0;
+    bool failed = false;
+};
+
+} // namespace hodea
+
+#endif /*!HODEA_SEGMENT_LIST_HPP */
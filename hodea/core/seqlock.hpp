@@ -0,0 +1,114 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Sequence lock to share data between an interrupt and the main loop.
+ *
+ * A sequence lock allows a single writer to update a data structure
+ * without blocking, while readers detect an update which happened
+ * during their read access and simply retry. Neither side has to
+ * disable the global interrupt.
+ *
+ * The writer increments a sequence counter before and after modifying
+ * the data. An odd counter value signals that an update is in progress.
+ * A reader samples the counter, copies the data and samples the counter
+ * again. If the counter values differ or are odd, the copy may be
+ * inconsistent and the read is repeated.
+ *
+ * Typical use case: An interrupt service routine updates statistics,
+ * the main loop reads them.
+ *
+ * \note
+ * The implementation targets single core MCUs. The writer must run with
+ * a higher priority than the readers, i.e. it must never be preempted by
+ * a reader. Otherwise the reader would spin forever. Therefore,
+ * std::atomic_signal_fence() is sufficient to order the memory accesses.
+ * See also Critical_section.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_SEQLOCK_HPP
+#define HODEA_SEQLOCK_HPP
+
+#include <atomic>
+#include <type_traits>
+
+namespace hodea {
+
+/**
+ * Class to protect data of type \a T via a sequence lock.
+ *
+ * \a T must be trivially copyable, as readers copy the data while it may
+ * be modified.
+ */
+template <typename T>
+class Seqlock {
+public:
+    static_assert(
+        std::is_trivially_copyable<T>::value,
+        "T must be trivially copyable"
+        );
+
+    /**
+     * Modify the protected data in place [writer].
+     *
+     * \param[in] modify
+     *      Callable invoked with a reference to the protected data.
+     */
+    template <typename F>
+    void modify(F&& modify)
+    {
+        unsigned seq = sequence.load(std::memory_order_relaxed);
+
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+
+        modify(data);
+
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        sequence.store(seq + 2, std::memory_order_relaxed);
+    }
+
+    /**
+     * Replace the protected data [writer].
+     */
+    void store(const T& val)
+    {
+        modify([&val](T& d) { d = val; });
+    }
+
+    /**
+     * Get a consistent copy of the protected data [reader].
+     */
+    T load() const
+    {
+        T copy;
+        unsigned seq;
+
+        do {
+            seq = sequence.load(std::memory_order_relaxed);
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            copy = data;
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+        } while ((seq & 1) ||
+                 (seq != sequence.load(std::memory_order_relaxed)));
+
+        return copy;
+    }
+
+    /**
+     * Direct access to the protected data [writer].
+     *
+     * Only the writer is allowed to read the data without sequence
+     * check, as it is the only one modifying it.
+     */
+    const T& writer_view() const { return data; }
+
+private:
+    std::atomic<unsigned> sequence{0};
+    T data{};
+};
+
+} // namespace hodea
+
+#endif /*!HODEA_SEQLOCK_HPP */
@@ -38,11 +38,16 @@
  * strcpy() library functions, i.e. the first parameter gives the
  * destination, the second the source.
  *
+ * Floating point numbers are handled by the store_f32_le(), etc.
+ * functions, which transfer the IEEE-754 bit pattern unchanged. For
+ * fixed-point numbers see fixed_point.hpp.
+ *
  * \author f.hollerer@hodea.org
  */
 #if !defined HODEA_SERIALIZATION_HPP
 #define HODEA_SERIALIZATION_HPP
 
+#include <cstring>
 #include <type_traits>
 #include <hodea/core/cstdint.hpp>
 
@@ -61,11 +66,9 @@ template <
     typename T,
     typename = typename std::enable_if<std::is_integral<T>::value>::type
     >
-int fetch8(T& dst, const uint8_t *buf)
+constexpr int fetch8(T& dst, const uint8_t *buf)
 {
-    uint8_t v;
-
-    v = *buf;
+    const uint8_t v = *buf;
     dst = v;
     return sizeof(v);
 }
@@ -83,11 +86,9 @@ template <
     typename T,
     typename = typename std::enable_if<std::is_integral<T>::value>::type
     >
-int fetch16_le(T& dst, const uint8_t *buf)
+constexpr int fetch16_le(T& dst, const uint8_t *buf)
 {
-    uint16_t v;
-
-    v = (static_cast<uint16_t>(buf[1]) << 8) | buf[0];
+    const uint16_t v = (static_cast<uint16_t>(buf[1]) << 8) | buf[0];
     dst = v;
     return sizeof(v);
 }
@@ -105,11 +106,10 @@ template <
     typename T,
     typename = typename std::enable_if<std::is_integral<T>::value>::type
     >
-int fetch32_le(T& dst, const uint8_t *buf)
+constexpr int fetch32_le(T& dst, const uint8_t *buf)
 {
-    uint32_t v;
-
-    v = (static_cast<uint32_t>(buf[3]) << 24) |
+    const uint32_t v =
+        (static_cast<uint32_t>(buf[3]) << 24) |
         (static_cast<uint32_t>(buf[2]) << 16) |
         (static_cast<uint32_t>(buf[1]) << 8)  |
         buf[0];
@@ -131,11 +131,10 @@ template <
     typename T,
     typename = typename std::enable_if<std::is_integral<T>::value>::type
     >
-int fetch64_le(T& dst, const uint8_t *buf)
+constexpr int fetch64_le(T& dst, const uint8_t *buf)
 {
-    uint64_t v;
-
-    v = (static_cast<uint64_t>(buf[7]) << 56) |
+    const uint64_t v =
+        (static_cast<uint64_t>(buf[7]) << 56) |
         (static_cast<uint64_t>(buf[6]) << 48) |
         (static_cast<uint64_t>(buf[5]) << 40) |
         (static_cast<uint64_t>(buf[4]) << 32) |
@@ -161,11 +160,9 @@ template <
     typename T,
     typename = typename std::enable_if<std::is_integral<T>::value>::type
     >
-int fetch16_be(T& dst, const uint8_t *buf)
+constexpr int fetch16_be(T& dst, const uint8_t *buf)
 {
-    uint16_t v;
-
-    v = (static_cast<uint16_t>(buf[0]) << 8) | buf[1];
+    const uint16_t v = (static_cast<uint16_t>(buf[0]) << 8) | buf[1];
     dst = v;
     return sizeof(v);
 }
@@ -183,11 +180,10 @@ template <
     typename T,
     typename = typename std::enable_if<std::is_integral<T>::value>::type
     >
-int fetch32_be(T& dst, const uint8_t *buf)
+constexpr int fetch32_be(T& dst, const uint8_t *buf)
 {
-    uint32_t v;
-
-    v = (static_cast<uint32_t>(buf[0]) << 24) |
+    const uint32_t v =
+        (static_cast<uint32_t>(buf[0]) << 24) |
         (static_cast<uint32_t>(buf[1]) << 16) |
         (static_cast<uint32_t>(buf[2]) << 8)  |
         buf[3];
@@ -209,11 +205,10 @@ template <
     typename T,
     typename = typename std::enable_if<std::is_integral<T>::value>::type
     >
-int fetch64_be(T& dst, const uint8_t *buf)
+constexpr int fetch64_be(T& dst, const uint8_t *buf)
 {
-    uint64_t v;
-
-    v = (static_cast<uint64_t>(buf[0]) << 56) |
+    const uint64_t v =
+        (static_cast<uint64_t>(buf[0]) << 56) |
         (static_cast<uint64_t>(buf[1]) << 48) |
         (static_cast<uint64_t>(buf[2]) << 40) |
         (static_cast<uint64_t>(buf[3]) << 32) |
@@ -239,7 +234,7 @@ template <
     typename T,
     typename = typename std::enable_if<std::is_integral<T>::value>::type
     >
-int store8(uint8_t *buf, const T val)
+constexpr int store8(uint8_t *buf, const T val)
 {
     const uint8_t uval = val;
 
@@ -260,7 +255,7 @@ template <
     typename T,
     typename = typename std::enable_if<std::is_integral<T>::value>::type
     >
-int store16_le(uint8_t *buf, const T val)
+constexpr int store16_le(uint8_t *buf, const T val)
 {
     const uint16_t uval = val;
 
@@ -282,7 +277,7 @@ template <
     typename T,
     typename = typename std::enable_if<std::is_integral<T>::value>::type
     >
-static inline int store32_le(uint8_t *buf, const T val)
+static inline constexpr int store32_le(uint8_t *buf, const T val)
 {
     const uint32_t uval = val;
 
@@ -306,7 +301,7 @@ template <
     typename T,
     typename = typename std::enable_if<std::is_integral<T>::value>::type
     >
-static inline int store64_le(uint8_t *buf, const T val)
+static inline constexpr int store64_le(uint8_t *buf, const T val)
 {
     const uint64_t uval = val;
 
@@ -334,7 +329,7 @@ template <
     typename T,
     typename = typename std::enable_if<std::is_integral<T>::value>::type
     >
-int store16_be(uint8_t *buf, const T val)
+constexpr int store16_be(uint8_t *buf, const T val)
 {
     const uint16_t uval = val;
 
@@ -356,7 +351,7 @@ template <
     typename T,
     typename = typename std::enable_if<std::is_integral<T>::value>::type
     >
-static inline int store32_be(uint8_t *buf, const T val)
+static inline constexpr int store32_be(uint8_t *buf, const T val)
 {
     const uint32_t uval = val;
 
@@ -380,7 +375,7 @@ template <
     typename T,
     typename = typename std::enable_if<std::is_integral<T>::value>::type
     >
-static inline int store64_be(uint8_t *buf, const T val)
+static inline constexpr int store64_be(uint8_t *buf, const T val)
 {
     const uint64_t uval = val;
 
@@ -395,6 +390,187 @@ static inline int store64_be(uint8_t *buf, const T val)
     return sizeof(uval);
 }
 
+static_assert(
+    sizeof(float) == 4,
+    "float is expected to be an IEEE-754 single precision number"
+    );
+static_assert(
+    sizeof(double) == 8,
+    "double is expected to be an IEEE-754 double precision number"
+    );
+
+/**
+ * Extract a 32 bit IEEE-754 floating point number stored in
+ * little endian format (LSB first).
+ *
+ * The bit pattern is copied unchanged, so no floating point arithmetic
+ * is involved.
+ *
+ * param[out] dst Target variable.
+ * param[in] buf  Source buffer holding the number.
+ *
+ * \returns
+ *      The number of bytes read from \a buf.
+ */
+static inline int fetch_f32_le(float& dst, const uint8_t *buf)
+{
+    uint32_t bits;
+    int len = fetch32_le(bits, buf);
+
+    std::memcpy(&dst, &bits, sizeof(dst));
+    return len;
+}
+
+/**
+ * Extract a 32 bit IEEE-754 floating point number stored in
+ * big endian format (MSB first).
+ *
+ * The bit pattern is copied unchanged, so no floating point arithmetic
+ * is involved.
+ *
+ * param[out] dst Target variable.
+ * param[in] buf  Source buffer holding the number.
+ *
+ * \returns
+ *      The number of bytes read from \a buf.
+ */
+static inline int fetch_f32_be(float& dst, const uint8_t *buf)
+{
+    uint32_t bits;
+    int len = fetch32_be(bits, buf);
+
+    std::memcpy(&dst, &bits, sizeof(dst));
+    return len;
+}
+
+/**
+ * Extract a 64 bit IEEE-754 floating point number stored in
+ * little endian format (LSB first).
+ *
+ * The bit pattern is copied unchanged, so no floating point arithmetic
+ * is involved.
+ *
+ * param[out] dst Target variable.
+ * param[in] buf  Source buffer holding the number.
+ *
+ * \returns
+ *      The number of bytes read from \a buf.
+ */
+static inline int fetch_f64_le(double& dst, const uint8_t *buf)
+{
+    uint64_t bits;
+    int len = fetch64_le(bits, buf);
+
+    std::memcpy(&dst, &bits, sizeof(dst));
+    return len;
+}
+
+/**
+ * Extract a 64 bit IEEE-754 floating point number stored in
+ * big endian format (MSB first).
+ *
+ * The bit pattern is copied unchanged, so no floating point arithmetic
+ * is involved.
+ *
+ * param[out] dst Target variable.
+ * param[in] buf  Source buffer holding the number.
+ *
+ * \returns
+ *      The number of bytes read from \a buf.
+ */
+static inline int fetch_f64_be(double& dst, const uint8_t *buf)
+{
+    uint64_t bits;
+    int len = fetch64_be(bits, buf);
+
+    std::memcpy(&dst, &bits, sizeof(dst));
+    return len;
+}
+
+/**
+ * Store a 32 bit IEEE-754 floating point number in
+ * little endian format (LSB first).
+ *
+ * The bit pattern is copied unchanged, so no floating point arithmetic
+ * is involved.
+ *
+ * param[out] buf Target buffer.
+ * param[in] val The value to store.
+ *
+ * \returns
+ *      The number of bytes written into \a buf.
+ */
+static inline int store_f32_le(uint8_t *buf, const float val)
+{
+    uint32_t bits;
+
+    std::memcpy(&bits, &val, sizeof(bits));
+    return store32_le(buf, bits);
+}
+
+/**
+ * Store a 32 bit IEEE-754 floating point number in
+ * big endian format (MSB first).
+ *
+ * The bit pattern is copied unchanged, so no floating point arithmetic
+ * is involved.
+ *
+ * param[out] buf Target buffer.
+ * param[in] val The value to store.
+ *
+ * \returns
+ *      The number of bytes written into \a buf.
+ */
+static inline int store_f32_be(uint8_t *buf, const float val)
+{
+    uint32_t bits;
+
+    std::memcpy(&bits, &val, sizeof(bits));
+    return store32_be(buf, bits);
+}
+
+/**
+ * Store a 64 bit IEEE-754 floating point number in
+ * little endian format (LSB first).
+ *
+ * The bit pattern is copied unchanged, so no floating point arithmetic
+ * is involved.
+ *
+ * param[out] buf Target buffer.
+ * param[in] val The value to store.
+ *
+ * \returns
+ *      The number of bytes written into \a buf.
+ */
+static inline int store_f64_le(uint8_t *buf, const double val)
+{
+    uint64_t bits;
+
+    std::memcpy(&bits, &val, sizeof(bits));
+    return store64_le(buf, bits);
+}
+
+/**
+ * Store a 64 bit IEEE-754 floating point number in
+ * big endian format (MSB first).
+ *
+ * The bit pattern is copied unchanged, so no floating point arithmetic
+ * is involved.
+ *
+ * param[out] buf Target buffer.
+ * param[in] val The value to store.
+ *
+ * \returns
+ *      The number of bytes written into \a buf.
+ */
+static inline int store_f64_be(uint8_t *buf, const double val)
+{
+    uint64_t bits;
+
+    std::memcpy(&bits, &val, sizeof(bits));
+    return store64_be(buf, bits);
+}
+
 } // namespace hodea
 
 #endif /*!HODEA_SERIALIZATION_HPP */
@@ -0,0 +1,144 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Functions to serialize and deserialize arrays of numbers.
+ *
+ * These are the bulk counterparts of the store and fetch functions in
+ * serialization.hpp, intended e.g. for blocks of ADC samples. If the
+ * requested byte order matches the CPU byte order the array is copied
+ * via memcpy(), otherwise the bytes are swapped with the fastest method
+ * available (see bulk_uswap.hpp).
+ *
+ * Example:
+ *
+ * \code
+ * uint16_t samples[256];
+ * uint8_t buf[sizeof(samples)];
+ * :
+ * int len = store_array_be(buf, samples, 256);
+ * send_msg(buf, len);
+ * \endcode
+ *
+ * \note
+ * As in serialization.hpp, the first parameter gives the destination,
+ * the second the source.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_SERIALIZATION_ARRAY_HPP
+#define HODEA_SERIALIZATION_ARRAY_HPP
+
+#include <cstring>
+#include <type_traits>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/bulk_uswap.hpp>
+#include <hodea/core/cpu_endian.hpp>
+
+namespace hodea {
+
+/**
+ * Copy an array, swapping bytes if \a swap is true.
+ */
+template <typename T>
+static inline int copy_array_swap_if(
+    void* dst, const void* src, int n, bool swap)
+{
+    if (swap)
+        uswap_copy<sizeof(T)>(dst, src, n);
+    else
+        std::memcpy(dst, src, n * sizeof(T));
+    return n * sizeof(T);
+}
+
+/**
+ * Store an array of numbers in little endian format (LSB first).
+ *
+ * \param[out] buf
+ *      Target buffer.
+ * \param[in] src
+ *      Array holding the numbers.
+ * \param[in] n
+ *      The number of array elements.
+ *
+ * \returns
+ *      The number of bytes written to \a buf.
+ */
+template <
+    typename T,
+    typename = typename std::enable_if<std::is_integral<T>::value>::type
+    >
+int store_array_le(uint8_t* buf, const T* src, int n)
+{
+    return copy_array_swap_if<T>(buf, src, n, !is_cpu_le());
+}
+
+/**
+ * Store an array of numbers in big endian format (MSB first).
+ *
+ * \param[out] buf
+ *      Target buffer.
+ * \param[in] src
+ *      Array holding the numbers.
+ * \param[in] n
+ *      The number of array elements.
+ *
+ * \returns
+ *      The number of bytes written to \a buf.
+ */
+template <
+    typename T,
+    typename = typename std::enable_if<std::is_integral<T>::value>::type
+    >
+int store_array_be(uint8_t* buf, const T* src, int n)
+{
+    return copy_array_swap_if<T>(buf, src, n, !is_cpu_be());
+}
+
+/**
+ * Extract an array of numbers stored in little endian format.
+ *
+ * \param[out] dst
+ *      Target array.
+ * \param[in] buf
+ *      Source buffer holding the numbers.
+ * \param[in] n
+ *      The number of array elements.
+ *
+ * \returns
+ *      The number of bytes read from \a buf.
+ */
+template <
+    typename T,
+    typename = typename std::enable_if<std::is_integral<T>::value>::type
+    >
+int fetch_array_le(T* dst, const uint8_t* buf, int n)
+{
+    return copy_array_swap_if<T>(dst, buf, n, !is_cpu_le());
+}
+
+/**
+ * Extract an array of numbers stored in big endian format.
+ *
+ * \param[out] dst
+ *      Target array.
+ * \param[in] buf
+ *      Source buffer holding the numbers.
+ * \param[in] n
+ *      The number of array elements.
+ *
+ * \returns
+ *      The number of bytes read from \a buf.
+ */
+template <
+    typename T,
+    typename = typename std::enable_if<std::is_integral<T>::value>::type
+    >
+int fetch_array_be(T* dst, const uint8_t* buf, int n)
+{
+    return copy_array_swap_if<T>(dst, buf, n, !is_cpu_be());
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_SERIALIZATION_ARRAY_HPP */
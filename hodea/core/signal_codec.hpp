@@ -0,0 +1,350 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Extract and insert signals at arbitrary bit positions of a frame.
+ *
+ * CAN frames and similar protocols pack signals at arbitrary bit offsets
+ * and with arbitrary widths, either in Intel (little endian) or Motorola
+ * (big endian) byte order. This file provides a codec for such signals
+ * following the conventions of the DBC file format:
+ *
+ * - Bits are numbered from 0 to 8 * n - 1, where bit \a i is bit
+ *   \a i % 8 of byte \a i / 8.
+ * - For Intel signals the start bit gives the least significant bit of
+ *   the signal. The signal continues at higher bit numbers.
+ * - For Motorola signals the start bit gives the most significant bit of
+ *   the signal. The signal continues towards bit 0 of the same byte and
+ *   then at bit 7 of the following byte.
+ * - The physical value is phys = raw * factor + offset.
+ *
+ * The signal is described by a constexpr Signal_descriptor. As all
+ * parameters are known at compile time, the compiler reduces an access
+ * to a few byte loads, shifts and masks. Within the loaded bytes the
+ * signal is handled as bit field via Bitfield_descriptor.
+ *
+ * The factor is given in fixed point, so no floating point arithmetic is
+ * required at run time. Use signal_scale() to convert a floating point
+ * factor at compile time.
+ *
+ * Example:
+ *
+ * \code
+ * // SG_ Motor_current : 12|14@1- (0.05,-100) [-100|300] "A" ECU
+ * constexpr Signal_descriptor motor_current{
+ *     12, 14, Signal_order::intel, true, signal_scale(0.05, 16), 16, -100
+ *     };
+ *
+ * int32_t current = get_signal_phys(frame.data, motor_current);
+ * set_signal_raw(frame.data, motor_current, 0x1234);
+ * \endcode
+ *
+ * For sequential non-aligned fields see bitstream.hpp.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_SIGNAL_CODEC_HPP
+#define HODEA_SIGNAL_CODEC_HPP
+
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/bitfield.hpp>
+
+namespace hodea {
+
+/**
+ * Byte order of a signal.
+ */
+enum struct Signal_order {
+    intel,              // little endian
+    motorola            // big endian
+};
+
+/**
+ * Convert a floating point factor into fixed point at compile time.
+ *
+ * \param[in] factor
+ *      The factor.
+ * \param[in] shift
+ *      The number of fractional bits.
+ */
+constexpr int32_t signal_scale(double factor, int shift)
+{
+    return static_cast<int32_t>(
+        factor * static_cast<double>(1ULL << shift) +
+        ((factor < 0) ? -0.5 : 0.5)
+        );
+}
+
+/**
+ * Class describing position, size and scaling of a signal.
+ *
+ * \note
+ * The signal must not span more than 8 bytes, i.e. the bit offset of
+ * the signal within its first byte plus its length must not exceed 64.
+ * This holds for all signals up to a length of 57 bits, and for all
+ * byte aligned signals. Define the descriptors constexpr, so that
+ * invalid parameters are rejected at compile time.
+ */
+class Signal_descriptor {
+public:
+    /**
+     * Constructor.
+     *
+     * \param[in] start_bit
+     *      Start bit as given in the DBC file.
+     * \param[in] length
+     *      Length of the signal in bits, 1 to 64.
+     * \param[in] order
+     *      Byte order of the signal.
+     * \param[in] is_signed
+     *      True if the raw value is in two's complement.
+     * \param[in] scale
+     *      Factor to convert the raw into the physical value, in fixed
+     *      point with \a scale_shift fractional bits. Must not be 0.
+     * \param[in] scale_shift
+     *      Number of fractional bits of \a scale, 0 to 30.
+     * \param[in] offset
+     *      Offset added to get the physical value.
+     */
+    constexpr Signal_descriptor(
+        int start_bit, int length, Signal_order order, bool is_signed,
+        int32_t scale = 1, int scale_shift = 0, int32_t offset = 0
+        ) :
+        length{checked_length(length)},
+        is_signed{is_signed},
+        scale{checked_scale(scale)},
+        scale_shift{checked_scale_shift(scale_shift)},
+        offset{offset},
+        first_byte{
+            (order == Signal_order::intel) ?
+            checked_start_bit(start_bit) / 8 :
+            msb_index(checked_start_bit(start_bit)) / 8
+            },
+        num_bytes{checked_num_bytes((
+            ((order == Signal_order::intel) ?
+             start_bit % 8 : msb_index(start_bit) % 8) + length + 7
+            ) / 8)},
+        order{order},
+        field{
+            (order == Signal_order::intel) ?
+            start_bit % 8 :
+            num_bytes * 8 - msb_index(start_bit) % 8 - length,
+            (length == 64) ? ~0ULL : (1ULL << length) - 1
+            }
+    {}
+
+    const int length;
+    const bool is_signed;
+    const int32_t scale;
+    const int scale_shift;
+    const int32_t offset;
+
+    const int first_byte;       // first byte occupied by the signal
+    const int num_bytes;        // number of bytes occupied
+    const Signal_order order;
+
+    /**
+     * Position and mask of the signal within the occupied bytes, loaded
+     * as integer in the byte order of the signal.
+     */
+    const Bitfield_descriptor<uint64_t> field;
+
+private:
+    /*
+     * The checks fail in a constant expression by calling the
+     * non-constexpr error functions below. A throw expression would do
+     * as well, but is not available with -fno-exceptions.
+     */
+    static constexpr int checked_start_bit(int start_bit)
+    {
+        return (start_bit >= 0) ?
+            start_bit : signal_start_bit_is_negative(start_bit);
+    }
+
+    static constexpr int checked_length(int length)
+    {
+        return ((length >= 1) && (length <= 64)) ?
+            length : signal_length_is_not_1_to_64(length);
+    }
+
+    static constexpr int checked_num_bytes(int num_bytes)
+    {
+        return (num_bytes <= 8) ?
+            num_bytes : signal_spans_more_than_8_bytes(num_bytes);
+    }
+
+    static constexpr int32_t checked_scale(int32_t scale)
+    {
+        return (scale != 0) ? scale : signal_scale_is_zero(scale);
+    }
+
+    // keeps (phys - offset) << scale_shift within 64 bits
+    static constexpr int checked_scale_shift(int scale_shift)
+    {
+        return ((scale_shift >= 0) && (scale_shift <= 30)) ?
+            scale_shift : signal_scale_shift_is_not_0_to_30(scale_shift);
+    }
+
+    static int signal_start_bit_is_negative(int start_bit)
+    {
+        return start_bit;
+    }
+
+    static int signal_length_is_not_1_to_64(int length)
+    {
+        return length;
+    }
+
+    static int signal_spans_more_than_8_bytes(int num_bytes)
+    {
+        return num_bytes;
+    }
+
+    static int32_t signal_scale_is_zero(int32_t scale)
+    {
+        return scale;
+    }
+
+    static int signal_scale_shift_is_not_0_to_30(int scale_shift)
+    {
+        return scale_shift;
+    }
+
+    /*
+     * Motorola signals are easier to handle with bits numbered in
+     * transmission order, i.e. bit 0 is the MSB of byte 0.
+     */
+    static constexpr int msb_index(int start_bit)
+    {
+        return (start_bit / 8) * 8 + 7 - start_bit % 8;
+    }
+};
+
+/**
+ * Load the bytes occupied by a signal.
+ */
+static inline uint64_t load_signal_bytes(
+    const uint8_t* buf, const Signal_descriptor& sd)
+{
+    const uint8_t* p = buf + sd.first_byte;
+    uint64_t v = 0;
+
+    if (sd.order == Signal_order::intel) {
+        for (int i = sd.num_bytes - 1; i >= 0; --i)
+            v = (v << 8) | p[i];
+    }
+    else {
+        for (int i = 0; i < sd.num_bytes; ++i)
+            v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+/**
+ * Store the bytes occupied by a signal.
+ */
+static inline void store_signal_bytes(
+    uint8_t* buf, const Signal_descriptor& sd, uint64_t v)
+{
+    uint8_t* p = buf + sd.first_byte;
+
+    if (sd.order == Signal_order::intel) {
+        for (int i = 0; i < sd.num_bytes; ++i, v >>= 8)
+            p[i] = static_cast<uint8_t>(v);
+    }
+    else {
+        for (int i = sd.num_bytes - 1; i >= 0; --i, v >>= 8)
+            p[i] = static_cast<uint8_t>(v);
+    }
+}
+
+/**
+ * Extract the raw value of a signal.
+ *
+ * \param[in] buf
+ *      The frame holding the signal.
+ * \param[in] sd
+ *      The signal descriptor.
+ *
+ * \returns
+ *      The raw value, sign extended if the signal is signed.
+ */
+static inline int64_t get_signal_raw(
+    const uint8_t* buf, const Signal_descriptor& sd)
+{
+    uint64_t raw = fld2val(load_signal_bytes(buf, sd), sd.field);
+
+    if (sd.is_signed && (sd.length < 64)) {
+        uint64_t sign = 1ULL << (sd.length - 1);
+        raw = (raw ^ sign) - sign;
+    }
+    return static_cast<int64_t>(raw);
+}
+
+/**
+ * Insert the raw value of a signal.
+ *
+ * The other bits of the frame are preserved.
+ *
+ * \param[in,out] buf
+ *      The frame holding the signal.
+ * \param[in] sd
+ *      The signal descriptor.
+ * \param[in] raw
+ *      The raw value. Bits not fitting into the signal are discarded.
+ */
+static inline void set_signal_raw(
+    uint8_t* buf, const Signal_descriptor& sd, int64_t raw)
+{
+    uint64_t v = load_signal_bytes(buf, sd);
+
+    v = (v & ~sd.field.msk) |
+        val2fld(static_cast<uint64_t>(raw), sd.field.pos, sd.field.msk);
+    store_signal_bytes(buf, sd, v);
+}
+
+/**
+ * Extract the physical value of a signal.
+ *
+ * \returns
+ *      raw * factor + offset, rounded to nearest.
+ */
+static inline int32_t get_signal_phys(
+    const uint8_t* buf, const Signal_descriptor& sd)
+{
+    int64_t v = get_signal_raw(buf, sd) * sd.scale;
+
+    if (sd.scale_shift > 0)
+        v = (v + (1LL << (sd.scale_shift - 1))) >> sd.scale_shift;
+    return static_cast<int32_t>(v + sd.offset);
+}
+
+/**
+ * Insert the physical value of a signal.
+ *
+ * The raw value is rounded to nearest.
+ *
+ * \note
+ * This requires an integer division unless the factor is 1.
+ */
+static inline void set_signal_phys(
+    uint8_t* buf, const Signal_descriptor& sd, int32_t phys)
+{
+    int64_t v = static_cast<int64_t>(phys) - sd.offset;
+
+    if ((sd.scale != 1) || (sd.scale_shift != 0)) {
+        int64_t num = v * (1LL << sd.scale_shift);
+        int64_t den = sd.scale;
+
+        if (den < 0) {
+            num = -num;
+            den = -den;
+        }
+        v = (num + ((num < 0) ? -den / 2 : den / 2)) / den;
+    }
+    set_signal_raw(buf, sd, v);
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_SIGNAL_CODEC_HPP */
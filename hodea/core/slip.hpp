@@ -0,0 +1,323 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Serial Line Internet Protocol (SLIP) framing according RFC 1055.
+ *
+ * SLIP terminates each frame with the END character (0xc0). END and ESC
+ * (0xdb) characters within the frame are replaced by the sequences
+ * ESC ESC_END respectively ESC ESC_ESC. In contrast to COBS (see
+ * cobs.hpp) the overhead depends on the data and is up to 100%, but the
+ * encoder does not need to look ahead.
+ *
+ * The classes have the same interface as their COBS counterparts:
+ *
+ * - Slip_encoder encodes a frame passed in one or several chunks into
+ *   an output buffer.
+ * - Slip_decoder decodes the received bytes incrementally.
+ * - slip_decode() decodes a complete frame, optionally in place.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_SLIP_HPP
+#define HODEA_SLIP_HPP
+
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/span.hpp>
+
+namespace hodea {
+
+/**
+ * Special characters used by SLIP.
+ */
+constexpr uint8_t slip_end = 0xc0;
+constexpr uint8_t slip_esc = 0xdb;
+constexpr uint8_t slip_esc_end = 0xdc;
+constexpr uint8_t slip_esc_esc = 0xdd;
+
+/**
+ * Class to encode a frame with SLIP.
+ */
+class Slip_encoder {
+public:
+    /**
+     * Get the maximum size of an encoded frame including delimiters.
+     */
+    static constexpr int max_encoded_size(int len)
+    {
+        return 2 * len + 2;
+    }
+
+    /**
+     * Constructor.
+     *
+     * \param[in] buf
+     *      Buffer receiving the encoded frame.
+     * \param[in] capacity
+     *      The size of \a buf.
+     * \param[in] leading_end
+     *      If true, each frame starts with an END character, as
+     *      recommended by RFC 1055 to flush line noise at the receiver.
+     */
+    Slip_encoder(uint8_t* buf, int capacity, bool leading_end = true)
+        : buf{buf}, capacity{capacity}, leading_end{leading_end}
+    {
+        reset();
+    }
+
+    Slip_encoder(Byte_span buf, bool leading_end = true)
+        : Slip_encoder(buf.data(), buf.size(), leading_end)
+    {}
+
+    template <std::size_t N>
+    Slip_encoder(uint8_t (&buf)[N], bool leading_end = true)
+        : Slip_encoder(buf, N, leading_end)
+    {}
+
+    /**
+     * Start a new frame, discarding the current one.
+     */
+    void reset()
+    {
+        pos = 0;
+        failed = false;
+        if (leading_end)
+            emit(slip_end);
+    }
+
+    /**
+     * Append a byte to the frame.
+     */
+    bool put(uint8_t byte)
+    {
+        switch (byte) {
+        case slip_end:
+            return emit(slip_esc, slip_esc_end);
+        case slip_esc:
+            return emit(slip_esc, slip_esc_esc);
+        default:
+            return emit(byte);
+        }
+    }
+
+    /**
+     * Append a sequence of bytes to the frame.
+     */
+    bool put(const uint8_t* data, int len)
+    {
+        for (int i = 0; i < len; ++i) {
+            if (!put(data[i]))
+                return false;
+        }
+        return ok();
+    }
+
+    /**
+     * Complete the frame by appending the END character.
+     */
+    bool finish()
+    {
+        return emit(slip_end);
+    }
+
+    /**
+     * Test if all bytes fitted into the buffer.
+     */
+    bool ok() const { return !failed; }
+
+    /**
+     * Get the size of the encoded frame.
+     */
+    int size() const { return pos; }
+
+private:
+    bool emit(uint8_t byte)
+    {
+        if (failed || (pos >= capacity)) {
+            failed = true;
+            return false;
+        }
+        buf[pos++] = byte;
+        return true;
+    }
+
+    bool emit(uint8_t byte1, uint8_t byte2)
+    {
+        if (failed || (pos + 1 >= capacity)) {
+            failed = true;
+            return false;
+        }
+        buf[pos++] = byte1;
+        buf[pos++] = byte2;
+        return true;
+    }
+
+    uint8_t* const buf;
+    const int capacity;
+    const bool leading_end;
+    int pos;
+    bool failed;
+};
+
+/**
+ * Class to decode SLIP frames incrementally.
+ *
+ * Frames exceeding the buffer and invalid escape sequences are reported
+ * as error. The decoder resynchronizes at the next END character. Empty
+ * frames are ignored.
+ */
+class Slip_decoder {
+public:
+    enum struct Status {
+        pending,        // frame not yet complete
+        complete,       // frame received
+        error           // frame dropped
+    };
+
+    Slip_decoder(uint8_t* buf, int capacity)
+        : buf{buf}, capacity{capacity}
+    {}
+
+    Slip_decoder(Byte_span buf) : Slip_decoder(buf.data(), buf.size()) {}
+
+    template <std::size_t N>
+    Slip_decoder(uint8_t (&buf)[N]) : Slip_decoder(buf, N) {}
+
+    /**
+     * Process a received byte.
+     */
+    Status put(uint8_t byte)
+    {
+        if (is_complete)
+            restart();
+
+        if (byte == slip_end)
+            return end_of_frame();
+        if (failed)
+            return Status::pending;
+
+        if (is_escaped) {
+            is_escaped = false;
+            if (byte == slip_esc_end)
+                append(slip_end);
+            else if (byte == slip_esc_esc)
+                append(slip_esc);
+            else
+                failed = true;
+        }
+        else if (byte == slip_esc) {
+            is_escaped = true;
+        }
+        else {
+            append(byte);
+        }
+        return Status::pending;
+    }
+
+    /**
+     * Process a chunk of received bytes.
+     *
+     * Processing stops after a complete frame or an error, see
+     * Cobs_decoder::put().
+     */
+    int put(const uint8_t* data, int len, Status& status)
+    {
+        status = Status::pending;
+        for (int i = 0; i < len; ++i) {
+            status = put(data[i]);
+            if (status != Status::pending)
+                return i + 1;
+        }
+        return len;
+    }
+
+    /**
+     * Get the frame after put() reported Status::complete.
+     */
+    Byte_span frame() const { return Byte_span{buf, pos}; }
+
+    /**
+     * Discard the frame received so far.
+     */
+    void restart()
+    {
+        pos = 0;
+        is_escaped = false;
+        is_complete = false;
+        failed = false;
+    }
+
+private:
+    void append(uint8_t byte)
+    {
+        if (pos >= capacity)
+            failed = true;
+        else
+            buf[pos++] = byte;
+    }
+
+    Status end_of_frame()
+    {
+        if ((pos == 0) && !is_escaped && !failed)
+            return Status::pending;
+
+        if (failed || is_escaped) {
+            restart();
+            return Status::error;
+        }
+        is_complete = true;
+        return Status::complete;
+    }
+
+    uint8_t* const buf;
+    const int capacity;
+    int pos = 0;
+    bool is_escaped = false;
+    bool is_complete = false;
+    bool failed = false;
+};
+
+/**
+ * Decode a complete SLIP frame.
+ *
+ * \param[out] dst
+ *      Target buffer with space for \a len bytes. May be equal to
+ *      \a src to decode in place.
+ * \param[in] src
+ *      The encoded frame. END characters are skipped.
+ * \param[in] len
+ *      The number of bytes in \a src.
+ *
+ * \returns
+ *      The size of the decoded frame, or -1 on an invalid escape
+ *      sequence.
+ */
+static inline int slip_decode(uint8_t* dst, const uint8_t* src, int len)
+{
+    const uint8_t* end = src + len;
+    uint8_t* p = dst;
+
+    while (src < end) {
+        uint8_t byte = *src++;
+
+        if (byte == slip_end)
+            continue;
+        if (byte == slip_esc) {
+            if (src == end)
+                return -1;
+            byte = *src++;
+            if (byte == slip_esc_end)
+                byte = slip_end;
+            else if (byte == slip_esc_esc)
+                byte = slip_esc;
+            else
+                return -1;
+        }
+        *p++ = byte;
+    }
+    return p - dst;
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_SLIP_HPP */
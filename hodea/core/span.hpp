@@ -0,0 +1,101 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Non-owning view onto a contiguous sequence of objects.
+ *
+ * The class Span combines a pointer and the number of elements it
+ * points to. It is a minimal subset of std::span as introduced with
+ * C++20, and of gsl::span from the Guideline Support Library. Sizes
+ * are given as int, according our coding style.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_SPAN_HPP
+#define HODEA_SPAN_HPP
+
+#include <cstddef>
+#include <type_traits>
+#include <hodea/core/cstdint.hpp>
+
+namespace hodea {
+
+/**
+ * Class representing a view onto a contiguous sequence of objects.
+ */
+template <typename T>
+class Span {
+public:
+    typedef T Element;
+
+    constexpr Span() : ptr{nullptr}, len{0} {}
+
+    constexpr Span(T* data, int size) : ptr{data}, len{size} {}
+
+    template <std::size_t N>
+    constexpr Span(T (&array)[N]) : ptr{array}, len{static_cast<int>(N)} {}
+
+    /**
+     * Allow conversion from Span<T> to Span<const T>.
+     */
+    template <
+        typename U,
+        typename = typename std::enable_if<
+            std::is_convertible<U(*)[], T(*)[]>::value>::type
+        >
+    constexpr Span(const Span<U>& other)
+        : ptr{other.data()}, len{other.size()}
+    {}
+
+    constexpr T* data() const { return ptr; }
+
+    constexpr int size() const { return len; }
+
+    constexpr bool empty() const { return len == 0; }
+
+    constexpr T& operator[](int idx) const { return ptr[idx]; }
+
+    constexpr T* begin() const { return ptr; }
+
+    constexpr T* end() const { return ptr + len; }
+
+    /**
+     * Get a span onto the first \a count elements.
+     */
+    constexpr Span first(int count) const { return Span{ptr, count}; }
+
+    /**
+     * Get a span onto the last \a count elements.
+     */
+    constexpr Span last(int count) const
+    {
+        return Span{ptr + len - count, count};
+    }
+
+    /**
+     * Get a span onto \a count elements starting at \a offs.
+     */
+    constexpr Span subspan(int offs, int count) const
+    {
+        return Span{ptr + offs, count};
+    }
+
+    /**
+     * Get a span onto the elements starting at \a offs.
+     */
+    constexpr Span subspan(int offs) const
+    {
+        return Span{ptr + offs, len - offs};
+    }
+
+private:
+    T* ptr;
+    int len;
+};
+
+typedef Span<uint8_t> Byte_span;
+typedef Span<const uint8_t> Const_byte_span;
+
+} // namespace hodea
+
+#endif /*!HODEA_SPAN_HPP */
@@ -0,0 +1,227 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Measure the peak stack usage via stack painting.
+ *
+ * The unused part of a stack is filled with a known pattern at startup.
+ * Later on the stack is scanned from its limit towards its top. The
+ * first word which does not hold the pattern marks the deepest point
+ * the stack has ever reached, the so called high-water mark.
+ *
+ * The scan is incremental. Each call checks a limited number of words
+ * and resumes where the previous call stopped. So it can run in the
+ * background, e.g. in the idle loop, without stalling the main loop.
+ * As the stack only grows towards its limit, a pass stops as soon as it
+ * reaches the high-water mark found so far.
+ *
+ * We assume a full descending stack as used by ARM Cortex-M cores, i.e.
+ * the stack grows from \a top towards \a limit.
+ *
+ * Example:
+ *
+ * \code
+ * extern "C" uint32_t __StackLimit[];
+ * extern "C" uint32_t __StackTop[];
+ *
+ * Stack_watermark msp_watermark{__StackLimit, __StackTop};
+ *
+ * int main()
+ * {
+ *     msp_watermark.paint_unused();
+ *     :
+ *     for (;;) {
+ *         :
+ *         msp_watermark.scan(16);
+ *         auto usage = msp_watermark.usage();
+ *     }
+ * }
+ * \endcode
+ *
+ * \note
+ * Painting is not able to detect stack accesses which write the
+ * pattern. The probability of this is low, but not zero.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_STACK_WATERMARK_HPP
+#define HODEA_STACK_WATERMARK_HPP
+
+#include <hodea/core/cstdint.hpp>
+
+namespace hodea {
+
+/**
+ * Class to determine the high-water mark of a stack.
+ */
+class Stack_watermark {
+public:
+    /**
+     * Pattern used to paint the stack.
+     */
+    static constexpr uint32_t paint_pattern = 0xcafebabeU;
+
+    /**
+     * Number of words below the actual stack pointer not painted by
+     * paint_unused(). It covers the stack frame of paint_unused()
+     * itself.
+     */
+    static constexpr int guard_words = 16;
+
+    /**
+     * Stack usage reported by usage().
+     */
+    struct Usage {
+        int size_bytes;         // total size of the stack
+        int peak_bytes;         // maximum stack usage detected so far
+    };
+
+    /**
+     * Constructor.
+     *
+     * \param[in] limit
+     *      The lowest address of the stack.
+     * \param[in] top
+     *      The address just above the stack, i.e. the initial stack
+     *      pointer.
+     */
+    constexpr Stack_watermark(uint32_t* limit, uint32_t* top)
+        : limit{limit}, top{top}, watermark{top}, cursor{limit}
+    {}
+
+    /**
+     * Paint the whole stack.
+     *
+     * Use this method for stacks which are not in use yet, e.g. the
+     * process stack before it is activated.
+     */
+    void paint()
+    {
+        fill(top);
+    }
+
+    /**
+     * Paint the part of the active stack below the stack pointer.
+     *
+     * Use this method for the stack the caller is running on, e.g.
+     * from rte_init() for the main stack.
+     */
+    void paint_unused()
+    {
+        volatile uint32_t marker = 0;
+        uint32_t* sp = const_cast<uint32_t*>(&marker) - guard_words;
+
+        if ((sp > limit) && (sp < top))
+            fill(sp);
+    }
+
+    /**
+     * Continue scanning the stack for the high-water mark.
+     *
+     * \param[in] max_words
+     *      The maximum number of words checked by this call.
+     *
+     * \returns
+     *      True if a pass over the painted region is complete, false
+     *      otherwise.
+     */
+    bool scan(int max_words)
+    {
+        const volatile uint32_t* p = cursor;
+
+        if (!is_painted)
+            return true;
+
+        for (int i = 0; i < max_words; ++i) {
+            if (p >= watermark) {
+                cursor = limit;
+                return true;
+            }
+            if (*p != paint_pattern) {
+                watermark = const_cast<uint32_t*>(p);
+                cursor = limit;
+                return true;
+            }
+            ++p;
+        }
+
+        cursor = const_cast<uint32_t*>(p);
+        return false;
+    }
+
+    /**
+     * Continue scanning the stack within a given time budget.
+     *
+     * The stack is scanned in chunks of \a chunk_words. The time budget
+     * is checked after each chunk, so the budget is exceeded by at most
+     * the time required to scan a single chunk.
+     *
+     * \tparam T_tsc
+     *      Timestamp counter class, e.g. Htsc.
+     * \param[in] budget
+     *      Time budget for this call in ticks of \a T_tsc.
+     * \param[in] chunk_words
+     *      The number of words checked between two budget checks.
+     *
+     * \returns
+     *      True if a pass over the painted region is complete, false
+     *      otherwise.
+     */
+    template <class T_tsc>
+    bool scan_for(typename T_tsc::Ticks budget, int chunk_words = 8)
+    {
+        typename T_tsc::Ticks ts_start = T_tsc::now();
+
+        do {
+            if (scan(chunk_words))
+                return true;
+        } while (!T_tsc::is_elapsed(ts_start, budget));
+
+        return false;
+    }
+
+    /**
+     * Get size and peak usage of the stack.
+     */
+    Usage usage() const
+    {
+        return Usage{
+            static_cast<int>((top - limit) * sizeof(uint32_t)),
+            static_cast<int>((top - watermark) * sizeof(uint32_t))
+            };
+    }
+
+    /**
+     * Test if the stack has been used up completely.
+     *
+     * This is the case if the word at the stack limit got overwritten.
+     * The stack has most likely overflowed.
+     */
+    bool is_exhausted() const
+    {
+        return watermark == limit;
+    }
+
+private:
+    void fill(uint32_t* end)
+    {
+        volatile uint32_t* p = limit;
+
+        while (p < end)
+            *p++ = paint_pattern;
+
+        watermark = end;
+        cursor = limit;
+        is_painted = true;
+    }
+
+    uint32_t* const limit;
+    uint32_t* const top;
+    uint32_t* watermark;        // lowest word found modified
+    uint32_t* cursor;           // next word to scan
+    bool is_painted = false;
+};
+
+} // namespace hodea
+
+#endif /*!HODEA_STACK_WATERMARK_HPP */
@@ -4,6 +4,18 @@
 /**
  * Reverse byte order of unsigned types various sizes.
  *
+ * With GCC and LLVM/clang (including ARM Compiler 6) the functions map
+ * onto the __builtin_bswap intrinsics. These are usable in constant
+ * expressions and translate into a single instruction where the target
+ * provides one, e.g. REV and REV16 on ARM cores, BSWAP on x86.
+ *
+ * Other compilers provide byte swap intrinsics (e.g. __rev, __REV) only
+ * as run time functions, which cannot be used in constexpr functions.
+ * For them we fall back to mask-and-shift expressions, which most
+ * compilers recognize as byte swap.
+ *
+ * For arrays see bulk_uswap.hpp.
+ *
  * \author f.hollerer@hodea.org
  */
 #if !defined HODEA_USWAP_HPP
@@ -23,7 +35,11 @@ namespace hodea {
  */
 static inline constexpr uint16_t uswap16(uint16_t x)
 {
+#if defined __GNUC__ || defined __clang__
+    return __builtin_bswap16(x);
+#else
     return ((x & 0xff00U) >> 8) | ((x & 0x00ffU) << 8);
+#endif
 }
 
 /**
@@ -36,10 +52,14 @@ static inline constexpr uint16_t uswap16(uint16_t x)
  */
 static inline constexpr uint32_t uswap32(uint32_t x)
 {
+#if defined __GNUC__ || defined __clang__
+    return __builtin_bswap32(x);
+#else
     return ((x & 0xff000000U) >> 24) |
            ((x & 0x00ff0000U) >>  8) |
            ((x & 0x0000ff00U) <<  8) |
            ((x & 0x000000ffU) << 24);
+#endif
 }
 
 /**
@@ -52,6 +72,9 @@ static inline constexpr uint32_t uswap32(uint32_t x)
  */
 static inline constexpr uint64_t uswap64(uint64_t x)
 {
+#if defined __GNUC__ || defined __clang__
+    return __builtin_bswap64(x);
+#else
     return ((x & 0xff00000000000000ULL) >> 56) |
            ((x & 0x00ff000000000000ULL) >> 40) |
            ((x & 0x0000ff0000000000ULL) >> 24) |
@@ -60,6 +83,7 @@ static inline constexpr uint64_t uswap64(uint64_t x)
            ((x & 0x0000000000ff0000ULL) << 24) |
            ((x & 0x000000000000ff00ULL) << 40) |
            ((x & 0x00000000000000FFULL) << 56);
+#endif
 }
 
 } // namespace hodea
@@ -0,0 +1,190 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Integer wire formats with fixed width and byte order.
+ *
+ * The class Wire_format describes how an integer is represented within
+ * a message, i.e. its width in bytes and its byte order. It provides
+ * fetch() and store() methods with the same semantic as the functions
+ * in serialization.hpp.
+ *
+ * In contrast to the functions in serialization.hpp, which assemble the
+ * value byte by byte, Wire_format copies the bytes with memcpy() into
+ * an unsigned integer and swaps them if the wire byte order differs
+ * from the CPU byte order. Compilers translate this into a single load
+ * or store instruction, plus a REV instruction if a swap is required,
+ * provided the target supports unaligned accesses (e.g. Cortex-M4).
+ * On targets without unaligned access support (e.g. Cortex-M0) the
+ * compiler falls back to byte accesses.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_WIRE_FORMAT_HPP
+#define HODEA_WIRE_FORMAT_HPP
+
+#include <cstring>
+#include <type_traits>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/cpu_endian.hpp>
+#include <hodea/core/uswap.hpp>
+
+namespace hodea {
+
+/**
+ * Unsigned and signed integer types for a given width in bytes.
+ */
+template <int width>
+struct Wire_int_types;
+
+template <>
+struct Wire_int_types<1> {
+    typedef uint8_t Uint;
+    typedef int8_t Sint;
+    static constexpr uint8_t swap(uint8_t x) { return x; }
+};
+
+template <>
+struct Wire_int_types<2> {
+    typedef uint16_t Uint;
+    typedef int16_t Sint;
+    static constexpr uint16_t swap(uint16_t x) { return uswap16(x); }
+};
+
+template <>
+struct Wire_int_types<4> {
+    typedef uint32_t Uint;
+    typedef int32_t Sint;
+    static constexpr uint32_t swap(uint32_t x) { return uswap32(x); }
+};
+
+template <>
+struct Wire_int_types<8> {
+    typedef uint64_t Uint;
+    typedef int64_t Sint;
+    static constexpr uint64_t swap(uint64_t x) { return uswap64(x); }
+};
+
+/**
+ * Class representing an integer wire format.
+ *
+ * \tparam width
+ *      Width of the integer on the wire in bytes: 1, 2, 4 or 8.
+ * \tparam order
+ *      Byte order of the integer on the wire.
+ */
+template <int width, Byte_order order>
+class Wire_format {
+public:
+    typedef typename Wire_int_types<width>::Uint Uint;
+    typedef typename Wire_int_types<width>::Sint Sint;
+
+    /**
+     * Number of bytes occupied on the wire.
+     */
+    static constexpr int size = width;
+
+    /**
+     * Convert a value in CPU byte order into wire byte order, and vice
+     * versa.
+     */
+    static constexpr Uint swap_if_required(Uint x)
+    {
+        return (order == cpu_byte_order()) ?
+            x : Wire_int_types<width>::swap(x);
+    }
+
+    /**
+     * Read the unsigned integer stored in wire format.
+     */
+    static Uint load(const uint8_t* buf)
+    {
+        Uint v;
+
+        std::memcpy(&v, buf, sizeof(v));
+        return swap_if_required(v);
+    }
+
+    /**
+     * Write an unsigned integer in wire format.
+     */
+    static void save(uint8_t* buf, Uint v)
+    {
+        v = swap_if_required(v);
+        std::memcpy(buf, &v, sizeof(v));
+    }
+
+    /**
+     * Extract a number stored in wire format.
+     *
+     * If \a T is a signed type, the number on the wire is interpreted as
+     * signed number with \a width bytes and sign extended.
+     *
+     * \param[out] dst Target variable.
+     * \param[in] buf  Source buffer holding the number.
+     *
+     * \returns
+     *      The number of bytes read from \a buf.
+     */
+    template <
+        typename T,
+        typename = typename std::enable_if<
+            std::is_integral<T>::value || std::is_enum<T>::value>::type
+        >
+    static int fetch(T& dst, const uint8_t* buf)
+    {
+        typedef typename std::conditional<
+            std::is_signed<T>::value, Sint, Uint>::type Wire_type;
+
+        dst = static_cast<T>(static_cast<Wire_type>(load(buf)));
+        return size;
+    }
+
+    /**
+     * Store a number in wire format.
+     *
+     * \param[out] buf Target buffer.
+     * \param[in] val The value to store.
+     *
+     * \returns
+     *      The number of bytes written into \a buf.
+     */
+    template <
+        typename T,
+        typename = typename std::enable_if<
+            std::is_integral<T>::value || std::is_enum<T>::value>::type
+        >
+    static int store(uint8_t* buf, const T val)
+    {
+        save(buf, static_cast<Uint>(val));
+        return size;
+    }
+};
+
+/**
+ * Sum of the sizes of a list of wire formats or message fields.
+ */
+template <typename... T>
+struct Wire_size;
+
+template <>
+struct Wire_size<> {
+    static constexpr int value = 0;
+};
+
+template <typename T, typename... T_rest>
+struct Wire_size<T, T_rest...> {
+    static constexpr int value = T::size + Wire_size<T_rest...>::value;
+};
+
+typedef Wire_format<1, Byte_order::le> Wire_u8;
+typedef Wire_format<2, Byte_order::le> Wire_le16;
+typedef Wire_format<4, Byte_order::le> Wire_le32;
+typedef Wire_format<8, Byte_order::le> Wire_le64;
+typedef Wire_format<2, Byte_order::be> Wire_be16;
+typedef Wire_format<4, Byte_order::be> Wire_be32;
+typedef Wire_format<8, Byte_order::be> Wire_be64;
+
+} // namespace hodea
+
+#endif /*!HODEA_WIRE_FORMAT_HPP */
@@ -0,0 +1,60 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * ARM DWT cycle counter as timebase for Tsc.
+ *
+ * The data watchpoint and trace unit (DWT) of Cortex-M3/M4 cores provides
+ * a 32 bit cycle counter clocked with the core clock. It gives the best
+ * possible resolution and is intended for measurements like interrupt
+ * latency or benchmarks.
+ *
+ * \note
+ * Cortex-M0 cores don't have a cycle counter.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_ARM_CM_DWT_TIME_BASE_HPP
+#define HODEA_ARM_CM_DWT_TIME_BASE_HPP
+
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/bitmanip.hpp>
+#include <hodea/device/hal/device_setup.hpp>
+
+#if !defined HODEA_DERIVED_CONFIG_CORE_ARM_CORTEX_M4
+#error "DWT cycle counter not available on this core."
+#endif
+
+namespace hodea {
+
+/**
+ * Timebase derived from the DWT cycle counter.
+ */
+class Dwt_time_base {
+public:
+    typedef uint32_t Ticks;
+
+    static constexpr Ticks counter_msk = 0xffffffffU;
+    static constexpr unsigned counter_clk_hz = config_sysclk_hz;
+
+    static void init()
+    {
+        set_bit(CoreDebug->DEMCR, CoreDebug_DEMCR_TRCENA_Msk);
+        DWT->CYCCNT = 0;
+        set_bit(DWT->CTRL, DWT_CTRL_CYCCNTENA_Msk);
+    }
+
+    static void deinit()
+    {
+        clr_bit(DWT->CTRL, DWT_CTRL_CYCCNTENA_Msk);
+    }
+
+    static Ticks now()
+    {
+        return DWT->CYCCNT;
+    }
+};
+
+} // namespace hodea
+
+#endif /*!HODEA_ARM_CM_DWT_TIME_BASE_HPP */
@@ -0,0 +1,67 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Software triggered interrupt via the NVIC.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_ARM_CM_NVIC_SW_IRQ_HPP
+#define HODEA_ARM_CM_NVIC_SW_IRQ_HPP
+
+#include <hodea/device/hal/device_setup.hpp>
+
+namespace hodea {
+
+/**
+ * Class to trigger an interrupt by software.
+ *
+ * Any device interrupt not used otherwise can be triggered by software.
+ * Cortex-M3/M4 cores provide the software trigger interrupt register
+ * (STIR) for this purpose. On Cortex-M0 cores we set the pending bit
+ * via the interrupt set-pending register (ISPR). In both cases a single
+ * store is required.
+ *
+ * \tparam irqn
+ *      The interrupt number as defined by the CMSIS device header.
+ */
+template <IRQn_Type irqn>
+class Nvic_sw_irq {
+public:
+    static_assert(irqn >= 0, "only device interrupts can be triggered");
+
+    /**
+     * Set priority and enable the interrupt.
+     */
+    static void init(unsigned priority)
+    {
+        NVIC_ClearPendingIRQ(irqn);
+        NVIC_SetPriority(irqn, priority);
+        NVIC_EnableIRQ(irqn);
+    }
+
+    /**
+     * Disable the interrupt.
+     */
+    static void deinit()
+    {
+        NVIC_DisableIRQ(irqn);
+        NVIC_ClearPendingIRQ(irqn);
+    }
+
+    /**
+     * Set the interrupt pending.
+     */
+    static void pend()
+    {
+#if defined HODEA_DERIVED_CONFIG_CORE_ARM_CORTEX_M4
+        NVIC->STIR = irqn;
+#else
+        NVIC_SetPendingIRQ(irqn);
+#endif
+    }
+};
+
+} // namespace hodea
+
+#endif /*!HODEA_ARM_CM_NVIC_SW_IRQ_HPP */
@@ -0,0 +1,97 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Interrupt service routine with access to the exception stack frame.
+ *
+ * On exception entry Cortex-M cores push R0-R3, R12, LR, PC and xPSR
+ * onto the active stack, which is either the main stack (MSP) or the
+ * process stack (PSP). The stacked PC is the address of the interrupted
+ * instruction and is the sample used by Pc_profiler.
+ *
+ * The position of the stack frame relative to the stack pointer seen
+ * by a C++ function depends on its prologue. Therefore, we use a small
+ * assembler trampoline as vector, which passes the address of the
+ * exception stack frame to a C++ function.
+ *
+ * Example:
+ *
+ * \code
+ * Pc_profiler<1024, 6> profiler{FLASH_BASE};
+ *
+ * HODEA_DEFINE_FRAME_ISR(TIM16_IRQHandler, tim16_isr)
+ *
+ * extern "C" void tim16_isr(const uint32_t* frame)
+ * {
+ *     TIM16->SR = 0;
+ *     profiler.sample(stacked_pc(frame));
+ * }
+ * \endcode
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_ARM_CM_PC_SAMPLING_ISR_HPP
+#define HODEA_ARM_CM_PC_SAMPLING_ISR_HPP
+
+#include <hodea/core/cstdint.hpp>
+
+namespace hodea {
+
+/**
+ * Index of registers within the exception stack frame.
+ */
+enum struct Exception_frame {
+    r0 = 0, r1, r2, r3, r12, lr, pc, xpsr
+};
+
+/**
+ * Get the program counter of the interrupted code.
+ *
+ * \param[in] frame
+ *      Pointer to the exception stack frame.
+ */
+static inline uint32_t stacked_pc(const uint32_t* frame)
+{
+    return frame[static_cast<int>(Exception_frame::pc)];
+}
+
+} // namespace hodea
+
+#if defined __GNUC__
+
+/**
+ * Define an exception vector passing the stack frame to a function.
+ *
+ * The trampoline checks bit 2 of EXC_RETURN in LR to determine the
+ * active stack and tail calls \a body with the frame address in R0.
+ * Only instructions available on Cortex-M0 are used.
+ *
+ * \param[in] vector
+ *      Name of the exception handler as used in the vector table.
+ * \param[in] body
+ *      Name of a function declared as
+ *      extern "C" void body(const uint32_t* frame).
+ */
+#define HODEA_DEFINE_FRAME_ISR(vector, body)                            \
+extern "C" void body(const uint32_t* frame);                            \
+extern "C" __attribute__((naked)) void vector()                         \
+{                                                                       \
+    __asm volatile(                                                     \
+        "   movs r0, #4             \n"                                 \
+        "   mov r1, lr              \n"                                 \
+        "   tst r0, r1              \n"                                 \
+        "   bne 1f                  \n"                                 \
+        "   mrs r0, msp             \n"                                 \
+        "   b 2f                    \n"                                 \
+        "1: mrs r0, psp             \n"                                 \
+        "2: ldr r1, =" #body "      \n"                                 \
+        "   bx r1                   \n"                                 \
+        "   .ltorg                  \n"                                 \
+        );                                                              \
+}
+
+#else
+#error "HODEA_DEFINE_FRAME_ISR() not supported for this compiler."
+#endif
+
+#endif /*!HODEA_ARM_CM_PC_SAMPLING_ISR_HPP */
@@ -0,0 +1,105 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Host stand-in for a software triggered interrupt.
+ *
+ * This class mimics Nvic_sw_irq on the host. The interrupt service
+ * routine is a plain function registered via init(). Pending the
+ * interrupt invokes the handler synchronously, unless the interrupt is
+ * masked. In this case the handler runs as soon as the interrupt gets
+ * unmasked. This emulates the behavior of a critical section and allows
+ * to test code using software triggered interrupts, e.g.
+ * Irq_latency_meter, without hardware.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_HOST_SW_IRQ_HPP
+#define HODEA_HOST_SW_IRQ_HPP
+
+namespace hodea {
+
+/**
+ * Class emulating a software triggered interrupt.
+ *
+ * \tparam id
+ *      Arbitrary number to distinguish several emulated interrupts.
+ */
+template <int id = 0>
+class Host_sw_irq {
+public:
+    typedef void (*Handler)();
+
+    /**
+     * Register the interrupt service routine and enable the interrupt.
+     */
+    static void init(Handler isr)
+    {
+        handler = isr;
+        pending = false;
+        masked = false;
+    }
+
+    /**
+     * Disable the interrupt.
+     */
+    static void deinit()
+    {
+        handler = nullptr;
+        pending = false;
+    }
+
+    /**
+     * Set the interrupt pending.
+     */
+    static void pend()
+    {
+        pending = true;
+        dispatch();
+    }
+
+    /**
+     * Block the interrupt, e.g. to emulate a critical section.
+     */
+    static void mask() { masked = true; }
+
+    /**
+     * Unblock the interrupt and run the handler if pending.
+     */
+    static void unmask()
+    {
+        masked = false;
+        dispatch();
+    }
+
+    /**
+     * Test if the interrupt is pending.
+     */
+    static bool is_pending() { return pending; }
+
+private:
+    static void dispatch()
+    {
+        if (pending && !masked && handler) {
+            pending = false;
+            handler();
+        }
+    }
+
+    static Handler handler;
+    static bool pending;
+    static bool masked;
+};
+
+template <int id>
+typename Host_sw_irq<id>::Handler Host_sw_irq<id>::handler = nullptr;
+
+template <int id>
+bool Host_sw_irq<id>::pending = false;
+
+template <int id>
+bool Host_sw_irq<id>::masked = false;
+
+} // namespace hodea
+
+#endif /*!HODEA_HOST_SW_IRQ_HPP */
@@ -0,0 +1,48 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Host clock as timebase for Tsc.
+ *
+ * This timebase allows to use code based on Tsc, e.g. Htsc, when
+ * building for the host. It is intended for tests, benchmarks and
+ * host tools.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_HOST_TIME_BASE_HPP
+#define HODEA_HOST_TIME_BASE_HPP
+
+#include <chrono>
+#include <hodea/core/cstdint.hpp>
+
+namespace hodea {
+
+/**
+ * Timebase derived from std::chrono::steady_clock.
+ *
+ * The class is named Htsc_time_base, so it can be selected via
+ * HODEA_CONFIG_HTSC_TIME_BASE_INCLUDE for host builds.
+ */
+class Htsc_time_base {
+public:
+    typedef uint64_t Ticks;
+
+    static constexpr Ticks counter_msk = ~static_cast<Ticks>(0);
+    static constexpr unsigned counter_clk_hz =
+        std::chrono::steady_clock::period::den /
+        std::chrono::steady_clock::period::num;
+
+    static void init() {}
+
+    static void deinit() {}
+
+    static Ticks now()
+    {
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+};
+
+} // namespace hodea
+
+#endif /*!HODEA_HOST_TIME_BASE_HPP */
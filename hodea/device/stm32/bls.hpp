@@ -34,6 +34,10 @@ namespace hodea {
  *
  * @returns
  *      CRC calculated from \a start to \a end (inclusive).
+ *
+ * \note
+ * The function waits until the CRC is complete. Use Crc_unit_job to
+ * calculate the CRC in the background.
  */
 uint32_t bls_progmem_crc(const uint32_t *start, const uint32_t *end);
 
@@ -0,0 +1,267 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Asynchronous CRC calculation with the CRC unit of STM32 devices.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <hodea/core/bitmanip.hpp>
+#include <hodea/device/hal/device_setup.hpp>
+#include <hodea/device/hal/crc_unit.hpp>
+
+namespace hodea {
+
+namespace {
+
+/**
+ * Maximum number of items of a single DMA transfer.
+ */
+constexpr int max_dma_count = 0xffff;
+
+/**
+ * Mask the DMA channel 1 interrupt within the current scope.
+ *
+ * This serializes the access to the CRC unit, the DMA channel and the
+ * job queue with Crc_unit_job::dma_irq_handler(). Other interrupts
+ * are not affected.
+ */
+class Dma_irq_mask {
+public:
+    Dma_irq_mask()
+        : was_enabled{is_bit_set(NVIC->ISER[0], irq_bit)}
+    {
+        NVIC->ICER[0] = irq_bit;
+        __DSB();
+        __ISB();
+    }
+
+    ~Dma_irq_mask()
+    {
+        if (was_enabled)
+            NVIC->ISER[0] = irq_bit;
+    }
+
+    Dma_irq_mask(const Dma_irq_mask&) = delete;
+    Dma_irq_mask& operator=(const Dma_irq_mask&) = delete;
+
+private:
+    static constexpr uint32_t irq_bit = 1U << DMA1_Channel1_IRQn;
+    bool was_enabled;
+};
+
+bool is_valid_chunk(const void* data, int len, Crc_unit_job::Mode mode)
+{
+    if (len < 0)
+        return false;
+    if (mode == Crc_unit_job::Mode::words)
+        return ((reinterpret_cast<uintptr_t>(data) | len) & 3) == 0;
+    return true;
+}
+
+} // namespace
+
+Crc_unit_job* Crc_unit_job::owner = nullptr;
+Crc_unit_job* Crc_unit_job::queue_head = nullptr;
+Crc_unit_job* Crc_unit_job::queue_tail = nullptr;
+
+bool Crc_unit_job::start(
+    const void* data, int len, Mode mode, uint32_t init
+    )
+{
+    if (is_busy() || !is_valid_chunk(data, len, mode))
+        return false;
+
+    crc = init;
+    return submit(data, len, mode);
+}
+
+bool Crc_unit_job::append(const void* data, int len, Mode mode)
+{
+    if (!is_done() || !is_valid_chunk(data, len, mode))
+        return false;
+
+    return submit(data, len, mode);
+}
+
+Crc_unit_job::State Crc_unit_job::poll()
+{
+    {
+        Dma_irq_mask mask;
+
+        service();
+    }
+
+    return state();
+}
+
+void Crc_unit_job::cancel()
+{
+    Dma_irq_mask mask;
+
+    if (owner == this) {
+        clr_bit(DMA1_Channel1->CCR, DMA_CCR_EN);
+        DMA1->IFCR = DMA_IFCR_CGIF1;
+        owner = nullptr;
+        serve_next();
+    }
+    else if (state() == State::queued) {
+        Crc_unit_job* prev = nullptr;
+
+        for (Crc_unit_job* p = queue_head; p; prev = p, p = p->next_queued) {
+            if (p == this) {
+                if (prev)
+                    prev->next_queued = next_queued;
+                else
+                    queue_head = next_queued;
+                if (queue_tail == this)
+                    queue_tail = prev;
+                next_queued = nullptr;
+                break;
+            }
+        }
+    }
+
+    st.store(State::idle, std::memory_order_release);
+}
+
+void Crc_unit_job::dma_irq_handler()
+{
+    service();
+}
+
+bool Crc_unit_job::submit(const void* data, int len, Mode mode)
+{
+    Dma_irq_mask mask;
+
+    next = static_cast<const uint8_t*>(data);
+    remaining = len;
+    this->mode = mode;
+
+    if (len == 0) {
+        st.store(State::done, std::memory_order_release);
+        if (callback)
+            callback(*this, context);
+        return true;
+    }
+
+    st.store(State::queued, std::memory_order_release);
+    if (!owner) {
+        start_transfer();
+    }
+    else {
+        if (queue_tail)
+            queue_tail->next_queued = this;
+        else
+            queue_head = this;
+        queue_tail = this;
+    }
+
+    return true;
+}
+
+void Crc_unit_job::start_transfer()
+{
+    DMA_Channel_TypeDef *dma = DMA1_Channel1;
+    int width = (mode == Mode::words) ? 4 : 1;
+    int count = remaining / width;
+
+    if (count > max_dma_count)
+        count = max_dma_count;
+
+    owner = this;
+    st.store(State::busy, std::memory_order_release);
+
+#if defined RCC_AHBENR_DMAEN
+    set_bit(RCC->AHBENR, RCC_AHBENR_CRCEN | RCC_AHBENR_DMAEN);
+#else
+    set_bit(RCC->AHBENR, RCC_AHBENR_CRCEN | RCC_AHBENR_DMA1EN);
+#endif
+
+    // restore default settings and continue with the running CRC
+#if defined CRC_POL_POL
+    CRC->POL = 0x04c11db7U;
+#endif
+    CRC->INIT = crc;
+    CRC->CR = CRC_CR_RESET;
+
+    // lowest priority, the transfer must not delay other DMA channels
+    dma->CCR =
+        _VAL2FLD(DMA_CCR_MEM2MEM, 1) |
+        _VAL2FLD(DMA_CCR_PL, 0) |
+        _VAL2FLD(DMA_CCR_MSIZE, (mode == Mode::words) ? 2 : 0) |
+        _VAL2FLD(DMA_CCR_PSIZE, (mode == Mode::words) ? 2 : 0) |
+        _VAL2FLD(DMA_CCR_MINC, 1) |
+        _VAL2FLD(DMA_CCR_PINC, 0) |
+        _VAL2FLD(DMA_CCR_DIR, 1) |
+        _VAL2FLD(DMA_CCR_TEIE, 1) |
+        _VAL2FLD(DMA_CCR_TCIE, 1);
+
+    dma->CNDTR = count;
+
+    dma->CPAR = (uintptr_t) &CRC->DR;
+    dma->CMAR = (uintptr_t) next;
+
+    DMA1->IFCR = DMA_IFCR_CGIF1;
+    set_bit(dma->CCR, DMA_CCR_EN);
+
+    next += count * width;
+    remaining -= count * width;
+}
+
+/**
+ * Complete the transfer of the job owning the CRC unit.
+ *
+ * The caller must ensure that this function is not preempted by
+ * dma_irq_handler().
+ */
+void Crc_unit_job::service()
+{
+    Crc_unit_job* job = owner;
+    uint32_t isr = DMA1->ISR;
+
+    if (!job || !is_bit_set(isr, DMA_ISR_TCIF1 | DMA_ISR_TEIF1))
+        return;
+
+    DMA1->IFCR = DMA_IFCR_CGIF1;
+    clr_bit(DMA1_Channel1->CCR, DMA_CCR_EN);
+
+    job->crc = CRC->DR;
+
+    State result;
+
+    if (is_bit_set(isr, DMA_ISR_TEIF1)) {
+        result = State::failed;
+    }
+    else if (job->remaining > 0) {
+        job->start_transfer();
+        return;
+    }
+    else {
+        result = State::done;
+    }
+
+    // hand over the CRC unit before the callback may append a chunk
+    owner = nullptr;
+    serve_next();
+
+    job->st.store(result, std::memory_order_release);
+    if (job->callback)
+        job->callback(*job, job->context);
+}
+
+void Crc_unit_job::serve_next()
+{
+    Crc_unit_job* job = queue_head;
+
+    if (!job)
+        return;
+
+    queue_head = job->next_queued;
+    if (!queue_head)
+        queue_tail = nullptr;
+    job->next_queued = nullptr;
+    job->start_transfer();
+}
+
+} // namespace hodea
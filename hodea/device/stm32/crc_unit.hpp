@@ -0,0 +1,241 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Asynchronous CRC calculation with the CRC unit of STM32 devices.
+ *
+ * bls_progmem_crc() calculates the CRC in a single DMA transfer and
+ * waits until it is complete. For large images this stalls the caller
+ * for milliseconds. The class Crc_unit_job provided here feeds the CRC
+ * unit via DMA channel 1 in the background instead:
+ *
+ * - The data is passed in chunks. start() begins a new calculation,
+ *   append() continues it with the next chunk. The running CRC is kept
+ *   in the job and loaded into the CRC unit whenever the job gets the
+ *   peripheral, so calculations can be interleaved.
+ * - Completion of a chunk is reported via state() and an optional
+ *   callback. The callback is invoked from poll() or from
+ *   Crc_unit_job::dma_irq_handler(), whichever detects the completion
+ *   first.
+ * - Concurrent jobs are served in FIFO order. A job waiting for the
+ *   peripheral is in the state queued. Only one chunk is transferred at
+ *   a time.
+ *
+ * Two modes are supported, both using the CRC unit in its default
+ * configuration (polynomial 0x4C11DB7, no reflection, XorOut 0):
+ *
+ * - Crc_unit_job::Mode::words feeds 32 bit words. The data must be
+ *   word-aligned and its size a multiple of 4. The result equals
+ *   bls_progmem_crc() and Crc32_stm32 from crc.hpp.
+ * - Crc_unit_job::Mode::bytes feeds single bytes. Any alignment and
+ *   size is accepted, e.g. RAM buffers received from a host. The result
+ *   equals Crc32_mpeg2 from crc.hpp. This mode takes four times the DMA
+ *   transfers of the word mode.
+ *
+ * Example:
+ *
+ * \code
+ * Crc_unit_job job;
+ *
+ * void DMA1_Channel1_IRQHandler()
+ * {
+ *     Crc_unit_job::dma_irq_handler();
+ * }
+ *
+ * int main()
+ * {
+ *     :
+ *     NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+ *     job.start(rx_buf, rx_len, Crc_unit_job::Mode::bytes);
+ *     :
+ *     for (;;) {
+ *         if (job.is_done() && (job.value() != rx_crc))
+ *             return error;
+ *         :
+ *     }
+ * }
+ * \endcode
+ *
+ * Using the interrupt is optional. Without it the job advances each
+ * time poll() is called.
+ *
+ * \note
+ * The methods must not be called from contexts which preempt each
+ * other, e.g. from the main loop and an interrupt service routine.
+ * They mask the DMA channel 1 interrupt while they access the
+ * peripherals. The global interrupt is never disabled.
+ *
+ * \note
+ * DMA channel 1 is reserved for the CRC unit. The clocks of the CRC
+ * unit and of DMA1 are enabled on the first transfer and left enabled.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_STM32_CRC_UNIT_HPP
+#define HODEA_STM32_CRC_UNIT_HPP
+
+#include <atomic>
+#include <hodea/core/cstdint.hpp>
+
+namespace hodea {
+
+/**
+ * Class for an asynchronous CRC calculation using the CRC unit.
+ */
+class Crc_unit_job {
+public:
+    /**
+     * Width of the transfers to the CRC unit.
+     */
+    enum struct Mode {
+        words,                  // 32 bit words, word-aligned data
+        bytes                   // single bytes, any alignment
+    };
+
+    /**
+     * State of the job.
+     */
+    enum struct State {
+        idle,                   // no calculation started or cancelled
+        queued,                 // waiting for the CRC unit
+        busy,                   // chunk is being transferred
+        done,                   // chunk complete, value() is valid
+        failed                  // DMA transfer error
+    };
+
+    /**
+     * Function invoked when a chunk is complete or has failed.
+     */
+    typedef void (*Callback)(Crc_unit_job& job, void* context);
+
+    /**
+     * Initial value of the CRC unit.
+     */
+    static constexpr uint32_t crc_init = 0xffffffffU;
+
+    Crc_unit_job() = default;
+
+    /**
+     * Constructor.
+     *
+     * \param[in] callback
+     *      Function invoked when a chunk is complete or has failed.
+     * \param[in] context
+     *      User defined pointer passed to \a callback.
+     */
+    constexpr Crc_unit_job(Callback callback, void* context = nullptr)
+        : callback{callback}, context{context}
+    {}
+
+    Crc_unit_job(const Crc_unit_job&) = delete;
+    Crc_unit_job& operator=(const Crc_unit_job&) = delete;
+
+    /**
+     * Start a new CRC calculation.
+     *
+     * \param[in] data
+     *      First chunk of data. It must remain valid until the job is
+     *      done.
+     * \param[in] len
+     *      Size of the chunk in bytes.
+     * \param[in] mode
+     *      Width of the transfers to the CRC unit.
+     * \param[in] init
+     *      Initial CRC value.
+     *
+     * \returns
+     *      True if the chunk has been accepted. False if the job is
+     *      still queued or busy, or if \a data violates the alignment
+     *      required by \a mode.
+     */
+    bool start(
+        const void* data, int len, Mode mode = Mode::words,
+        uint32_t init = crc_init
+        );
+
+    /**
+     * Continue the CRC calculation with the next chunk.
+     *
+     * The chunk may use another mode than the previous one.
+     *
+     * \returns
+     *      True if the chunk has been accepted. False if the previous
+     *      chunk is not done, or if \a data violates the alignment
+     *      required by \a mode.
+     */
+    bool append(const void* data, int len, Mode mode = Mode::words);
+
+    /**
+     * Advance the job without relying on the DMA interrupt.
+     *
+     * \returns
+     *      The state of the job.
+     */
+    State poll();
+
+    /**
+     * Abort the calculation.
+     *
+     * The job is removed from the queue respectively its transfer is
+     * stopped. The callback is not invoked.
+     */
+    void cancel();
+
+    State state() const
+    {
+        return st.load(std::memory_order_acquire);
+    }
+
+    bool is_busy() const
+    {
+        State s = state();
+
+        return (s == State::queued) || (s == State::busy);
+    }
+
+    bool is_done() const
+    {
+        return state() == State::done;
+    }
+
+    /**
+     * Get the CRC over all chunks processed so far.
+     *
+     * The value is valid if the job is done.
+     */
+    uint32_t value() const
+    {
+        return crc;
+    }
+
+    /**
+     * Handle the completion of a DMA transfer.
+     *
+     * Call this function from DMA1_Channel1_IRQHandler() if the
+     * interrupt is used.
+     */
+    static void dma_irq_handler();
+
+private:
+    bool submit(const void* data, int len, Mode mode);
+    void start_transfer();
+    static void service();
+    static void serve_next();
+
+    const uint8_t* next = nullptr;  // data not yet transferred
+    int remaining = 0;              // bytes not yet transferred
+    Mode mode = Mode::words;
+    std::atomic<State> st{State::idle};
+    uint32_t crc = crc_init;        // CRC over the data transferred
+    Callback callback = nullptr;
+    void* context = nullptr;
+    Crc_unit_job* next_queued = nullptr;
+
+    static Crc_unit_job* owner;     // job using the CRC unit
+    static Crc_unit_job* queue_head;
+    static Crc_unit_job* queue_tail;
+};
+
+} // namespace hodea
+
+#endif /*!HODEA_STM32_CRC_UNIT_HPP */
@@ -8,15 +8,30 @@
  */
 
 #include <hodea/rte/htsc.hpp>
+#include <hodea/rte/stack_watermark.hpp>
 #include <hodea/rte/setup.hpp>
 
+#if defined HODEA_DERIVED_CONFIG_MAIN_STACK_WATERMARK
+extern "C" uint32_t HODEA_CONFIG_MAIN_STACK_LIMIT[];
+extern "C" uint32_t HODEA_CONFIG_MAIN_STACK_TOP[];
+#endif
+
 namespace hodea {
 
+#if defined HODEA_DERIVED_CONFIG_MAIN_STACK_WATERMARK
+Stack_watermark main_stack_watermark{
+    HODEA_CONFIG_MAIN_STACK_LIMIT, HODEA_CONFIG_MAIN_STACK_TOP
+    };
+#endif
+
 /**
  * Initialize the runtime environment.
  */
 void rte_init()
 {
+#if defined HODEA_DERIVED_CONFIG_MAIN_STACK_WATERMARK
+    main_stack_watermark.paint_unused();
+#endif
     Htsc::init();
 }
 
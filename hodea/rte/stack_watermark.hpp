@@ -0,0 +1,41 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * High-water mark of the main stack.
+ *
+ * If the user configuration provides the linker symbols for the main
+ * stack via
+ *
+ * - HODEA_CONFIG_MAIN_STACK_LIMIT, e.g. __StackLimit
+ * - HODEA_CONFIG_MAIN_STACK_TOP, e.g. __StackTop
+ *
+ * rte_init() paints the unused part of the main stack, and the
+ * application can call main_stack_watermark.scan() in its idle loop to
+ * keep the high-water mark up to date.
+ *
+ * Further stacks, e.g. process stacks used by an RTOS, can be monitored
+ * by own instances of Stack_watermark.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_RTE_STACK_WATERMARK_HPP
+#define HODEA_RTE_STACK_WATERMARK_HPP
+
+#include <hodea/core/stack_watermark.hpp>
+#include "hodea_user_config.hpp"
+
+#if defined HODEA_CONFIG_MAIN_STACK_LIMIT && \
+    defined HODEA_CONFIG_MAIN_STACK_TOP
+
+#define HODEA_DERIVED_CONFIG_MAIN_STACK_WATERMARK
+
+namespace hodea {
+
+extern Stack_watermark main_stack_watermark;
+
+} // namespace hodea
+
+#endif
+
+#endif /*!HODEA_RTE_STACK_WATERMARK_HPP */
@@ -0,0 +1,242 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Test the bulk byte swap and the array serialization.
+ *
+ * All paths are compared with the element-by-element reference for
+ * lengths 0 to max_len elements, unaligned buffers and in-place use.
+ * Build the test with and without -mssse3, -mavx2 and -mavx512bw to
+ * cover the SIMD paths, and with -U__SSE2__ to cover the word-wise loop
+ * used by targets without SIMD instructions.
+ *
+ * Build:
+ *
+ * \verbatim
+ * g++ -std=c++14 -O2 [-mavx2 | -U__SSE2__] -I<hodea-lib> -o bulk_uswap_test \
+ *     bulk_uswap_test.cpp
+ * \endverbatim
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <cstring>
+#include <vector>
+#include <tests/test.hpp>
+#include <hodea/core/bulk_uswap.hpp>
+#include <hodea/core/serialization.hpp>
+#include <hodea/core/serialization_array.hpp>
+
+using namespace hodea;
+
+// covers several iterations of the widest SIMD loop and all tails
+constexpr int max_len = 300;
+
+static std::vector<uint8_t> pattern(int len, int seed)
+{
+    std::vector<uint8_t> v(len);
+    Prng rng{0x12345678U + seed};
+
+    for (auto& b : v)
+        b = rng.next();
+    return v;
+}
+
+/**
+ * Reference: reverse each group of \a size bytes.
+ */
+static void reference_swap(uint8_t* dst, const uint8_t* src, int n, int size)
+{
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < size; ++j)
+            dst[i * size + j] = src[i * size + size - 1 - j];
+    }
+}
+
+template <int size>
+static void test_copy(
+    const char* name, void (*copy)(void*, const void*, int),
+    void (*buffer)(void*, int)
+    )
+{
+    int num_failed = test_state().num_failed;
+
+    for (int n = 0; n <= max_len; ++n) {
+        int len = n * size;
+
+        for (int src_offs = 0; src_offs < 4; ++src_offs) {
+            for (int dst_offs = 0; dst_offs < 4; ++dst_offs) {
+                auto src = pattern(len + 8, n);
+                auto dst = pattern(len + 2 * guard_size, n + 1);
+                auto expected = dst;
+
+                reference_swap(
+                    &expected[guard_size + dst_offs], &src[src_offs], n, size
+                    );
+                copy(&dst[guard_size + dst_offs], &src[src_offs], n);
+                CHECK(dst == expected);
+            }
+
+            // in place, the guard bytes must not be touched
+            int offs = guard_size + src_offs;
+            auto buf = pattern(len + 2 * guard_size, n + 2);
+            auto expected = buf;
+
+            reference_swap(&expected[offs], &buf[offs], n, size);
+            copy(&buf[offs], &buf[offs], n);
+            CHECK(buf == expected);
+
+            buf = pattern(len + 2 * guard_size, n + 3);
+            expected = buf;
+            reference_swap(&expected[offs], &buf[offs], n, size);
+            buffer(&buf[offs], n);
+            CHECK(buf == expected);
+        }
+    }
+
+    if (test_state().num_failed != num_failed)
+        fprintf(stderr, "%s failed\n", name);
+}
+
+template <int size>
+static void uswap_copy_generic(void* dst, const void* src, int n)
+{
+    uswap_copy<size>(dst, src, n);
+}
+
+template <int size>
+static void uswap_buffer_generic(void* buf, int n)
+{
+    uswap_copy<size>(buf, buf, n);
+}
+
+static void test_uswap()
+{
+    test_copy<2>("uswap16_copy", uswap16_copy, uswap16_buffer);
+    test_copy<4>("uswap32_copy", uswap32_copy, uswap32_buffer);
+    test_copy<8>("uswap64_copy", uswap64_copy, uswap64_buffer);
+    test_copy<2>(
+        "uswap_copy<2>", uswap_copy_generic<2>, uswap_buffer_generic<2>
+        );
+    test_copy<4>(
+        "uswap_copy<4>", uswap_copy_generic<4>, uswap_buffer_generic<4>
+        );
+    test_copy<8>(
+        "uswap_copy<8>", uswap_copy_generic<8>, uswap_buffer_generic<8>
+        );
+    test_copy<2>(
+        "uswap16_copy_scalar", uswap16_copy_scalar, uswap_buffer_generic<2>
+        );
+    test_copy<4>(
+        "uswap32_copy_scalar", uswap32_copy_scalar, uswap_buffer_generic<4>
+        );
+    test_copy<8>(
+        "uswap64_copy_scalar", uswap64_copy_scalar, uswap_buffer_generic<8>
+        );
+
+    // elements of size 1 are copied
+    auto src = pattern(max_len, 0);
+    std::vector<uint8_t> dst(max_len);
+
+    uswap_copy<1>(dst.data(), src.data(), max_len);
+    CHECK(dst == src);
+    uswap_copy<1>(dst.data(), dst.data(), max_len);
+    CHECK(dst == src);
+}
+
+/**
+ * Compare the array functions with the store and fetch functions.
+ */
+template <typename T>
+static void test_array(
+    int (*store_le)(uint8_t*, T), int (*store_be)(uint8_t*, T),
+    int (*fetch_le)(T&, const uint8_t*), int (*fetch_be)(T&, const uint8_t*)
+    )
+{
+    constexpr int size = sizeof(T);
+
+    for (int n = 0; n <= max_len; ++n) {
+        // one extra element keeps data() valid for n == 0
+        auto raw = pattern(n * size, n);
+        std::vector<T> values(n + 1);
+
+        if (n)
+            std::memcpy(values.data(), raw.data(), n * size);
+
+        for (int offs = 0; offs < 4; ++offs) {
+            std::vector<uint8_t> buf(n * size + 4);
+            std::vector<uint8_t> expected(n * size + 4);
+            std::vector<T> result(n + 1);
+            uint8_t* p = &expected[offs];
+
+            for (int i = 0; i < n; ++i)
+                p += store_le(p, values[i]);
+            CHECK(store_array_le(&buf[offs], values.data(), n) == n * size);
+            CHECK(buf == expected);
+            CHECK(fetch_array_le(result.data(), &buf[offs], n) == n * size);
+            CHECK(result == values);
+
+            p = &expected[offs];
+            for (int i = 0; i < n; ++i)
+                p += store_be(p, values[i]);
+            CHECK(store_array_be(&buf[offs], values.data(), n) == n * size);
+            CHECK(buf == expected);
+            CHECK(fetch_array_be(result.data(), &buf[offs], n) == n * size);
+            CHECK(result == values);
+
+            // element-wise fetch of the big endian representation
+            const uint8_t* q = &buf[offs];
+            bool is_equal = true;
+
+            for (int i = 0; i < n; ++i) {
+                T v;
+
+                q += fetch_be(v, q);
+                is_equal = is_equal && (v == values[i]);
+            }
+            CHECK(is_equal);
+
+            store_array_le(&buf[offs], values.data(), n);
+            q = &buf[offs];
+            is_equal = true;
+            for (int i = 0; i < n; ++i) {
+                T v;
+
+                q += fetch_le(v, q);
+                is_equal = is_equal && (v == values[i]);
+            }
+            CHECK(is_equal);
+        }
+    }
+}
+
+static void test_serialization_array()
+{
+    test_array<uint16_t>(
+        store16_le<uint16_t>, store16_be<uint16_t>,
+        fetch16_le<uint16_t>, fetch16_be<uint16_t>
+        );
+    test_array<int16_t>(
+        store16_le<int16_t>, store16_be<int16_t>,
+        fetch16_le<int16_t>, fetch16_be<int16_t>
+        );
+    test_array<uint32_t>(
+        store32_le<uint32_t>, store32_be<uint32_t>,
+        fetch32_le<uint32_t>, fetch32_be<uint32_t>
+        );
+    test_array<int32_t>(
+        store32_le<int32_t>, store32_be<int32_t>,
+        fetch32_le<int32_t>, fetch32_be<int32_t>
+        );
+    test_array<uint64_t>(
+        store64_le<uint64_t>, store64_be<uint64_t>,
+        fetch64_le<uint64_t>, fetch64_be<uint64_t>
+        );
+}
+
+int main()
+{
+    test_uswap();
+    test_serialization_array();
+
+    return test_result("bulk_uswap_test");
+}
@@ -0,0 +1,210 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Test sealing, validating and opening calibration blobs.
+ *
+ * A blob is sealed with Crc32<> and opened again. Each header field is
+ * then corrupted in turn and must be rejected with its Calib_status.
+ * The layout checks against the schema run at compile time.
+ *
+ * Build:
+ *
+ * \verbatim
+ * g++ -std=c++14 -O2 -I<hodea-lib> -o calib_blob_test calib_blob_test.cpp
+ * \endverbatim
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <cstring>
+#include <vector>
+#include <tests/test.hpp>
+#include <hodea/core/calib_blob.hpp>
+#include <hodea/core/crc.hpp>
+
+using namespace hodea;
+
+struct Motor_calib {
+    le_uint16_t gain;
+    le_uint32_t offset;
+    uint8_t pole_pairs;
+    be_uint16_t max_current;
+};
+
+typedef Calib_schema<
+    HODEA_CALIB_FIELD(Motor_calib, gain, Wire_le16),
+    HODEA_CALIB_FIELD(Motor_calib, offset, Wire_le32),
+    HODEA_CALIB_FIELD(Motor_calib, pole_pairs, Wire_u8),
+    HODEA_CALIB_FIELD(Motor_calib, max_current, Wire_be16)
+    > Motor_calib_schema;
+
+static_assert(
+    calib_layout_matches<Motor_calib, Motor_calib_schema>(),
+    "Motor_calib does not match its schema"
+    );
+
+// the fields are complete, but not in the order of the struct
+typedef Calib_schema<
+    HODEA_CALIB_FIELD(Motor_calib, offset, Wire_le32),
+    HODEA_CALIB_FIELD(Motor_calib, gain, Wire_le16),
+    HODEA_CALIB_FIELD(Motor_calib, pole_pairs, Wire_u8),
+    HODEA_CALIB_FIELD(Motor_calib, max_current, Wire_be16)
+    > Reordered_schema;
+
+static_assert(
+    !calib_layout_matches<Motor_calib, Reordered_schema>(),
+    "reordered schema not rejected"
+    );
+
+// the last field is missing
+typedef Calib_schema<
+    HODEA_CALIB_FIELD(Motor_calib, gain, Wire_le16),
+    HODEA_CALIB_FIELD(Motor_calib, offset, Wire_le32),
+    HODEA_CALIB_FIELD(Motor_calib, pole_pairs, Wire_u8)
+    > Truncated_schema;
+
+static_assert(
+    !calib_layout_matches<Motor_calib, Truncated_schema>(),
+    "truncated schema not rejected"
+    );
+
+constexpr uint32_t motor_calib_magic = 0x4d43414c;
+constexpr uint16_t motor_calib_version = 2;
+constexpr int header_size = sizeof(Calib_header);
+
+/**
+ * Build a sealed blob with \a extra bytes appended to the payload, as
+ * a newer version of the payload would have.
+ */
+static std::vector<uint8_t> make_blob(uint16_t version, int extra = 0)
+{
+    int length = sizeof(Motor_calib) + extra;
+    std::vector<uint8_t> blob(header_size + length);
+    auto payload = reinterpret_cast<Motor_calib*>(&blob[header_size]);
+
+    payload->gain = 0x1234;
+    payload->offset = 0xdeadbeefU;
+    payload->pole_pairs = 7;
+    payload->max_current = 0x0abc;
+    for (int i = 0; i < extra; ++i)
+        blob[header_size + sizeof(Motor_calib) + i] = i + 1;
+
+    CHECK(
+        seal_calib_blob(
+            blob.data(), motor_calib_magic, version, length, Crc32<>{}
+            ) == static_cast<int>(blob.size())
+        );
+    return blob;
+}
+
+static Calib_status validate(const std::vector<uint8_t>& blob, int size)
+{
+    return validate_calib_blob<Motor_calib>(
+        blob.data(), size, motor_calib_magic, motor_calib_version,
+        Crc32<>{}
+        );
+}
+
+static Calib_status validate(const std::vector<uint8_t>& blob)
+{
+    return validate(blob, blob.size());
+}
+
+static void test_seal_and_open()
+{
+    auto blob = make_blob(motor_calib_version);
+
+    // the header is little endian, the CRC covers the payload only
+    CHECK(blob[0] == 0x4c);
+    CHECK(blob[3] == 0x4d);
+    CHECK(blob[4] == motor_calib_version);
+    CHECK((blob[6] == 0) && (blob[7] == 0));
+    CHECK(blob[8] == sizeof(Motor_calib));
+    CHECK(
+        reinterpret_cast<const Calib_header*>(blob.data())->crc ==
+        crc32(&blob[header_size], sizeof(Motor_calib))
+        );
+
+    const Motor_calib* calib = open_calib_blob<Motor_calib>(
+        blob.data(), blob.size(), motor_calib_magic, motor_calib_version,
+        Crc32<>{}
+        );
+    const uint8_t* payload = &blob[header_size];
+
+    if (CHECK(calib == reinterpret_cast<const Motor_calib*>(payload))) {
+        CHECK(calib->gain == 0x1234);
+        CHECK(calib->offset == 0xdeadbeefU);
+        CHECK(calib->pole_pairs == 7);
+        CHECK(calib->max_current == 0x0abc);
+    }
+
+    // the wire format of the payload
+    const uint8_t expected[] = {
+        0x34, 0x12, 0xef, 0xbe, 0xad, 0xde, 0x07, 0x0a, 0xbc
+        };
+
+    CHECK(std::memcmp(payload, expected, sizeof(expected)) == 0);
+
+    // a newer blob with appended fields is accepted, also within a
+    // larger flash area
+    auto newer = make_blob(motor_calib_version + 1, 5);
+
+    CHECK(validate(newer) == Calib_status::ok);
+    newer.resize(newer.size() + 64, 0xff);
+    CHECK(validate(newer) == Calib_status::ok);
+}
+
+static void test_rejected()
+{
+    const auto good = make_blob(motor_calib_version);
+    auto blob = good;
+
+    CHECK(validate(blob) == Calib_status::ok);
+
+    blob[0] ^= 0x01;
+    CHECK(validate(blob) == Calib_status::bad_magic);
+    CHECK(
+        open_calib_blob<Motor_calib>(
+            blob.data(), blob.size(), motor_calib_magic,
+            motor_calib_version, Crc32<>{}
+            ) == nullptr
+        );
+
+    blob = good;
+    blob[6] = 1;
+    CHECK(validate(blob) == Calib_status::bad_reserved);
+
+    CHECK(validate(make_blob(motor_calib_version - 1)) ==
+          Calib_status::bad_version);
+
+    // area smaller than the header or than the length
+    CHECK(validate(good, header_size - 1) == Calib_status::bad_length);
+    CHECK(validate(good, good.size() - 1) == Calib_status::bad_length);
+
+    // length shorter than the payload known to the reader
+    blob = good;
+    seal_calib_blob(
+        blob.data(), motor_calib_magic, motor_calib_version,
+        sizeof(Motor_calib) - 1, Crc32<>{}
+        );
+    CHECK(validate(blob) == Calib_status::bad_length);
+
+    blob = good;
+    blob[8] = sizeof(Motor_calib) + 1;
+    CHECK(validate(blob) == Calib_status::bad_length);
+
+    // a flipped bit in the payload or in the stored CRC
+    for (std::size_t i = header_size - 4; i < good.size(); ++i) {
+        blob = good;
+        blob[i] ^= 0x80;
+        CHECK(validate(blob) == Calib_status::bad_crc);
+    }
+}
+
+int main()
+{
+    test_seal_and_open();
+    test_rejected();
+
+    return test_result("calib_blob_test");
+}
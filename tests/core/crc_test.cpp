@@ -0,0 +1,186 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Test the CRCs against a bitwise reference.
+ *
+ * Each alias is checked with all table sizes against the check value of
+ * the CRC catalogue, and against a bitwise implementation for all
+ * lengths up to 1000 bytes, both at once and split into two updates.
+ * Build the test with and without -mpclmul -mssse3 to cover the folding
+ * with carry-less multiplication.
+ *
+ * Build:
+ *
+ * \verbatim
+ * g++ -std=c++14 -O2 [-mpclmul -mssse3] -I<hodea-lib> -o crc_test \
+ *     crc_test.cpp
+ * \endverbatim
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <cstring>
+#include <vector>
+#include <tests/test.hpp>
+#include <hodea/core/crc.hpp>
+
+using namespace hodea;
+
+constexpr int max_len = 1000;
+
+static uint64_t reflect(uint64_t v, int width)
+{
+    uint64_t r = 0;
+
+    for (int i = 0; i < width; ++i, v >>= 1)
+        r = (r << 1) | (v & 1);
+    return r;
+}
+
+/**
+ * Calculate a CRC bit by bit, with the parameters of the Crc type.
+ */
+template <
+    typename T, T poly, T init, bool reflected, T xor_out, Crc_table table
+    >
+static T bitwise_crc(
+    const Crc<T, poly, init, reflected, xor_out, table>&,
+    const uint8_t* data, int len
+    )
+{
+    constexpr int width = 8 * sizeof(T);
+    uint64_t reg = init;
+
+    for (int i = 0; i < len; ++i) {
+        uint64_t b = reflected ? reflect(data[i], 8) : data[i];
+
+        for (int bit = 7; bit >= 0; --bit) {
+            bool top = ((reg >> (width - 1)) ^ (b >> bit)) & 1;
+
+            reg = (reg << 1) & ((1ULL << width) - 1);
+            if (top)
+                reg ^= poly;
+        }
+    }
+    if (reflected)
+        reg = reflect(reg, width);
+    return static_cast<T>(reg ^ xor_out);
+}
+
+/**
+ * Swap the bytes of each 32 bit word, as the STM32 CRC unit sees them.
+ */
+static std::vector<uint8_t> swap_words(const uint8_t* data, int len)
+{
+    std::vector<uint8_t> swapped(data, data + len);
+
+    for (int i = 0; i + 4 <= len; i += 4) {
+        for (int j = 0; j < 4; ++j)
+            swapped[i + j] = data[i + 3 - j];
+    }
+    return swapped;
+}
+
+template <typename C>
+static void test_crc(
+    const char* name, const std::vector<uint8_t>& data,
+    typename C::Value check
+    )
+{
+    const uint8_t* catalogue = reinterpret_cast<const uint8_t*>("123456789");
+    int num_failed = test_state().num_failed;
+    Prng rng{1};
+    bool is_ok = true;
+
+    CHECK(C::compute(catalogue, 9) == check);
+    CHECK(C::compute(nullptr, 0) == bitwise_crc(C{}, nullptr, 0));
+
+    for (int len = 0; (len <= max_len) && is_ok; ++len) {
+        // start at an odd address to cover unaligned accesses
+        const uint8_t* p = data.data() + 1;
+        typename C::Value expected = bitwise_crc(C{}, p, len);
+        int split = rng.below(len + 1);
+        C crc;
+
+        crc.update(p, split);
+        crc.update(p + split, len - split);
+        is_ok = (C::compute(p, len) == expected) &&
+            (crc.value() == expected) && (C{}(p, len) == expected);
+
+        crc.reset();
+        crc.update(p, len);
+        is_ok = is_ok && (crc.value() == expected);
+
+        if (len % 4 == 0) {
+            auto swapped = swap_words(p, len);
+
+            crc.reset();
+            crc.update_words(p, len);
+            is_ok = is_ok &&
+                (crc.value() == bitwise_crc(C{}, swapped.data(), len));
+        }
+    }
+    CHECK(is_ok);
+
+    if (test_state().num_failed != num_failed)
+        fprintf(stderr, "%s failed\n", name);
+}
+
+template <template <Crc_table> class C>
+static void test_alias(
+    const char* name, const std::vector<uint8_t>& data,
+    typename C<Crc_table::byte>::Value check
+    )
+{
+    test_crc<C<Crc_table::nibble>>(name, data, check);
+    test_crc<C<Crc_table::byte>>(name, data, check);
+    test_crc<C<Crc_table::slice8>>(name, data, check);
+}
+
+template <Crc_table table>
+static void test_stm32(const std::vector<uint8_t>& data)
+{
+    const uint8_t zero[4] = {};
+    bool is_ok = true;
+
+    CHECK(Crc32_stm32<table>()(zero, sizeof(zero)) == 0xc704dd7bU);
+
+    for (int len = 0; len <= max_len; len += 4) {
+        auto swapped = swap_words(data.data(), len);
+
+        is_ok = is_ok &&
+            (Crc32_stm32<table>()(data.data(), len) ==
+             Crc32_mpeg2<table>::compute(swapped.data(), len));
+    }
+    CHECK(is_ok);
+}
+
+int main()
+{
+    std::vector<uint8_t> data(max_len + 1);
+    Prng rng{0x9e3779b9U};
+
+    for (auto& b : data)
+        b = rng.next();
+
+    // check values of the CRC catalogue for "123456789"
+    test_alias<Crc8_smbus>("CRC-8/SMBUS", data, 0xf4);
+    test_alias<Crc16_ccitt_false>("CRC-16/CCITT-FALSE", data, 0x29b1);
+    test_alias<Crc16_xmodem>("CRC-16/XMODEM", data, 0x31c3);
+    test_alias<Crc16_kermit>("CRC-16/KERMIT", data, 0x2189);
+    test_alias<Crc16_modbus>("CRC-16/MODBUS", data, 0x4b37);
+    test_alias<Crc32>("CRC-32", data, 0xcbf43926U);
+    test_alias<Crc32c>("CRC-32C", data, 0xe3069283U);
+    test_alias<Crc32_mpeg2>("CRC-32/MPEG-2", data, 0x0376e6e7U);
+
+    test_stm32<Crc_table::nibble>(data);
+    test_stm32<Crc_table::byte>(data);
+    test_stm32<Crc_table::slice8>(data);
+
+    const uint8_t* catalogue = reinterpret_cast<const uint8_t*>("123456789");
+
+    CHECK(crc32(catalogue, 9) == 0xcbf43926U);
+    CHECK(crc32c(catalogue, 9) == 0xe3069283U);
+
+    return test_result("crc_test");
+}
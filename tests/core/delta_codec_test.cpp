@@ -0,0 +1,246 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Test the delta codec.
+ *
+ * The encoded streams are compared bit by bit with a reference encoder
+ * and decoded again, for several block sizes and stream lengths around
+ * the block boundaries. Extreme streams cover the bit widths 0 and 32.
+ * Build the test with and without -D__ARM_ARCH_6M__ to cover the 32 bit
+ * accumulator of Bit_writer used on the Cortex-M0.
+ *
+ * Fixtures (in fixtures/delta_codec):
+ *
+ * - adc.txt: 512 samples of a 12 bit ADC, see the comment in the file.
+ * - adc.delta: adc.txt encoded with the default block size and the
+ *   initial value 0. It pins the encoded format.
+ *
+ * Build:
+ *
+ * \verbatim
+ * g++ -std=c++14 -O2 [-D__ARM_ARCH_6M__] -I<hodea-lib> \
+ *     -o delta_codec_test delta_codec_test.cpp
+ * \endverbatim
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <tests/test.hpp>
+#include <hodea/core/delta_codec.hpp>
+
+using namespace hodea;
+
+/**
+ * Reference encoder, writing one bit after the other.
+ */
+static std::vector<uint8_t> reference_encode(
+    const std::vector<int32_t>& samples, int block_size, int32_t initial
+    )
+{
+    std::vector<bool> bits;
+    auto put = [&bits](uint32_t val, int num_bits) {
+        for (int i = 0; i < num_bits; ++i)
+            bits.push_back((val >> i) & 1);
+    };
+    uint32_t prev = initial;
+
+    for (std::size_t start = 0; start < samples.size(); start += block_size) {
+        std::vector<uint32_t> zz;
+        int width = 0;
+
+        for (std::size_t i = start;
+             (i < start + block_size) && (i < samples.size()); ++i) {
+            uint32_t delta = static_cast<uint32_t>(samples[i]) - prev;
+
+            prev = samples[i];
+            // zigzag: 0, -1, 1, -2, ... map to 0, 1, 2, 3, ...
+            zz.push_back((delta & 0x80000000U) ? ~delta * 2 + 1 : delta * 2);
+            while ((width < 32) && (zz.back() >> width))
+                ++width;
+        }
+        put(width, delta_width_bits);
+        for (uint32_t v : zz)
+            put(v, width);
+    }
+
+    std::vector<uint8_t> bytes((bits.size() + 7) / 8);
+
+    for (std::size_t i = 0; i < bits.size(); ++i)
+        bytes[i / 8] |= bits[i] << (i % 8);
+    return bytes;
+}
+
+template <int block_size>
+static std::vector<uint8_t> encode(
+    const std::vector<int32_t>& samples, int32_t initial = 0
+    )
+{
+    std::vector<uint8_t> buf(samples.size() * 5 + 8);
+    Bit_writer w{buf.data(), static_cast<int>(buf.size())};
+    Delta_encoder<block_size> enc{w, initial};
+
+    // single samples and runs, so both put() overloads are used
+    std::size_t i = 0;
+
+    for (; i < samples.size() / 3; ++i)
+        enc.put(samples[i]);
+    enc.put(samples.data() + i, samples.size() - i);
+    CHECK(enc.flush());
+    buf.resize(w.size());
+    return buf;
+}
+
+template <int block_size>
+static bool round_trip_is_ok(
+    const std::vector<int32_t>& samples, int32_t initial = 0
+    )
+{
+    auto buf = encode<block_size>(samples, initial);
+
+    if (buf != reference_encode(samples, block_size, initial))
+        return false;
+
+    Bit_reader r{buf.data(), static_cast<int>(buf.size())};
+    Delta_decoder<block_size> dec{r, initial};
+    std::vector<int32_t> decoded(samples.size());
+
+    return dec.get(decoded.data(), decoded.size()) && dec.ok() &&
+        (decoded == samples);
+}
+
+template <int block_size>
+static void test_block_boundaries()
+{
+    Prng rng{block_size};
+    bool is_ok = true;
+
+    for (int len = 0; len <= 5 * block_size + 1; ++len) {
+        for (int range : {1, 16, 4096, 1 << 20}) {
+            std::vector<int32_t> samples(len);
+            int32_t v = rng.below(4096);
+
+            // random walk with steps in [-range / 2, range / 2]
+            for (auto& s : samples) {
+                v += rng.below(range + 1) - range / 2;
+                s = v;
+            }
+            is_ok = is_ok && round_trip_is_ok<block_size>(samples, 2048);
+        }
+    }
+    CHECK(is_ok);
+}
+
+static void test_extreme_widths()
+{
+    // constant samples equal to the initial value take width 0
+    std::vector<int32_t> constant(48, 1000);
+    auto buf = encode<16>(constant, 1000);
+
+    CHECK(buf.size() == (3 * delta_width_bits + 7) / 8);
+    CHECK(round_trip_is_ok<16>(constant, 1000));
+
+    // jumps between INT32_MIN and INT32_MAX take the full 32 bits
+    std::vector<int32_t> jumps;
+
+    for (int i = 0; i < 40; ++i) {
+        jumps.push_back(INT32_MIN);
+        jumps.push_back(INT32_MAX);
+        jumps.push_back(0);
+    }
+    buf = encode<16>(jumps);
+    CHECK(!buf.empty() && ((buf[0] & 0x3f) == 32));
+    CHECK(round_trip_is_ok<16>(jumps));
+    CHECK(round_trip_is_ok<1>(jumps));
+    CHECK(round_trip_is_ok<7>(jumps, INT32_MAX));
+}
+
+static void test_malformed()
+{
+    int16_t sample;
+
+    // bit width beyond 32
+    uint8_t bad_width[] = {0x3f, 0xff, 0xff, 0xff, 0xff, 0xff};
+    Bit_reader r1{bad_width};
+    Delta_decoder<> dec1{r1};
+
+    CHECK(!dec1.get(sample));
+    CHECK(!dec1.ok());
+
+    // truncated stream
+    std::vector<int32_t> samples(20, 0);
+
+    samples[19] = 100;
+
+    auto buf = encode<16>(samples);
+
+    buf.pop_back();
+
+    Bit_reader r2{buf.data(), static_cast<int>(buf.size())};
+    Delta_decoder<> dec2{r2};
+    std::vector<int32_t> decoded(samples.size());
+
+    CHECK(!dec2.get(decoded.data(), decoded.size()));
+
+    // buffer too small for the encoder
+    uint8_t small[4];
+    Bit_writer w{small};
+    Delta_encoder<> enc{w};
+
+    CHECK(!enc.put(samples.data(), samples.size()) || !enc.flush());
+    CHECK(!w.ok());
+}
+
+static void test_fixture(const std::string& dir)
+{
+    auto text = read_fixture(dir, "adc.txt");
+    auto expected = read_fixture(dir, "adc.delta");
+    std::istringstream in{std::string(text.begin(), text.end())};
+    std::string line;
+    std::vector<int32_t> samples;
+
+    while (std::getline(in, line)) {
+        if (line.empty() || (line[0] == '#'))
+            continue;
+
+        std::istringstream fields{line};
+        int32_t v;
+
+        while (fields >> v)
+            samples.push_back(v);
+    }
+    CHECK(samples.size() == 512);
+
+    auto buf = encode<16>(samples);
+
+    CHECK(buf == expected);
+    CHECK(buf == reference_encode(samples, 16, 0));
+
+    // about 5 bits per sample instead of 16
+    CHECK(8 * buf.size() < 6 * samples.size());
+
+    Bit_reader r{expected.data(), static_cast<int>(expected.size())};
+    Delta_decoder<> dec{r};
+    std::vector<uint16_t> decoded(samples.size());
+
+    CHECK(dec.get(decoded.data(), decoded.size()));
+    CHECK(std::equal(decoded.begin(), decoded.end(), samples.begin()));
+}
+
+int main(int argc, char* argv[])
+{
+    std::string dir = fixture_dir(argc, argv, __FILE__) + "/delta_codec";
+
+    test_fixture(dir);
+    test_block_boundaries<1>();
+    test_block_boundaries<7>();
+    test_block_boundaries<16>();
+    test_block_boundaries<64>();
+    test_extreme_widths();
+    test_malformed();
+
+    return test_result("delta_codec_test");
+}
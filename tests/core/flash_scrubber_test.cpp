@@ -0,0 +1,256 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Test the flash scrubber with a simulated CRC job and time base.
+ *
+ * The job completes a chunk after a configurable number of polls and
+ * can be told to fail or reject the next chunk. Passes are checked for
+ * several job delays and time budgets, as well as the handling of
+ * failed and rejected chunks, CRC mismatches and invalid parameters.
+ *
+ * Build:
+ *
+ * \verbatim
+ * g++ -std=c++14 -O2 -I<hodea-lib> -o flash_scrubber_test \
+ *     flash_scrubber_test.cpp
+ * \endverbatim
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <vector>
+#include <tests/test.hpp>
+#include <hodea/core/crc.hpp>
+#include <hodea/core/flash_scrubber.hpp>
+
+using namespace hodea;
+
+constexpr int image_size = 4000;
+constexpr int max_ticks = 1000000;
+
+/**
+ * Time base advancing by one tick on each query.
+ */
+struct Sim_tsc {
+    typedef uint32_t Ticks;
+
+    static Ticks now() { return ++count; }
+
+    static bool is_elapsed(Ticks start, Ticks period)
+    {
+        return now() - start >= period;
+    }
+
+    static Ticks count;
+};
+
+Sim_tsc::Ticks Sim_tsc::count = 0;
+
+/**
+ * CRC job with the interface of Crc_unit_job, calculated in software.
+ */
+class Sim_job {
+public:
+    enum struct State { idle, queued, busy, done, failed };
+
+    bool start(const void* data, int len)
+    {
+        if ((st == State::queued) || (st == State::busy))
+            return false;
+        crc.reset();
+        return submit(data, len);
+    }
+
+    bool append(const void* data, int len)
+    {
+        if (st != State::done)
+            return false;
+        return submit(data, len);
+    }
+
+    State poll()
+    {
+        if ((st == State::busy) && (++num_polls > delay)) {
+            if (fail_next) {
+                fail_next = false;
+                st = State::failed;
+            }
+            else {
+                crc.update_words(data, len);
+                st = State::done;
+            }
+        }
+        return st;
+    }
+
+    uint32_t value() const { return crc.value(); }
+
+    int delay = 0;              // polls until a chunk is done
+    bool fail_next = false;     // the next chunk fails
+    bool reject_next = false;   // the next chunk is rejected
+    bool is_chunk_valid = true; // all chunks were word-aligned
+
+private:
+    bool submit(const void* data, int len)
+    {
+        if (reject_next) {
+            reject_next = false;
+            return false;
+        }
+        this->data = static_cast<const uint8_t*>(data);
+        this->len = len;
+        is_chunk_valid = is_chunk_valid && (len > 0) &&
+            (((reinterpret_cast<uintptr_t>(data) | len) & 3) == 0);
+        st = State::busy;
+        num_polls = 0;
+        return true;
+    }
+
+    Crc32_mpeg2<> crc;
+    State st = State::idle;
+    const uint8_t* data = nullptr;
+    int len = 0;
+    int num_polls = 0;
+};
+
+typedef Flash_scrubber<Sim_tsc, Sim_job> Scrubber;
+
+static std::vector<uint32_t> make_image()
+{
+    std::vector<uint32_t> image(image_size / 4);
+
+    for (std::size_t i = 0; i < image.size(); ++i)
+        image[i] = i * 2654435761U;
+    return image;
+}
+
+static uint32_t image_crc(const std::vector<uint32_t>& image)
+{
+    return Crc32_stm32<>()(
+        reinterpret_cast<const uint8_t*>(image.data()), image_size
+        );
+}
+
+/**
+ * Call tick() until \a num_passes passes are complete.
+ */
+static void run_passes(Scrubber& scrubber, uint32_t num_passes)
+{
+    for (int i = 0; i < max_ticks; ++i) {
+        if (scrubber.statistics().num_passes >= num_passes)
+            break;
+        scrubber.tick();
+    }
+    CHECK(scrubber.statistics().num_passes == num_passes);
+}
+
+static void test_passes()
+{
+    auto image = make_image();
+    uint32_t crc = image_crc(image);
+
+    for (int delay : {0, 3, 50}) {
+        for (uint32_t budget : {0U, 10U, 1000U}) {
+            for (int chunk_size : {4, 256, 1024, image_size}) {
+                Sim_job job;
+                Scrubber scrubber{
+                    job, image.data(), image_size, crc, 1024, chunk_size,
+                    budget
+                    };
+
+                job.delay = delay;
+                CHECK(scrubber.ok());
+                run_passes(scrubber, 3);
+                CHECK(!scrubber.is_corrupted());
+                CHECK(scrubber.statistics().last_crc == crc);
+                CHECK(scrubber.statistics().num_aborted == 0);
+                CHECK(job.is_chunk_valid);
+            }
+        }
+    }
+}
+
+static void test_errors()
+{
+    auto image = make_image();
+    uint32_t crc = image_crc(image);
+    Sim_job job;
+    Scrubber scrubber{job, image.data(), image_size, crc, 1024, 256, 100};
+
+    // a failed chunk restarts the pass
+    job.fail_next = true;
+    run_passes(scrubber, 1);
+    CHECK(scrubber.statistics().num_aborted == 1);
+    CHECK(!scrubber.is_corrupted());
+
+    // so does a rejected one, also in the middle of a pass
+    job.reject_next = true;
+    CHECK(!scrubber.tick());
+    CHECK(scrubber.statistics().num_aborted == 2);
+    CHECK(scrubber.progress() == 0);
+    scrubber.tick();
+    CHECK(scrubber.progress() > 0);
+    job.reject_next = true;
+    scrubber.tick();
+    CHECK(scrubber.statistics().num_aborted == 3);
+    CHECK(scrubber.progress() == 0);
+    run_passes(scrubber, 2);
+    CHECK(!scrubber.is_corrupted());
+    CHECK(scrubber.statistics().last_crc == crc);
+
+    image[500] ^= 1;
+    run_passes(scrubber, 3);
+    CHECK(scrubber.is_corrupted());
+    CHECK(scrubber.statistics().num_errors == 1);
+
+    scrubber.clear_errors();
+    image[500] ^= 1;
+    run_passes(scrubber, 4);
+    CHECK(!scrubber.is_corrupted());
+}
+
+static void test_invalid_config()
+{
+    auto image = make_image();
+    uint32_t crc = image_crc(image);
+    const uint32_t* unaligned = reinterpret_cast<const uint32_t*>(
+        reinterpret_cast<const uint8_t*>(image.data()) + 2
+        );
+    struct {
+        const uint32_t* start;
+        int len;
+        int bytes_per_tick;
+        int chunk_size;
+    } const configs[] = {
+        {unaligned, image_size - 4, 1024, 256},
+        {image.data(), 0, 1024, 256},
+        {image.data(), image_size - 2, 1024, 256},
+        {image.data(), image_size, 0, 256},
+        {image.data(), image_size, 2, 256},
+        {image.data(), image_size, 1022, 256},
+        {image.data(), image_size, 1024, 0},
+        {image.data(), image_size, 1024, 254},
+        {image.data(), image_size, 1024, -4},
+    };
+
+    for (const auto& c : configs) {
+        Sim_job job;
+        Scrubber scrubber{
+            job, c.start, c.len, crc, c.bytes_per_tick, c.chunk_size, 100
+            };
+
+        CHECK(!scrubber.ok());
+        CHECK(scrubber.is_corrupted());
+        CHECK(!scrubber.tick());
+        CHECK(job.poll() == Sim_job::State::idle);
+    }
+}
+
+int main()
+{
+    test_passes();
+    test_errors();
+    test_invalid_config();
+
+    return test_result("flash_scrubber_test");
+}
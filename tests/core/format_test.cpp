@@ -0,0 +1,229 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Test the printf-free formatting functions.
+ *
+ * The integer functions are compared with snprintf() and the
+ * fixed-point function with a reference using 64 bit arithmetic, for
+ * boundary values and random values. Build the test with and without
+ * -D__ARM_ARCH_6M__ to cover the Cortex-M0 paths, which avoid 64 bit
+ * multiplications and shifts.
+ *
+ * Build:
+ *
+ * \verbatim
+ * g++ -std=c++14 -O2 [-D__ARM_ARCH_6M__] -I<hodea-lib> -o format_test \
+ *     format_test.cpp
+ * \endverbatim
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <cinttypes>
+#include <cstdarg>
+#include <cstring>
+#include <string>
+#include <tests/test.hpp>
+#include <hodea/core/format.hpp>
+
+using namespace hodea;
+
+constexpr int num_random = 200000;
+
+static uint64_t random_u64(uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+template <typename T>
+static std::string formatted(int (*format)(char*, T), T val)
+{
+    char buf[32];
+
+    return std::string(buf, format(buf, val));
+}
+
+static std::string printed(const char* fmt, ...)
+    __attribute__((format(printf, 1, 2)));
+
+static std::string printed(const char* fmt, ...)
+{
+    char buf[64];
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    return buf;
+}
+
+static bool check_u64(uint64_t v)
+{
+    bool is_ok =
+        (formatted(format_u64, v) == printed("%" PRIu64, v)) &&
+        (formatted(format_i64, static_cast<int64_t>(v)) ==
+            printed("%" PRId64, static_cast<int64_t>(v))) &&
+        (formatted(format_u32, static_cast<uint32_t>(v)) ==
+            printed("%" PRIu32, static_cast<uint32_t>(v))) &&
+        (formatted(format_i32, static_cast<int32_t>(v)) ==
+            printed("%" PRId32, static_cast<int32_t>(v)));
+
+    if (!is_ok)
+        fprintf(stderr, "%" PRIx64 " failed\n", v);
+    return is_ok;
+}
+
+static void test_integers()
+{
+    uint64_t state = 0x9e3779b97f4a7c15ULL;
+    bool is_ok = true;
+
+    for (uint64_t p = 1; p != 0; p *= 10) {
+        is_ok = is_ok && check_u64(p - 1) && check_u64(p) &&
+            check_u64(p + 1) && check_u64(0 - p);
+        if (p > UINT64_MAX / 10)
+            break;
+    }
+    for (int i = 0; i < 64; ++i) {
+        uint64_t p = 1ULL << i;
+
+        is_ok = is_ok && check_u64(p - 1) && check_u64(p) && check_u64(~p);
+    }
+    is_ok = is_ok && check_u64(0x7fffffffU) && check_u64(0x80000000U) &&
+        check_u64(0xffffffffU) && check_u64(0x100000000ULL) &&
+        check_u64(INT64_MAX) && check_u64(UINT64_MAX);
+
+    for (int i = 0; i < num_random; ++i) {
+        uint64_t v = random_u64(state);
+
+        // all magnitudes, not just 19 and 20 digit numbers
+        is_ok = is_ok && check_u64(v >> (i % 64));
+    }
+    CHECK(is_ok);
+}
+
+static void test_div10000()
+{
+    uint64_t state = 1;
+    bool is_ok = true;
+
+    for (int i = 0; i < num_random; ++i) {
+        uint32_t x = random_u64(state) >> (i % 32);
+
+        is_ok = is_ok && (format_div10000(x) == x / 10000);
+    }
+    for (uint32_t x = 0xffffffffU - 100000; x != 0; ++x)
+        is_ok = is_ok && (format_div10000(x) == x / 10000);
+    CHECK(is_ok);
+
+    static_assert(format_div10000(0xffffffffU) == 429496, "");
+}
+
+/**
+ * Reference for format_fixed(), with 64 bit arithmetic.
+ */
+static std::string fixed_reference(
+    int32_t val, int frac_bits, int decimals
+    )
+{
+    uint64_t scale = 1;
+
+    for (int i = 0; i < decimals; ++i)
+        scale *= 10;
+
+    uint64_t mag = (val < 0) ? -static_cast<int64_t>(val) : val;
+    uint64_t frac = mag & ((1ULL << frac_bits) - 1);
+    uint64_t dec = (frac * scale + (1ULL << (frac_bits - 1))) >> frac_bits;
+    uint64_t int_part = (mag >> frac_bits) + (dec / scale);
+
+    return printed(
+        "%s%" PRIu64 ".%0*" PRIu64, (val < 0) ? "-" : "", int_part,
+        decimals, dec % scale
+        );
+}
+
+template <int frac_bits, int decimals>
+static void check_fixed()
+{
+    uint64_t state = frac_bits * 100 + decimals;
+    int num_failed = test_state().num_failed;
+    char buf[format_fixed_size(decimals)];
+    const int32_t boundaries[] = {
+        0, 1, -1, INT32_MAX, INT32_MIN, INT32_MIN + 1,
+        static_cast<int32_t>((1U << (frac_bits - 1)) - 1),
+        static_cast<int32_t>(1U << (frac_bits - 1)),
+        static_cast<int32_t>((1ULL << frac_bits) - 1),
+    };
+
+    for (int32_t v : boundaries) {
+        int n = format_fixed<frac_bits, decimals>(buf, v);
+
+        CHECK(std::string(buf, n) == fixed_reference(v, frac_bits, decimals));
+    }
+
+    bool is_ok = true;
+
+    for (int i = 0; i < num_random / 20; ++i) {
+        int32_t v = static_cast<int32_t>(random_u64(state)) >> (i % 32);
+        int n = format_fixed<frac_bits, decimals>(buf, v);
+
+        is_ok = is_ok &&
+            (std::string(buf, n) == fixed_reference(v, frac_bits, decimals));
+    }
+    CHECK(is_ok);
+
+    if (test_state().num_failed != num_failed)
+        fprintf(stderr, "format_fixed<%d, %d> failed\n", frac_bits, decimals);
+}
+
+static void test_fixed()
+{
+    char buf[format_fixed_size(3)];
+
+    CHECK(std::string(buf, format_fixed<15, 3>(buf, 0x4000)) == "0.500");
+    CHECK(std::string(buf, format_fixed<15, 3>(buf, -0x8000)) == "-1.000");
+    CHECK(std::string(buf, format_fixed<15, 3>(buf, 0x7fff)) == "1.000");
+    CHECK(std::string(buf, format_fixed<15, 1>(buf, 0x0ccc)) == "0.1");
+
+    // 32 bit product
+    check_fixed<1, 1>();
+    check_fixed<15, 1>();
+    check_fixed<15, 4>();
+    check_fixed<15, 5>();
+    check_fixed<8, 7>();
+
+    // split product
+    check_fixed<15, 6>();
+    check_fixed<15, 9>();
+    check_fixed<16, 5>();
+    check_fixed<24, 3>();
+    check_fixed<31, 1>();
+    check_fixed<31, 9>();
+}
+
+static void test_hex()
+{
+    char buf[format_hex64_size];
+
+    CHECK(std::string(buf, format_hex(buf, 0U)) == "0");
+    CHECK(std::string(buf, format_hex(buf, 0xabcU, 8)) == "00000abc");
+    CHECK(std::string(buf, format_hex(buf, 0xffffffffU)) == "ffffffff");
+    CHECK(
+        std::string(buf, format_hex(buf, 0x123456789abcdef0ULL)) ==
+        "123456789abcdef0"
+        );
+    CHECK(std::string(buf, format_hex(buf, uint8_t{0x5a}, 1)) == "5a");
+}
+
+int main()
+{
+    test_integers();
+    test_div10000();
+    test_fixed();
+    test_hex();
+
+    return test_result("format_test");
+}
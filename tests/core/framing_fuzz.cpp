@@ -0,0 +1,439 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Round trip and fuzz test of the COBS and SLIP framing.
+ *
+ * fuzz_one() runs all checks for a single input:
+ *
+ * - The input is encoded as frame, passed to the encoder in random
+ *   chunks, and decoded again with the incremental decoder, also fed in
+ *   random chunks, and with the in-place decode function.
+ * - The input is fed as received data to the decoders. They must not
+ *   write past their buffer, and for each frame the incremental decoder
+ *   must agree with the decode function on the result.
+ *
+ * The random choices are derived from the input, so a failure can be
+ * reproduced with the input alone.
+ *
+ * Fixtures (in fixtures/framing):
+ *
+ * - vectors.txt: Known-answer vectors for both encodings.
+ * - corpus: Seed inputs, e.g. blocks at the 254 byte boundary of COBS,
+ *   SLIP escape sequences, valid and malformed frames.
+ *
+ * The test program runs the vectors, the corpus and a fixed number of
+ * mutations of it. With clang, the same checks can be run under
+ * libFuzzer, which uses and extends the corpus directory:
+ *
+ * \verbatim
+ * clang++ -std=c++14 -g -O1 -fsanitize=fuzzer,address,undefined \
+ *     -DHODEA_LIBFUZZER -I<hodea-lib> -o framing_fuzz framing_fuzz.cpp
+ * ./framing_fuzz fixtures/framing/corpus
+ * \endverbatim
+ *
+ * Build:
+ *
+ * \verbatim
+ * g++ -std=c++14 -O2 -I<hodea-lib> -o framing_fuzz framing_fuzz.cpp
+ * \endverbatim
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <tests/test.hpp>
+#include <hodea/core/cobs.hpp>
+#include <hodea/core/slip.hpp>
+
+using namespace hodea;
+
+constexpr int num_mutations = 300;
+
+/*
+ * The codecs differ in the name of the decode function and the
+ * delimiter, but share the interface otherwise.
+ */
+struct Cobs {
+    typedef Cobs_encoder Encoder;
+    typedef Cobs_decoder Decoder;
+    static constexpr uint8_t delimiter = 0;
+    static constexpr const char* name = "cobs";
+
+    static int decode(uint8_t* dst, const uint8_t* src, int len)
+    {
+        return cobs_decode(dst, src, len);
+    }
+};
+
+struct Slip {
+    typedef Slip_encoder Encoder;
+    typedef Slip_decoder Decoder;
+    static constexpr uint8_t delimiter = slip_end;
+    static constexpr const char* name = "slip";
+
+    static int decode(uint8_t* dst, const uint8_t* src, int len)
+    {
+        return slip_decode(dst, src, len);
+    }
+};
+
+constexpr uint8_t Cobs::delimiter;
+constexpr uint8_t Slip::delimiter;
+
+template <typename T_codec>
+static std::vector<uint8_t> encode(
+    const uint8_t* data, int len, int capacity, Prng& rng, bool& is_ok
+    )
+{
+    std::vector<uint8_t> buf(capacity + guard_size, guard_byte);
+    typename T_codec::Encoder enc{buf.data(), capacity};
+    int i = 0;
+
+    while (i < len) {
+        int n = rng.below(len - i) + 1;
+
+        if (n == 1)
+            enc.put(data[i]);
+        else
+            enc.put(data + i, n);
+        i += n;
+    }
+    is_ok = enc.finish();
+    CHECK(is_guard_intact(buf, capacity));
+    if (is_ok)
+        CHECK(enc.size() <= capacity);
+    buf.resize(is_ok ? enc.size() : 0);
+    return buf;
+}
+
+/**
+ * Encode the input and decode it again.
+ */
+template <typename T_codec>
+static void check_round_trip(const uint8_t* data, int len, Prng& rng)
+{
+    typedef typename T_codec::Decoder Decoder;
+    int max_size = T_codec::Encoder::max_encoded_size(len);
+    bool is_ok;
+    auto enc = encode<T_codec>(data, len, max_size, rng, is_ok);
+    int size = enc.size();
+
+    if (!CHECK(is_ok))
+        return;
+
+    // the delimiter is used at the frame boundaries only
+    CHECK(enc.back() == T_codec::delimiter);
+    CHECK(
+        std::count(enc.begin() + 1, enc.end() - 1, T_codec::delimiter) == 0
+        );
+
+    // a buffer too small must be reported, without writing past it
+    encode<T_codec>(data, len, size - 1, rng, is_ok);
+    CHECK(!is_ok);
+    encode<T_codec>(data, len, rng.below(size), rng, is_ok);
+    CHECK(!is_ok);
+
+    // incremental decoding, fed in random chunks
+    std::vector<uint8_t> dec(len + guard_size, guard_byte);
+    Decoder d{dec.data(), len};
+    int num_complete = 0;
+    int i = 0;
+
+    while (i < size) {
+        typename Decoder::Status status;
+        int n = rng.below(size - i) + 1;
+
+        i += d.put(&enc[i], n, status);
+        if (status == Decoder::Status::complete) {
+            Byte_span frame = d.frame();
+
+            ++num_complete;
+            CHECK(i == size);
+            CHECK(frame.size() == len);
+            CHECK(std::equal(frame.begin(), frame.end(), data));
+        }
+        else {
+            CHECK(status == Decoder::Status::pending);
+        }
+    }
+    CHECK(is_guard_intact(dec, len));
+
+    // SLIP has no empty frames
+    CHECK(num_complete == ((len || (T_codec::delimiter == 0)) ? 1 : 0));
+
+    // the decoder must not accept a frame exceeding its buffer
+    if (len > 0) {
+        Decoder small{dec.data(), len - 1};
+        typename Decoder::Status status;
+
+        small.put(enc.data(), size, status);
+        CHECK(status == Decoder::Status::error);
+    }
+
+    // decode in place
+    int n = T_codec::decode(enc.data(), enc.data(), size);
+
+    CHECK(n == len);
+    if (n == len)
+        CHECK(std::equal(enc.begin(), enc.begin() + n, data));
+}
+
+/**
+ * Check the status of the decoder after a delimiter against the result
+ * of the decode function for the frame preceding the delimiter.
+ *
+ * A frame that decodes and fits into the buffer is complete, otherwise
+ * an error is reported. Empty frames are ignored.
+ */
+template <typename T_codec, typename T_status>
+static bool is_status_consistent(
+    const uint8_t* frame, int len, int capacity,
+    T_status status, Byte_span decoded
+    )
+{
+    std::vector<uint8_t> ref(frame, frame + len);
+    int n = T_codec::decode(ref.data(), ref.data(), len);
+
+    if (len == 0)
+        return status == T_status::pending;
+    if ((n < 0) || (n > capacity))
+        return status == T_status::error;
+    return (status == T_status::complete) && (decoded.size() == n) &&
+        std::equal(decoded.begin(), decoded.end(), ref.begin());
+}
+
+/**
+ * Feed the input as received data to the decoders.
+ *
+ * The decoder is fed in random chunks. It stops processing a chunk
+ * after a complete frame or an error, but not after an empty frame.
+ */
+template <typename T_codec>
+static void check_garbage(const uint8_t* data, int len, Prng& rng)
+{
+    typedef typename T_codec::Decoder Decoder;
+    static const int capacities[] = {0, 1, 16, 255, 256};
+    int capacity = capacities[rng.below(5)];
+    std::vector<uint8_t> buf(capacity + guard_size, guard_byte);
+    Decoder d{buf.data(), capacity};
+    int frame_start = 0;
+    int i = 0;
+    bool is_consistent = true;
+
+    while (i < len) {
+        typename Decoder::Status status;
+        int n = d.put(data + i, rng.below(len - i) + 1, status);
+
+        for (int j = i; j < i + n; ++j) {
+            if (data[j] != T_codec::delimiter)
+                continue;
+
+            // within the chunk only empty frames can pass
+            bool is_last = j == i + n - 1;
+
+            is_consistent = is_consistent &&
+                is_status_consistent<T_codec>(
+                    data + frame_start, j - frame_start, capacity,
+                    is_last ? status : Decoder::Status::pending,
+                    d.frame()
+                    );
+            frame_start = j + 1;
+        }
+        if (data[i + n - 1] != T_codec::delimiter)
+            is_consistent = is_consistent &&
+                (status == Decoder::Status::pending);
+        i += n;
+    }
+    CHECK(is_consistent);
+    CHECK(is_guard_intact(buf, capacity));
+
+    // the decode function never produces more bytes than it consumes
+    std::vector<uint8_t> out(len + guard_size, guard_byte);
+    int n = T_codec::decode(out.data(), data, len);
+
+    CHECK(n <= len);
+    CHECK(is_guard_intact(out, len));
+}
+
+static void fuzz_one(const uint8_t* data, int len)
+{
+    Prng rng{data, len};
+
+    check_round_trip<Cobs>(data, len, rng);
+    check_round_trip<Slip>(data, len, rng);
+    check_garbage<Cobs>(data, len, rng);
+    check_garbage<Slip>(data, len, rng);
+}
+
+#if defined HODEA_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    fuzz_one(data, static_cast<int>(size));
+    if (test_state().num_failed != 0)
+        abort();
+    return 0;
+}
+
+#else
+
+template <typename T_codec>
+static void check_vector(
+    const std::vector<uint8_t>& decoded, const std::vector<uint8_t>& encoded
+    )
+{
+    Prng rng{decoded.data(), static_cast<int>(decoded.size())};
+    bool is_ok;
+    auto enc = encode<T_codec>(
+        decoded.data(), decoded.size(),
+        T_codec::Encoder::max_encoded_size(decoded.size()), rng, is_ok
+        );
+
+    if (!CHECK(is_ok && (enc == encoded)))
+        fprintf(stderr, "%s vector failed\n", T_codec::name);
+    check_round_trip<T_codec>(decoded.data(), decoded.size(), rng);
+}
+
+static void test_vectors(const std::string& dir)
+{
+    auto text = read_fixture(dir, "vectors.txt");
+    std::istringstream in{std::string(text.begin(), text.end())};
+    std::string line;
+    int num_vectors = 0;
+
+    while (std::getline(in, line)) {
+        std::istringstream fields{line};
+        std::string codec;
+        std::string decoded;
+        std::string encoded;
+
+        if (line.empty() || (line[0] == '#'))
+            continue;
+        if (!CHECK(!!(fields >> codec >> decoded >> encoded)))
+            continue;
+        if (codec == Cobs::name)
+            check_vector<Cobs>(from_hex(decoded), from_hex(encoded));
+        else
+            check_vector<Slip>(from_hex(decoded), from_hex(encoded));
+        ++num_vectors;
+    }
+    CHECK(num_vectors == 18);
+}
+
+static std::vector<std::vector<uint8_t>> read_corpus(const std::string& dir)
+{
+    std::vector<std::string> names;
+    std::vector<std::vector<uint8_t>> corpus;
+    DIR* d = opendir(dir.c_str());
+
+    if (!CHECK(d != nullptr))
+        return corpus;
+    while (struct dirent* e = readdir(d)) {
+        if (e->d_name[0] != '.')
+            names.push_back(e->d_name);
+    }
+    closedir(d);
+
+    // sorted, so the mutations do not depend on the directory order
+    std::sort(names.begin(), names.end());
+    for (const auto& name : names)
+        corpus.push_back(read_fixture(dir, name));
+    return corpus;
+}
+
+/**
+ * Mutate an input in a way likely to hit the corner cases of the
+ * framing, e.g. by inserting special characters.
+ */
+static void mutate(
+    std::vector<uint8_t>& v, const std::vector<uint8_t>& other, Prng& rng
+    )
+{
+    static const uint8_t special[] = {
+        0x00, 0x01, 0x02, 0xfe, 0xff,
+        slip_end, slip_esc, slip_esc_end, slip_esc_esc
+    };
+    int num_ops = rng.below(4) + 1;
+
+    for (int op = 0; op < num_ops; ++op) {
+        int pos = rng.below(v.size() + 1);
+
+        switch (rng.below(6)) {
+        case 0:
+            if (pos < static_cast<int>(v.size()))
+                v[pos] ^= 1U << rng.below(8);
+            break;
+        case 1:
+            if (pos < static_cast<int>(v.size()))
+                v[pos] = special[rng.below(sizeof(special))];
+            break;
+        case 2:
+            v.insert(v.begin() + pos, special[rng.below(sizeof(special))]);
+            break;
+        case 3:
+            if (pos < static_cast<int>(v.size()))
+                v.erase(v.begin() + pos);
+            break;
+        case 4:
+            v.resize(pos);
+            break;
+        default: {
+            // splice with a part of another input
+            int start = rng.below(other.size() + 1);
+            int n = rng.below(other.size() - start + 1);
+
+            v.insert(
+                v.begin() + pos,
+                other.begin() + start, other.begin() + start + n
+                );
+            break;
+        }
+        }
+    }
+}
+
+static void test_corpus(const std::string& dir)
+{
+    auto corpus = read_corpus(dir + "/corpus");
+    Prng rng{0x1055U};
+
+    CHECK(corpus.size() >= 10);
+    for (const auto& input : corpus)
+        fuzz_one(input.data(), input.size());
+
+    for (std::size_t i = 0; i < corpus.size(); ++i) {
+        for (int j = 0; j < num_mutations; ++j) {
+            std::vector<uint8_t> v = corpus[i];
+
+            mutate(v, corpus[rng.below(corpus.size())], rng);
+            fuzz_one(v.data(), v.size());
+        }
+    }
+
+    // random inputs of all sizes up to two COBS blocks
+    for (int len = 0; len <= 600; ++len) {
+        std::vector<uint8_t> v(len);
+
+        for (auto& b : v)
+            b = rng.next() >> 24;
+        fuzz_one(v.data(), len);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string dir = fixture_dir(argc, argv, __FILE__) + "/framing";
+
+    test_vectors(dir);
+    test_corpus(dir);
+
+    return test_result("framing_fuzz");
+}
+
+#endif
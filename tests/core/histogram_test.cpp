@@ -0,0 +1,106 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Test the histogram.
+ *
+ * Values of different unsigned types are accounted, in particular
+ * types too narrow to represent the number of bins.
+ *
+ * Build:
+ *
+ * \verbatim
+ * g++ -std=c++14 -O2 -I<hodea-lib> -o histogram_test histogram_test.cpp
+ * \endverbatim
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <tests/test.hpp>
+#include <hodea/core/histogram.hpp>
+
+using namespace hodea;
+
+/**
+ * Account each value of T once and check the counters against the
+ * bin each value belongs to.
+ */
+template <int num_bins, int bin_shift, typename T>
+static void test_all_values(const char* name)
+{
+    Histogram<num_bins, bin_shift> hist;
+    uint32_t expected[num_bins] = {};
+    int num_failed = test_state().num_failed;
+
+    for (uint32_t v = 0; v <= std::numeric_limits<T>::max(); ++v) {
+        uint32_t idx = v >> bin_shift;
+
+        hist.add(static_cast<T>(v));
+        ++expected[(idx < num_bins) ? idx : num_bins - 1];
+    }
+
+    bool is_equal = true;
+
+    for (int i = 0; i < num_bins; ++i)
+        is_equal = is_equal && (hist[i] == expected[i]);
+    CHECK(is_equal);
+    CHECK(hist.total() == std::numeric_limits<T>::max() + 1ULL);
+
+    hist.clear();
+    CHECK(hist.total() == 0);
+
+    if (test_state().num_failed != num_failed)
+        fprintf(stderr, "%s failed\n", name);
+}
+
+static void test_narrow_types()
+{
+    // num_bins does not fit into T
+    test_all_values<256, 0, uint8_t>("uint8_t, 256 bins");
+    test_all_values<300, 0, uint8_t>("uint8_t, 300 bins");
+    test_all_values<65536, 0, uint16_t>("uint16_t, 65536 bins");
+    test_all_values<70000, 0, uint16_t>("uint16_t, 70000 bins");
+
+    // values beyond the last bin
+    test_all_values<10, 0, uint8_t>("uint8_t, 10 bins");
+    test_all_values<10, 4, uint8_t>("uint8_t, 10 bins, shift 4");
+    test_all_values<100, 8, uint16_t>("uint16_t, 100 bins, shift 8");
+}
+
+static void test_wide_types()
+{
+    Histogram<16, 4> hist;
+
+    hist.add(0U);
+    hist.add(255U);
+    hist.add(256U);
+    hist.add(0xffffffffU);
+    hist.add(static_cast<uint64_t>(15));
+    hist.add(static_cast<uint64_t>(16));
+    hist.add(0x100000000ULL);
+    hist.add(0xffffffffffffffffULL);
+
+    CHECK(hist[0] == 2);
+    CHECK(hist[1] == 1);
+    CHECK(hist[15] == 5);
+    CHECK(hist.total() == 8);
+    CHECK(hist.lower_bound(15) == 240);
+}
+
+static void test_saturation()
+{
+    Histogram<4, 0, uint8_t> hist;
+
+    for (int i = 0; i < 1000; ++i)
+        hist.add(1U);
+    CHECK(hist[1] == 255);
+    CHECK(hist[0] == 0);
+}
+
+int main()
+{
+    test_narrow_types();
+    test_wide_types();
+    test_saturation();
+
+    return test_result("histogram_test");
+}
@@ -0,0 +1,159 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Test the interrupt latency meter with an emulated interrupt.
+ *
+ * Host_sw_irq runs the interrupt service routine as soon as it is
+ * pended and unmasked. Masking it emulates a critical section, and the
+ * time base advances only when told to, so each latency is known
+ * exactly. The statistics, the histogram, the handling of triggers
+ * while a measurement is pending and reset() are checked.
+ *
+ * Build:
+ *
+ * \verbatim
+ * g++ -std=c++14 -O2 -I<hodea-lib> -o irq_latency_meter_test \
+ *     irq_latency_meter_test.cpp
+ * \endverbatim
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <tests/test.hpp>
+#include <hodea/core/irq_latency_meter.hpp>
+#include <hodea/device/host/host_sw_irq.hpp>
+
+using namespace hodea;
+
+/**
+ * Time base advanced explicitly by the test.
+ */
+struct Fake_tsc {
+    typedef uint32_t Ticks;
+
+    static Ticks now() { return count; }
+
+    static Ticks elapsed(Ticks ts_older, Ticks ts_newer)
+    {
+        return ts_newer - ts_older;
+    }
+
+    static Ticks count;
+};
+
+Fake_tsc::Ticks Fake_tsc::count = 0;
+
+typedef Host_sw_irq<> Probe_irq;
+typedef Irq_latency_meter<Fake_tsc, Probe_irq, 8, 2> Meter;
+
+static Meter meter;
+static int num_isr_calls;
+
+static void probe_isr()
+{
+    ++num_isr_calls;
+    meter.isr_entry();
+}
+
+/**
+ * Trigger a measurement within an emulated critical section, which
+ * blocks the interrupt for \a latency ticks.
+ */
+static void measure(Fake_tsc::Ticks latency)
+{
+    Probe_irq::mask();
+    meter.trigger();
+    Fake_tsc::count += latency;
+    Probe_irq::unmask();
+}
+
+static void test_statistics()
+{
+    const Fake_tsc::Ticks latencies[] = {3, 0, 4, 7, 8, 31, 32, 1000};
+
+    meter.reset();
+    for (auto latency : latencies)
+        measure(latency);
+
+    auto s = meter.statistics();
+
+    CHECK(!meter.is_pending());
+    CHECK(s.num_samples == 8);
+    CHECK(s.min_latency == 0);
+    CHECK(s.max_latency == 1000);
+    CHECK(s.sum_latency == 1085);
+
+    // bins of 4 ticks, the last one takes all latencies beyond
+    CHECK(s.histogram[0] == 2);
+    CHECK(s.histogram[1] == 2);
+    CHECK(s.histogram[2] == 1);
+    CHECK(s.histogram[3] == 0);
+    CHECK(s.histogram[6] == 0);
+    CHECK(s.histogram[7] == 3);
+    CHECK(s.histogram.total() == 8);
+}
+
+static void test_retrigger()
+{
+    meter.reset();
+    Fake_tsc::count = 0xfffffff0U;
+
+    // a trigger while pending must not restart the measurement
+    Probe_irq::mask();
+    meter.trigger();
+    Fake_tsc::count += 10;
+    meter.trigger();
+    CHECK(meter.is_pending());
+    Fake_tsc::count += 20;
+    num_isr_calls = 0;
+    Probe_irq::unmask();
+    CHECK(num_isr_calls == 1);
+    CHECK(!meter.is_pending());
+
+    auto s = meter.statistics();
+
+    CHECK(s.num_samples == 1);
+    CHECK(s.min_latency == 30);     // across the wrap-around of the counter
+    CHECK(s.max_latency == 30);
+
+    // an interrupt without trigger is not accounted
+    Probe_irq::pend();
+    CHECK(meter.statistics().num_samples == 1);
+}
+
+static void test_run_and_reset()
+{
+    meter.reset();
+    meter.run([] { meter.trigger(); }, 100);
+
+    auto s = meter.statistics();
+
+    CHECK(s.num_samples == 100);
+    CHECK(s.max_latency == 0);
+    CHECK(s.histogram[0] == 100);
+
+    meter.reset();
+    s = meter.statistics();
+    CHECK(s.num_samples == 0);
+    CHECK(s.sum_latency == 0);
+    CHECK(s.max_latency == 0);
+    CHECK(s.histogram.total() == 0);
+
+    // the first sample after reset() sets the minimum
+    measure(5);
+    s = meter.statistics();
+    CHECK(s.min_latency == 5);
+    CHECK(s.max_latency == 5);
+}
+
+int main()
+{
+    Probe_irq::init(probe_isr);
+
+    test_statistics();
+    test_retrigger();
+    test_run_and_reset();
+
+    Probe_irq::deinit();
+    return test_result("irq_latency_meter_test");
+}
@@ -0,0 +1,282 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Round trip test of the LZSS encoder and decoder.
+ *
+ * Random, low-entropy, periodic and run-length inputs are compressed
+ * and decompressed with several window and lookahead sizes. Input and
+ * output are passed in random chunks, including empty ones, to cover
+ * the incremental interfaces. The decoder is also fed truncated,
+ * corrupted and random streams.
+ *
+ * Fixtures (in fixtures/lzss):
+ *
+ * - crash_log.txt: A synthetic log as typically compressed on a target.
+ * - crash_log.lzss: crash_log.txt compressed with the default
+ *   parameters by "tools/lzss/lzss < crash_log.txt". It pins the
+ *   compressed format.
+ *
+ * Build:
+ *
+ * \verbatim
+ * g++ -std=c++14 -O2 -I<hodea-lib> -o lzss_test lzss_test.cpp
+ * \endverbatim
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <tests/test.hpp>
+#include <hodea/core/lzss.hpp>
+
+using namespace hodea;
+
+constexpr int max_chunk = 80;
+
+// abort a round trip which makes no progress
+constexpr int max_iterations = 1000000;
+
+enum struct Input_kind {
+    random,             // incompressible
+    low_entropy,        // few symbols, skewed distribution
+    periodic,           // repeated pattern, period within or beyond window
+    runs,               // long runs of the same byte
+    num_kinds
+};
+
+static std::vector<uint8_t> make_input(Input_kind kind, int len, uint32_t seed)
+{
+    std::vector<uint8_t> v(len);
+    Prng rng{seed};
+    int period = 1 + rng.below(600);
+    std::vector<uint8_t> pattern(period);
+
+    for (auto& b : pattern)
+        b = rng.next();
+
+    for (int i = 0; i < len; ++i) {
+        switch (kind) {
+        case Input_kind::random:
+            v[i] = rng.next();
+            break;
+        case Input_kind::low_entropy: {
+            int r = rng.below(16);
+
+            v[i] = (r < 10) ? 'a' : (r < 14) ? 'b' : 'c' + (r & 1);
+            break;
+        }
+        case Input_kind::periodic:
+            v[i] = pattern[i % period];
+            break;
+        default:
+            v[i] = ((i == 0) || (rng.below(100) == 0)) ?
+                rng.next() : v[i - 1];
+            break;
+        }
+    }
+    return v;
+}
+
+template <typename T_encoder>
+static std::vector<uint8_t> compress(
+    T_encoder& enc, const std::vector<uint8_t>& data, Prng& rng
+    )
+{
+    std::vector<uint8_t> out;
+    uint8_t buf[max_chunk];
+    int size = data.size();
+    int done = 0;
+
+    enc.reset();
+    if (size == 0)
+        enc.finish();
+    for (int i = 0; !enc.is_done() && (i < max_iterations); ++i) {
+        int n = std::min(rng.below(max_chunk + 1), size - done);
+
+        if (n > 0) {
+            done += enc.sink(&data[done], n);
+            if (done == size)
+                enc.finish();
+        }
+
+        int m = enc.poll(buf, 1 + rng.below(max_chunk));
+
+        out.insert(out.end(), buf, buf + m);
+    }
+    CHECK(enc.is_done());
+    return out;
+}
+
+/**
+ * Decompress a stream until all input is consumed and no more output
+ * is available.
+ */
+template <typename T_decoder>
+static std::vector<uint8_t> decompress(
+    T_decoder& dec, const std::vector<uint8_t>& data, Prng& rng
+    )
+{
+    std::vector<uint8_t> out;
+    uint8_t buf[max_chunk];
+    int size = data.size();
+    int done = 0;
+
+    dec.reset();
+    for (int i = 0; i < max_iterations; ++i) {
+        int n = std::min(rng.below(max_chunk + 1), size - done);
+
+        if (n > 0)
+            done += dec.sink(&data[done], n);
+
+        int m = dec.poll(buf, 1 + rng.below(max_chunk));
+
+        out.insert(out.end(), buf, buf + m);
+        if ((m == 0) && ((done == size) || !dec.ok()))
+            break;
+    }
+    return out;
+}
+
+static bool is_prefix(
+    const std::vector<uint8_t>& prefix, const std::vector<uint8_t>& v
+    )
+{
+    return (prefix.size() <= v.size()) &&
+        std::equal(prefix.begin(), prefix.end(), v.begin());
+}
+
+/**
+ * Upper bound of the output decoded from \a size bytes of any stream.
+ *
+ * No back-reference yields more than max_match bytes and no literal
+ * yields more bytes per bit than a back-reference.
+ */
+template <typename T_params>
+static std::size_t max_decoded_size(std::size_t size)
+{
+    return (8 * size / T_params::backref_bits + 1) * T_params::max_match;
+}
+
+template <int window_bits, int lookahead_bits, int input_size>
+static void test_params(int max_len)
+{
+    typedef Lzss_encoder<window_bits, lookahead_bits> Encoder;
+    typedef Lzss_decoder<window_bits, lookahead_bits, input_size> Decoder;
+    typedef Lzss_params<window_bits, lookahead_bits> Params;
+
+    // the buffers are members, up to 64 KiB for the largest window
+    std::unique_ptr<Encoder> enc{new Encoder};
+    std::unique_ptr<Decoder> dec{new Decoder};
+    Prng rng{window_bits * 100 + lookahead_bits};
+    int num_failed = test_state().num_failed;
+    const int lengths[] = {
+        0, 1, 2, Params::max_match, Params::window_size - 1,
+        Params::window_size, Params::window_size + 1, max_len
+    };
+
+    for (int k = 0; k < static_cast<int>(Input_kind::num_kinds); ++k) {
+        for (int len : lengths) {
+            if (len > max_len)
+                continue;
+
+            auto data = make_input(static_cast<Input_kind>(k), len, rng.next());
+            auto packed = compress(*enc, data, rng);
+
+            // literals need 9 bits per byte, long runs at least halve
+            CHECK(packed.size() <= (9 * data.size() + 7) / 8);
+            if ((len == max_len) &&
+                (static_cast<Input_kind>(k) == Input_kind::runs))
+                CHECK(packed.size() < data.size() / 2);
+
+            auto unpacked = decompress(*dec, packed, rng);
+
+            CHECK(dec->ok());
+            CHECK(unpacked == data);
+
+            if (packed.empty())
+                continue;
+
+            // a truncated stream decodes to a prefix of the input
+            std::vector<uint8_t> truncated(
+                packed.begin(), packed.begin() + rng.below(packed.size())
+                );
+
+            unpacked = decompress(*dec, truncated, rng);
+            CHECK(dec->ok());
+            CHECK(is_prefix(unpacked, data));
+
+            // a corrupted stream must not crash the decoder
+            std::vector<uint8_t> corrupted = packed;
+
+            corrupted[rng.below(corrupted.size())] ^= 1U << rng.below(8);
+            unpacked = decompress(*dec, corrupted, rng);
+            CHECK(unpacked.size() <= max_decoded_size<Params>(packed.size()));
+        }
+    }
+
+    // random garbage
+    for (int i = 0; i < 50; ++i) {
+        auto garbage = make_input(
+            Input_kind::random, rng.below(2000), rng.next()
+            );
+        auto unpacked = decompress(*dec, garbage, rng);
+
+        CHECK(unpacked.size() <= max_decoded_size<Params>(garbage.size()));
+
+        // once failed, the decoder produces no more output
+        if (!dec->ok()) {
+            uint8_t buf[16];
+
+            CHECK(dec->poll(buf, sizeof(buf)) == 0);
+            CHECK(!dec->ok());
+        }
+    }
+
+    if (test_state().num_failed != num_failed) {
+        fprintf(
+            stderr, "Lzss<%d, %d, %d> failed\n",
+            window_bits, lookahead_bits, input_size
+            );
+    }
+}
+
+static void test_fixture(const std::string& dir)
+{
+    auto text = read_fixture(dir, "crash_log.txt");
+    auto packed = read_fixture(dir, "crash_log.lzss");
+    Lzss_encoder<> enc;
+    Lzss_decoder<> dec;
+    Prng rng{1};
+
+    CHECK(compress(enc, text, rng) == packed);
+    CHECK(decompress(dec, packed, rng) == text);
+    CHECK(dec.ok());
+    CHECK(packed.size() < text.size() / 2 + text.size() / 20);
+}
+
+int main(int argc, char* argv[])
+{
+    std::string dir = fixture_dir(argc, argv, __FILE__) + "/lzss";
+
+    // the accumulator exceeds 32 bits for back-references beyond 25 bits
+    static_assert(
+        std::is_same<Lzss_params<14, 10>::Acc, uint32_t>::value &&
+        std::is_same<Lzss_params<14, 11>::Acc, uint64_t>::value,
+        "accumulator type"
+        );
+
+    test_fixture(dir);
+    test_params<4, 2, 1>(3000);
+    test_params<4, 3, 32>(3000);
+    test_params<8, 4, 1>(20000);
+    test_params<8, 4, 32>(20000);
+    test_params<10, 6, 7>(20000);
+    test_params<12, 4, 32>(20000);
+    test_params<14, 10, 16>(40000);
+    test_params<15, 2, 4>(40000);
+    test_params<15, 14, 64>(40000);
+
+    return test_result("lzss_test");
+}
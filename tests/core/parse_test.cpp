@@ -0,0 +1,289 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Test the parsing of decimal and hexadecimal numbers.
+ *
+ * Boundary values are checked explicitly, random numbers are compared
+ * with strtoull() and a fixed-point reference using 64 bit arithmetic.
+ * Build the test with and without -D__ARM_ARCH_6M__ to cover both the
+ * SWAR and the plain digit loop.
+ *
+ * Build:
+ *
+ * \verbatim
+ * g++ -std=c++14 -O2 [-D__ARM_ARCH_6M__] -I<hodea-lib> -o parse_test \
+ *     parse_test.cpp
+ * \endverbatim
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <tests/test.hpp>
+#include <hodea/core/parse.hpp>
+
+using namespace hodea;
+
+constexpr int num_random = 100000;
+constexpr int32_t untouched = 0x5a5a5a5a;
+
+static uint64_t random_u64(uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static Const_byte_span text(const std::string& s)
+{
+    return Const_byte_span(
+        reinterpret_cast<const uint8_t*>(s.data()), s.size()
+        );
+}
+
+/**
+ * Parse an unsigned number and check the result.
+ *
+ * \a len is the expected number of bytes consumed, 0 if parsing must
+ * fail and leave the target variable unmodified.
+ */
+static bool u32_is(const std::string& s, int len, uint32_t expected = 0)
+{
+    uint32_t v = untouched;
+    int n = parse_u32(v, text(s));
+
+    return (n == len) && (v == ((len == 0) ? untouched : expected));
+}
+
+static bool i32_is(const std::string& s, int len, int32_t expected = 0)
+{
+    int32_t v = untouched;
+    int n = parse_i32(v, text(s));
+
+    return (n == len) && (v == ((len == 0) ? untouched : expected));
+}
+
+static bool hex_is(const std::string& s, int len, uint32_t expected = 0)
+{
+    uint32_t v = untouched;
+    int n = parse_hex(v, text(s));
+
+    return (n == len) && (v == ((len == 0) ? untouched : expected));
+}
+
+template <int frac_bits>
+static bool fixed_is(const std::string& s, int len, int32_t expected = 0)
+{
+    int32_t v = untouched;
+    int n = parse_fixed<frac_bits>(v, text(s));
+
+    return (n == len) && (v == ((len == 0) ? untouched : expected));
+}
+
+static void test_u32()
+{
+    CHECK(u32_is("0", 1, 0));
+    CHECK(u32_is("4294967295", 10, 4294967295U));
+    CHECK(u32_is("4294967296", 0));
+    CHECK(u32_is("4294967300", 0));
+    CHECK(u32_is("5000000000", 0));
+    CHECK(u32_is("42949672950", 0));
+    CHECK(u32_is("0000000004294967295", 19, 4294967295U));
+    CHECK(u32_is("0000000004294967296", 0));
+    CHECK(u32_is("12345678", 8, 12345678));
+    CHECK(u32_is("123456789", 9, 123456789));
+    CHECK(u32_is("1234567/9", 7, 1234567));
+    CHECK(u32_is("1234567:9", 7, 1234567));
+    CHECK(u32_is("12345678 ", 8, 12345678));
+    CHECK(u32_is("7 ", 1, 7));
+    CHECK(u32_is("", 0));
+    CHECK(u32_is(" 1", 0));
+    CHECK(u32_is("+1", 0));
+    CHECK(u32_is("-1", 0));
+
+    // no access beyond the end of the span
+    std::string digits = "123456789";
+    uint32_t v = untouched;
+
+    CHECK(parse_u32(v, text(digits).subspan(0, 3)) == 3);
+    CHECK(v == 123);
+}
+
+static void test_i32()
+{
+    CHECK(i32_is("2147483647", 10, INT32_MAX));
+    CHECK(i32_is("+2147483647", 11, INT32_MAX));
+    CHECK(i32_is("2147483648", 0));
+    CHECK(i32_is("+2147483648", 0));
+    CHECK(i32_is("-2147483648", 11, INT32_MIN));
+    CHECK(i32_is("-2147483649", 0));
+    CHECK(i32_is("-4294967296", 0));
+    CHECK(i32_is("-0", 2, 0));
+    CHECK(i32_is("-12x", 3, -12));
+    CHECK(i32_is("-", 0));
+    CHECK(i32_is("+", 0));
+    CHECK(i32_is("--1", 0));
+    CHECK(i32_is("", 0));
+}
+
+static void test_hex()
+{
+    CHECK(hex_is("0", 1, 0));
+    CHECK(hex_is("ffffffff", 8, 0xffffffffU));
+    CHECK(hex_is("0xFFFFFFFF", 10, 0xffffffffU));
+    CHECK(hex_is("00000000ffffffff", 16, 0xffffffffU));
+    CHECK(hex_is("100000000", 0));
+    CHECK(hex_is("0x100000000", 0));
+    CHECK(hex_is("0X1aB", 5, 0x1ab));
+    CHECK(hex_is("DeadBeefg", 8, 0xdeadbeefU));
+
+    // "0x" without digits is the number 0 followed by 'x'
+    CHECK(hex_is("0x", 1, 0));
+    CHECK(hex_is("0X", 1, 0));
+    CHECK(hex_is("0xg", 1, 0));
+    CHECK(hex_is("0x ", 1, 0));
+    CHECK(hex_is("x1", 0));
+    CHECK(hex_is("", 0));
+    CHECK(hex_is("g", 0));
+}
+
+static void test_fixed()
+{
+    CHECK(fixed_is<15>("0.5", 3, 0x4000));
+    CHECK(fixed_is<15>(".5", 2, 0x4000));
+    CHECK(fixed_is<15>("1.", 2, 0x8000));
+    CHECK(fixed_is<15>("-1", 2, -0x8000));
+    CHECK(fixed_is<15>("+0.25x", 5, 0x2000));
+    CHECK(fixed_is<15>(".", 0));
+    CHECK(fixed_is<15>("-", 0));
+    CHECK(fixed_is<15>("-.", 0));
+    CHECK(fixed_is<15>("", 0));
+
+    // half an LSB rounds away from zero
+    CHECK(fixed_is<1>("0.25", 4, 1));
+    CHECK(fixed_is<1>("-0.25", 5, -1));
+    CHECK(fixed_is<1>("0.249999999", 11, 0));
+    CHECK(fixed_is<1>("0.75", 4, 2));
+    CHECK(fixed_is<15>("0.000015258", 11, 0));
+    CHECK(fixed_is<15>("0.000015259", 11, 1));
+    CHECK(fixed_is<15>("-0.000015259", 12, -1));
+    CHECK(fixed_is<15>("0.999984741", 11, 0x7fff));
+    CHECK(fixed_is<15>("0.999984742", 11, 0x8000));
+
+    // digits beyond the ninth are ignored
+    CHECK(fixed_is<15>("0.0000152589", 12, 0));
+    CHECK(fixed_is<15>("1.0000000009999", 15, 0x8000));
+
+    // range of int32_t
+    CHECK(fixed_is<15>("65535.999984741", 15, INT32_MAX));
+    CHECK(fixed_is<15>("65535.999984742", 0));
+    CHECK(fixed_is<15>("65536", 0));
+    CHECK(fixed_is<15>("-65536", 6, INT32_MIN));
+    CHECK(fixed_is<15>("-65536.000015258", 16, INT32_MIN));
+    CHECK(fixed_is<15>("-65536.000015259", 0));
+    CHECK(fixed_is<15>("4294967296", 0));
+    CHECK(fixed_is<0>("2147483647.4", 12, INT32_MAX));
+    CHECK(fixed_is<0>("2147483647.5", 0));
+    CHECK(fixed_is<0>("-2147483648.5", 0));
+    CHECK(fixed_is<31>("-1", 2, INT32_MIN));
+    CHECK(fixed_is<31>("1", 0));
+}
+
+/**
+ * Reference for parse_fixed(), with 64 bit arithmetic.
+ */
+static int64_t fixed_reference(
+    bool is_negative, uint32_t int_part, uint32_t num, uint32_t den,
+    int frac_bits
+    )
+{
+    uint64_t n = static_cast<uint64_t>(num) << frac_bits;
+    int64_t mag = (static_cast<int64_t>(int_part) << frac_bits) +
+        (2 * n + den) / (2 * den);
+
+    return is_negative ? -mag : mag;
+}
+
+template <int frac_bits>
+static bool check_random_fixed(uint64_t& state)
+{
+    bool is_negative = random_u64(state) & 1;
+    // all magnitudes up to slightly beyond the range of int32_t
+    uint64_t r = random_u64(state) >> (32 + frac_bits);
+    uint32_t int_part = r >> (random_u64(state) % (33 - frac_bits));
+    int num_digits = random_u64(state) % 10;
+    uint32_t den = 1;
+    std::string s = (is_negative ? "-" : "") + std::to_string(int_part);
+
+    for (int i = 0; i < num_digits; ++i)
+        den *= 10;
+
+    uint32_t num = random_u64(state) % den;
+    std::string digits = std::to_string(num);
+
+    if (num_digits > 0)
+        s += "." + std::string(num_digits - digits.size(), '0') + digits;
+
+    int64_t expected =
+        fixed_reference(is_negative, int_part, num, den, frac_bits);
+    int32_t v = untouched;
+    int n = parse_fixed<frac_bits>(v, text(s));
+
+    if ((expected < INT32_MIN) || (expected > INT32_MAX))
+        return (n == 0) && (v == untouched);
+    return (n == static_cast<int>(s.size())) && (v == expected);
+}
+
+static void test_random()
+{
+    uint64_t state = 0x9e3779b97f4a7c15ULL;
+    bool is_ok = true;
+
+    for (int i = 0; (i < num_random) && is_ok; ++i) {
+        uint64_t x = random_u64(state) >> (i % 64);
+        std::string s = std::to_string(x);
+
+        // with leading zeros to cross the 8 digit blocks differently
+        s = std::string(i % 11, '0') + s;
+
+        unsigned long long ref = strtoull(s.c_str(), nullptr, 10);
+        uint32_t v = untouched;
+        int n = parse_u32(v, text(s + "x"));
+
+        is_ok = (ref > 0xffffffffU) ?
+            ((n == 0) && (v == untouched)) :
+            ((n == static_cast<int>(s.size())) && (v == ref));
+
+        char buf[16];
+        uint32_t y = x;
+        std::string z = std::to_string(static_cast<int32_t>(y));
+
+        snprintf(buf, sizeof(buf), "%x", static_cast<unsigned>(y));
+        is_ok = is_ok && hex_is(buf, strlen(buf), y) &&
+            i32_is(z, z.size(), static_cast<int32_t>(y));
+    }
+    CHECK(is_ok);
+
+    is_ok = true;
+    for (int i = 0; (i < num_random) && is_ok; ++i) {
+        is_ok = check_random_fixed<0>(state) &&
+            check_random_fixed<15>(state) &&
+            check_random_fixed<24>(state) &&
+            check_random_fixed<31>(state);
+    }
+    CHECK(is_ok);
+}
+
+int main()
+{
+    test_u32();
+    test_i32();
+    test_hex();
+    test_fixed();
+    test_random();
+
+    return test_result("parse_test");
+}
@@ -0,0 +1,477 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Test the protobuf codec against encodings generated by protoc.
+ *
+ * Fixtures (in fixtures/protobuf):
+ *
+ * - telemetry.proto: The message definition, covering all scalar
+ *   types, packed repeated fields, a nested message, an enum and the
+ *   largest field number.
+ * - telemetry_full.txt, telemetry_limits.txt: The field values in
+ *   protobuf text format, the latter with the extreme values.
+ * - telemetry_full.bin, telemetry_limits.bin: The reference encodings
+ *   generated with "protoc --encode" as noted in telemetry.proto.
+ *
+ * The messages are encoded with Pb_writer and compared byte by byte
+ * with the reference encodings, which are then decoded with Pb_reader.
+ *
+ * Build:
+ *
+ * \verbatim
+ * g++ -std=c++14 -O2 -I<hodea-lib> -o protobuf_test protobuf_test.cpp
+ * \endverbatim
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <string>
+#include <vector>
+#include <tests/test.hpp>
+#include <hodea/core/protobuf.hpp>
+
+using namespace hodea;
+
+enum class Mode { idle = 0, run = 1, fault = 300 };
+
+using Tm_seq = Pb_field<1, Pb_type::uint32>;
+using Tm_current = Pb_field<2, Pb_type::sint32>;
+using Tm_timestamp = Pb_field<3, Pb_type::fixed64>;
+using Tm_samples = Pb_field<4, Pb_type::uint32>;
+using Tm_neg = Pb_field<5, Pb_type::int32>;
+using Tm_flag = Pb_field<6, Pb_type::boolean>;
+using Tm_f = Pb_field<7, Pb_type::float32>;
+using Tm_d = Pb_field<8, Pb_type::float64>;
+using Tm_sf = Pb_field<9, Pb_type::sfixed32>;
+using Tm_s64 = Pb_field<10, Pb_type::sint64>;
+using Tm_inner = Pb_field<11, Pb_type::bytes>;
+using Tm_blob = Pb_field<12, Pb_type::bytes>;
+using Tm_zz = Pb_field<13, Pb_type::sint32>;
+using Tm_fx = Pb_field<14, Pb_type::fixed32>;
+using Tm_u64 = Pb_field<15, Pb_type::uint64>;
+using Tm_sf64 = Pb_field<16, Pb_type::sfixed64>;
+using Tm_i64 = Pb_field<17, Pb_type::int64>;
+using Tm_mode = Pb_field<18, Pb_type::enumeration>;
+using Tm_last = Pb_field<536870911, Pb_type::uint32>;
+
+using Inner_a = Pb_field<1, Pb_type::uint32>;
+using Inner_s = Pb_field<2, Pb_type::bytes>;
+
+constexpr int max_elems = 8;
+
+/**
+ * Decoded message. Fields not present in the encoding keep their
+ * default value, as in proto3.
+ */
+struct Telemetry {
+    uint32_t seq;
+    int32_t current;
+    uint64_t timestamp;
+    uint32_t samples[max_elems];
+    int num_samples;
+    int32_t neg;
+    bool flag;
+    float f;
+    double d;
+    int32_t sf;
+    int64_t s64;
+    bool has_inner;
+    uint32_t inner_a;
+    std::string inner_s;
+    std::string blob;
+    int32_t zz[max_elems];
+    int num_zz;
+    uint32_t fx[max_elems];
+    int num_fx;
+    uint64_t u64;
+    int64_t sf64;
+    int64_t i64;
+    Mode mode;
+    uint32_t last;
+};
+
+static Telemetry full_message()
+{
+    Telemetry tm = Telemetry{};
+
+    tm.seq = 150;
+    tm.current = -3;
+    tm.timestamp = 81985529216486895ULL;
+    tm.samples[0] = 1;
+    tm.samples[1] = 300;
+    tm.samples[2] = 70000;
+    tm.samples[3] = 0;
+    tm.num_samples = 4;
+    tm.neg = -2;
+    tm.flag = true;
+    tm.f = 1.5f;
+    tm.d = -2.25;
+    tm.sf = -7;
+    tm.s64 = -1234567890123LL;
+    tm.has_inner = true;
+    tm.inner_a = 5;
+    tm.inner_s = std::string(200, 'x');  // length needs a 2 byte varint
+    tm.blob = "abc";
+    tm.zz[0] = -1;
+    tm.zz[1] = 1;
+    tm.zz[2] = -64;
+    tm.zz[3] = 64;
+    tm.num_zz = 4;
+    tm.fx[0] = 1;
+    tm.fx[1] = 2;
+    tm.num_fx = 2;
+    tm.u64 = 1099511627776ULL;
+    tm.sf64 = -81985529216486895LL;
+    tm.i64 = -300;
+    tm.mode = Mode::fault;
+    tm.last = 7;
+    return tm;
+}
+
+static Telemetry limits_message()
+{
+    Telemetry tm = Telemetry{};
+
+    tm.seq = UINT32_MAX;
+    tm.current = INT32_MIN;
+    tm.timestamp = UINT64_MAX;
+    tm.samples[0] = UINT32_MAX;
+    tm.num_samples = 1;
+    tm.neg = INT32_MIN;         // negative int32 takes 10 bytes
+    tm.sf = INT32_MIN;
+    tm.s64 = INT64_MIN;
+    tm.zz[0] = INT32_MAX;
+    tm.zz[1] = INT32_MIN;
+    tm.num_zz = 2;
+    tm.u64 = UINT64_MAX;
+    tm.sf64 = INT64_MIN;
+    tm.i64 = INT64_MIN;
+    tm.last = UINT32_MAX;
+    return tm;
+}
+
+/**
+ * Encode the fields with non-default values in field number order,
+ * as protoc does.
+ */
+static void encode(Pb_writer& w, const Telemetry& tm)
+{
+    if (tm.seq)
+        w.write<Tm_seq>(tm.seq);
+    if (tm.current)
+        w.write<Tm_current>(tm.current);
+    if (tm.timestamp)
+        w.write<Tm_timestamp>(tm.timestamp);
+    if (tm.num_samples)
+        w.write_packed<Tm_samples>(tm.samples, tm.num_samples);
+    if (tm.neg)
+        w.write<Tm_neg>(tm.neg);
+    if (tm.flag)
+        w.write<Tm_flag>(tm.flag);
+    if (tm.f != 0.0f)
+        w.write<Tm_f>(tm.f);
+    if (tm.d != 0.0)
+        w.write<Tm_d>(tm.d);
+    if (tm.sf)
+        w.write<Tm_sf>(tm.sf);
+    if (tm.s64)
+        w.write<Tm_s64>(tm.s64);
+    if (tm.has_inner) {
+        int mark = w.begin_message<Tm_inner>();
+
+        w.write<Inner_a>(tm.inner_a);
+        w.write_bytes<Inner_s>(tm.inner_s.data(), tm.inner_s.size());
+        w.end_message(mark);
+    }
+    if (!tm.blob.empty())
+        w.write_bytes<Tm_blob>(tm.blob.data(), tm.blob.size());
+    if (tm.num_zz)
+        w.write_packed<Tm_zz>(tm.zz, tm.num_zz);
+    if (tm.num_fx)
+        w.write_packed<Tm_fx>(tm.fx, tm.num_fx);
+    if (tm.u64)
+        w.write<Tm_u64>(tm.u64);
+    if (tm.sf64)
+        w.write<Tm_sf64>(tm.sf64);
+    if (tm.i64)
+        w.write<Tm_i64>(tm.i64);
+    if (tm.mode != Mode::idle)
+        w.write<Tm_mode>(static_cast<int32_t>(tm.mode));
+    if (tm.last)
+        w.write<Tm_last>(tm.last);
+}
+
+static void decode_inner(Telemetry& tm, Const_byte_span bytes, bool& is_ok)
+{
+    Pb_reader r{bytes};
+
+    tm.has_inner = true;
+    while (r.next()) {
+        switch (r.field_number()) {
+        case Inner_a::number:
+            r.read<Inner_a>(tm.inner_a);
+            break;
+        case Inner_s::number: {
+            Const_byte_span s = r.read_bytes();
+
+            tm.inner_s.assign(s.begin(), s.end());
+            break;
+        }
+        default:
+            r.skip();
+            break;
+        }
+    }
+    is_ok = r.ok();
+}
+
+static bool decode(Telemetry& tm, const uint8_t* buf, int len)
+{
+    Pb_reader r{buf, len};
+    bool is_inner_ok = true;
+    int32_t mode;
+    Const_byte_span blob;
+
+    tm = Telemetry{};
+    while (r.next()) {
+        switch (r.field_number()) {
+        case Tm_seq::number:
+            r.read<Tm_seq>(tm.seq);
+            break;
+        case Tm_current::number:
+            r.read<Tm_current>(tm.current);
+            break;
+        case Tm_timestamp::number:
+            r.read<Tm_timestamp>(tm.timestamp);
+            break;
+        case Tm_samples::number:
+            tm.num_samples += r.read_packed<Tm_samples>(
+                tm.samples + tm.num_samples, max_elems - tm.num_samples
+                );
+            break;
+        case Tm_neg::number:
+            r.read<Tm_neg>(tm.neg);
+            break;
+        case Tm_flag::number:
+            r.read<Tm_flag>(tm.flag);
+            break;
+        case Tm_f::number:
+            r.read<Tm_f>(tm.f);
+            break;
+        case Tm_d::number:
+            r.read<Tm_d>(tm.d);
+            break;
+        case Tm_sf::number:
+            r.read<Tm_sf>(tm.sf);
+            break;
+        case Tm_s64::number:
+            r.read<Tm_s64>(tm.s64);
+            break;
+        case Tm_inner::number:
+            decode_inner(tm, r.read_bytes(), is_inner_ok);
+            break;
+        case Tm_blob::number:
+            blob = r.read_bytes();
+            tm.blob.assign(blob.begin(), blob.end());
+            break;
+        case Tm_zz::number:
+            tm.num_zz += r.read_packed<Tm_zz>(
+                tm.zz + tm.num_zz, max_elems - tm.num_zz
+                );
+            break;
+        case Tm_fx::number:
+            tm.num_fx += r.read_packed<Tm_fx>(
+                tm.fx + tm.num_fx, max_elems - tm.num_fx
+                );
+            break;
+        case Tm_u64::number:
+            r.read<Tm_u64>(tm.u64);
+            break;
+        case Tm_sf64::number:
+            r.read<Tm_sf64>(tm.sf64);
+            break;
+        case Tm_i64::number:
+            r.read<Tm_i64>(tm.i64);
+            break;
+        case Tm_mode::number:
+            if (r.read<Tm_mode>(mode))
+                tm.mode = static_cast<Mode>(mode);
+            break;
+        case Tm_last::number:
+            r.read<Tm_last>(tm.last);
+            break;
+        default:
+            r.skip();
+            break;
+        }
+    }
+    return r.ok() && r.at_end() && is_inner_ok;
+}
+
+static bool is_equal(const Telemetry& a, const Telemetry& b)
+{
+    bool is_eq =
+        (a.seq == b.seq) && (a.current == b.current) &&
+        (a.timestamp == b.timestamp) && (a.num_samples == b.num_samples) &&
+        (a.neg == b.neg) && (a.flag == b.flag) && (a.f == b.f) &&
+        (a.d == b.d) && (a.sf == b.sf) && (a.s64 == b.s64) &&
+        (a.has_inner == b.has_inner) && (a.inner_a == b.inner_a) &&
+        (a.inner_s == b.inner_s) && (a.blob == b.blob) &&
+        (a.num_zz == b.num_zz) && (a.num_fx == b.num_fx) &&
+        (a.u64 == b.u64) && (a.sf64 == b.sf64) && (a.i64 == b.i64) &&
+        (a.mode == b.mode) && (a.last == b.last);
+
+    for (int i = 0; is_eq && (i < a.num_samples); ++i)
+        is_eq = a.samples[i] == b.samples[i];
+    for (int i = 0; is_eq && (i < a.num_zz); ++i)
+        is_eq = a.zz[i] == b.zz[i];
+    for (int i = 0; is_eq && (i < a.num_fx); ++i)
+        is_eq = a.fx[i] == b.fx[i];
+    return is_eq;
+}
+
+static void test_encode(const std::vector<uint8_t>& ref, const Telemetry& tm)
+{
+    std::vector<uint8_t> buf(ref.size() + 16);
+    Pb_writer w{buf.data(), static_cast<int>(buf.size())};
+
+    encode(w, tm);
+    CHECK(w.ok());
+    CHECK(w.size() == static_cast<int>(ref.size()));
+    buf.resize(w.size());
+    CHECK(buf == ref);
+}
+
+static void test_decode(const std::vector<uint8_t>& ref, const Telemetry& tm)
+{
+    Telemetry result;
+
+    CHECK(decode(result, ref.data(), ref.size()));
+    CHECK(is_equal(result, tm));
+}
+
+/**
+ * Every buffer smaller than the message must be reported as overflow,
+ * without writing past its end.
+ */
+static void test_overflow(const std::vector<uint8_t>& ref, const Telemetry& tm)
+{
+    constexpr int guard = 16;
+    bool is_rejected = true;
+    bool is_guard_intact = true;
+
+    for (int cap = 0; cap < static_cast<int>(ref.size()); ++cap) {
+        std::vector<uint8_t> buf(cap + guard, 0xa5);
+        Pb_writer w{buf.data(), cap};
+
+        encode(w, tm);
+        is_rejected = is_rejected && !w.ok() && (w.size() <= cap);
+        for (int i = cap; i < cap + guard; ++i)
+            is_guard_intact = is_guard_intact && (buf[i] == 0xa5);
+    }
+    CHECK(is_rejected);
+    CHECK(is_guard_intact);
+
+    std::vector<uint8_t> buf(ref.size());
+    Pb_writer w{buf.data(), static_cast<int>(buf.size())};
+
+    encode(w, tm);
+    CHECK(w.ok());
+    CHECK(buf == ref);
+}
+
+/**
+ * A message cut within a field must fail. A message cut at a field
+ * boundary is valid, but must not decode to the complete message.
+ */
+static void test_truncated(const std::vector<uint8_t>& ref)
+{
+    bool is_consistent = true;
+    int num_failed = 0;
+    Telemetry complete;
+
+    decode(complete, ref.data(), ref.size());
+    for (int len = 0; len < static_cast<int>(ref.size()); ++len) {
+        // copy, so reads past the end are visible to sanitizers
+        std::vector<uint8_t> buf(ref.begin(), ref.begin() + len);
+        Telemetry result;
+
+        if (decode(result, buf.data(), len))
+            is_consistent = is_consistent && !is_equal(result, complete);
+        else
+            ++num_failed;
+    }
+    CHECK(is_consistent);
+    CHECK(num_failed > 0);
+
+    Pb_reader r{ref.data(), static_cast<int>(ref.size()) - 1};
+
+    while (r.next())
+        r.skip();
+    CHECK(!r.ok());
+}
+
+/**
+ * Unknown fields are skipped, wrong wire types rejected.
+ */
+static void test_unknown(const std::vector<uint8_t>& ref)
+{
+    Pb_reader r{ref.data(), static_cast<int>(ref.size())};
+    uint32_t seq = 0;
+    uint32_t last = 0;
+    int num_skipped = 0;
+
+    while (r.next()) {
+        if (r.field_number() == Tm_seq::number) {
+            r.read<Tm_seq>(seq);
+        }
+        else if (r.field_number() == Tm_last::number) {
+            r.read<Tm_last>(last);
+        }
+        else {
+            r.skip();
+            ++num_skipped;
+        }
+    }
+    CHECK(r.ok() && r.at_end());
+    CHECK(seq == 150);
+    CHECK(last == 7);
+    CHECK(num_skipped == 17);
+
+    // seq is a varint, not a fixed32
+    using Tm_seq_fixed = Pb_field<1, Pb_type::fixed32>;
+    Pb_reader rf{ref.data(), static_cast<int>(ref.size())};
+
+    if (CHECK(rf.next()))
+        CHECK(!rf.read<Tm_seq_fixed>(seq));
+    CHECK(!rf.ok());
+    CHECK(!rf.next());
+
+    // more packed values than space available
+    Pb_reader rp{ref.data(), static_cast<int>(ref.size())};
+    uint32_t samples[2];
+
+    while (rp.next() && (rp.field_number() != Tm_samples::number))
+        rp.skip();
+    CHECK(rp.read_packed<Tm_samples>(samples, 2) == 2);
+    CHECK(!rp.ok());
+}
+
+int main(int argc, char* argv[])
+{
+    std::string dir = fixture_dir(argc, argv, __FILE__) + "/protobuf";
+    auto full = read_fixture(dir, "telemetry_full.bin");
+    auto limits = read_fixture(dir, "telemetry_limits.bin");
+
+    test_encode(full, full_message());
+    test_encode(limits, limits_message());
+    test_decode(full, full_message());
+    test_decode(limits, limits_message());
+    test_overflow(full, full_message());
+    test_overflow(limits, limits_message());
+    test_truncated(full);
+    test_truncated(limits);
+    test_unknown(full);
+
+    return test_result("protobuf_test");
+}
@@ -0,0 +1,491 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Test the base64 and hexadecimal codecs.
+ *
+ * The codecs are checked against the RFC 4648 vectors, a bit-by-bit
+ * reference encoder and a set of malformed inputs. Streams are passed
+ * in random chunks, and the output buffers are sized exactly as
+ * documented with guard bytes behind them. Every character of an
+ * encoded text is replaced by invalid characters, which must be
+ * rejected by the SIMD and the scalar paths alike. Build the test with
+ * and without -mssse3 and -mavx2 to cover the SIMD paths.
+ *
+ * Fixtures (in fixtures/rfc4648):
+ *
+ * - vectors.txt: Known-answer vectors.
+ * - invalid.txt: Malformed input.
+ *
+ * Build:
+ *
+ * \verbatim
+ * g++ -std=c++14 -O2 [-mavx2] -I<hodea-lib> -o rfc4648_test \
+ *     rfc4648_test.cpp
+ * \endverbatim
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <tests/test.hpp>
+#include <hodea/core/base64.hpp>
+#include <hodea/core/hex_codec.hpp>
+
+using namespace hodea;
+
+constexpr int max_len = 300;
+constexpr int max_chunk = 40;
+
+static std::string to_lower(std::string s)
+{
+    for (auto& c : s) {
+        if ((c >= 'A') && (c <= 'Z'))
+            c += 'a' - 'A';
+    }
+    return s;
+}
+
+static std::vector<uint8_t> random_data(int len, Prng& rng)
+{
+    std::vector<uint8_t> v(len);
+
+    for (auto& b : v)
+        b = rng.next();
+    return v;
+}
+
+/**
+ * Get a random chunk size, 0 included.
+ */
+static int chunk_size(int remaining, Prng& rng)
+{
+    return std::min(rng.below(max_chunk + 1), remaining);
+}
+
+/**
+ * Reference base64 encoder, processing one bit after the other.
+ */
+static std::string base64_reference(const std::vector<uint8_t>& data)
+{
+    std::string s;
+    int num_bits = 8 * data.size();
+    int v = 0;
+
+    for (int i = 0; i < num_bits; ++i) {
+        v = (v << 1) | ((data[i / 8] >> (7 - i % 8)) & 1);
+        if ((i % 6 == 5) || (i == num_bits - 1)) {
+            v <<= 5 - i % 6;
+            s += base64_alphabet[v];
+            v = 0;
+        }
+    }
+    while (s.size() % 4)
+        s += '=';
+    return s;
+}
+
+static std::string base64_one_shot(const std::vector<uint8_t>& data)
+{
+    int len = data.size();
+    std::vector<char> buf(base64_encoded_size(len) + guard_size, guard_byte);
+    int n = base64_encode(buf.data(), data.data(), len);
+
+    CHECK(n == base64_encoded_size(len));
+    CHECK(is_guard_intact(buf, n));
+    return std::string(buf.data(), n);
+}
+
+static std::string base64_chunked(const std::vector<uint8_t>& data, Prng& rng)
+{
+    Base64_encoder enc;
+    std::string s;
+    int size = data.size();
+    bool is_ok = true;
+
+    for (int done = 0; done < size; ) {
+        int len = chunk_size(size - done, rng);
+        std::vector<char> buf(
+            Base64_encoder::max_put_size(len) + guard_size, guard_byte
+            );
+        int n = enc.put(buf.data(), data.data() + done, len);
+
+        is_ok = is_ok && (n <= Base64_encoder::max_put_size(len)) &&
+            is_guard_intact(buf, n);
+        s.append(buf.data(), n);
+        done += len;
+    }
+
+    std::vector<char> buf(Base64_encoder::finish_size + guard_size, guard_byte);
+    int n = enc.finish(buf.data());
+
+    CHECK(is_ok && is_guard_intact(buf, n));
+    s.append(buf.data(), n);
+    return s;
+}
+
+/**
+ * Decode a complete buffer.
+ *
+ * \returns
+ *      False if the decoder rejects the input.
+ */
+static bool base64_one_shot(std::vector<uint8_t>& data, const std::string& s)
+{
+    int len = s.size();
+    std::vector<uint8_t> buf(base64_decoded_size(len) + guard_size, guard_byte);
+    int n = base64_decode(buf.data(), s.data(), len);
+
+    data.clear();
+    if (n < 0)
+        return false;
+    CHECK(is_guard_intact(buf, n));
+    data.assign(buf.begin(), buf.begin() + n);
+    return true;
+}
+
+static bool base64_chunked(
+    std::vector<uint8_t>& data, const std::string& s, Prng& rng
+    )
+{
+    Base64_decoder dec;
+    int size = s.size();
+    bool is_ok = true;
+
+    data.clear();
+    for (int done = 0; done < size; ) {
+        int len = chunk_size(size - done, rng);
+        std::vector<uint8_t> buf(
+            Base64_decoder::max_put_size(len) + guard_size, guard_byte
+            );
+        int n = dec.put(buf.data(), s.data() + done, len);
+
+        if (n < 0) {
+            // the decoder stays failed until reset
+            CHECK(!dec.ok());
+            CHECK(dec.put(buf.data(), "Zm9v", 4) < 0);
+            return false;
+        }
+        is_ok = is_ok && (n <= Base64_decoder::max_put_size(len)) &&
+            is_guard_intact(buf, n);
+        data.insert(data.end(), buf.begin(), buf.begin() + n);
+        done += len;
+    }
+
+    std::vector<uint8_t> buf(
+        Base64_decoder::finish_size + guard_size, guard_byte
+        );
+    int n = dec.finish(buf.data());
+
+    CHECK(is_ok);
+    if (n < 0)
+        return false;
+    CHECK(is_guard_intact(buf, n));
+    data.insert(data.end(), buf.begin(), buf.begin() + n);
+    return true;
+}
+
+static std::string hex_one_shot(const std::vector<uint8_t>& data)
+{
+    int len = data.size();
+    std::vector<char> buf(2 * len + guard_size, guard_byte);
+    int n = hex_encode(buf.data(), data.data(), len);
+
+    CHECK(n == 2 * len);
+    CHECK(is_guard_intact(buf, n));
+    return std::string(buf.data(), n);
+}
+
+static std::string hex_chunked(const std::vector<uint8_t>& data, Prng& rng)
+{
+    std::string s;
+    int size = data.size();
+
+    for (int done = 0; done < size; ) {
+        int len = chunk_size(size - done, rng);
+        std::vector<char> buf(2 * len + guard_size, guard_byte);
+        int n = hex_encode(buf.data(), data.data() + done, len);
+
+        CHECK(is_guard_intact(buf, n));
+        s.append(buf.data(), n);
+        done += len;
+    }
+    return s;
+}
+
+static bool hex_one_shot(std::vector<uint8_t>& data, const std::string& s)
+{
+    int len = s.size();
+    std::vector<uint8_t> buf(len / 2 + guard_size, guard_byte);
+    int n = hex_decode(buf.data(), s.data(), len);
+
+    data.clear();
+    if (n < 0)
+        return false;
+    CHECK(is_guard_intact(buf, n));
+    data.assign(buf.begin(), buf.begin() + n);
+    return true;
+}
+
+static bool hex_chunked(
+    std::vector<uint8_t>& data, const std::string& s, Prng& rng
+    )
+{
+    Hex_decoder dec;
+    int size = s.size();
+    bool is_ok = true;
+
+    data.clear();
+    for (int done = 0; done < size; ) {
+        int len = chunk_size(size - done, rng);
+        std::vector<uint8_t> buf(
+            Hex_decoder::max_put_size(len) + guard_size, guard_byte
+            );
+        int n = dec.put(buf.data(), s.data() + done, len);
+
+        if (n < 0) {
+            CHECK(!dec.ok());
+            CHECK(dec.put(buf.data(), "66", 2) < 0);
+            return false;
+        }
+        is_ok = is_ok && (n <= Hex_decoder::max_put_size(len)) &&
+            is_guard_intact(buf, n);
+        data.insert(data.end(), buf.begin(), buf.begin() + n);
+        done += len;
+    }
+    CHECK(is_ok);
+    return dec.finish();
+}
+
+static void check_base64(
+    const std::vector<uint8_t>& data, const std::string& text, Prng& rng
+    )
+{
+    std::string unpadded = text.substr(0, text.find('='));
+    std::vector<uint8_t> decoded;
+    int num_failed = test_state().num_failed;
+
+    CHECK(base64_one_shot(data) == text);
+    CHECK(base64_chunked(data, rng) == text);
+    CHECK(base64_one_shot(decoded, text) && (decoded == data));
+    CHECK(base64_chunked(decoded, text, rng) && (decoded == data));
+
+    // padding is optional
+    CHECK(base64_one_shot(decoded, unpadded) && (decoded == data));
+    CHECK(base64_chunked(decoded, unpadded, rng) && (decoded == data));
+
+    if (test_state().num_failed != num_failed)
+        fprintf(stderr, "base64 of %zu bytes failed\n", data.size());
+}
+
+static void check_hex(
+    const std::vector<uint8_t>& data, const std::string& text, Prng& rng
+    )
+{
+    std::string lower = to_lower(text);
+    std::vector<uint8_t> decoded;
+    int num_failed = test_state().num_failed;
+
+    CHECK(hex_one_shot(data) == lower);
+    CHECK(hex_chunked(data, rng) == lower);
+    CHECK(hex_one_shot(decoded, text) && (decoded == data));
+    CHECK(hex_chunked(decoded, text, rng) && (decoded == data));
+    CHECK(hex_one_shot(decoded, lower) && (decoded == data));
+    CHECK(hex_chunked(decoded, lower, rng) && (decoded == data));
+
+    if (test_state().num_failed != num_failed)
+        fprintf(stderr, "base16 of %zu bytes failed\n", data.size());
+}
+
+static void test_vectors(const std::string& dir)
+{
+    auto text = read_fixture(dir, "vectors.txt");
+    std::istringstream in{std::string(text.begin(), text.end())};
+    std::string line;
+    Prng rng{1};
+    int num_vectors = 0;
+
+    while (std::getline(in, line)) {
+        std::istringstream fields{line};
+        std::string codec;
+        std::string decoded;
+        std::string encoded;
+
+        if (line.empty() || (line[0] == '#'))
+            continue;
+        if (!CHECK(!!(fields >> codec >> decoded >> encoded)))
+            continue;
+        if (encoded == "-")
+            encoded.clear();
+        if (codec == "base64") {
+            CHECK(base64_reference(from_hex(decoded)) == encoded);
+            check_base64(from_hex(decoded), encoded, rng);
+        }
+        else {
+            check_hex(from_hex(decoded), encoded, rng);
+        }
+        ++num_vectors;
+    }
+    CHECK(num_vectors == 21);
+}
+
+static void test_invalid(const std::string& dir)
+{
+    auto text = read_fixture(dir, "invalid.txt");
+    std::istringstream in{std::string(text.begin(), text.end())};
+    std::string line;
+    Prng rng{2};
+    std::vector<uint8_t> decoded;
+    int num_inputs = 0;
+
+    while (std::getline(in, line)) {
+        std::istringstream fields{line};
+        std::string codec;
+        std::string encoded;
+
+        if (line.empty() || (line[0] == '#'))
+            continue;
+        if (!CHECK(!!(fields >> codec >> encoded)))
+            continue;
+        if (codec == "base64") {
+            if (!CHECK(!base64_one_shot(decoded, encoded)) ||
+                !CHECK(!base64_chunked(decoded, encoded, rng)))
+                fprintf(stderr, "base64 %s accepted\n", encoded.c_str());
+        }
+        else {
+            if (!CHECK(!hex_one_shot(decoded, encoded)) ||
+                !CHECK(!hex_chunked(decoded, encoded, rng)))
+                fprintf(stderr, "base16 %s accepted\n", encoded.c_str());
+        }
+        ++num_inputs;
+    }
+    CHECK(num_inputs == 22);
+
+    // whitespace and line breaks
+    CHECK(!base64_one_shot(decoded, "Zm9v YmFy"));
+    CHECK(!base64_one_shot(decoded, "Zm9v\r\nYmFy"));
+    CHECK(!base64_one_shot(decoded, "Zm9vYmFy\n"));
+    CHECK(!hex_one_shot(decoded, "666f 6f"));
+    CHECK(!hex_one_shot(decoded, "666f6f\n"));
+}
+
+static void test_round_trip()
+{
+    Prng rng{3};
+
+    for (int len = 0; len <= max_len; ++len) {
+        for (int i = 0; i < 4; ++i) {
+            auto data = random_data(len, rng);
+
+            check_base64(data, base64_reference(data), rng);
+            check_hex(data, hex_one_shot(data), rng);
+        }
+    }
+
+    // the scalar versions encode and decode complete groups only
+    auto data = random_data(max_len, rng);
+    std::string text = base64_reference(data);
+    std::vector<char> chars(text.size());
+    std::vector<uint8_t> bytes(data.size());
+
+    CHECK(base64_encode_scalar(chars.data(), data.data(), 100) == 99);
+    CHECK(std::equal(chars.begin(), chars.begin() + 132, text.begin()));
+    CHECK(base64_decode_scalar(bytes.data(), text.data(), 135) == 132);
+    CHECK(std::equal(bytes.begin(), bytes.begin() + 99, data.begin()));
+    CHECK(hex_encode_scalar(chars.data(), data.data(), 99) == 198);
+    CHECK(hex_decode_scalar(bytes.data(), chars.data(), 198) == 198);
+    CHECK(std::equal(bytes.begin(), bytes.begin() + 99, data.begin()));
+}
+
+/**
+ * Replace each of the first \a num_chars characters of \a text by each
+ * of \a invalid.
+ */
+template <typename T_decode_one_shot, typename T_decode_chunked>
+static void check_corrupted(
+    const char* name, const std::string& text, int num_chars,
+    const std::string& invalid,
+    T_decode_one_shot decode_one_shot, T_decode_chunked decode_chunked
+    )
+{
+    std::vector<uint8_t> decoded;
+    int num_failed = test_state().num_failed;
+
+    for (int i = 0; i < num_chars; ++i) {
+        for (char c : invalid) {
+            std::string corrupted = text;
+
+            corrupted[i] = c;
+            CHECK(!decode_one_shot(decoded, corrupted));
+            CHECK(!decode_chunked(decoded, corrupted));
+        }
+    }
+
+    if (test_state().num_failed != num_failed)
+        fprintf(stderr, "%s accepted corrupted input\n", name);
+}
+
+/**
+ * Corrupt encoded texts with characters outside the alphabets.
+ *
+ * The characters are chosen close to the valid ranges and with the
+ * most significant bit set, to catch signed comparisons.
+ */
+static void test_corrupted()
+{
+    // the strings contain null characters
+    static const char base64_invalid[] =
+        "\x00\t\n\r -_.,*:;@[`{~\x7f\x80\xab\xaf\xb0\xc1\xe1\xff";
+    static const char hex_invalid[] =
+        "\x00\t\n -+/:@GgXx`\x7f\x80\xb0\xb9\xc1\xc6\xe1\xff";
+    Prng rng{4};
+
+    for (int len : {1, 2, 3, 12, 13, 24, 25, 47, 48, 49, 100}) {
+        auto data = random_data(len, rng);
+        std::string text = base64_reference(data);
+        auto one_shot = [](std::vector<uint8_t>& d, const std::string& s) {
+            return base64_one_shot(d, s);
+        };
+        auto chunked = [&rng](std::vector<uint8_t>& d, const std::string& s) {
+            return base64_chunked(d, s, rng);
+        };
+
+        std::string hex_text = hex_one_shot(data);
+
+        check_corrupted(
+            "base64", text, text.size(),
+            std::string(base64_invalid, sizeof(base64_invalid) - 1),
+            one_shot, chunked
+            );
+
+        // padding is valid in place of the last 2 characters
+        check_corrupted(
+            "base64", text, text.size() - 2, "=", one_shot, chunked
+            );
+
+        check_corrupted(
+            "base16", hex_text, hex_text.size(),
+            std::string(hex_invalid, sizeof(hex_invalid) - 1),
+            [](std::vector<uint8_t>& d, const std::string& s) {
+                return hex_one_shot(d, s);
+            },
+            [&rng](std::vector<uint8_t>& d, const std::string& s) {
+                return hex_chunked(d, s, rng);
+            }
+            );
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string dir = fixture_dir(argc, argv, __FILE__) + "/rfc4648";
+
+    test_vectors(dir);
+    test_invalid(dir);
+    test_round_trip();
+    test_corrupted();
+
+    return test_result("rfc4648_test");
+}
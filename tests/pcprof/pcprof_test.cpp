@@ -0,0 +1,182 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Test merging and symbolization of program counter profiles.
+ *
+ * Fixtures:
+ *
+ * - run1.hpcp: A record exported by Pc_profiler<8, 4>::dump().
+ * - run2.log: A UART capture with a record surrounded by console
+ *   output, including a bogus record header.
+ * - firmware.elf: Built from firmware.S. Its functions are placed such
+ *   that bins span two functions or a gap without symbol.
+ *
+ * Build:
+ *
+ * \verbatim
+ * g++ -std=c++14 -O2 -I<hodea-lib> -o pcprof_test pcprof_test.cpp
+ * \endverbatim
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <cmath>
+#include <stdexcept>
+#include <tests/test.hpp>
+#include <tools/pcprof/pc_profile.hpp>
+
+using namespace hodea;
+
+static bool is_near(double a, double b)
+{
+    return std::fabs(a - b) < 1e-9;
+}
+
+static double samples_of(
+    const std::vector<Symbol_samples>& result, const std::string& name
+    )
+{
+    for (const auto& r : result) {
+        if (r.name == name)
+            return r.samples;
+    }
+    return -1.0;
+}
+
+static void test_parse(const std::string& dir)
+{
+    auto run1 = parse_pc_profiles(read_fixture(dir, "run1.hpcp"));
+
+    if (CHECK(run1.size() == 1)) {
+        const Pc_profile& p = run1[0];
+
+        CHECK(p.bin_shift == 4);
+        CHECK(p.base == 0x08000000U);
+        CHECK(p.num_samples == 43);
+        CHECK(p.num_outside == 3);
+        CHECK((p.bins == std::vector<uint32_t>{10, 16, 0, 8, 4, 2, 0, 0}));
+    }
+
+    // the bogus header in front of the record is skipped
+    auto run2 = parse_pc_profiles(read_fixture(dir, "run2.log"));
+
+    if (CHECK(run2.size() == 1)) {
+        const Pc_profile& p = run2[0];
+
+        CHECK(p.num_samples == 53);
+        CHECK(p.num_outside == 1);
+        CHECK((p.bins == std::vector<uint32_t>{0, 4, 20, 8, 12, 0, 6, 2}));
+    }
+
+    // a truncated record is ignored
+    auto data = read_fixture(dir, "run1.hpcp");
+
+    if (!data.empty())
+        data.pop_back();
+    CHECK(parse_pc_profiles(data).empty());
+
+    // two records in one capture
+    auto both = read_fixture(dir, "run1.hpcp");
+    auto log = read_fixture(dir, "run2.log");
+
+    both.insert(both.end(), log.begin(), log.end());
+    CHECK(parse_pc_profiles(both).size() == 2);
+}
+
+static Pc_profile merged_profile(const std::string& dir)
+{
+    auto run1 = parse_pc_profiles(read_fixture(dir, "run1.hpcp"));
+    auto run2 = parse_pc_profiles(read_fixture(dir, "run2.log"));
+
+    if (run1.empty() || run2.empty())
+        return Pc_profile{4, 0x08000000U, 0, 0, {}};
+
+    merge_pc_profile(run1[0], run2[0]);
+    return run1[0];
+}
+
+static void test_merge(const std::string& dir)
+{
+    Pc_profile p = merged_profile(dir);
+
+    CHECK(p.num_samples == 96);
+    CHECK(p.num_outside == 4);
+    CHECK((p.bins == std::vector<uint32_t>{10, 20, 20, 16, 16, 2, 6, 2}));
+
+    Pc_profile other = p;
+    bool is_rejected = false;
+
+    other.bin_shift = 5;
+    try {
+        merge_pc_profile(p, other);
+    }
+    catch (const std::runtime_error&) {
+        is_rejected = true;
+    }
+    CHECK(is_rejected);
+}
+
+static void test_elf(const std::string& dir)
+{
+    auto syms = read_elf_functions(read_fixture(dir, "firmware.elf"));
+
+    if (CHECK(syms.size() == 4)) {
+        CHECK(syms[0].addr == 0x08000000U);
+        CHECK(syms[0].size == 0x18);
+        CHECK(syms[0].name == "reset_handler");
+        CHECK(syms[1].addr == 0x08000018U);
+        CHECK(syms[1].name == "hodea::pid_update()");
+        CHECK(syms[2].addr == 0x08000038U);
+        CHECK(syms[2].name == "ctrl_isr");
+        CHECK(syms[3].addr == 0x08000050U);
+        CHECK(syms[3].name == "main");
+    }
+
+    bool is_rejected = false;
+
+    try {
+        read_elf_functions(read_fixture(dir, "run1.hpcp"));
+    }
+    catch (const std::runtime_error&) {
+        is_rejected = true;
+    }
+    CHECK(is_rejected);
+}
+
+static void test_symbolize(const std::string& dir)
+{
+    Pc_profile p = merged_profile(dir);
+    auto syms = read_elf_functions(read_fixture(dir, "firmware.elf"));
+    auto result = symbolize_pc_profile(p, syms);
+
+    // bin 1 is shared by reset_handler and pid_update, bin 3 by
+    // pid_update and ctrl_isr, bin 4 by ctrl_isr and the gap
+    CHECK(is_near(samples_of(result, "reset_handler"), 10 + 10));
+    CHECK(is_near(samples_of(result, "hodea::pid_update()"), 10 + 20 + 8));
+    CHECK(is_near(samples_of(result, "ctrl_isr"), 8 + 8));
+    CHECK(is_near(samples_of(result, "<unknown>"), 8));
+    CHECK(is_near(samples_of(result, "main"), 2 + 6 + 2));
+
+    if (CHECK(result.size() == 5)) {
+        CHECK(result[0].name == "hodea::pid_update()");
+        CHECK(result[4].name == "<unknown>");
+    }
+
+    // without symbols everything is unknown
+    auto unknown = symbolize_pc_profile(p, std::vector<Elf_symbol>{});
+
+    if (CHECK(unknown.size() == 1))
+        CHECK(is_near(unknown[0].samples, 92));
+}
+
+int main(int argc, char* argv[])
+{
+    std::string dir = fixture_dir(argc, argv, __FILE__);
+
+    test_parse(dir);
+    test_merge(dir);
+    test_elf(dir);
+    test_symbolize(dir);
+
+    return test_result("pcprof_test");
+}
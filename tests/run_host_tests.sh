@@ -0,0 +1,138 @@
+#!/bin/sh
+# This script builds and runs the host tests.
+
+PROGRAM_NAME=`basename $0`
+
+top=`cd "$(dirname "$0")/.." && pwd`
+build_dir="${TMPDIR:-/tmp}/hodea_tests"
+cxx="${CXX:-g++}"
+cxxflags="${CXXFLAGS:--std=c++14 -O2 -Wall -Wextra}"
+num_failed=0
+
+# -------------------------------------------------------------------------
+
+# Print usage message.
+usage()
+{
+    echo "Build and run the host tests"
+    echo "usage: $PROGRAM_NAME [build_dir]"
+    echo "  build_dir\tdirectory for the test programs"
+    echo "\t\tdefault: \$TMPDIR/hodea_tests"
+}
+
+# -------------------------------------------------------------------------
+
+# Test if the host CPU supports an instruction set extension.
+cpu_has()
+{
+    grep -q -w "$1" /proc/cpuinfo 2>/dev/null
+}
+
+# -------------------------------------------------------------------------
+
+# Build and run a test.
+#
+# run_test <source> [variant...]
+#
+# Each variant is a set of additional compiler flags, e.g. "-mavx2".
+# The test is built and run once for each variant, or once without
+# additional flags if no variant is given.
+run_test()
+{
+    local src="$1"
+    local name=`basename "$src" .cpp`
+    local variant
+    local exe
+
+    shift
+    [ "$#" -eq "0" ] && set -- ""
+
+    for variant in "$@"; do
+        exe="$build_dir/$name`echo "$variant" | tr -d ' =' | tr -- '-' '_'`"
+        echo "--- $name $variant"
+        if ! $cxx $cxxflags $variant -I"$top" -o "$exe" "$top/$src"; then
+            num_failed=$((num_failed + 1))
+            continue
+        fi
+        if ! "$exe"; then
+            num_failed=$((num_failed + 1))
+        fi
+    done
+}
+
+# -------------------------------------------------------------------------
+
+# Build the LZSS tool and check the round trip of some files.
+#
+# Decompressing a file which is no LZSS stream must fail without
+# crashing the tool.
+run_lzss_tool()
+{
+    local exe="$build_dir/lzss"
+    local f
+
+    echo "--- lzss tool"
+    if ! $cxx $cxxflags -I"$top" -o "$exe" "$top/tools/lzss/lzss.cpp"; then
+        num_failed=$((num_failed + 1))
+        return
+    fi
+    for f in "$top"/tests/core/fixtures/lzss/* "$top/tools/lzss/lzss.cpp" \
+            "$exe"; do
+        if ! "$exe" < "$f" | "$exe" -d | cmp -s - "$f"; then
+            echo "round trip of $f failed"
+            num_failed=$((num_failed + 1))
+        fi
+    done
+    "$exe" -d < "$exe" > /dev/null 2>&1
+    if [ "$?" -gt "1" ]; then
+        echo "decompression of garbage crashed"
+        num_failed=$((num_failed + 1))
+    fi
+}
+
+# -------------------------------------------------------------------------
+
+case "$1" in
+    -h|--help)
+        usage
+        exit 0
+        ;;
+    "")
+        ;;
+    *)
+        build_dir="$1"
+        ;;
+esac
+
+mkdir -p "$build_dir" || exit 1
+
+# SIMD paths are tested as far as supported by the host CPU
+simd_variants=""
+cpu_has ssse3 && simd_variants="-mssse3"
+cpu_has avx2 && simd_variants="$simd_variants -mavx2"
+cpu_has avx512bw && simd_variants="$simd_variants -mavx512bw"
+clmul_variant=""
+cpu_has pclmulqdq && cpu_has ssse3 && clmul_variant="-mpclmul -mssse3"
+
+run_test tests/core/bulk_uswap_test.cpp "" -U__SSE2__ $simd_variants
+run_test tests/core/calib_blob_test.cpp
+run_test tests/core/crc_test.cpp "" ${clmul_variant:+"$clmul_variant"}
+run_test tests/core/delta_codec_test.cpp "" -D__ARM_ARCH_6M__
+run_test tests/core/flash_scrubber_test.cpp
+run_test tests/core/format_test.cpp "" -D__ARM_ARCH_6M__
+run_test tests/core/framing_fuzz.cpp
+run_test tests/core/histogram_test.cpp
+run_test tests/core/irq_latency_meter_test.cpp
+run_test tests/core/lzss_test.cpp
+run_test tests/core/parse_test.cpp "" -D__ARM_ARCH_6M__
+run_test tests/core/protobuf_test.cpp
+run_test tests/core/rfc4648_test.cpp "" $simd_variants
+run_test tests/pcprof/pcprof_test.cpp
+run_test tests/telemetry/telemetry_test.cpp -pthread
+run_lzss_tool
+
+if [ "$num_failed" -ne "0" ]; then
+    echo "$num_failed test(s) failed"
+    exit 1
+fi
+echo "all tests passed"
@@ -0,0 +1,308 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Test the splitting and decoding of telemetry captures.
+ *
+ * A small capture is built with the COBS encoder. Between the valid
+ * frames it holds empty frames, oversize frames, frames of the wrong
+ * size and malformed frames, and it ends with a truncated frame. The
+ * decoded columns and the error counts must not depend on the chunk
+ * size or the number of worker threads. A sink throwing an exception
+ * must stop the decoding.
+ *
+ * Build:
+ *
+ * \verbatim
+ * g++ -std=c++14 -O2 -pthread -I<hodea-lib> -o telemetry_test \
+ *     telemetry_test.cpp
+ * \endverbatim
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <tests/test.hpp>
+#include <tools/telemetry/telemetry.hpp>
+
+using namespace hodea;
+
+static const char* const schema_spec =
+    "seq:u16le,current:i32le,voltage:u32be,temp:f32le";
+constexpr int frame_size = 14;
+constexpr int num_valid = 60;
+constexpr int num_invalid = 6 * 3 + 1;
+
+/**
+ * Capture with the values of its valid frames.
+ */
+struct Capture {
+    std::vector<uint8_t> bytes;
+    std::vector<uint16_t> seq;
+    std::vector<int32_t> current;
+    std::vector<uint32_t> voltage;
+    std::vector<float> temp;
+};
+
+static std::vector<uint8_t> encode_frame(const uint8_t* raw, int len)
+{
+    std::vector<uint8_t> buf(Cobs_encoder::max_encoded_size(len));
+    Cobs_encoder enc{buf.data(), static_cast<int>(buf.size())};
+
+    enc.put(raw, len);
+    CHECK(enc.finish());
+    buf.resize(enc.size());
+    return buf;
+}
+
+static std::vector<uint8_t> encode_values(
+    uint16_t seq, int32_t current, uint32_t voltage, float temp
+    )
+{
+    uint8_t raw[frame_size];
+    uint8_t* p = raw;
+
+    p += store16_le(p, seq);
+    p += store32_le(p, current);
+    p += store32_be(p, voltage);
+    store_f32_le(p, temp);
+    return encode_frame(raw, sizeof(raw));
+}
+
+static Capture make_capture()
+{
+    Capture cap;
+    std::vector<uint8_t>& b = cap.bytes;
+    Prng rng{42};
+
+    for (int i = 0; i < num_valid; ++i) {
+        // zero values give zero bytes, i.e. several COBS blocks
+        uint16_t seq = i;
+        int32_t current = (i % 4 == 0) ? 0 : static_cast<int32_t>(rng.next());
+        uint32_t voltage = (i % 3 == 0) ? 0 : rng.below(5000);
+        float temp = i * 0.25f - 10.0f;
+        auto frame = encode_values(seq, current, voltage, temp);
+
+        cap.seq.push_back(seq);
+        cap.current.push_back(current);
+        cap.voltage.push_back(voltage);
+        cap.temp.push_back(temp);
+        b.insert(b.end(), frame.begin(), frame.end());
+
+        switch (i % 10) {
+        case 3:
+            // empty frames are skipped without error
+            b.push_back(0);
+            b.push_back(0);
+            break;
+        case 5: {
+            // 17 data bytes exceed the maximum encoded size
+            b.push_back(18);
+            for (int j = 1; j <= 17; ++j)
+                b.push_back(j);
+            b.push_back(0);
+            break;
+        }
+        case 7: {
+            // well formed, but too short
+            uint8_t raw[frame_size - 4] = {1, 2, 3};
+            auto short_frame = encode_frame(raw, sizeof(raw));
+
+            b.insert(b.end(), short_frame.begin(), short_frame.end());
+            break;
+        }
+        case 9:
+            // the code byte points beyond the end of the frame
+            b.push_back(5);
+            b.push_back(1);
+            b.push_back(0);
+            break;
+        }
+    }
+
+    // truncated at the end of the capture
+    auto last = encode_values(num_valid, 1, 2, 3.0f);
+
+    b.insert(b.end(), last.begin(), last.begin() + frame_size / 2);
+    return cap;
+}
+
+template <typename T>
+static bool is_column_equal(
+    const std::vector<uint8_t>& col, const std::vector<T>& expected
+    )
+{
+    return (col.size() == expected.size() * sizeof(T)) &&
+        (expected.empty() ||
+         (std::memcmp(col.data(), expected.data(), col.size()) == 0));
+}
+
+static bool is_capture_equal(const Chunk_result& r, const Capture& cap)
+{
+    return (r.columns.size() == 4) &&
+        is_column_equal(r.columns[0], cap.seq) &&
+        is_column_equal(r.columns[1], cap.current) &&
+        is_column_equal(r.columns[2], cap.voltage) &&
+        is_column_equal(r.columns[3], cap.temp);
+}
+
+static void test_split(const Capture& cap)
+{
+    const uint8_t* data = cap.bytes.data();
+    const std::size_t len = cap.bytes.size();
+
+    CHECK(split_chunks(data, 0, 16).empty());
+
+    for (std::size_t chunk_size : {
+            std::size_t{1}, std::size_t{7}, std::size_t{16},
+            std::size_t{100}, len - 1, len, 2 * len
+            }) {
+        auto chunks = split_chunks(data, len, chunk_size);
+        bool is_ok = !chunks.empty() && (chunks.front().begin == 0) &&
+            (chunks.back().end == len);
+
+        // contiguous, each but the last ends after a delimiter
+        for (std::size_t i = 0; is_ok && (i < chunks.size()); ++i) {
+            const Chunk& c = chunks[i];
+
+            is_ok = (c.end > c.begin) &&
+                ((i == 0) || (c.begin == chunks[i - 1].end));
+            if (is_ok && (i + 1 < chunks.size()))
+                is_ok = (c.end - c.begin > chunk_size) &&
+                    (data[c.end - 1] == 0);
+        }
+        CHECK(is_ok);
+        if (chunk_size >= len - 1)
+            CHECK(chunks.size() == 1);
+    }
+
+    // no delimiter after the nominal boundary, one chunk
+    const uint8_t no_delim[] = {0, 1, 2, 3, 4};
+
+    CHECK(split_chunks(no_delim, sizeof(no_delim), 2).size() == 1);
+}
+
+static void test_decode_chunk(const Capture& cap)
+{
+    Schema schema = parse_schema(schema_spec);
+    Chunk_result r;
+
+    CHECK(schema.frame_size == frame_size);
+
+    decode_chunk(r, schema, cap.bytes.data(), cap.bytes.size());
+    CHECK(r.num_frames == num_valid);
+    CHECK(r.num_errors == num_invalid);
+    CHECK(is_capture_equal(r, cap));
+
+    // a complete frame without delimiter is accepted
+    auto frame = encode_values(7, -1, 3300, 25.5f);
+    Chunk_result unterminated;
+
+    frame.pop_back();
+    decode_chunk(unterminated, schema, frame.data(), frame.size());
+    CHECK(unterminated.num_frames == 1);
+    CHECK(unterminated.num_errors == 0);
+    CHECK(is_column_equal(unterminated.columns[1], std::vector<int32_t>{-1}));
+
+    // an empty chunk gives empty columns
+    Chunk_result empty;
+
+    decode_chunk(empty, schema, frame.data(), 0);
+    CHECK(empty.num_frames == 0);
+    CHECK((empty.columns.size() == 4) && empty.columns[0].empty());
+}
+
+static void test_decode_capture(const Capture& cap)
+{
+    Schema schema = parse_schema(schema_spec);
+    const uint8_t* data = cap.bytes.data();
+    const std::size_t len = cap.bytes.size();
+
+    for (int num_threads : {1, 2, 4}) {
+        for (std::size_t chunk_size : {
+                std::size_t{1}, std::size_t{7}, std::size_t{40}, 2 * len
+                }) {
+            auto chunks = split_chunks(data, len, chunk_size);
+            Chunk_result all;
+            std::vector<uint64_t> chunk_frames;
+
+            all.columns.resize(4);
+            auto stats = decode_capture(
+                schema, data, len, num_threads, chunk_size,
+                [&](const Chunk_result& r) {
+                    for (std::size_t i = 0; i < r.columns.size(); ++i) {
+                        all.columns[i].insert(
+                            all.columns[i].end(),
+                            r.columns[i].begin(), r.columns[i].end()
+                            );
+                    }
+                    chunk_frames.push_back(r.num_frames + r.num_errors);
+                }
+                );
+
+            CHECK(stats.num_chunks == chunks.size());
+            CHECK(stats.num_frames == num_valid);
+            CHECK(stats.num_errors == num_invalid);
+            CHECK(is_capture_equal(all, cap));
+
+            // the results are passed in chunk order
+            bool is_in_order = chunk_frames.size() == chunks.size();
+
+            for (std::size_t i = 0; is_in_order && (i < chunks.size()); ++i) {
+                Chunk_result r;
+
+                decode_chunk(
+                    r, schema, data + chunks[i].begin,
+                    chunks[i].end - chunks[i].begin
+                    );
+                is_in_order = chunk_frames[i] == r.num_frames + r.num_errors;
+            }
+            CHECK(is_in_order);
+        }
+    }
+
+    // an empty capture has no chunks
+    int num_calls = 0;
+    auto stats = decode_capture(
+        schema, data, 0, 2, 16, [&](const Chunk_result&) { ++num_calls; }
+        );
+
+    CHECK(stats.num_chunks == 0);
+    CHECK(num_calls == 0);
+}
+
+static void test_throwing_sink(const Capture& cap)
+{
+    Schema schema = parse_schema(schema_spec);
+    std::string what;
+    int num_calls = 0;
+
+    try {
+        decode_capture(
+            schema, cap.bytes.data(), cap.bytes.size(), 3, 16,
+            [&](const Chunk_result&) {
+                if (++num_calls == 3)
+                    throw std::runtime_error("sink full");
+            }
+            );
+    }
+    catch (const std::runtime_error& e) {
+        what = e.what();
+    }
+    CHECK(what == "sink full");
+    CHECK(num_calls == 3);
+}
+
+int main()
+{
+    Capture cap = make_capture();
+
+    test_split(cap);
+    test_decode_chunk(cap);
+    test_decode_capture(cap);
+    test_throwing_sink(cap);
+
+    return test_result("telemetry_test");
+}
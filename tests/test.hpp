@@ -0,0 +1,221 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Minimal support for host tests.
+ *
+ * Each test is a program of its own. Conditions are checked with
+ * CHECK(), which reports failures but continues, so a single run shows
+ * all failed checks. The exit status is taken from test_result().
+ *
+ * Fixtures are stored in the directory "fixtures" next to the test
+ * source. The directory can be overridden by the first argument.
+ *
+ * Helpers shared by the tests are a pseudo random number generator,
+ * guard bytes to detect buffer overruns and hex strings for fixtures.
+ *
+ * Example:
+ *
+ * \code
+ * int main(int argc, char* argv[])
+ * {
+ *     std::string dir = fixture_dir(argc, argv, __FILE__);
+ *     auto data = read_fixture(dir, "input.bin");
+ *
+ *     CHECK(decode(data) == 42);
+ *     return test_result("decode_test");
+ * }
+ * \endcode
+ *
+ * See run_host_tests.sh to build and run all tests.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_TESTS_TEST_HPP
+#define HODEA_TESTS_TEST_HPP
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <hodea/core/cstdint.hpp>
+
+namespace hodea {
+
+struct Test_state {
+    int num_checks;
+    int num_failed;
+};
+
+static inline Test_state& test_state()
+{
+    static Test_state state;
+
+    return state;
+}
+
+static inline bool test_check(
+    bool cond, const char* expr, const char* file, int line
+    )
+{
+    Test_state& state = test_state();
+
+    ++state.num_checks;
+    if (!cond) {
+        // limit the output if a check fails within a loop
+        if (state.num_failed++ < 20)
+            fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+    }
+    return cond;
+}
+
+/**
+ * Check a condition and report it if it is false.
+ *
+ * \returns
+ *      The result of the condition.
+ */
+#define CHECK(cond) hodea::test_check((cond), #cond, __FILE__, __LINE__)
+
+/**
+ * Print the summary of the checks.
+ *
+ * \returns
+ *      Exit status for main(), 0 if all checks passed.
+ */
+static inline int test_result(const char* name)
+{
+    const Test_state& state = test_state();
+
+    printf(
+        "%s: %d checks, %d failed\n",
+        name, state.num_checks, state.num_failed
+        );
+    return (state.num_failed == 0) ? 0 : 1;
+}
+
+/**
+ * Get the fixture directory.
+ *
+ * \param[in] argc, argv
+ *      Arguments passed to main().
+ * \param[in] src
+ *      Path of the test source, i.e. __FILE__.
+ */
+static inline std::string fixture_dir(
+    int argc, char* argv[], const char* src
+    )
+{
+    if (argc > 1)
+        return argv[1];
+
+    std::string path{src};
+    std::string::size_type slash = path.rfind('/');
+
+    return ((slash == std::string::npos) ? std::string{"."} :
+            path.substr(0, slash)) + "/fixtures";
+}
+
+/**
+ * Read a fixture file completely into memory.
+ *
+ * A missing file is reported as failed check and yields an empty
+ * vector.
+ */
+static inline std::vector<uint8_t> read_fixture(
+    const std::string& dir, const std::string& fname
+    )
+{
+    std::string path = dir + "/" + fname;
+    std::ifstream f(path, std::ios::binary);
+
+    if (!test_check(f.good(), path.c_str(), __FILE__, __LINE__))
+        return std::vector<uint8_t>{};
+
+    return std::vector<uint8_t>(
+        std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>()
+        );
+}
+
+/**
+ * Parse a string of hexadecimal digit pairs, as used in fixtures.
+ *
+ * "-" stands for an empty sequence.
+ */
+static inline std::vector<uint8_t> from_hex(const std::string& s)
+{
+    std::vector<uint8_t> v;
+
+    if (s == "-")
+        return v;
+    for (std::string::size_type i = 0; i + 1 < s.size(); i += 2)
+        v.push_back(std::strtoul(s.substr(i, 2).c_str(), nullptr, 16));
+    return v;
+}
+
+/**
+ * Pseudo random number generator (xorshift32).
+ *
+ * The sequence depends on the seed only, so a failure can be reproduced
+ * on any host.
+ */
+class Prng {
+public:
+    explicit Prng(uint32_t seed) : x{seed ? seed : 1} {}
+
+    /**
+     * Derive the seed from data, e.g. a fuzz input (FNV-1a hash).
+     */
+    Prng(const uint8_t* data, int len) : x{2166136261U}
+    {
+        for (int i = 0; i < len; ++i)
+            x = (x ^ data[i]) * 16777619U;
+        x ^= static_cast<uint32_t>(len);
+        if (x == 0)
+            x = 1;
+    }
+
+    uint32_t next()
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return x;
+    }
+
+    /**
+     * Get a number in the range 0 to n - 1, or 0 if n is not positive.
+     */
+    int below(int n)
+    {
+        return (n <= 0) ? 0 : static_cast<int>(next() % n);
+    }
+
+private:
+    uint32_t x;
+};
+
+/**
+ * Guard bytes placed behind an output buffer to detect overruns.
+ */
+constexpr int guard_size = 16;
+constexpr uint8_t guard_byte = 0xa5;
+
+/**
+ * Test if the guard bytes behind \a used bytes of \a buf are intact.
+ */
+template <typename T>
+static inline bool is_guard_intact(const std::vector<T>& buf, int used)
+{
+    for (auto i = static_cast<std::size_t>(used); i < buf.size(); ++i) {
+        if (static_cast<uint8_t>(buf[i]) != guard_byte)
+            return false;
+    }
+    return true;
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_TESTS_TEST_HPP */
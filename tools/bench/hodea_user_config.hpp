@@ -0,0 +1,15 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * User configuration for host builds of the benchmarks.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_USER_CONFIG_HPP
+#define HODEA_USER_CONFIG_HPP
+
+#define HODEA_CONFIG_HTSC_TIME_BASE_INCLUDE \
+    <hodea/device/host/host_time_base.hpp>
+
+#endif /*!HODEA_USER_CONFIG_HPP */
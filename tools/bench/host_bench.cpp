@@ -0,0 +1,30 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Run the benchmark suites on the host.
+ *
+ * Build:
+ *
+ * \verbatim
+ * g++ -std=c++14 -O2 -I. -I<hodea-lib> -o host_bench host_bench.cpp
+ * \endverbatim
+ *
+ * The results are written as CSV lines to stdout, see bench.hpp. The
+ * times are given in nanoseconds (times 1000), as the host time base
+ * is clocked with 1 GHz.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <hodea/rte/htsc.hpp>
+#include <hodea/bench/bench_suites.hpp>
+
+using namespace hodea;
+
+int main()
+{
+    Bench<Htsc> bench;
+
+    bench_all<Htsc>(bench);
+    return 0;
+}
@@ -0,0 +1,145 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Compress and decompress streams in the format of lzss.hpp.
+ *
+ * The tool is mainly used to decompress crash logs and trace dumps
+ * captured from a target, but also compresses for testing purposes.
+ * Both directions use the classes running on the target, with the
+ * default parameters.
+ *
+ * Build:
+ *
+ * \verbatim
+ * g++ -std=c++14 -O2 -I<hodea-lib> -o lzss lzss.cpp
+ * \endverbatim
+ *
+ * Usage:
+ *
+ * \verbatim
+ * lzss [-d] [-v] < input > output
+ * \endverbatim
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <cstdio>
+#include <unistd.h>
+#include <hodea/core/lzss.hpp>
+
+using namespace hodea;
+
+static void usage(const char* prog)
+{
+    fprintf(
+        stderr,
+        "usage: %s [-d] [-v] < input > output\n"
+        "  -d  decompress\n"
+        "  -v  print the compression ratio to stderr\n",
+        prog
+        );
+}
+
+static void end_of_input(Lzss_encoder<>& enc) { enc.finish(); }
+
+static void end_of_input(Lzss_decoder<>&) {}
+
+/**
+ * Pass stdin through a codec with sink() and poll() methods.
+ */
+template <typename T_codec>
+static bool run(T_codec& codec, long& in_size, long& out_size)
+{
+    uint8_t in[1024];
+    uint8_t out[1024];
+    bool eof = false;
+
+    for (;;) {
+        int len = 0;
+
+        if (!eof) {
+            len = fread(in, 1, sizeof(in), stdin);
+            in_size += len;
+            eof = len < static_cast<int>(sizeof(in));
+        }
+
+        int done = 0;
+
+        do {
+            int accepted = codec.sink(in + done, len - done);
+            int polled = 0;
+            int n;
+
+            done += accepted;
+            if (eof && (done == len))
+                end_of_input(codec);
+
+            while ((n = codec.poll(out, sizeof(out))) > 0) {
+                if (fwrite(out, 1, n, stdout) != static_cast<size_t>(n))
+                    return false;
+                out_size += n;
+                polled += n;
+            }
+
+            // a decoder in error state accepts no more input
+            if ((accepted == 0) && (polled == 0) && (done < len))
+                return false;
+        } while (done < len);
+
+        if (eof)
+            return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    bool decompress = false;
+    bool verbose = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "dvh")) != -1) {
+        switch (opt) {
+        case 'd':
+            decompress = true;
+            break;
+        case 'v':
+            verbose = true;
+            break;
+        default:
+            usage(argv[0]);
+            return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    long in_size = 0;
+    long out_size = 0;
+    bool ok;
+
+    if (decompress) {
+        static Lzss_decoder<> dec;
+        ok = run(dec, in_size, out_size) && dec.ok();
+    }
+    else {
+        static Lzss_encoder<> enc;
+        ok = run(enc, in_size, out_size) && enc.is_done();
+    }
+
+    if (!ok || ferror(stdin)) {
+        fprintf(
+            stderr, "error: %s failed\n",
+            decompress ? "decompression" : "compression"
+            );
+        return 1;
+    }
+
+    if (verbose) {
+        long raw = decompress ? out_size : in_size;
+        long packed = decompress ? in_size : out_size;
+
+        fprintf(
+            stderr, "%ld -> %ld bytes, ratio %.2f\n",
+            raw, packed, packed ? static_cast<double>(raw) / packed : 0.0
+            );
+    }
+    return 0;
+}
@@ -0,0 +1,341 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Host side support for program counter profiles.
+ *
+ * This file provides functions to read the records exported by
+ * Pc_profiler::dump(), to merge them and to map the histogram bins to
+ * the function symbols of an ELF file.
+ *
+ * Errors are reported via std::runtime_error.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_TOOLS_PC_PROFILE_HPP
+#define HODEA_TOOLS_PC_PROFILE_HPP
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cxxabi.h>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/serialization.hpp>
+
+namespace hodea {
+
+/**
+ * Program counter profile as read from a Pc_profiler record.
+ */
+struct Pc_profile {
+    int bin_shift;
+    uint32_t base;
+    uint32_t num_samples;
+    uint32_t num_outside;
+    std::vector<uint32_t> bins;
+
+    uint32_t bin_start(int idx) const
+    {
+        return base + (static_cast<uint32_t>(idx) << bin_shift);
+    }
+
+    uint32_t bin_end(int idx) const { return bin_start(idx + 1); }
+};
+
+/**
+ * Function symbol read from an ELF file.
+ */
+struct Elf_symbol {
+    uint32_t addr;
+    uint32_t size;
+    std::string name;
+};
+
+/**
+ * Read a file completely into memory.
+ */
+static inline std::vector<uint8_t> read_file(const std::string& fname)
+{
+    std::ifstream f(fname, std::ios::binary);
+
+    if (!f)
+        throw std::runtime_error(fname + ": cannot open file");
+
+    return std::vector<uint8_t>(
+        std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>()
+        );
+}
+
+/**
+ * Parse all Pc_profiler records found in a buffer.
+ *
+ * Bytes not belonging to a record, e.g. other UART output captured
+ * together with the profile, are skipped.
+ */
+static inline std::vector<Pc_profile> parse_pc_profiles(
+    const std::vector<uint8_t>& data
+    )
+{
+    constexpr int header_size = 20;
+    static const uint8_t magic[] = {'H', 'P', 'C', 'P'};
+    std::vector<Pc_profile> profiles;
+    auto pos = data.begin();
+
+    for (;;) {
+        pos = std::search(pos, data.end(), magic, magic + sizeof(magic));
+        if (data.end() - pos < header_size)
+            break;
+
+        const uint8_t* p = &*pos + sizeof(magic);
+        Pc_profile prof;
+        int version;
+        int num_bins;
+
+        p += fetch8(version, p);
+        p += fetch8(prof.bin_shift, p);
+        p += fetch16_le(num_bins, p);
+        p += fetch32_le(prof.base, p);
+        p += fetch32_le(prof.num_samples, p);
+        p += fetch32_le(prof.num_outside, p);
+
+        if ((version != 1) || (prof.bin_shift > 31) ||
+            (data.end() - pos < header_size + 4 * num_bins)) {
+            ++pos;
+            continue;
+        }
+
+        prof.bins.resize(num_bins);
+        for (auto& b : prof.bins)
+            p += fetch32_le(b, p);
+
+        profiles.push_back(prof);
+        pos += header_size + 4 * num_bins;
+    }
+
+    return profiles;
+}
+
+/**
+ * Merge profile \a src into \a dst.
+ *
+ * Both profiles must have been recorded with the same configuration.
+ */
+static inline void merge_pc_profile(Pc_profile& dst, const Pc_profile& src)
+{
+    if ((dst.base != src.base) || (dst.bin_shift != src.bin_shift) ||
+        (dst.bins.size() != src.bins.size()))
+        throw std::runtime_error("profiles differ in layout");
+
+    dst.num_samples += src.num_samples;
+    dst.num_outside += src.num_outside;
+    for (std::size_t i = 0; i < dst.bins.size(); ++i)
+        dst.bins[i] += src.bins[i];
+}
+
+/**
+ * Demangle a C++ symbol name, if possible.
+ */
+static inline std::string demangle(const std::string& name)
+{
+    int status;
+    char* s = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+
+    if (status != 0)
+        return name;
+
+    std::string result{s};
+    free(s);
+    return result;
+}
+
+/**
+ * Read the function symbols from a 32 bit little endian ELF file.
+ *
+ * \returns
+ *      Function symbols sorted by address. For ARM bit 0 of the
+ *      address, used to mark Thumb code, is cleared. Of several symbols
+ *      at the same address only the first one is kept.
+ */
+static inline std::vector<Elf_symbol> read_elf_functions(
+    const std::vector<uint8_t>& elf
+    )
+{
+    constexpr int sht_symtab = 2;
+    constexpr int stt_func = 2;
+    constexpr int shdr_size = 40;
+    constexpr int sym_size = 16;
+    std::vector<Elf_symbol> syms;
+
+    if ((elf.size() < 52) || (elf[0] != 0x7f) || (elf[1] != 'E') ||
+        (elf[2] != 'L') || (elf[3] != 'F'))
+        throw std::runtime_error("not an ELF file");
+    if ((elf[4] != 1) || (elf[5] != 1))
+        throw std::runtime_error("only 32 bit little endian ELF supported");
+
+    constexpr int em_arm = 40;
+    uint32_t shoff;
+    int shnum;
+    int machine;
+
+    fetch16_le(machine, &elf[0x12]);
+    fetch32_le(shoff, &elf[0x20]);
+    fetch16_le(shnum, &elf[0x30]);
+
+    auto in_file = [&elf](uint64_t offs, uint64_t len) {
+        return offs + len <= elf.size();
+    };
+
+    if (!in_file(shoff, static_cast<uint64_t>(shnum) * shdr_size))
+        throw std::runtime_error("corrupt section header table");
+
+    for (int i = 0; i < shnum; ++i) {
+        const uint8_t* sh = &elf[shoff + i * shdr_size];
+        uint32_t type, offs, size, link;
+
+        fetch32_le(type, sh + 4);
+        if (type != sht_symtab)
+            continue;
+        fetch32_le(offs, sh + 16);
+        fetch32_le(size, sh + 20);
+        fetch32_le(link, sh + 24);
+
+        if ((link >= static_cast<uint32_t>(shnum)) || !in_file(offs, size))
+            throw std::runtime_error("corrupt symbol table");
+
+        const uint8_t* strsh = &elf[shoff + link * shdr_size];
+        uint32_t str_offs, str_size;
+
+        fetch32_le(str_offs, strsh + 16);
+        fetch32_le(str_size, strsh + 20);
+        if (!in_file(str_offs, str_size))
+            throw std::runtime_error("corrupt string table");
+
+        for (uint32_t s = 0; s + sym_size <= size; s += sym_size) {
+            const uint8_t* sym = &elf[offs + s];
+            uint32_t name, value, sym_len;
+            int info;
+
+            fetch32_le(name, sym);
+            fetch32_le(value, sym + 4);
+            fetch32_le(sym_len, sym + 8);
+            fetch8(info, sym + 12);
+
+            if (((info & 0xf) != stt_func) || (name >= str_size))
+                continue;
+
+            const char* str = reinterpret_cast<const char*>(
+                &elf[str_offs + name]
+                );
+            if (machine == em_arm)
+                value &= ~1U;
+
+            syms.push_back(Elf_symbol{
+                value, sym_len,
+                demangle(std::string(str, strnlen(str, str_size - name)))
+                });
+        }
+    }
+
+    // sort by address and drop aliases to avoid counting samples twice
+    std::sort(
+        syms.begin(), syms.end(),
+        [](const Elf_symbol& a, const Elf_symbol& b) {
+            return a.addr < b.addr;
+        });
+    syms.erase(
+        std::unique(
+            syms.begin(), syms.end(),
+            [](const Elf_symbol& a, const Elf_symbol& b) {
+                return a.addr == b.addr;
+            }),
+        syms.end()
+        );
+    return syms;
+}
+
+/**
+ * Samples attributed to a function.
+ */
+struct Symbol_samples {
+    std::string name;
+    double samples;
+};
+
+/**
+ * Attribute the histogram bins to function symbols.
+ *
+ * If a bin overlaps several functions, its samples are distributed
+ * proportional to the overlapping address range. Samples of address
+ * ranges not covered by any function are attributed to "<unknown>".
+ *
+ * \returns
+ *      Samples per function, sorted by descending number of samples.
+ */
+static inline std::vector<Symbol_samples> symbolize_pc_profile(
+    const Pc_profile& prof, const std::vector<Elf_symbol>& syms
+    )
+{
+    std::vector<double> per_sym(syms.size() + 1, 0.0);
+    const std::size_t unknown = syms.size();
+
+    for (std::size_t i = 0; i < prof.bins.size(); ++i) {
+        if (prof.bins[i] == 0)
+            continue;
+
+        uint64_t start = prof.bin_start(i);
+        uint64_t end = start + (1ULL << prof.bin_shift);
+        double per_byte = static_cast<double>(prof.bins[i]) / (end - start);
+        uint64_t covered = 0;
+
+        auto it = std::upper_bound(
+            syms.begin(), syms.end(), start,
+            [](uint64_t a, const Elf_symbol& s) { return a < s.addr; }
+            );
+        if (it != syms.begin())
+            --it;
+
+        for (; (it != syms.end()) && (it->addr < end); ++it) {
+            uint64_t lo = std::max<uint64_t>(start, it->addr);
+            uint64_t hi = std::min<uint64_t>(
+                end, static_cast<uint64_t>(it->addr) + it->size
+                );
+
+            // don't let a symbol overlap its successor
+            if ((it + 1 != syms.end()) && ((it + 1)->addr < hi))
+                hi = (it + 1)->addr;
+            if (hi <= lo)
+                continue;
+            per_sym[it - syms.begin()] += per_byte * (hi - lo);
+            covered += hi - lo;
+        }
+
+        if (covered < end - start)
+            per_sym[unknown] += per_byte * (end - start - covered);
+    }
+
+    std::vector<Symbol_samples> result;
+
+    for (std::size_t i = 0; i < per_sym.size(); ++i) {
+        if (per_sym[i] > 0.0) {
+            result.push_back(Symbol_samples{
+                (i == unknown) ? "<unknown>" : syms[i].name, per_sym[i]
+                });
+        }
+    }
+
+    std::sort(
+        result.begin(), result.end(),
+        [](const Symbol_samples& a, const Symbol_samples& b) {
+            return a.samples > b.samples;
+        });
+    return result;
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_TOOLS_PC_PROFILE_HPP */
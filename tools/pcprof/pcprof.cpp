@@ -0,0 +1,141 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Evaluate program counter profiles recorded with Pc_profiler.
+ *
+ * The tool reads one or more files with records exported by
+ * Pc_profiler::dump(), e.g. captured from the UART, merges them and
+ * prints the samples per function found in the given ELF file.
+ *
+ * Build:
+ *
+ * \verbatim
+ * g++ -std=c++14 -O2 -I<hodea-lib> -o pcprof pcprof.cpp
+ * \endverbatim
+ *
+ * Usage:
+ *
+ * \verbatim
+ * pcprof [-e firmware.elf] [-b] [-n max_lines] samples...
+ * \endverbatim
+ *
+ * Without ELF file, or with -b, the non-empty bins are printed.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <cstdio>
+#include <exception>
+#include <unistd.h>
+#include "pc_profile.hpp"
+
+using namespace hodea;
+
+static void usage(const char* prog)
+{
+    fprintf(
+        stderr,
+        "usage: %s [-e firmware.elf] [-b] [-n max_lines] samples...\n"
+        "  -e  ELF file used to map the samples to functions\n"
+        "  -b  print the non-empty bins\n"
+        "  -n  limit the number of printed functions\n",
+        prog
+        );
+}
+
+static void print_bins(const Pc_profile& prof)
+{
+    for (std::size_t i = 0; i < prof.bins.size(); ++i) {
+        if (prof.bins[i] == 0)
+            continue;
+        printf(
+            "0x%08x-0x%08x %10u\n",
+            prof.bin_start(i), prof.bin_end(i) - 1, prof.bins[i]
+            );
+    }
+}
+
+static void print_functions(
+    const Pc_profile& prof, const std::vector<Elf_symbol>& syms,
+    int max_lines
+    )
+{
+    auto result = symbolize_pc_profile(prof, syms);
+    int lines = 0;
+
+    for (const auto& r : result) {
+        if ((max_lines > 0) && (lines++ >= max_lines))
+            break;
+        printf(
+            "%6.2f%% %12.1f  %s\n",
+            100.0 * r.samples / prof.num_samples, r.samples, r.name.c_str()
+            );
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const char* elf_fname = nullptr;
+    bool show_bins = false;
+    int max_lines = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "e:bn:h")) != -1) {
+        switch (opt) {
+        case 'e':
+            elf_fname = optarg;
+            break;
+        case 'b':
+            show_bins = true;
+            break;
+        case 'n':
+            max_lines = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        std::vector<Pc_profile> profiles;
+
+        for (int i = optind; i < argc; ++i) {
+            auto p = parse_pc_profiles(read_file(argv[i]));
+            if (p.empty())
+                fprintf(stderr, "%s: no profile records found\n", argv[i]);
+            profiles.insert(profiles.end(), p.begin(), p.end());
+        }
+
+        if (profiles.empty())
+            return 1;
+
+        Pc_profile merged = profiles[0];
+        for (std::size_t i = 1; i < profiles.size(); ++i)
+            merge_pc_profile(merged, profiles[i]);
+
+        printf(
+            "records: %zu, samples: %u, outside range: %u\n",
+            profiles.size(), merged.num_samples, merged.num_outside
+            );
+
+        if (show_bins || !elf_fname)
+            print_bins(merged);
+
+        if (elf_fname)
+            print_functions(
+                merged, read_elf_functions(read_file(elf_fname)), max_lines
+                );
+    }
+    catch (const std::exception& e) {
+        fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,447 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Host side decoder for captured telemetry streams.
+ *
+ * A telemetry capture is a sequence of COBS encoded frames (see
+ * cobs.hpp), each terminated by a zero byte. All frames have the same
+ * layout, a sequence of fixed-size fields written with the store*()
+ * functions from serialization.hpp. The layout is given as schema
+ * string, e.g.
+ *
+ * \verbatim
+ * seq:u16le,current:i32le,voltage:u32be,temp:f32le
+ * \endverbatim
+ *
+ * Captures run to several gigabytes. The file is therefore mapped into
+ * memory instead of being read, and split into chunks at frame
+ * boundaries. As the zero byte occurs only as delimiter, a chunk
+ * boundary is found by searching the next zero byte after the nominal
+ * boundary. The chunks are decoded in parallel by a pool of worker
+ * threads using the same fetch*() functions as the firmware.
+ *
+ * The result is columnar, i.e. all values of a field are stored
+ * consecutively in host representation. The results are passed to the
+ * caller in chunk order, and only a bounded number of chunks is held in
+ * memory at any time.
+ *
+ * Errors are reported via std::runtime_error.
+ *
+ * \author f.hollerer@hodea.org
+ */
+#if !defined HODEA_TOOLS_TELEMETRY_HPP
+#define HODEA_TOOLS_TELEMETRY_HPP
+
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <hodea/core/cstdint.hpp>
+#include <hodea/core/cobs.hpp>
+#include <hodea/core/serialization.hpp>
+
+namespace hodea {
+
+/**
+ * Read-only memory mapping of a file.
+ */
+class Mapped_file {
+public:
+    explicit Mapped_file(const std::string& fname)
+    {
+        int fd = open(fname.c_str(), O_RDONLY);
+
+        if (fd < 0)
+            throw std::runtime_error(fname + ": cannot open file");
+
+        struct stat st;
+
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error(fname + ": cannot stat file");
+        }
+
+        len = st.st_size;
+        if (len > 0) {
+            void* p = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (p == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error(fname + ": cannot map file");
+            }
+            madvise(p, len, MADV_SEQUENTIAL);
+            addr = static_cast<const uint8_t*>(p);
+        }
+        close(fd);
+    }
+
+    ~Mapped_file()
+    {
+        if (addr)
+            munmap(const_cast<uint8_t*>(addr), len);
+    }
+
+    Mapped_file(const Mapped_file&) = delete;
+    Mapped_file& operator=(const Mapped_file&) = delete;
+
+    const uint8_t* data() const { return addr; }
+
+    std::size_t size() const { return len; }
+
+private:
+    const uint8_t* addr = nullptr;
+    std::size_t len = 0;
+};
+
+/**
+ * Type of a column, i.e. the wire format of a field.
+ */
+struct Column_type {
+    const char* name;
+    int wire_size;
+    int host_size;
+    void (*fetch)(uint8_t* dst, const uint8_t* src);
+};
+
+/**
+ * Fetch a field and store it in host representation.
+ */
+template <typename T, int (*fetch)(T&, const uint8_t*)>
+void fetch_column_value(uint8_t* dst, const uint8_t* src)
+{
+    T v;
+
+    fetch(v, src);
+    std::memcpy(dst, &v, sizeof(v));
+}
+
+/**
+ * Look up a column type by its name.
+ *
+ * \returns
+ *      The column type, or nullptr if the name is unknown.
+ */
+static inline const Column_type* find_column_type(const std::string& name)
+{
+    static const Column_type types[] = {
+        {"u8", 1, 1, fetch_column_value<uint8_t, fetch8<uint8_t>>},
+        {"i8", 1, 1, fetch_column_value<int8_t, fetch8<int8_t>>},
+        {"u16le", 2, 2, fetch_column_value<uint16_t, fetch16_le<uint16_t>>},
+        {"i16le", 2, 2, fetch_column_value<int16_t, fetch16_le<int16_t>>},
+        {"u32le", 4, 4, fetch_column_value<uint32_t, fetch32_le<uint32_t>>},
+        {"i32le", 4, 4, fetch_column_value<int32_t, fetch32_le<int32_t>>},
+        {"u64le", 8, 8, fetch_column_value<uint64_t, fetch64_le<uint64_t>>},
+        {"i64le", 8, 8, fetch_column_value<int64_t, fetch64_le<int64_t>>},
+        {"u16be", 2, 2, fetch_column_value<uint16_t, fetch16_be<uint16_t>>},
+        {"i16be", 2, 2, fetch_column_value<int16_t, fetch16_be<int16_t>>},
+        {"u32be", 4, 4, fetch_column_value<uint32_t, fetch32_be<uint32_t>>},
+        {"i32be", 4, 4, fetch_column_value<int32_t, fetch32_be<int32_t>>},
+        {"u64be", 8, 8, fetch_column_value<uint64_t, fetch64_be<uint64_t>>},
+        {"i64be", 8, 8, fetch_column_value<int64_t, fetch64_be<int64_t>>},
+        {"f32le", 4, 4, fetch_column_value<float, fetch_f32_le>},
+        {"f32be", 4, 4, fetch_column_value<float, fetch_f32_be>},
+        {"f64le", 8, 8, fetch_column_value<double, fetch_f64_le>},
+        {"f64be", 8, 8, fetch_column_value<double, fetch_f64_be>},
+    };
+
+    for (const auto& t : types) {
+        if (name == t.name)
+            return &t;
+    }
+    return nullptr;
+}
+
+/**
+ * Field of a telemetry frame.
+ */
+struct Column {
+    std::string name;
+    const Column_type* type;
+    int offset;                 // offset within the decoded frame
+};
+
+/**
+ * Layout of a telemetry frame.
+ */
+struct Schema {
+    std::vector<Column> columns;
+    int frame_size = 0;
+};
+
+/**
+ * Parse a schema string of the form "name:type,name:type,...".
+ */
+static inline Schema parse_schema(const std::string& spec)
+{
+    Schema schema;
+    std::size_t pos = 0;
+
+    while (pos < spec.size()) {
+        std::size_t end = spec.find(',', pos);
+
+        if (end == std::string::npos)
+            end = spec.size();
+
+        std::string field = spec.substr(pos, end - pos);
+        std::size_t colon = field.find(':');
+
+        if ((colon == 0) || (colon == std::string::npos))
+            throw std::runtime_error(field + ": expected name:type");
+
+        const Column_type* type = find_column_type(field.substr(colon + 1));
+
+        if (!type)
+            throw std::runtime_error(field + ": unknown type");
+
+        schema.columns.push_back(
+            Column{field.substr(0, colon), type, schema.frame_size}
+            );
+        schema.frame_size += type->wire_size;
+        pos = end + 1;
+    }
+
+    if (schema.columns.empty())
+        throw std::runtime_error("empty schema");
+    return schema;
+}
+
+/**
+ * Part of a capture holding complete frames.
+ */
+struct Chunk {
+    std::size_t begin;
+    std::size_t end;
+};
+
+/**
+ * Split a capture into chunks of about \a chunk_size bytes.
+ *
+ * Each chunk ends after a frame delimiter, except the last one.
+ */
+static inline std::vector<Chunk> split_chunks(
+    const uint8_t* data, std::size_t len, std::size_t chunk_size
+    )
+{
+    std::vector<Chunk> chunks;
+    std::size_t begin = 0;
+
+    while (begin < len) {
+        std::size_t end = len;
+
+        if (len - begin > chunk_size) {
+            const void* z = std::memchr(
+                data + begin + chunk_size, 0, len - begin - chunk_size
+                );
+            if (z)
+                end = static_cast<const uint8_t*>(z) - data + 1;
+        }
+        chunks.push_back(Chunk{begin, end});
+        begin = end;
+    }
+    return chunks;
+}
+
+/**
+ * Decoded values of a chunk.
+ */
+struct Chunk_result {
+    std::vector<std::vector<uint8_t>> columns;
+    uint64_t num_frames = 0;
+    uint64_t num_errors = 0;    // malformed frames or wrong size
+};
+
+/**
+ * Decode all frames of a chunk.
+ *
+ * A frame which is not terminated by a delimiter, e.g. a frame
+ * truncated at the end of the capture, is decoded as well and counted
+ * as error if its size does not match.
+ */
+static inline void decode_chunk(
+    Chunk_result& result, const Schema& schema,
+    const uint8_t* data, std::size_t len
+    )
+{
+    const int max_encoded = Cobs_encoder::max_encoded_size(
+        schema.frame_size
+        );
+    std::vector<uint8_t> frame(max_encoded);
+    std::size_t max_frames = len / (schema.frame_size + 2) + 1;
+    const uint8_t* p = data;
+    const uint8_t* end = data + len;
+
+    result.columns.resize(schema.columns.size());
+    for (std::size_t i = 0; i < schema.columns.size(); ++i) {
+        result.columns[i].clear();
+        result.columns[i].reserve(
+            max_frames * schema.columns[i].type->host_size
+            );
+    }
+
+    while (p < end) {
+        const void* z = std::memchr(p, 0, end - p);
+        const uint8_t* frame_end =
+            z ? static_cast<const uint8_t*>(z) : end;
+        std::size_t encoded_len = frame_end - p;
+        const uint8_t* frame_begin = p;
+
+        p = z ? frame_end + 1 : end;
+        if (encoded_len == 0)
+            continue;
+
+        if ((encoded_len > static_cast<std::size_t>(max_encoded)) ||
+            (cobs_decode(frame.data(), frame_begin, encoded_len) !=
+             schema.frame_size)) {
+            ++result.num_errors;
+            continue;
+        }
+
+        for (std::size_t i = 0; i < schema.columns.size(); ++i) {
+            const Column& c = schema.columns[i];
+            std::vector<uint8_t>& col = result.columns[i];
+            std::size_t col_size = col.size();
+
+            col.resize(col_size + c.type->host_size);
+            c.type->fetch(&col[col_size], &frame[c.offset]);
+        }
+        ++result.num_frames;
+    }
+}
+
+/**
+ * Statistics of a decoded capture.
+ */
+struct Decode_stats {
+    uint64_t num_frames = 0;
+    uint64_t num_errors = 0;
+    std::size_t num_chunks = 0;
+};
+
+/**
+ * Decode a capture in parallel.
+ *
+ * The chunks are decoded by \a num_threads worker threads. The results
+ * are passed to \a sink in chunk order by the calling thread. At most
+ * 2 * \a num_threads results are pending at any time, so the memory
+ * required does not depend on the size of the capture.
+ *
+ * If \a sink or the decoding of a chunk throws, e.g. std::bad_alloc,
+ * the workers are stopped and joined, and the first exception is
+ * rethrown to the caller. No further chunks are passed to \a sink.
+ */
+static inline Decode_stats decode_capture(
+    const Schema& schema, const uint8_t* data, std::size_t len,
+    int num_threads, std::size_t chunk_size,
+    const std::function<void(const Chunk_result&)>& sink
+    )
+{
+    const std::vector<Chunk> chunks = split_chunks(data, len, chunk_size);
+    const std::size_t num_chunks = chunks.size();
+    const std::size_t window = 2 * num_threads;
+    std::vector<std::unique_ptr<Chunk_result>> results(num_chunks);
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::size_t next = 0;
+    std::size_t done = 0;
+    bool is_stopped = false;
+    std::exception_ptr error;
+
+    // an exception must not leave a thread, so it is kept for the caller
+    auto stop = [&](std::exception_ptr e) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!error)
+                error = e;
+            is_stopped = true;
+        }
+        cv.notify_all();
+    };
+
+    auto worker = [&] {
+        try {
+            for (;;) {
+                std::size_t idx;
+                {
+                    std::unique_lock<std::mutex> lock(mtx);
+                    cv.wait(lock, [&] {
+                        return is_stopped || (next >= num_chunks) ||
+                            (next < done + window);
+                    });
+                    if (is_stopped || (next >= num_chunks))
+                        return;
+                    idx = next++;
+                }
+
+                std::unique_ptr<Chunk_result> r(new Chunk_result);
+                const Chunk& c = chunks[idx];
+
+                decode_chunk(*r, schema, data + c.begin, c.end - c.begin);
+                {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    results[idx] = std::move(r);
+                }
+                cv.notify_all();
+            }
+        }
+        catch (...) {
+            stop(std::current_exception());
+        }
+    };
+
+    std::vector<std::thread> threads;
+    Decode_stats stats;
+
+    try {
+        for (int i = 0; i < num_threads; ++i)
+            threads.emplace_back(worker);
+
+        for (std::size_t i = 0; i < num_chunks; ++i) {
+            std::unique_ptr<Chunk_result> r;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [&] {
+                    return is_stopped || (results[i] != nullptr);
+                });
+                if (is_stopped)
+                    break;
+                r = std::move(results[i]);
+            }
+
+            sink(*r);
+            stats.num_frames += r->num_frames;
+            stats.num_errors += r->num_errors;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                done = i + 1;
+            }
+            cv.notify_all();
+        }
+    }
+    catch (...) {
+        stop(std::current_exception());
+    }
+
+    for (auto& t : threads)
+        t.join();
+
+    if (error)
+        std::rethrow_exception(error);
+
+    stats.num_chunks = num_chunks;
+    return stats;
+}
+
+} // namespace hodea
+
+#endif /*!HODEA_TOOLS_TELEMETRY_HPP */
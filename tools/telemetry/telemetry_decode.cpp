@@ -0,0 +1,153 @@
+// Copyright (c) 2017, Franz Hollerer.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Decode a captured telemetry stream into columns.
+ *
+ * The tool decodes a capture as described in telemetry.hpp and writes
+ * one file per column, named <prefix><name>.bin. Each file holds the
+ * values of the column as array in host representation, e.g. to be
+ * loaded with numpy.fromfile().
+ *
+ * Build:
+ *
+ * \verbatim
+ * g++ -std=c++14 -O2 -pthread -I<hodea-lib> \
+ *     -o telemetry_decode telemetry_decode.cpp
+ * \endverbatim
+ *
+ * Usage:
+ *
+ * \verbatim
+ * telemetry_decode -s schema [-o prefix] [-j threads] [-c chunk_mib] \
+ *     capture
+ * \endverbatim
+ *
+ * \author f.hollerer@hodea.org
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "telemetry.hpp"
+
+using namespace hodea;
+
+static void usage(const char* prog)
+{
+    fprintf(
+        stderr,
+        "usage: %s -s schema [-o prefix] [-j threads] [-c chunk_mib] "
+        "capture\n"
+        "  -s  frame layout, e.g. seq:u16le,current:i32le,temp:f32be\n"
+        "  -o  prefix of the column files (default: capture name + .)\n"
+        "  -j  number of worker threads (default: number of cores)\n"
+        "  -c  chunk size in MiB (default: 16)\n",
+        prog
+        );
+}
+
+int main(int argc, char* argv[])
+{
+    const char* schema_spec = nullptr;
+    std::string prefix;
+    int num_threads = std::thread::hardware_concurrency();
+    int chunk_mib = 16;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:o:j:c:h")) != -1) {
+        switch (opt) {
+        case 's':
+            schema_spec = optarg;
+            break;
+        case 'o':
+            prefix = optarg;
+            break;
+        case 'j':
+            num_threads = atoi(optarg);
+            break;
+        case 'c':
+            chunk_mib = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    if (!schema_spec || (optind + 1 != argc) || (chunk_mib <= 0)) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (num_threads <= 0)
+        num_threads = 1;
+    if (prefix.empty())
+        prefix = std::string(argv[optind]) + ".";
+
+    std::vector<FILE*> files;
+    int rc = 0;
+
+    try {
+        Schema schema = parse_schema(schema_spec);
+        Mapped_file capture(argv[optind]);
+
+        for (const auto& c : schema.columns) {
+            std::string fname = prefix + c.name + ".bin";
+            FILE* f = fopen(fname.c_str(), "wb");
+
+            if (!f)
+                throw std::runtime_error(fname + ": cannot create file");
+            files.push_back(f);
+        }
+
+        bool write_failed = false;
+        auto start = std::chrono::steady_clock::now();
+
+        Decode_stats stats = decode_capture(
+            schema, capture.data(), capture.size(), num_threads,
+            static_cast<std::size_t>(chunk_mib) << 20,
+            [&](const Chunk_result& r) {
+                for (std::size_t i = 0; i < files.size(); ++i) {
+                    const auto& col = r.columns[i];
+                    if (fwrite(col.data(), 1, col.size(), files[i]) !=
+                        col.size())
+                        write_failed = true;
+                }
+            });
+
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+
+        printf(
+            "frames: %llu, errors: %llu, chunks: %zu, threads: %d\n"
+            "%.1f MiB in %.3f s, %.1f MiB/s\n",
+            static_cast<unsigned long long>(stats.num_frames),
+            static_cast<unsigned long long>(stats.num_errors),
+            stats.num_chunks, num_threads,
+            capture.size() / 1048576.0, elapsed.count(),
+            capture.size() / 1048576.0 / elapsed.count()
+            );
+        for (const auto& c : schema.columns)
+            printf(
+                "%s%s.bin: %s\n",
+                prefix.c_str(), c.name.c_str(), c.type->name
+                );
+
+        if (write_failed)
+            throw std::runtime_error("writing column files failed");
+    }
+    catch (const std::exception& e) {
+        fprintf(stderr, "error: %s\n", e.what());
+        rc = 1;
+    }
+
+    for (FILE* f : files) {
+        if (fclose(f) != 0)
+            rc = 1;
+    }
+    return rc;
+}